@@ -0,0 +1,554 @@
+// PythonBridge round-trip benchmark and soak test on the fake Keep backend
+//
+// Usage: bridge_bench [--python python3] [--script gkeep_bridge/keep_bridge.py]
+//                     [--out bridge_bench.json] [--max-bytes 10485760]
+//                     [--latency-ms 0] [--jitter-ms 0] [--fail-rate 0] [--seed 0]
+//                     [--soak-seconds N] [--import-files N] [--labels N]
+//                     [--crash-every N [--commands N]]
+//                     [--sync-timeout-ms N [--commands N]]
+//
+// Drives the real PythonBridge over its process transport against
+// keep_bridge.py --backend=fake, which keeps notes in memory instead of
+// talking to Google. With no simulated latency the numbers cover pipes,
+// JSON encoding/decoding and dispatch only. Reports p50/p99 latency and
+// commands per second for status, get, create_note and update_note at
+// payload sizes from 100 B up to --max-bytes, and writes the same results
+// as JSON for comparison between builds.
+//
+// --soak-seconds instead runs a random mix of every note command for that
+// long (with --fail-rate, against injected Keep failures) and fails if the
+// bridge dies or stops answering.
+//
+// --import-files generates a tree of N small note files and imports it the
+// way Sync Folder does (BulkImport on a thread pool, creates grouped into
+// batch calls), next to the same files created one round trip each.
+//
+// --labels grows an account to N labels and times creating notes
+// with ten existing labels each at four account sizes on the way, then
+// lists the notes by label. Per-note create time should not grow with the
+// label count.
+//
+// --crash-every makes the bridge process exit without replying to every
+// Nth command. With restarts enabled, --commands reads and idempotent
+// writes must all succeed anyway, each recovery (restart and sign-in) must
+// take under a second, and create_note, which is not sent twice, may fail.
+//
+// --sync-timeout-ms gives sync a deadline shorter than --latency-ms, so
+// every sync fails, and follows each with a create_note and a get of the
+// new note. Those must get their own replies, not the late sync's: a
+// timeout must leave the stream in step without restarting the bridge.
+// Whether a sync fails by timing out here or by the script's own
+// "timed out" reply racing the deadline depends on load, so only the
+// failures and the replies staying in step are checked.
+
+#include "BulkImport.h"
+#include "PythonBridge.h"
+#include "Utf.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace NppGoogleKeepSync;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+    struct Result {
+        std::string command;
+        size_t payloadBytes;
+        size_t iterations;
+        size_t failures;
+        double p50Us;
+        double p99Us;
+        double meanUs;
+        double opsPerSec;
+    };
+
+    double percentile(std::vector<double> samples, double p) {
+        if (samples.empty()) return 0;
+        std::sort(samples.begin(), samples.end());
+        size_t idx = static_cast<size_t>(p * (samples.size() - 1));
+        return samples[idx];
+    }
+
+    // Fewer iterations as payloads grow so a full run stays around a minute
+    size_t iterationsFor(size_t bytes) {
+        if (bytes <= 10 * 1024) return 200;
+        if (bytes <= 100 * 1024) return 50;
+        if (bytes <= 1024 * 1024) return 10;
+        return 3;
+    }
+
+    // Note-like text: short lines with some characters that need escaping
+    std::string makePayload(size_t bytes) {
+        static const char line[] = "- [ ] follow up on \"item\" \\ tab\there, 42%\n";
+        std::string text;
+        text.reserve(bytes);
+        while (text.size() < bytes) {
+            text.append(line, std::min(sizeof(line) - 1, bytes - text.size()));
+        }
+        return text;
+    }
+
+    Result measure(const std::string& command, size_t payloadBytes, size_t iterations,
+                   const std::function<bool()>& op) {
+        op();   // Warm-up
+        std::vector<double> samples;
+        samples.reserve(iterations);
+        size_t failures = 0;
+        auto total = Clock::now();
+        for (size_t i = 0; i < iterations; ++i) {
+            auto start = Clock::now();
+            if (!op()) failures++;
+            samples.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+        }
+        double totalSec = std::chrono::duration<double>(Clock::now() - total).count();
+
+        double sum = 0;
+        for (double s : samples) sum += s;
+        return {command, payloadBytes, iterations, failures,
+                percentile(samples, 0.50), percentile(samples, 0.99),
+                samples.empty() ? 0 : sum / samples.size(),
+                totalSec > 0 ? iterations / totalSec : 0};
+    }
+
+    std::wstring widen(const char* s) {
+        return Utf::FromUtf8(s);
+    }
+
+    bool writeJson(const std::string& path, const std::vector<Result>& results) {
+        std::ofstream out(path, std::ios::trunc);
+        if (!out) return false;
+        out << "{\n  \"benchmark\": \"bridge_bench\",\n";
+        out << "  \"timestamp\": " << static_cast<long long>(std::time(nullptr)) << ",\n";
+#ifdef _WIN32
+        out << "  \"platform\": \"windows\",\n";
+#else
+        out << "  \"platform\": \"posix\",\n";
+#endif
+        out << "  \"results\": [\n";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const Result& r = results[i];
+            char line[512];
+            std::snprintf(line, sizeof(line),
+                          "    {\"command\": \"%s\", \"payload_bytes\": %zu, \"iterations\": %zu, "
+                          "\"failures\": %zu, \"p50_us\": %.1f, \"p99_us\": %.1f, \"mean_us\": %.1f, "
+                          "\"ops_per_sec\": %.1f}%s\n",
+                          r.command.c_str(), r.payloadBytes, r.iterations, r.failures,
+                          r.p50Us, r.p99Us, r.meanUs, r.opsPerSec,
+                          i + 1 < results.size() ? "," : "");
+            out << line;
+        }
+        out << "  ]\n}\n";
+        return out.good();
+    }
+
+    // Random mix of note commands for the given time. Failed commands are
+    // expected under fault injection; losing the bridge is not.
+    int soak(PythonBridge& bridge, double seconds, unsigned seed) {
+        std::mt19937 rng(seed);
+        std::vector<std::string> ids;
+        std::map<std::string, std::pair<size_t, size_t>> counts;     // command -> (ok, failed)
+        auto record = [&](const char* command, bool ok) {
+            auto& c = counts[command];
+            (ok ? c.first : c.second)++;
+        };
+        std::string cursor;
+        auto end = Clock::now() + std::chrono::duration<double>(seconds);
+        size_t total = 0;
+        while (Clock::now() < end) {
+            std::string text = makePayload(100 + rng() % 20000);
+            int pick = static_cast<int>(rng() % 100);
+            if (ids.size() < 5 || pick < 20) {
+                auto r = bridge.CreateNote("soak " + std::to_string(total), text);
+                if (r.success) ids.push_back(bridge.ParseNote(r.raw_json).id);
+                record("create_note", r.success);
+            } else if (pick < 40) {
+                auto r = bridge.UpdateNote(ids[rng() % ids.size()], std::nullopt, text);
+                record("update_note", r.success);
+            } else if (pick < 55) {
+                const std::string& id = ids[rng() % ids.size()];
+                KeepNote note;
+                bool ok = bridge.GetNoteCached(id, note);
+                if (ok) {
+                    ok = bridge.PatchNote(id, note.text, note.text + "appended line\n", std::nullopt).success;
+                }
+                record("patch_note", ok);
+            } else if (pick < 75) {
+                record("get", bridge.GetNote(ids[rng() % ids.size()]).success);
+            } else if (pick < 80) {
+                record("list", bridge.ListNotes(false, 50).success);
+            } else if (pick < 85) {
+                // Streamed in small pages, so the reply spans several frames
+                ListQuery query;
+                query.page_size = 16;
+                size_t streamed = 0;
+                auto r = bridge.StreamNotes(query, [&](KeepNote&) { return ++streamed < 100; });
+                record("list_stream", r.success);
+            } else if (pick < 95) {
+                RemoteChanges changes;
+                auto r = bridge.ChangesSince(cursor, changes);
+                if (r.success) cursor = changes.cursor;
+                record("changes_since", r.success);
+            } else {
+                size_t index = rng() % ids.size();
+                auto r = bridge.DeleteNote(ids[index], true);
+                if (r.success) ids.erase(ids.begin() + index);
+                record("delete", r.success);
+            }
+            total++;
+            if (!bridge.IsConnected()) {
+                std::fprintf(stderr, "bridge lost after %zu commands: %s\n", total, bridge.GetLastError().c_str());
+                return 1;
+            }
+        }
+
+        std::printf("%-14s %10s %10s\n", "command", "ok", "failed");
+        for (const auto& c : counts) {
+            std::printf("%-14s %10zu %10zu\n", c.first.c_str(), c.second.first, c.second.second);
+        }
+        std::printf("%zu commands in %.1f s, %zu notes live\n", total, seconds, ids.size());
+
+        // Still answering after the run
+        if (bridge.GetStatus().raw_json.empty()) {
+            std::fprintf(stderr, "bridge stopped answering: %s\n", bridge.GetLastError().c_str());
+            return 1;
+        }
+        return 0;
+    }
+
+    // Commands against a bridge that keeps dying (--crash-every)
+    int recovery(PythonBridge& bridge, size_t commands, unsigned seed) {
+        RestartPolicy policy;
+        policy.enabled = true;
+        bridge.SetRestartPolicy(policy);
+
+        const auto& counters = bridge.GetCounters();
+        std::mt19937 rng(seed);
+        size_t failed = 0;
+        size_t createFailed = 0;
+        std::string id;
+        uint64_t idRestarts = 0;    // Restarts when id was created
+        for (size_t i = 0; i < commands; ++i) {
+            bool ok;
+            const char* name;
+            int pick = static_cast<int>(rng() % 6);
+            if (id.empty() || pick == 0) {
+                // Each new process starts with an empty fake account
+                name = "create_note";
+                auto r = bridge.CreateNote("recovery " + std::to_string(i), makePayload(200));
+                ok = r.success;
+                id = ok ? bridge.ParseNote(r.raw_json).id : std::string();
+                idRestarts = counters.restarts.load();
+                if (!ok) {
+                    createFailed++;
+                    continue;
+                }
+            } else if (pick == 1) {
+                name = "update_note";
+                ok = bridge.UpdateNote(id, std::nullopt, makePayload(300)).success;
+            } else if (pick == 2) {
+                name = "status";
+                ok = !bridge.GetStatus().raw_json.empty();
+            } else if (pick == 3) {
+                name = "list";
+                ListQuery query;
+                query.page_size = 8;
+                ok = bridge.StreamNotes(query, [](KeepNote&) { return true; }).success;
+            } else if (pick == 4) {
+                name = "changes_since";
+                RemoteChanges changes;
+                ok = bridge.ChangesSince("", changes).success;
+            } else {
+                name = "sync";
+                ok = bridge.Sync().success;
+            }
+            if (ok) continue;
+            if (pick == 1 && counters.restarts.load() != idRestarts) {
+                id.clear();     // The note went with the process that made it
+                continue;
+            }
+            failed++;
+            std::fprintf(stderr, "%s failed: %s\n", name, bridge.GetLastError().c_str());
+        }
+
+        double maxMs = counters.recovery.MaxUs() / 1000.0;
+        std::printf("%zu commands, %llu restarts, %llu replayed, %zu create_note lost\n", commands,
+                    static_cast<unsigned long long>(counters.restarts.load()),
+                    static_cast<unsigned long long>(counters.replayed.load()), createFailed);
+        std::printf("recovery       %llu, mean %.1f ms, max %.1f ms\n",
+                    static_cast<unsigned long long>(counters.recovery.Count()),
+                    counters.recovery.Count() ? counters.recovery.SumUs() / 1000.0 / counters.recovery.Count() : 0.0,
+                    maxMs);
+        if (counters.recovery.Count() == 0 || maxMs >= 1000.0) {
+            std::fprintf(stderr, "expected recoveries under a second\n");
+            return 1;
+        }
+        return failed == 0 ? 0 : 1;
+    }
+    int deadlines(PythonBridge& bridge, size_t commands, uint32_t syncTimeoutMs) {
+        bridge.SetCommandTimeout("sync", std::chrono::milliseconds(syncTimeoutMs));
+        const auto& counters = bridge.GetCounters();
+        size_t failed = 0;
+        std::vector<double> syncMs;
+        for (size_t i = 0; i < commands; ++i) {
+            auto start = Clock::now();
+            if (bridge.Sync().success) {
+                std::fprintf(stderr, "sync %zu finished inside %u ms\n", i, syncTimeoutMs);
+                failed++;
+            }
+            syncMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+
+            std::string title = "deadline " + std::to_string(i);
+            auto created = bridge.CreateNote(title, makePayload(100));
+            std::string id = created.success ? bridge.ParseNote(created.raw_json).id : std::string();
+            auto fetched = id.empty() ? BridgeResult() : bridge.GetNote(id);
+            KeepNote note = fetched.success ? bridge.ParseNote(fetched.raw_json) : KeepNote();
+            if (id.empty() || note.id != id || note.title != title) {
+                std::fprintf(stderr, "command %zu got the wrong reply: %s\n", i,
+                             (fetched.success ? fetched.raw_json : bridge.GetLastError()).c_str());
+                failed++;
+            }
+        }
+
+        std::printf("%zu syncs timed out (median %.1f ms), %llu late replies dropped, %llu restarts\n",
+                    static_cast<size_t>(counters.timeouts.load()), percentile(syncMs, 0.5),
+                    static_cast<unsigned long long>(counters.lateFrames.load()),
+                    static_cast<unsigned long long>(counters.restarts.load()));
+        if (counters.restarts.load() != 0) {
+            std::fprintf(stderr, "expected the bridge to stay up through the timeouts\n");
+            return 1;
+        }
+        return failed == 0 ? 0 : 1;
+    }
+
+    // Bulk import of a generated notes tree: 100 files per directory
+    int import(PythonBridge& bridge, size_t fileCount, unsigned seed) {
+        namespace fs = std::filesystem;
+        fs::path root = fs::temp_directory_path() / "keepsync_bench_import";
+        fs::remove_all(root);
+        std::mt19937 rng(seed);
+        for (size_t i = 0; i < fileCount; ++i) {
+            fs::path dir = root / ("d" + std::to_string(i / 100));
+            if (i % 100 == 0) fs::create_directories(dir);
+            std::ofstream file(dir / ("note" + std::to_string(i) + ".txt"), std::ios::binary);
+            file << makePayload(200 + rng() % 4000);
+        }
+
+        // Baseline: one create_note round trip per file, on a sample
+        size_t sample = std::min<size_t>(fileCount, 200);
+        auto start = Clock::now();
+        for (size_t i = 0; i < sample; ++i) {
+            bridge.CreateNote("baseline " + std::to_string(i), makePayload(200 + i * 20));
+        }
+        double perFile = std::chrono::duration<double>(Clock::now() - start).count() / sample;
+
+        BulkImport::Options options;
+        BulkImport::Progress progress;
+        start = Clock::now();
+        auto files = BulkImport::Enumerate(root.wstring(), options, progress);
+        double enumerateSec = std::chrono::duration<double>(Clock::now() - start).count();
+
+        size_t batches = 0;
+        BulkImport::Hooks hooks;
+        hooks.upload = [&](std::vector<BulkImport::Item>& batch) {
+            std::vector<BatchOp> ops;
+            for (const auto& item : batch) {
+                BatchOp op;
+                op.kind = BatchOp::Kind::Create;
+                op.title = fs::path(item.path).stem().string();
+                op.text = item.content;
+                ops.push_back(std::move(op));
+            }
+            std::vector<std::string> ids;
+            bool ok = bridge.Batch(ops, ids).success && ids.size() == ops.size();
+            for (auto& item : batch) item.ok = ok;
+            batches++;
+            return bridge.IsConnected();
+        };
+        bool completed = BulkImport::Run(files, options, hooks, progress);
+        double importSec = std::chrono::duration<double>(Clock::now() - start).count();
+        fs::remove_all(root);
+
+        std::printf("files          %zu in %zu batches\n", files.size(), batches);
+        std::printf("enumerate      %.2f s\n", enumerateSec);
+        std::printf("bulk import    %.2f s (%.0f files/s)  %s\n", importSec,
+                    importSec > 0 ? files.size() / importSec : 0.0, BulkImport::FormatProgress(progress).c_str());
+        std::printf("one per call   %.2f s estimated (%.0f files/s)\n", perFile * files.size(),
+                    perFile > 0 ? 1.0 / perFile : 0.0);
+        return completed && progress.uploaded == files.size() ? 0 : 1;
+    }
+
+    // Label-heavy account: per-note create time as the label count grows,
+    // then a list filtered by label
+    int labelNotes(PythonBridge& bridge, size_t labelCount) {
+        const size_t perNote = 10;
+        const size_t timedNotes = 200;
+        std::mt19937 rng(1);
+        size_t labels = 0;
+        size_t notes = 0;
+        size_t failures = 0;
+        auto create = [&](const std::vector<std::string>& names) {
+            if (!bridge.CreateNote("labelled " + std::to_string(notes++), "text", false, "DEFAULT", names).success) {
+                failures++;
+            }
+        };
+
+        std::printf("%-10s %16s\n", "labels", "create us/note");
+        for (size_t step = 1; step <= 4; ++step) {
+            // Grow the account with notes that each bring new labels
+            while (labels + perNote <= labelCount * step / 4) {
+                std::vector<std::string> names;
+                for (size_t k = 0; k < perNote; ++k) names.push_back("label" + std::to_string(labels++));
+                create(names);
+            }
+            // Then time notes tagged with existing labels
+            auto start = Clock::now();
+            for (size_t i = 0; i < timedNotes; ++i) {
+                std::vector<std::string> names;
+                for (size_t k = 0; k < perNote; ++k) names.push_back("LABEL" + std::to_string(rng() % labels));
+                create(names);
+            }
+            double us = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / timedNotes;
+            std::printf("%-10zu %16.0f\n", labels, us);
+        }
+
+        auto start = Clock::now();
+        auto listed = bridge.ListNotes(false, 0, "", {"label0", "label1"});
+        double listMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        std::printf("list by label  %.1f ms over %zu notes, %zu failed\n", listMs, notes, failures);
+        return failures == 0 && listed.success ? 0 : 1;
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    const char* python = "python3";
+    const char* script = "gkeep_bridge/keep_bridge.py";
+    const char* outPath = "bridge_bench.json";
+    size_t maxBytes = 10 * 1024 * 1024;
+    double soakSeconds = 0;
+    size_t importFiles = 0;
+    size_t labelCount = 0;
+    size_t crashEvery = 0;
+    uint32_t syncTimeoutMs = 0;
+    size_t commands = 200;
+    std::vector<std::wstring> backendArgs{L"--backend=fake"};
+    unsigned seed = 0;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string flag = argv[i];
+        if (flag == "--python") python = argv[i + 1];
+        else if (flag == "--script") script = argv[i + 1];
+        else if (flag == "--out") outPath = argv[i + 1];
+        else if (flag == "--max-bytes") maxBytes = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (flag == "--soak-seconds") soakSeconds = std::atof(argv[i + 1]);
+        else if (flag == "--import-files") importFiles = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (flag == "--labels") labelCount = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (flag == "--commands") commands = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (flag == "--sync-timeout-ms") syncTimeoutMs = static_cast<uint32_t>(std::strtoul(argv[i + 1], nullptr, 10));
+        else if (flag == "--crash-every") {
+            crashEvery = std::strtoull(argv[i + 1], nullptr, 10);
+            backendArgs.push_back(L"--fake-crash-every=" + widen(argv[i + 1]));
+        }
+        else if (flag == "--latency-ms") backendArgs.push_back(L"--fake-latency-ms=" + widen(argv[i + 1]));
+        else if (flag == "--jitter-ms") backendArgs.push_back(L"--fake-jitter-ms=" + widen(argv[i + 1]));
+        else if (flag == "--fail-rate") backendArgs.push_back(L"--fake-fail-rate=" + widen(argv[i + 1]));
+        else if (flag == "--seed") {
+            seed = static_cast<unsigned>(std::strtoul(argv[i + 1], nullptr, 10));
+            backendArgs.push_back(L"--fake-seed=" + widen(argv[i + 1]));
+        }
+    }
+
+    PythonBridge bridge;
+    if (!bridge.Initialize(widen(python), widen(script), backendArgs)) {
+        std::fprintf(stderr, "failed to start bridge: %s\n", bridge.GetLastError().c_str());
+        return 1;
+    }
+
+    if (soakSeconds > 0) {
+        int rc = soak(bridge, soakSeconds, seed);
+        bridge.Shutdown();
+        return rc;
+    }
+    if (importFiles > 0) {
+        int rc = import(bridge, importFiles, seed);
+        bridge.Shutdown();
+        return rc;
+    }
+    if (labelCount > 0) {
+        int rc = labelNotes(bridge, labelCount);
+        bridge.Shutdown();
+        return rc;
+    }
+    if (crashEvery > 0) {
+        int rc = recovery(bridge, commands, seed);
+        bridge.Shutdown();
+        return rc;
+    }
+    if (syncTimeoutMs > 0) {
+        int rc = deadlines(bridge, commands, syncTimeoutMs);
+        bridge.Shutdown();
+        return rc;
+    }
+
+    std::vector<Result> results;
+
+    // status carries no payload; any reply counts
+    results.push_back(measure("status", 0, 500, [&] {
+        return !bridge.GetStatus().raw_json.empty();
+    }));
+
+    for (size_t bytes = 100; bytes <= maxBytes; bytes *= 10) {
+        std::string payload = makePayload(bytes);
+        size_t iterations = iterationsFor(bytes);
+
+        std::vector<std::string> ids;
+        results.push_back(measure("create_note", bytes, iterations, [&] {
+            auto r = bridge.CreateNote("bench", payload);
+            if (r.success) ids.push_back(bridge.ParseNote(r.raw_json).id);
+            return r.success;
+        }));
+        if (ids.empty()) {
+            std::fprintf(stderr, "create_note failed at %zu bytes: %s\n", bytes, bridge.GetLastError().c_str());
+            return 1;
+        }
+
+        const std::string id = ids.front();
+        results.push_back(measure("get", bytes, iterations, [&] {
+            return bridge.GetNote(id).success;
+        }));
+        results.push_back(measure("update_note", bytes, iterations, [&] {
+            return bridge.UpdateNote(id, std::nullopt, payload).success;
+        }));
+
+        // The fake backend keeps every note in memory; drop this size's notes
+        for (const auto& noteId : ids) {
+            bridge.DeleteNote(noteId, true);
+        }
+    }
+
+    std::printf("%-12s %12s %6s %12s %12s %12s\n", "command", "bytes", "iters", "p50 us", "p99 us", "cmds/s");
+    for (const auto& r : results) {
+        std::printf("%-12s %12zu %6zu %12.1f %12.1f %12.1f%s\n", r.command.c_str(), r.payloadBytes,
+                    r.iterations, r.p50Us, r.p99Us, r.opsPerSec, r.failures ? "  (failures)" : "");
+    }
+
+    bridge.Shutdown();
+
+    if (!writeJson(outPath, results)) {
+        std::fprintf(stderr, "failed to write %s\n", outPath);
+        return 1;
+    }
+    std::printf("results written to %s\n", outPath);
+    return 0;
+}
@@ -0,0 +1,212 @@
+// Throughput benchmark for the sync core's per-file work
+//
+// Usage: core_bench [size_kb] [iterations]
+//
+// Runs each stage a file goes through on its way to Keep (hash, diff and
+// merge against the last synced text, snapshot compression, chunking, and
+// decoding a note-list reply) over a generated note-like text, and reports
+// MB/s per stage. The note-list decoders also report heap allocations for
+// a 10,000-note reply.
+
+#include "Chunker.h"
+#include "Compression.h"
+#include "ContentHash.h"
+#include "Json.h"
+#include "NoteList.h"
+#include "TextMerge.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace NppGoogleKeepSync;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+    volatile size_t g_sink;     // Keeps results observable to the optimiser
+    std::atomic<size_t> g_allocations{0};
+
+    std::string makeText(size_t bytes, unsigned seed) {
+        static const char* const words[] = {
+            "meeting", "follow", "up", "on", "the", "draft", "- [ ]", "TODO:", "call",
+            "\"quoted\"", "review", "notes", "caf\xC3\xA9", "2025-01-01", "\\path", "\t"
+        };
+        std::mt19937 rng(seed);
+        std::string text;
+        text.reserve(bytes);
+        while (text.size() < bytes) {
+            text += words[rng() % 16];
+            text += (rng() % 8 == 0) ? '\n' : ' ';
+        }
+        text.resize(bytes);
+        return text;
+    }
+
+    // Change roughly one line in fifty
+    std::string editLines(const std::string& text, unsigned seed) {
+        std::mt19937 rng(seed);
+        std::string out;
+        out.reserve(text.size() + text.size() / 50);
+        for (auto line : TextMerge::SplitLines(text)) {
+            if (rng() % 50 == 0) out += "edited line\n";
+            else out.append(line.data(), line.size());
+        }
+        return out;
+    }
+
+    std::string escapeJson(const std::string& text) {
+        std::string out;
+        for (char c : text) {
+            switch (c) {
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\t': out += "\\t"; break;
+                default: out += c;
+            }
+        }
+        return out;
+    }
+
+    void run(const char* name, size_t bytes, int iterations, const std::function<size_t()>& op) {
+        g_sink = op();  // Warm-up
+        std::vector<double> samples;
+        for (int i = 0; i < iterations; ++i) {
+            auto start = Clock::now();
+            g_sink = op();
+            samples.push_back(std::chrono::duration<double>(Clock::now() - start).count());
+        }
+        std::sort(samples.begin(), samples.end());
+        double median = samples[samples.size() / 2];
+        std::printf("%-22s %10.2f ms %10.1f MB/s\n", name, median * 1000.0,
+                    median > 0 ? bytes / median / (1024.0 * 1024.0) : 0.0);
+    }
+}
+
+void* operator new(size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+int main(int argc, char** argv)
+{
+    size_t sizeKb = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1024;
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 10;
+    if (sizeKb == 0 || iterations <= 0) {
+        std::fprintf(stderr, "usage: core_bench [size_kb] [iterations]\n");
+        return 1;
+    }
+
+    size_t bytes = sizeKb * 1024;
+    std::string base = makeText(bytes, 1);
+    std::string local = editLines(base, 2);
+    std::string remote = editLines(base, 3);
+    std::string compressed = Compression::Compress(base);
+
+    // A note-list reply carrying the text split across 100 notes
+    std::string reply = "{\"success\": true, \"notes\": [";
+    size_t per = bytes / 100 + 1;
+    for (size_t off = 0, i = 0; off < bytes; off += per, ++i) {
+        if (i > 0) reply += ", ";
+        reply += "{\"id\": \"n" + std::to_string(i) + "\", \"title\": \"t\", \"text\": \"" +
+                 escapeJson(base.substr(off, per)) + "\", \"labels\": [\"work\"]}";
+    }
+    reply += "]}";
+
+    std::printf("core_bench: %zu KB text, %d iterations (median)\n\n", sizeKb, iterations);
+    std::printf("%-22s %13s %15s\n", "stage", "time", "throughput");
+
+    run("md5", bytes, iterations, [&] {
+        return ContentHash::Md5Hex(base).size();
+    });
+    run("crc32", bytes, iterations, [&] {
+        return static_cast<size_t>(ContentHash::Crc32(base));
+    });
+    run("normalize_newlines", bytes, iterations, [&] {
+        return TextMerge::NormalizeNewlines(base).size();
+    });
+    run("diff", bytes, iterations, [&] {
+        return TextMerge::Diff(base, local).size();
+    });
+    run("merge", bytes, iterations, [&] {
+        return TextMerge::Merge(base, local, remote).text.size();
+    });
+    run("compress", bytes, iterations, [&] {
+        return Compression::Compress(base).size();
+    });
+    run("decompress", bytes, iterations, [&] {
+        std::string out;
+        Compression::Decompress(compressed, out);
+        return out.size();
+    });
+    run("chunk (64 KB max)", bytes, iterations, [&] {
+        return Chunker::Split(base, 64 * 1024).size();
+    });
+    run("parse_note_list", reply.size(), iterations, [&] {
+        size_t total = 0;
+        Json::ForEachObject(reply, "notes", [&](const std::string& note) {
+            total += Json::ExtractString(note, "text").size();
+            return true;
+        });
+        return total;
+    });
+    run("parse_note_list (view)", reply.size(), iterations, [&] {
+        NoteList notes;
+        notes.Parse(reply);
+        size_t total = 0;
+        for (size_t i = 0; i < notes.size(); ++i) {
+            total += notes[i].text.size();
+        }
+        return total;
+    });
+
+    // Many small notes, as a full mirror refresh returns them
+    std::string many = "{\"success\": true, \"count\": 10000, \"notes\": [";
+    for (int i = 0; i < 10000; ++i) {
+        if (i > 0) many += ", ";
+        many += "{\"id\": \"n" + std::to_string(i) + "\", \"title\": \"Note " + std::to_string(i) +
+                "\", \"text\": \"" + escapeJson(base.substr(i * 37 % (bytes - 200), 200)) +
+                "\", \"pinned\": false, \"archived\": false, \"color\": \"DEFAULT\", "
+                "\"labels\": [\"work\"], \"timestamp\": \"2025-01-01\", \"edited\": \"2025-01-02\"}";
+    }
+    many += "]}";
+    auto allocations = [&](const char* name, const std::function<size_t()>& op) {
+        size_t before = g_allocations.load();
+        g_sink = op();
+        std::printf("%-22s %10zu allocations for 10000 notes\n", name, g_allocations.load() - before);
+    };
+    std::printf("\n");
+    allocations("parse_note_list", [&] {
+        size_t total = 0;
+        Json::ForEachObject(many, "notes", [&](const std::string& note) {
+            total += Json::ExtractString(note, "id").size() + Json::ExtractString(note, "title").size() +
+                     Json::ExtractString(note, "text").size() + Json::ExtractStringArray(note, "labels").size();
+            return true;
+        });
+        return total;
+    });
+    allocations("parse_note_list (view)", [&] {
+        NoteList notes;
+        notes.Parse(std::string(many));     // The copy stands in for the reply read off the pipe
+        size_t total = 0;
+        for (size_t i = 0; i < notes.size(); ++i) {
+            total += notes[i].id.size() + notes[i].title.size() + notes[i].text.size() + notes[i].LabelCount();
+        }
+        return total;
+    });
+
+    std::printf("\ncompression ratio %.2f\n", static_cast<double>(compressed.size()) / bytes);
+    return 0;
+}
@@ -0,0 +1,143 @@
+// SyncRules benchmark
+//
+// Usage: rules_bench [paths] [iterations]
+//
+// Checks generated paths against a few hundred rules (extensions, names,
+// rooted directories, globs, some with size bounds) and reports ns per
+// path for the compiled rule set next to checking the same rules one at a
+// time, as a linear scan over the config lists would. Also reports heap
+// allocations made while checking, which should be zero.
+
+#include "SyncRules.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+    volatile size_t g_sink;     // Keeps results observable to the optimiser
+    std::atomic<size_t> g_allocations{0};
+
+    struct Rules {
+        std::vector<std::wstring> extensions;
+        std::vector<std::wstring> patterns;
+    };
+
+    Rules makeRules(std::mt19937& rng) {
+        Rules rules;
+        for (int i = 0; i < 200; ++i) rules.extensions.push_back(L"x" + std::to_wstring(i));
+        for (int i = 0; i < 100; ++i) rules.patterns.push_back(L"name" + std::to_wstring(i));
+        for (int i = 0; i < 50; ++i) rules.patterns.push_back(L"C:\\Exclude" + std::to_wstring(i) + L"\\");
+        for (int i = 0; i < 40; ++i) {
+            rules.patterns.push_back(L"**/gen" + std::to_wstring(i) + L"/*.tmp");
+        }
+        for (int i = 0; i < 10; ++i) {
+            rules.patterns.push_back(L"*.part" + std::to_wstring(i) + L" >" + std::to_wstring(rng() % 64 + 1) + L"KB");
+        }
+        return rules;
+    }
+
+    std::vector<std::wstring> makePaths(size_t count, std::mt19937& rng) {
+        static const wchar_t* const dirs[] = {L"src", L"docs", L"Notes", L"projects", L"2024", L"archive",
+                                              L"drafts", L"work", L"name7", L"gen3", L"Exclude4"};
+        static const wchar_t* const exts[] = {L"txt", L"md", L"cpp", L"h", L"log", L"x17", L"tmp", L"part2"};
+        std::vector<std::wstring> paths;
+        paths.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            std::wstring path = L"C:";
+            size_t depth = 2 + rng() % 5;
+            for (size_t d = 0; d < depth; ++d) {
+                path += L'\\';
+                path += dirs[rng() % (sizeof(dirs) / sizeof(dirs[0]))];
+            }
+            path += L"\\file" + std::to_wstring(rng() % 1000) + L'.' + exts[rng() % (sizeof(exts) / sizeof(exts[0]))];
+            paths.push_back(std::move(path));
+        }
+        return paths;
+    }
+
+    double median(int iterations, const std::function<size_t()>& op) {
+        g_sink = op();  // Warm-up
+        std::vector<double> samples;
+        for (int i = 0; i < iterations; ++i) {
+            auto start = Clock::now();
+            g_sink = op();
+            samples.push_back(std::chrono::duration<double>(Clock::now() - start).count());
+        }
+        std::sort(samples.begin(), samples.end());
+        return samples[samples.size() / 2];
+    }
+}
+
+void* operator new(size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+int main(int argc, char** argv)
+{
+    size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 10;
+    if (count == 0 || iterations <= 0) {
+        std::fprintf(stderr, "usage: rules_bench [paths] [iterations]\n");
+        return 1;
+    }
+
+    std::mt19937 rng(42);
+    Rules rules = makeRules(rng);
+    std::vector<std::wstring> paths = makePaths(count, rng);
+    std::vector<uint64_t> sizes(count);
+    for (auto& size : sizes) size = rng() % (128 * 1024);
+
+    SyncRules compiled = SyncRules::Compile(rules.extensions, rules.patterns);
+    std::vector<SyncRules> oneByOne;
+    for (const auto& extension : rules.extensions) oneByOne.push_back(SyncRules::Compile({extension}));
+    for (const auto& pattern : rules.patterns) oneByOne.push_back(SyncRules::Compile({}, {pattern}));
+
+    auto runCompiled = [&] {
+        size_t excluded = 0;
+        for (size_t i = 0; i < count; ++i) excluded += compiled.IsExcluded(paths[i], sizes[i]);
+        return excluded;
+    };
+    auto runLinear = [&] {
+        size_t excluded = 0;
+        for (size_t i = 0; i < count; ++i) {
+            excluded += std::any_of(oneByOne.begin(), oneByOne.end(),
+                                    [&](const SyncRules& rule) { return rule.IsExcluded(paths[i], sizes[i]); });
+        }
+        return excluded;
+    };
+
+    size_t excluded = runCompiled();
+    if (excluded != runLinear()) {
+        std::fprintf(stderr, "compiled and linear results disagree\n");
+        return 1;
+    }
+
+    std::printf("rules_bench: %zu rules, %zu paths (%zu excluded), %d iterations (median)\n\n",
+                rules.extensions.size() + rules.patterns.size(), count, excluded, iterations);
+    double fast = median(iterations, runCompiled);
+    double slow = median(iterations, runLinear);
+    std::printf("%-10s %10.1f ns/path\n", "compiled", fast * 1e9 / count);
+    std::printf("%-10s %10.1f ns/path\n", "linear", slow * 1e9 / count);
+    std::printf("%-10s %10.1fx\n", "speedup", slow / fast);
+
+    size_t before = g_allocations.load();
+    g_sink = runCompiled();
+    std::printf("\n%-10s %10zu allocations for %zu checks\n", "compiled", g_allocations.load() - before, count);
+    return 0;
+}
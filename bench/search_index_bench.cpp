@@ -0,0 +1,156 @@
+// NoteSearchIndex benchmark on a generated corpus
+//
+// Usage: search_index_bench [note_count] [query_count]
+//
+// Builds an index over synthetic notes whose words follow a Zipf
+// distribution (so common terms have long postings lists), then reports
+// build throughput, query latency percentiles and save/load times.
+
+#include "NoteSearchIndex.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace NppGoogleKeepSync;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+    double elapsedMs(Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    std::vector<std::string> makeVocabulary(size_t size, std::mt19937& rng) {
+        static const char* const syllables[] = {
+            "ka", "lo", "mi", "ne", "ru", "sa", "to", "vi", "ze", "qu",
+            "bar", "den", "fol", "gir", "hum", "jas", "pel", "tor", "wex", "yin"
+        };
+        std::uniform_int_distribution<int> pick(0, 19);
+        std::uniform_int_distribution<int> parts(2, 4);
+        std::vector<std::string> vocab;
+        vocab.reserve(size);
+        for (size_t i = 0; i < size; ++i) {
+            std::string word;
+            int n = parts(rng);
+            for (int j = 0; j < n; ++j) word += syllables[pick(rng)];
+            word += std::to_string(i % 97);
+            vocab.push_back(word);
+        }
+        return vocab;
+    }
+
+    // Inverse-CDF sampler for a Zipf(s=1) distribution over the vocabulary
+    class ZipfSampler {
+    public:
+        ZipfSampler(size_t n) : m_cdf(n) {
+            double sum = 0;
+            for (size_t i = 0; i < n; ++i) {
+                sum += 1.0 / static_cast<double>(i + 1);
+                m_cdf[i] = sum;
+            }
+            for (auto& v : m_cdf) v /= sum;
+        }
+        size_t operator()(std::mt19937& rng) {
+            double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+            return static_cast<size_t>(std::lower_bound(m_cdf.begin(), m_cdf.end(), u) - m_cdf.begin());
+        }
+    private:
+        std::vector<double> m_cdf;
+    };
+
+    double percentile(std::vector<double> samples, double p) {
+        if (samples.empty()) return 0;
+        std::sort(samples.begin(), samples.end());
+        size_t idx = static_cast<size_t>(p * (samples.size() - 1));
+        return samples[idx];
+    }
+}
+
+int main(int argc, char** argv)
+{
+    size_t noteCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+    size_t queryCount = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2000;
+
+    std::mt19937 rng(42);
+    auto vocab = makeVocabulary(50000, rng);
+    ZipfSampler zipf(vocab.size());
+    std::uniform_int_distribution<int> bodyWords(20, 400);
+
+    std::vector<KeepNote> notes(noteCount);
+    size_t corpusBytes = 0;
+    for (size_t i = 0; i < noteCount; ++i) {
+        KeepNote& note = notes[i];
+        note.id = "note-" + std::to_string(i);
+        for (int w = 0; w < 4; ++w) note.title += vocab[zipf(rng)] + " ";
+        int words = bodyWords(rng);
+        for (int w = 0; w < words; ++w) {
+            note.text += vocab[zipf(rng)];
+            note.text += (w % 12 == 11) ? "\n" : " ";
+        }
+        corpusBytes += note.title.size() + note.text.size();
+    }
+
+    NoteSearchIndex index;
+    auto start = Clock::now();
+    for (const auto& note : notes) index.Upsert(note);
+    double buildMs = elapsedMs(start);
+
+    // Incremental updates: re-index 10% of the notes with edited text
+    start = Clock::now();
+    for (size_t i = 0; i < noteCount; i += 10) {
+        KeepNote edited = notes[i];
+        edited.text += " " + vocab[zipf(rng)];
+        index.Upsert(edited);
+    }
+    double updateMs = elapsedMs(start);
+
+    // Queries mix common, mid-frequency and rare terms, one to three terms each
+    std::uniform_int_distribution<size_t> anyWord(0, vocab.size() - 1);
+    std::uniform_int_distribution<int> termCount(1, 3);
+    std::vector<double> latenciesUs;
+    latenciesUs.reserve(queryCount);
+    size_t totalHits = 0;
+    for (size_t q = 0; q < queryCount; ++q) {
+        std::string query;
+        int terms = termCount(rng);
+        for (int t = 0; t < terms; ++t) {
+            query += (t % 2 == 0 ? vocab[zipf(rng)] : vocab[anyWord(rng) % 2000]) + " ";
+        }
+        auto qs = Clock::now();
+        auto hits = index.Search(query, 50);
+        latenciesUs.push_back(std::chrono::duration<double, std::micro>(Clock::now() - qs).count());
+        totalHits += hits.size();
+    }
+
+    auto path = std::filesystem::temp_directory_path() / "search_index_bench.idx";
+    start = Clock::now();
+    bool saved = index.Save(path);
+    double saveMs = elapsedMs(start);
+
+    NoteSearchIndex loaded;
+    start = Clock::now();
+    bool reloaded = loaded.Load(path);
+    double loadMs = elapsedMs(start);
+    auto fileBytes = saved ? std::filesystem::file_size(path) : 0;
+    std::filesystem::remove(path);
+
+    std::printf("notes:            %zu (%.1f MB text)\n", noteCount, corpusBytes / 1048576.0);
+    std::printf("terms:            %zu\n", index.TermCount());
+    std::printf("build:            %.1f ms (%.0f notes/s)\n", buildMs, noteCount / (buildMs / 1000.0));
+    std::printf("reindex 10%%:      %.1f ms\n", updateMs);
+    std::printf("queries:          %zu (avg %.1f hits)\n", queryCount,
+                static_cast<double>(totalHits) / std::max<size_t>(1, queryCount));
+    std::printf("query p50:        %.1f us\n", percentile(latenciesUs, 0.50));
+    std::printf("query p99:        %.1f us\n", percentile(latenciesUs, 0.99));
+    std::printf("query max:        %.1f us\n", percentile(latenciesUs, 1.0));
+    std::printf("save:             %.1f ms (%.1f MB)%s\n", saveMs, fileBytes / 1048576.0, saved ? "" : " FAILED");
+    std::printf("load:             %.1f ms%s\n", loadMs, reloaded ? "" : " FAILED");
+
+    return (saved && reloaded && loaded.DocumentCount() == index.DocumentCount()) ? 0 : 1;
+}
@@ -0,0 +1,158 @@
+// Plugin startup benchmark: bridge started in setInfo vs on a background thread
+//
+// Usage: startup_bench [--python python3] [--script gkeep_bridge/keep_bridge.py]
+//                      [--latency-ms 200] [--runs 5]
+//
+// Replays what FileSyncManager::Initialize does with the bridge on the fake
+// Keep backend, whose --latency-ms stands in for Google's sign-in time:
+//
+//   eager  the old setInfo: start Python, wait for its ready frame, load
+//          the mirror and sign in, all before returning
+//   lazy   the current setInfo: create the bridge object and hand the same
+//          steps to another thread, which the first sync waits for
+//
+// For each it reports the median time setInfo blocks Notepad++ and the
+// time until a file saved right after startup is in Keep. Lazy startup
+// should block for well under a millisecond and sync that first save no
+// later than eager startup does.
+
+#include "PythonBridge.h"
+#include "Utf.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace NppGoogleKeepSync;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+    struct Options {
+        std::wstring python = L"python3";
+        std::wstring script = L"gkeep_bridge/keep_bridge.py";
+        std::vector<std::wstring> backendArgs{L"--backend=fake"};
+        std::filesystem::path mirror;
+    };
+
+    struct Sample {
+        double blockedMs;       // setInfo returned
+        double firstSyncMs;     // First save created in Keep
+    };
+
+    double msSince(Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    double median(std::vector<double> samples) {
+        if (samples.empty()) return 0;
+        std::sort(samples.begin(), samples.end());
+        return samples[samples.size() / 2];
+    }
+
+    // The bridge steps FileSyncManager::Start takes
+    bool startBridge(PythonBridge& bridge, const Options& options) {
+        if (!bridge.Initialize(options.python, options.script, options.backendArgs)) {
+            std::fprintf(stderr, "failed to start bridge: %s\n", bridge.GetLastError().c_str());
+            return false;
+        }
+        bridge.EnableMirror(options.mirror.wstring(), std::chrono::seconds(300));
+        auto login = bridge.Login("bench@example.com", "app-password");
+        if (!login.success) {
+            std::fprintf(stderr, "sign-in failed: %s\n", login.error_message.c_str());
+        }
+        return login.success;
+    }
+
+    bool firstSync(PythonBridge& bridge) {
+        return bridge.CreateNote("saved", "saved during startup").success;
+    }
+
+    bool eager(const Options& options, Sample& sample) {
+        auto start = Clock::now();
+        PythonBridge bridge;
+        bool ok = startBridge(bridge, options);
+        sample.blockedMs = msSince(start);
+
+        ok = ok && firstSync(bridge);
+        sample.firstSyncMs = msSince(start);
+        bridge.Shutdown();
+        return ok;
+    }
+
+    bool lazy(const Options& options, Sample& sample) {
+        auto start = Clock::now();
+        PythonBridge bridge;
+        std::once_flag startOnce;
+        bool started = false;
+        auto ensureStarted = [&] {
+            std::call_once(startOnce, [&] { started = startBridge(bridge, options); });
+            return started;
+        };
+        std::thread queue(ensureStarted);
+        sample.blockedMs = msSince(start);
+
+        // A save queued now runs once the bridge is up
+        bool ok = ensureStarted() && firstSync(bridge);
+        sample.firstSyncMs = msSince(start);
+        queue.join();
+        bridge.Shutdown();
+        return ok;
+    }
+
+    bool run(const char* name, const std::function<bool(Sample&)>& startup, int runs, Sample& result) {
+        std::vector<double> blocked, firstSync;
+        for (int i = 0; i < runs; ++i) {
+            Sample sample{};
+            if (!startup(sample)) {
+                std::fprintf(stderr, "%s startup failed\n", name);
+                return false;
+            }
+            blocked.push_back(sample.blockedMs);
+            firstSync.push_back(sample.firstSyncMs);
+        }
+        result = {median(blocked), median(firstSync)};
+        std::printf("%-8s %14.3f %18.1f\n", name, result.blockedMs, result.firstSyncMs);
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    std::string latency = "200";
+    int runs = 5;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string flag = argv[i];
+        if (flag == "--python") options.python = Utf::FromUtf8(argv[i + 1]);
+        else if (flag == "--script") options.script = Utf::FromUtf8(argv[i + 1]);
+        else if (flag == "--latency-ms") latency = argv[i + 1];
+        else if (flag == "--runs") runs = std::max(1, std::atoi(argv[i + 1]));
+    }
+    options.backendArgs.push_back(L"--fake-latency-ms=" + Utf::FromUtf8(latency));
+    options.mirror = std::filesystem::temp_directory_path() / "startup_bench.mirror";
+
+    std::printf("startup with %s ms sign-in latency, median of %d runs\n\n", latency.c_str(), runs);
+    std::printf("%-8s %14s %18s\n", "mode", "setInfo (ms)", "first sync (ms)");
+
+    Sample eagerResult{}, lazyResult{};
+    bool ok = run("eager", [&](Sample& s) { return eager(options, s); }, runs, eagerResult) &&
+              run("lazy", [&](Sample& s) { return lazy(options, s); }, runs, lazyResult);
+
+    std::error_code ec;
+    std::filesystem::remove(options.mirror, ec);
+    if (!ok) return 1;
+
+    std::printf("\nsetInfo %.0fx faster\n", lazyResult.blockedMs > 0 ? eagerResult.blockedMs / lazyResult.blockedMs : 0);
+    if (lazyResult.blockedMs >= eagerResult.blockedMs) {
+        std::fprintf(stderr, "lazy startup blocked as long as eager startup\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,140 @@
+// Utf transcoding benchmark
+//
+// Usage: utf_bench [size_kb] [iterations]
+//
+// Converts generated text of four kinds (pure ASCII, Latin text with
+// accents, CJK, and chat-style text heavy with emoji) between UTF-8 and
+// wide strings, and reports MB/s (of UTF-8) for Utf::ToUtf8, Utf::FromUtf8
+// and Utf::IsValidUtf8 next to a one-character-at-a-time reference.
+
+#include "Utf.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+    volatile size_t g_sink;     // Keeps results observable to the optimiser
+
+    // Words drawn at random until the text reaches `bytes` of UTF-8
+    std::string makeText(const std::vector<const char*>& words, size_t bytes, unsigned seed) {
+        std::mt19937 rng(seed);
+        std::string text;
+        text.reserve(bytes + 16);
+        while (text.size() < bytes) {
+            text += words[rng() % words.size()];
+            text += (rng() % 10 == 0) ? '\n' : ' ';
+        }
+        return text;
+    }
+
+    // The scalar reference: one code point at a time, no block fast path
+    std::string referenceToUtf8(const std::wstring& text) {
+        std::string out;
+        out.reserve(text.size());
+        for (size_t i = 0; i < text.size(); ++i) {
+            char32_t cp = static_cast<uint32_t>(text[i]);
+            if (sizeof(wchar_t) == 2 && cp >= 0xD800 && cp <= 0xDBFF && i + 1 < text.size()) {
+                cp = 0x10000 + ((cp - 0xD800) << 10) + (static_cast<uint32_t>(text[++i]) - 0xDC00);
+            }
+            Utf::Append(out, cp);
+        }
+        return out;
+    }
+
+    std::wstring referenceFromUtf8(const std::string& text) {
+        std::wstring out;
+        out.reserve(text.size());
+        for (size_t i = 0; i < text.size(); ) {
+            char32_t cp;
+            i += Utf::Decode(text, i, cp);
+            if (sizeof(wchar_t) == 2 && cp >= 0x10000) {
+                out += static_cast<wchar_t>(0xD800 + ((cp - 0x10000) >> 10));
+                out += static_cast<wchar_t>(0xDC00 + ((cp - 0x10000) & 0x3FF));
+            } else {
+                out += static_cast<wchar_t>(cp);
+            }
+        }
+        return out;
+    }
+
+    double median(int iterations, const std::function<size_t()>& op) {
+        g_sink = op();  // Warm-up
+        std::vector<double> samples;
+        for (int i = 0; i < iterations; ++i) {
+            auto start = Clock::now();
+            g_sink = op();
+            samples.push_back(std::chrono::duration<double>(Clock::now() - start).count());
+        }
+        std::sort(samples.begin(), samples.end());
+        return samples[samples.size() / 2];
+    }
+}
+
+int main(int argc, char** argv)
+{
+    size_t sizeKb = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1024;
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 20;
+    if (sizeKb == 0 || iterations <= 0) {
+        std::fprintf(stderr, "usage: utf_bench [size_kb] [iterations]\n");
+        return 1;
+    }
+
+    struct Corpus {
+        const char* name;
+        std::vector<const char*> words;
+    };
+    std::vector<Corpus> corpora = {
+        {"ascii", {"meeting", "notes", "follow", "up", "- [ ]", "TODO:", "review", "the", "draft", "2025-01-01"}},
+        {"latin", {"r\xC3\xA9union", "notes", "caf\xC3\xA9", "gr\xC3\xBC\xC3\x9F" "e", "ma\xC3\xB1" "ana", "the",
+                   "na\xC3\xAFve", "se\xC3\xB1or", "d\xC3\xA9j\xC3\xA0", "plan"}},
+        {"cjk", {"\xE4\xBC\x9A\xE8\xAD\xB0", "\xE3\x83\xA1\xE3\x83\xA2", "\xE6\x9D\xB1\xE4\xBA\xAC",
+                 "\xE7\xA2\xBA\xE8\xAA\x8D", "\xED\x9A\x8C\xEC\x9D\x98", "\xE8\xAE\xA1\xE5\x88\x92", "OK"}},
+        {"emoji", {"\xF0\x9F\x98\x80", "lol", "\xF0\x9F\x8E\x89\xF0\x9F\x8E\x89", "see", "you",
+                   "\xE2\x9D\xA4\xEF\xB8\x8F", "\xF0\x9F\x91\x8D", "tmrw", "\xF0\x9F\x9A\x80"}},
+    };
+
+    size_t bytes = sizeKb * 1024;
+    std::printf("utf_bench: %zu KB per corpus, %d iterations (median), %zu-byte wchar_t\n\n",
+                sizeKb, iterations, sizeof(wchar_t));
+    std::printf("%-8s %-12s %12s %12s %8s\n", "corpus", "op", "Utf MB/s", "scalar MB/s", "speedup");
+
+    for (size_t c = 0; c < corpora.size(); ++c) {
+        std::string utf8 = makeText(corpora[c].words, bytes, static_cast<unsigned>(c + 1));
+        std::wstring wide = Utf::FromUtf8(utf8);
+        if (Utf::ToUtf8(wide) != utf8 || referenceFromUtf8(utf8) != wide || referenceToUtf8(wide) != utf8) {
+            std::fprintf(stderr, "%s: conversions disagree\n", corpora[c].name);
+            return 1;
+        }
+
+        double mb = utf8.size() / (1024.0 * 1024.0);
+        auto report = [&](const char* op, double fast, double slow) {
+            std::printf("%-8s %-12s %12.1f %12.1f %7.1fx\n", corpora[c].name, op, mb / fast, mb / slow, slow / fast);
+        };
+        report("to_utf8",
+               median(iterations, [&] { return Utf::ToUtf8(wide).size(); }),
+               median(iterations, [&] { return referenceToUtf8(wide).size(); }));
+        report("from_utf8",
+               median(iterations, [&] { return Utf::FromUtf8(utf8).size(); }),
+               median(iterations, [&] { return referenceFromUtf8(utf8).size(); }));
+        report("validate",
+               median(iterations, [&] { return static_cast<size_t>(Utf::IsValidUtf8(utf8)); }),
+               median(iterations, [&] {
+                   size_t bad = 0;
+                   for (size_t i = 0; i < utf8.size(); ) {
+                       char32_t cp;
+                       i += Utf::Decode(utf8, i, cp);
+                       bad += cp == 0xFFFD;
+                   }
+                   return bad;
+               }));
+    }
+    return 0;
+}
@@ -0,0 +1,105 @@
+// BridgeTransport - byte stream between PythonBridge and the bridge process
+// ARM64 Windows Compatible
+//
+// PythonBridge speaks newline-delimited JSON over this interface.
+// ProcessTransport runs the bridge as a child process on its stdin/stdout
+// (Win32 pipes on Windows, POSIX pipes elsewhere); tests and benchmarks
+// can substitute their own implementation.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/types.h>
+#endif
+
+namespace NppGoogleKeepSync {
+
+class BridgeTransport {
+public:
+    virtual ~BridgeTransport() = default;
+
+    /**
+     * Launch the bridge
+     * @param program Executable (looked up on PATH)
+     * @param args Arguments after the program name
+     */
+    virtual bool Start(const std::wstring& program, const std::vector<std::wstring>& args) = 0;
+
+    /**
+     * Close the stream and end the bridge, forcibly if it does not exit
+     */
+    virtual void Stop() = 0;
+
+    /**
+     * End the bridge from another thread, so a Read blocked there fails
+     * now instead of at its timeout. Nothing can be started afterwards.
+     * A transport whose reads never block need not override this.
+     */
+    virtual void Interrupt() {}
+
+    /**
+     * True while the bridge is running
+     */
+    virtual bool IsAlive() = 0;
+
+    /**
+     * Write all of data
+     */
+    virtual bool Write(const char* data, size_t size) = 0;
+
+    /**
+     * Read whatever is available, waiting at most timeout_ms for data
+     * @return Bytes read, 0 on timeout, -1 once the stream is closed or broken
+     */
+    virtual long long Read(char* buffer, size_t size, uint32_t timeout_ms) = 0;
+
+    const std::string& GetLastError() const { return m_last_error; }
+
+protected:
+    std::string m_last_error;
+};
+
+/**
+ * Child process with its stdin/stdout as the stream
+ */
+class ProcessTransport : public BridgeTransport {
+public:
+    ProcessTransport() = default;
+    ~ProcessTransport() override;
+
+    ProcessTransport(const ProcessTransport&) = delete;
+    ProcessTransport& operator=(const ProcessTransport&) = delete;
+
+    bool Start(const std::wstring& program, const std::vector<std::wstring>& args) override;
+    void Stop() override;
+    void Interrupt() override;
+    bool IsAlive() override;
+    bool Write(const char* data, size_t size) override;
+    long long Read(char* buffer, size_t size, uint32_t timeout_ms) override;
+
+private:
+    // Guards the process handle or pid, which Interrupt reads from another
+    // thread
+    std::mutex m_processMutex;
+    bool m_interrupted = false;
+#ifdef _WIN32
+    HANDLE m_hStdInWr = nullptr;
+    HANDLE m_hStdOutRd = nullptr;
+    HANDLE m_hProcess = nullptr;
+    HANDLE m_hThread = nullptr;
+#else
+    int m_stdinFd = -1;
+    int m_stdoutFd = -1;
+    pid_t m_pid = -1;
+#endif
+};
+
+} // namespace NppGoogleKeepSync
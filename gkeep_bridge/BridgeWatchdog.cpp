@@ -0,0 +1,64 @@
+// BridgeWatchdog - keeps the bridge process answering between commands
+
+#include "BridgeWatchdog.h"
+
+namespace NppGoogleKeepSync {
+
+BridgeWatchdog::BridgeWatchdog(PythonBridge& bridge, std::recursive_mutex& bridge_mutex,
+                               std::chrono::milliseconds interval, uint32_t ping_timeout_ms)
+    : m_bridge(bridge)
+    , m_bridge_mutex(bridge_mutex)
+    , m_interval(interval)
+    , m_ping_timeout_ms(ping_timeout_ms)
+{
+}
+
+BridgeWatchdog::~BridgeWatchdog()
+{
+    Stop();
+}
+
+void BridgeWatchdog::Start()
+{
+    if (m_thread.joinable()) {
+        return;
+    }
+    m_stop = false;
+    m_thread = std::thread([this] { Run(); });
+}
+
+void BridgeWatchdog::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+bool BridgeWatchdog::Check()
+{
+    std::unique_lock<std::recursive_mutex> lock(m_bridge_mutex, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        return true;
+    }
+    if (m_bridge.Ping(m_ping_timeout_ms)) {
+        return true;
+    }
+    return m_bridge.Recover();
+}
+
+void BridgeWatchdog::Run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_wake.wait_for(lock, m_interval, [this] { return m_stop; })) {
+        lock.unlock();
+        Check();
+        lock.lock();
+    }
+}
+
+} // namespace NppGoogleKeepSync
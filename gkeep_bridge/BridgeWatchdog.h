@@ -0,0 +1,64 @@
+#pragma once
+
+/**
+ * BridgeWatchdog - keeps the bridge process answering between commands
+ *
+ * Commands restart a dead bridge themselves (see RestartPolicy), but only
+ * when one is sent; a bridge that died or hung while idle would make the
+ * next sync pay for the restart. The watchdog sends it a side-effect free
+ * ping every interval and restarts it when the ping fails, so it is
+ * usually back before anyone needs it. It never waits for the bridge:
+ * while a command holds the lock the check is skipped, since that command
+ * will notice a dead process itself.
+ */
+
+#include "PythonBridge.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+namespace NppGoogleKeepSync {
+
+class BridgeWatchdog {
+public:
+    /**
+     * @param bridge Bridge to watch; must outlive the watchdog
+     * @param bridge_mutex Held by everything that uses the bridge
+     * @param interval Time between pings
+     * @param ping_timeout_ms A bridge that takes longer to answer is hung
+     */
+    BridgeWatchdog(PythonBridge& bridge, std::recursive_mutex& bridge_mutex,
+                   std::chrono::milliseconds interval, uint32_t ping_timeout_ms = 5000);
+    ~BridgeWatchdog();
+
+    BridgeWatchdog(const BridgeWatchdog&) = delete;
+    BridgeWatchdog& operator=(const BridgeWatchdog&) = delete;
+
+    void Start();
+    void Stop();
+
+    /**
+     * One check now: ping the bridge and restart it if the ping fails
+     * @return false if the bridge is down and could not be restarted
+     *         (the restart backs off and is tried again next time)
+     */
+    bool Check();
+
+private:
+    void Run();
+
+    PythonBridge& m_bridge;
+    std::recursive_mutex& m_bridge_mutex;
+    std::chrono::milliseconds m_interval;
+    uint32_t m_ping_timeout_ms;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_stop = false;
+    std::thread m_thread;
+};
+
+} // namespace NppGoogleKeepSync
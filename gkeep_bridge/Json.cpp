@@ -0,0 +1,164 @@
+// Json - the small JSON reader used for bridge replies
+
+#include "Json.h"
+
+#include <cctype>
+
+namespace NppGoogleKeepSync {
+namespace Json {
+
+namespace {
+    void appendUtf8(std::string& out, unsigned int cp) {
+        if (cp < 0x80) {
+            out += static_cast<char>(cp);
+        } else if (cp < 0x800) {
+            out += static_cast<char>(0xC0 | (cp >> 6));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            out += static_cast<char>(0xE0 | (cp >> 12));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (cp >> 18));
+            out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    }
+
+    // Exactly four hex digits at pos; strtoul would take "12\"" or "+1f" as well
+    bool parseHex4(const std::string& json, size_t pos, unsigned int& cp) {
+        if (pos + 4 > json.length()) return false;
+        cp = 0;
+        for (size_t i = pos; i < pos + 4; ++i) {
+            if (!std::isxdigit(static_cast<unsigned char>(json[i]))) return false;
+            char c = json[i];
+            unsigned int d = c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10;
+            cp = (cp << 4) | d;
+        }
+        return true;
+    }
+}
+
+std::string ReadString(const std::string& json, size_t start)
+{
+    std::string out;
+    for (size_t i = start; i < json.length(); ++i) {
+        char c = json[i];
+        if (c == '"') break;
+        if (c != '\\' || i + 1 >= json.length()) {
+            out += c;
+            continue;
+        }
+        char e = json[++i];
+        switch (e) {
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'u': {
+                unsigned int cp;
+                if (!parseHex4(json, i + 1, cp)) return "";
+                i += 4;
+                // Python's json.dumps escapes non-BMP characters as surrogate pairs
+                if (cp >= 0xD800 && cp <= 0xDBFF && i + 6 < json.length() &&
+                    json[i + 1] == '\\' && json[i + 2] == 'u') {
+                    unsigned int lo;
+                    if (parseHex4(json, i + 3, lo) && lo >= 0xDC00 && lo <= 0xDFFF) {
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                        i += 6;
+                    }
+                }
+                appendUtf8(out, cp);
+                break;
+            }
+            default: out += e;
+        }
+    }
+    return out;
+}
+
+std::string ExtractString(const std::string& json, const std::string& key)
+{
+    size_t pos = json.find("\"" + key + "\":");
+    if (pos == std::string::npos) return "";
+
+    pos += key.length() + 3; // Move past key and colon
+    while (pos < json.length() && json[pos] == ' ') pos++;
+    if (pos >= json.length() || json[pos] != '"') return "";
+
+    return ReadString(json, pos + 1);
+}
+
+std::string ExtractValue(const std::string& json, const std::string& key)
+{
+    size_t pos = json.find("\"" + key + "\"");
+    if (pos == std::string::npos) return "";
+
+    size_t valuePos = json.find(':', pos);
+    if (valuePos == std::string::npos) return "";
+    valuePos++;
+
+    // Skip whitespace
+    while (valuePos < json.size() && json[valuePos] == ' ') valuePos++;
+    if (valuePos >= json.size()) return "";
+
+    // Check for string value
+    if (json[valuePos] == '"') {
+        valuePos++;
+        size_t endPos = json.find('"', valuePos);
+        if (endPos == std::string::npos) return "";
+        return json.substr(valuePos, endPos - valuePos);
+    }
+
+    // Check for numeric/boolean value
+    size_t endPos = valuePos;
+    while (endPos < json.size() && json[endPos] != ',' && json[endPos] != '}' && json[endPos] != ']') {
+        endPos++;
+    }
+    std::string value = json.substr(valuePos, endPos - valuePos);
+    // Trim whitespace
+    while (!value.empty() && value[0] == ' ') value.erase(0, 1);
+    while (!value.empty() && value[value.size() - 1] == ' ') value.erase(value.size() - 1);
+    return value;
+}
+
+bool ExtractBool(const std::string& json, const std::string& key)
+{
+    size_t pos = json.find("\"" + key + "\":");
+    if (pos == std::string::npos) return false;
+
+    pos += key.length() + 3;
+    size_t start = json.find_first_of("tf", pos);
+    if (start == std::string::npos) return false;
+
+    return json.compare(start, 4, "true") == 0;
+}
+
+std::vector<std::string> ExtractStringArray(const std::string& json, const std::string& key)
+{
+    // json.dumps writes "key": [...], with a space
+    std::vector<std::string> values;
+    size_t pos = json.find("\"" + key + "\":");
+    if (pos == std::string::npos) return values;
+    pos = json.find('[', pos);
+    if (pos == std::string::npos) return values;
+
+    for (pos++; pos < json.length() && json[pos] != ']'; ) {
+        if (json[pos] != '"') {
+            pos++;
+            continue;
+        }
+        values.push_back(ReadString(json, pos + 1));
+        // Skip to the closing quote of this value
+        for (pos++; pos < json.length() && json[pos] != '"'; pos++) {
+            if (json[pos] == '\\') pos++;
+        }
+        pos++;
+    }
+    return values;
+}
+
+} // namespace Json
+} // namespace NppGoogleKeepSync
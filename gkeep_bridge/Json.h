@@ -0,0 +1,82 @@
+// Json - the small JSON reader used for bridge replies
+// ARM64 Windows Compatible
+//
+// keep_bridge.py writes flat json.dumps output, so values are located by
+// key rather than through a full parse tree.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace NppGoogleKeepSync {
+namespace Json {
+
+/**
+ * Decode the JSON string starting after its opening quote; honours escapes,
+ * including surrogate pairs, and stops at the closing quote; a \u escape
+ * without four hex digits makes the whole string empty
+ */
+std::string ReadString(const std::string& json, size_t start);
+
+/**
+ * Decoded string value of "key": "..." (empty if absent or not a string)
+ */
+std::string ExtractString(const std::string& json, const std::string& key);
+
+/**
+ * Raw value of "key" without decoding: the contents of a string, or the
+ * text of a number/true/false/null, trimmed of spaces
+ */
+std::string ExtractValue(const std::string& json, const std::string& key);
+
+/**
+ * True only if "key" holds true
+ */
+bool ExtractBool(const std::string& json, const std::string& key);
+
+/**
+ * Flat array of strings stored under key
+ */
+std::vector<std::string> ExtractStringArray(const std::string& json, const std::string& key);
+
+/**
+ * Invoke fn(object) for each top-level object of the array stored under
+ * key, skipping braces inside string values; stops early if fn returns false
+ */
+template <typename Fn>
+void ForEachObject(const std::string& json, const std::string& key, Fn fn)
+{
+    size_t pos = json.find("\"" + key + "\":");
+    if (pos == std::string::npos) return;
+    pos = json.find('[', pos);
+    if (pos == std::string::npos) return;
+
+    int depth = 0;
+    bool in_string = false;
+    size_t obj_start = 0;
+    for (size_t i = pos + 1; i < json.length(); ++i) {
+        char c = json[i];
+        if (in_string) {
+            if (c == '\\') i++;
+            else if (c == '"') in_string = false;
+            continue;
+        }
+        if (c == '"') {
+            in_string = true;
+        } else if (c == '{') {
+            if (depth == 0) obj_start = i;
+            depth++;
+        } else if (c == '}') {
+            depth--;
+            if (depth == 0 && !fn(json.substr(obj_start, i - obj_start + 1))) {
+                return;
+            }
+        } else if (c == ']' && depth == 0) {
+            return;
+        }
+    }
+}
+
+} // namespace Json
+} // namespace NppGoogleKeepSync
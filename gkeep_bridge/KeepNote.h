@@ -0,0 +1,29 @@
+#pragma once
+
+/**
+ * KeepNote - plain note record shared by the bridge, the local mirror
+ * and the search index. Kept free of platform headers so the note-side
+ * data structures do not pull in <windows.h>.
+ */
+
+#include <string>
+#include <vector>
+
+namespace NppGoogleKeepSync {
+
+/**
+ * Simple note structure for C++ side
+ */
+struct KeepNote {
+    std::string id;
+    std::string title;
+    std::string text;
+    bool pinned = false;
+    bool archived = false;
+    std::string color;
+    std::vector<std::string> labels;
+    std::string created_timestamp;
+    std::string edited_timestamp;
+};
+
+} // namespace NppGoogleKeepSync
@@ -0,0 +1,321 @@
+// NoteList - a note-list reply decoded in place
+
+#include "NoteList.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace NppGoogleKeepSync {
+
+namespace {
+    int hexDigit(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    // Reads the JSON value at p, writing decoded strings back over their
+    // own escapes. Positions only move forward, so nothing overwritten is
+    // read again.
+    class Parser {
+    public:
+        Parser(char* begin, char* end) : m_base(begin), m_p(begin), m_end(end) {}
+
+        void SkipSpace() {
+            while (m_p < m_end && (*m_p == ' ' || *m_p == '\n' || *m_p == '\r' || *m_p == '\t')) m_p++;
+        }
+
+        // Consume c (after spaces) if it is next
+        bool Take(char c) {
+            SkipSpace();
+            if (m_p < m_end && *m_p == c) {
+                m_p++;
+                return true;
+            }
+            return false;
+        }
+
+        char Peek() {
+            SkipSpace();
+            return m_p < m_end ? *m_p : '\0';
+        }
+
+        // String at p, decoded in place; out is its offset and length
+        bool String(uint32_t& offset, uint32_t& length) {
+            if (!Take('"')) return false;
+            char* out = m_p;
+            char* start = m_p;
+            while (m_p < m_end) {
+                char c = *m_p++;
+                if (c == '"') {
+                    offset = static_cast<uint32_t>(start - m_base);
+                    length = static_cast<uint32_t>(out - start);
+                    return true;
+                }
+                if (c != '\\') {
+                    *out++ = c;
+                    continue;
+                }
+                if (m_p >= m_end) return false;
+                char e = *m_p++;
+                switch (e) {
+                    case 'n': *out++ = '\n'; break;
+                    case 'r': *out++ = '\r'; break;
+                    case 't': *out++ = '\t'; break;
+                    case 'b': *out++ = '\b'; break;
+                    case 'f': *out++ = '\f'; break;
+                    case 'u': {
+                        // Decoded in place: the UTF-8 (at most 3 bytes for
+                        // one escape) must not outgrow the 6 bytes read
+                        unsigned int cp;
+                        if (!Hex4(cp)) return false;
+                        // Python's json.dumps escapes non-BMP characters as surrogate pairs
+                        if (cp >= 0xD800 && cp <= 0xDBFF && m_end - m_p >= 6 && m_p[0] == '\\' && m_p[1] == 'u') {
+                            char* save = m_p;
+                            m_p += 2;
+                            unsigned int lo;
+                            if (Hex4(lo) && lo >= 0xDC00 && lo <= 0xDFFF) {
+                                cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                            } else {
+                                m_p = save;
+                            }
+                        }
+                        out = Utf8(out, cp);
+                        break;
+                    }
+                    default: *out++ = e;
+                }
+            }
+            return false;
+        }
+
+        bool Unsigned(size_t& value) {
+            SkipSpace();
+            char* start = m_p;
+            value = 0;
+            while (m_p < m_end && *m_p >= '0' && *m_p <= '9') {
+                value = value * 10 + static_cast<size_t>(*m_p++ - '0');
+            }
+            return m_p > start || Skip();
+        }
+
+        bool Bool(bool& value) {
+            SkipSpace();
+            if (m_end - m_p >= 4 && std::string_view(m_p, 4) == "true") {
+                value = true;
+                m_p += 4;
+                return true;
+            }
+            value = false;
+            return Skip();
+        }
+
+        // Any value, nested or not
+        bool Skip(int depth = 0) {
+            if (depth > 64) return false;
+            char c = Peek();
+            uint32_t offset, length;
+            if (c == '"') return String(offset, length);
+            if (c == '{' || c == '[') {
+                char close = c == '{' ? '}' : ']';
+                m_p++;
+                if (Take(close)) return true;
+                do {
+                    if (c == '{' && (!String(offset, length) || !Take(':'))) return false;
+                    if (!Skip(depth + 1)) return false;
+                } while (Take(','));
+                return Take(close);
+            }
+            // Number, true, false or null
+            char* start = m_p;
+            while (m_p < m_end && *m_p != ',' && *m_p != '}' && *m_p != ']' && *m_p != ' ' && *m_p != '\n') m_p++;
+            return m_p > start;
+        }
+
+        std::string_view View(uint32_t offset, uint32_t length) const {
+            return std::string_view(m_base + offset, length);
+        }
+
+    private:
+        // Four hex digits, consumed only if all are there
+        bool Hex4(unsigned int& cp) {
+            if (m_end - m_p < 4) return false;
+            cp = 0;
+            for (int i = 0; i < 4; ++i) {
+                int d = hexDigit(m_p[i]);
+                if (d < 0) return false;
+                cp = (cp << 4) | static_cast<unsigned int>(d);
+            }
+            m_p += 4;
+            return true;
+        }
+
+        static char* Utf8(char* out, unsigned int cp) {
+            if (cp < 0x80) {
+                *out++ = static_cast<char>(cp);
+            } else if (cp < 0x800) {
+                *out++ = static_cast<char>(0xC0 | (cp >> 6));
+                *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+            } else if (cp < 0x10000) {
+                *out++ = static_cast<char>(0xE0 | (cp >> 12));
+                *out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+                *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+            } else {
+                *out++ = static_cast<char>(0xF0 | (cp >> 18));
+                *out++ = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+                *out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+                *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+            }
+            return out;
+        }
+
+        char* m_base;
+        char* m_p;
+        char* m_end;
+    };
+}
+
+std::string_view NoteView::Label(size_t i) const
+{
+    return std::string_view(m_base + m_labels[2 * i], m_labels[2 * i + 1]);
+}
+
+KeepNote NoteView::ToKeepNote() const
+{
+    KeepNote note;
+    note.id.assign(id);
+    note.title.assign(title);
+    note.text.assign(text);
+    note.pinned = pinned;
+    note.archived = archived;
+    note.color.assign(color);
+    note.labels.reserve(m_label_count);
+    for (size_t i = 0; i < m_label_count; ++i) {
+        note.labels.emplace_back(Label(i));
+    }
+    note.created_timestamp.assign(created_timestamp);
+    note.edited_timestamp.assign(edited_timestamp);
+    return note;
+}
+
+bool NoteList::Parse(std::string json, std::string_view key)
+{
+    m_json = std::move(json);
+    m_notes.clear();
+    m_labels.clear();
+    if (m_json.size() >= std::numeric_limits<uint32_t>::max()) {
+        m_json.clear();
+        return false;
+    }
+
+    Parser parser(&m_json[0], &m_json[0] + m_json.size());
+    if (!parser.Take('{')) return false;
+    if (parser.Take('}')) return false;
+
+    uint32_t offset, length;
+    do {
+        if (!parser.String(offset, length) || !parser.Take(':')) return false;
+        std::string_view name = parser.View(offset, length);
+
+        // Replies give the count ahead of the notes; size the table once
+        if (name == "count" && parser.Peek() != '"') {
+            size_t count = 0;
+            if (!parser.Unsigned(count)) return false;
+            m_notes.reserve(std::min(count, m_json.size() / 2));
+            continue;
+        }
+        if (name != key || parser.Peek() != '[') {
+            if (!parser.Skip()) return false;
+            continue;
+        }
+
+        parser.Take('[');
+        if (parser.Take(']')) return true;
+        do {
+            if (!parser.Take('{')) return false;
+            Entry entry;
+            entry.label_begin = static_cast<uint32_t>(m_labels.size() / 2);
+            bool haveTimestamp = false;     // "timestamp" wins over "created"
+            if (!parser.Take('}')) {
+                do {
+                    if (!parser.String(offset, length) || !parser.Take(':')) return false;
+                    std::string_view field = parser.View(offset, length);
+                    Span* target = nullptr;
+                    if (field == "id") target = &entry.id;
+                    else if (field == "title") target = &entry.title;
+                    else if (field == "text") target = &entry.text;
+                    else if (field == "color") target = &entry.color;
+                    else if (field == "edited") target = &entry.edited;
+                    else if (field == "timestamp") { target = &entry.created; haveTimestamp = true; }
+                    else if (field == "created" && !haveTimestamp) target = &entry.created;
+
+                    bool ok;
+                    if (target && parser.Peek() == '"') {
+                        ok = parser.String(target->offset, target->length);
+                    } else if (field == "pinned") {
+                        ok = parser.Bool(entry.pinned);
+                    } else if (field == "archived") {
+                        ok = parser.Bool(entry.archived);
+                    } else if (field == "labels" && parser.Peek() == '[') {
+                        parser.Take('[');
+                        ok = true;
+                        if (!parser.Take(']')) {
+                            do {
+                                if (parser.Peek() == '"') {
+                                    ok = parser.String(offset, length);
+                                    m_labels.push_back(offset);
+                                    m_labels.push_back(length);
+                                    entry.label_count++;
+                                } else {
+                                    ok = parser.Skip();
+                                }
+                            } while (ok && parser.Take(','));
+                            ok = ok && parser.Take(']');
+                        }
+                    } else {
+                        ok = parser.Skip();
+                    }
+                    if (!ok) return false;
+                } while (parser.Take(','));
+                if (!parser.Take('}')) return false;
+            }
+            m_notes.push_back(entry);
+        } while (parser.Take(','));
+        return parser.Take(']');
+    } while (parser.Take(','));
+    return false;
+}
+
+NoteView NoteList::operator[](size_t i) const
+{
+    const Entry& entry = m_notes[i];
+    const char* base = m_json.data();
+    auto view = [base](const Span& span) { return std::string_view(base + span.offset, span.length); };
+
+    NoteView note;
+    note.id = view(entry.id);
+    note.title = view(entry.title);
+    note.text = view(entry.text);
+    note.color = view(entry.color);
+    note.created_timestamp = view(entry.created);
+    note.edited_timestamp = view(entry.edited);
+    note.pinned = entry.pinned;
+    note.archived = entry.archived;
+    note.m_base = base;
+    note.m_labels = m_labels.data() + 2 * entry.label_begin;
+    note.m_label_count = entry.label_count;
+    return note;
+}
+
+std::vector<KeepNote> NoteList::ToKeepNotes() const
+{
+    std::vector<KeepNote> notes;
+    notes.reserve(m_notes.size());
+    for (size_t i = 0; i < m_notes.size(); ++i) {
+        notes.push_back((*this)[i].ToKeepNote());
+    }
+    return notes;
+}
+
+} // namespace NppGoogleKeepSync
@@ -0,0 +1,93 @@
+#pragma once
+
+/**
+ * NoteList - a note-list reply decoded in place
+ *
+ * Takes ownership of the reply text and decodes the "notes" array inside
+ * it: JSON escapes are undone in the buffer itself (an escape is never
+ * shorter than what it decodes to), and every note field is a view into
+ * that buffer. Decoding a page of notes costs the note and label tables
+ * rather than a handful of strings per note; KeepNote copies are made
+ * only when asked for.
+ */
+
+#include "KeepNote.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace NppGoogleKeepSync {
+
+/**
+ * One note of a NoteList; valid while the list is alive and unchanged
+ */
+struct NoteView {
+    std::string_view id;
+    std::string_view title;
+    std::string_view text;
+    std::string_view color;
+    std::string_view created_timestamp;
+    std::string_view edited_timestamp;
+    bool pinned = false;
+    bool archived = false;
+
+    size_t LabelCount() const { return m_label_count; }
+    std::string_view Label(size_t i) const;
+
+    /**
+     * Owning copy for the mirror and other long-lived stores
+     */
+    KeepNote ToKeepNote() const;
+
+private:
+    friend class NoteList;
+    const char* m_base = nullptr;
+    const uint32_t* m_labels = nullptr;     // Offset/length pairs
+    size_t m_label_count = 0;
+};
+
+class NoteList {
+public:
+    NoteList() = default;
+
+    /**
+     * Decode the array under key in json, replacing what the list held
+     * @param json Reply text; consumed and decoded in place
+     * @param key Array holding the notes ("notes" for list, "changed"
+     *        for changes_since)
+     * @return false if the array is missing or the reply is malformed;
+     *         the notes before the fault are kept
+     */
+    bool Parse(std::string json, std::string_view key = "notes");
+
+    size_t size() const { return m_notes.size(); }
+    bool empty() const { return m_notes.empty(); }
+    NoteView operator[](size_t i) const;
+
+    /**
+     * Owning copies of every note
+     */
+    std::vector<KeepNote> ToKeepNotes() const;
+
+private:
+    // A string inside m_json
+    struct Span {
+        uint32_t offset = 0;
+        uint32_t length = 0;
+    };
+    struct Entry {
+        Span id, title, text, color, created, edited;
+        uint32_t label_begin = 0;   // Index of the first span in m_labels
+        uint32_t label_count = 0;
+        bool pinned = false;
+        bool archived = false;
+    };
+
+    std::string m_json;
+    std::vector<Entry> m_notes;
+    std::vector<uint32_t> m_labels;     // Offset/length pairs, by note
+};
+
+} // namespace NppGoogleKeepSync
@@ -0,0 +1,403 @@
+// NoteMirror - persistent local copy of Google Keep notes
+
+#include "NoteMirror.h"
+
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <sstream>
+
+namespace NppGoogleKeepSync {
+
+namespace {
+    const char* const kMirrorMagic = "KEEPMIRROR";
+    const int kMirrorVersion = 1;
+    const char kLabelSeparator = '\x1f';
+
+    // One note per line, tab separated; escape the separators
+    std::string escapeField(const std::string& input) {
+        std::string out;
+        out.reserve(input.size());
+        for (char c : input) {
+            switch (c) {
+                case '\\': out += "\\\\"; break;
+                case '\t': out += "\\t"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                default: out += c;
+            }
+        }
+        return out;
+    }
+
+    std::string unescapeField(const std::string& input) {
+        std::string out;
+        out.reserve(input.size());
+        for (size_t i = 0; i < input.size(); ++i) {
+            char c = input[i];
+            if (c == '\\' && i + 1 < input.size()) {
+                char n = input[++i];
+                switch (n) {
+                    case 't': out += '\t'; break;
+                    case 'n': out += '\n'; break;
+                    case 'r': out += '\r'; break;
+                    default: out += n;
+                }
+            } else {
+                out += c;
+            }
+        }
+        return out;
+    }
+
+    std::vector<std::string> splitFields(const std::string& line, char sep) {
+        std::vector<std::string> fields;
+        size_t start = 0;
+        while (true) {
+            size_t pos = line.find(sep, start);
+            if (pos == std::string::npos) {
+                fields.push_back(line.substr(start));
+                break;
+            }
+            fields.push_back(line.substr(start, pos - start));
+            start = pos + 1;
+        }
+        return fields;
+    }
+}
+
+bool NoteMirror::Load(const std::filesystem::path& path)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_path = path;
+    m_notes.clear();
+    m_byLabel.clear();
+    m_index.Clear();
+    m_lastRefresh = Clock::time_point{};
+    m_dirty = false;
+    m_generation = 0;
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::string line;
+    if (!std::getline(file, line)) {
+        return false;
+    }
+    auto header = splitFields(line, '\t');
+    if (header.size() < 3 || header[0] != kMirrorMagic || header[1] != std::to_string(kMirrorVersion)) {
+        // Unknown format: start over, the next refresh rewrites it
+        return false;
+    }
+    long long refreshed = 0;
+    const char* end = header[2].data() + header[2].size();
+    auto parsed = std::from_chars(header[2].data(), end, refreshed);
+    if (parsed.ec != std::errc() || parsed.ptr != end) {
+        return false;   // Corrupt header: as if there were no mirror
+    }
+    m_lastRefresh = Clock::time_point(std::chrono::seconds(refreshed));
+    // Mirrors written before the generation field have none, and never
+    // match an index
+    if (header.size() >= 4) {
+        end = header[3].data() + header[3].size();
+        parsed = std::from_chars(header[3].data(), end, m_generation);
+        if (parsed.ec != std::errc() || parsed.ptr != end) {
+            m_generation = 0;
+        }
+    }
+
+    while (std::getline(file, line)) {
+        // Fields: id, title, text, pinned, archived, color, labels, created, edited
+        auto fields = splitFields(line, '\t');
+        if (fields.size() != 9) continue;
+
+        KeepNote note;
+        note.id = unescapeField(fields[0]);
+        note.title = unescapeField(fields[1]);
+        note.text = unescapeField(fields[2]);
+        note.pinned = (fields[3] == "1");
+        note.archived = (fields[4] == "1");
+        note.color = unescapeField(fields[5]);
+        if (!fields[6].empty()) {
+            for (const auto& label : splitFields(fields[6], kLabelSeparator)) {
+                note.labels.push_back(unescapeField(label));
+            }
+        }
+        note.created_timestamp = unescapeField(fields[7]);
+        note.edited_timestamp = unescapeField(fields[8]);
+
+        IndexLabels(note);
+        m_notes[note.id] = std::move(note);
+    }
+
+    // The index is derived data; rebuild it if it is missing or out of
+    // step. A matching note count is not enough: a delete and a create in
+    // one pull keep the count but change the ids.
+    uint64_t indexGeneration = 0;
+    if (m_generation == 0 || !m_index.Load(IndexPath(), &indexGeneration) ||
+        indexGeneration != m_generation || m_index.DocumentCount() != m_notes.size()) {
+        m_index.Clear();
+        for (const auto& pair : m_notes) {
+            m_index.Upsert(pair.second);
+        }
+        m_dirty = true;
+    }
+
+    return true;
+}
+
+bool NoteMirror::Save()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_dirty || m_path.empty()) {
+        return true;
+    }
+
+    std::ofstream file(m_path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    auto refreshed = std::chrono::duration_cast<std::chrono::seconds>(
+        m_lastRefresh.time_since_epoch()).count();
+    uint64_t generation = m_generation + 1;
+    file << kMirrorMagic << '\t' << kMirrorVersion << '\t' << refreshed << '\t' << generation << '\n';
+
+    for (const auto& pair : m_notes) {
+        const KeepNote& note = pair.second;
+        std::string labels;
+        for (size_t i = 0; i < note.labels.size(); ++i) {
+            if (i > 0) labels += kLabelSeparator;
+            labels += escapeField(note.labels[i]);
+        }
+        file << escapeField(note.id) << '\t'
+             << escapeField(note.title) << '\t'
+             << escapeField(note.text) << '\t'
+             << (note.pinned ? "1" : "0") << '\t'
+             << (note.archived ? "1" : "0") << '\t'
+             << escapeField(note.color) << '\t'
+             << labels << '\t'
+             << escapeField(note.created_timestamp) << '\t'
+             << escapeField(note.edited_timestamp) << '\n';
+    }
+
+    file.close();
+    bool ok = file.good() && m_index.Save(IndexPath(), generation);
+    if (file.good()) {
+        m_generation = generation;
+    }
+    m_dirty = !ok;
+    return ok;
+}
+
+void NoteMirror::Upsert(const KeepNote& note)
+{
+    if (note.id.empty()) return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_notes.find(note.id);
+    if (it != m_notes.end()) {
+        UnindexLabels(it->second);
+        it->second = note;
+    } else {
+        m_notes.emplace(note.id, note);
+    }
+    IndexLabels(note);
+    m_index.Upsert(note);
+    m_dirty = true;
+}
+
+bool NoteMirror::Remove(const std::string& id)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_notes.find(id);
+    if (it == m_notes.end()) {
+        return false;
+    }
+    UnindexLabels(it->second);
+    m_index.Remove(id);
+    m_notes.erase(it);
+    m_dirty = true;
+    return true;
+}
+
+void NoteMirror::ReplaceAll(std::vector<KeepNote> notes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_notes.clear();
+    m_byLabel.clear();
+    m_index.Clear();
+    m_notes.reserve(notes.size());
+    for (auto& note : notes) {
+        if (note.id.empty()) continue;
+        IndexLabels(note);
+        m_index.Upsert(note);
+        std::string id = note.id;
+        m_notes[id] = std::move(note);
+    }
+    m_lastRefresh = Clock::now();
+    m_dirty = true;
+}
+
+std::optional<KeepNote> NoteMirror::Get(const std::string& id) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_notes.find(id);
+    if (it == m_notes.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+std::vector<KeepNote> NoteMirror::List(bool include_archived, size_t limit,
+                                       const std::string& query,
+                                       const std::vector<std::string>& labels) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::unordered_set<std::string> labelFilter(labels.begin(), labels.end());
+    auto accept = [&](const KeepNote& note) {
+        if (note.archived && !include_archived) return false;
+        if (labelFilter.empty()) return true;
+        return std::any_of(note.labels.begin(), note.labels.end(),
+                           [&](const std::string& label) { return labelFilter.count(label) > 0; });
+    };
+
+    std::vector<KeepNote> result;
+
+    // Queries are answered from the full-text index in relevance order
+    if (!query.empty()) {
+        for (const auto& hit : m_index.Search(query)) {
+            // An index out of step must not take the lookup down
+            auto it = m_notes.find(hit.id);
+            if (it == m_notes.end()) continue;
+            const KeepNote& note = it->second;
+            if (!accept(note)) continue;
+            result.push_back(note);
+            if (limit > 0 && result.size() >= limit) break;
+        }
+        return result;
+    }
+
+    // Narrow the candidate set through the label index first
+    std::vector<const KeepNote*> candidates;
+    if (!labels.empty()) {
+        std::unordered_set<std::string> seen;
+        for (const auto& label : labels) {
+            auto it = m_byLabel.find(label);
+            if (it == m_byLabel.end()) continue;
+            for (const auto& id : it->second) {
+                if (seen.insert(id).second) {
+                    candidates.push_back(&m_notes.at(id));
+                }
+            }
+        }
+    } else {
+        candidates.reserve(m_notes.size());
+        for (const auto& pair : m_notes) {
+            candidates.push_back(&pair.second);
+        }
+    }
+
+    auto last = std::remove_if(candidates.begin(), candidates.end(),
+                               [&](const KeepNote* note) { return !accept(*note); });
+    candidates.erase(last, candidates.end());
+
+    // Timestamps are ISO-like strings, so lexical order is chronological
+    auto newerFirst = [](const KeepNote* a, const KeepNote* b) {
+        if (a->edited_timestamp != b->edited_timestamp) {
+            return a->edited_timestamp > b->edited_timestamp;
+        }
+        return a->id < b->id;
+    };
+    if (limit > 0 && limit < candidates.size()) {
+        std::partial_sort(candidates.begin(), candidates.begin() + limit, candidates.end(), newerFirst);
+        candidates.resize(limit);
+    } else {
+        std::sort(candidates.begin(), candidates.end(), newerFirst);
+    }
+
+    result.reserve(candidates.size());
+    for (const KeepNote* note : candidates) {
+        result.push_back(*note);
+    }
+    return result;
+}
+
+std::vector<std::string> NoteMirror::Search(const std::string& query, size_t limit) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<std::string> ids;
+    for (auto& hit : m_index.Search(query, limit)) {
+        ids.push_back(std::move(hit.id));
+    }
+    return ids;
+}
+
+std::vector<std::string> NoteMirror::IdsWithLabel(const std::string& label) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_byLabel.find(label);
+    if (it == m_byLabel.end()) {
+        return {};
+    }
+    return std::vector<std::string>(it->second.begin(), it->second.end());
+}
+
+bool NoteMirror::IsStale(std::chrono::seconds max_age) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_lastRefresh == Clock::time_point{}) {
+        return true;
+    }
+    return Clock::now() - m_lastRefresh > max_age;
+}
+
+void NoteMirror::MarkRefreshed()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_lastRefresh = Clock::now();
+    m_dirty = true;
+}
+
+NoteMirror::Clock::time_point NoteMirror::LastRefresh() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_lastRefresh;
+}
+
+size_t NoteMirror::Size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_notes.size();
+}
+
+void NoteMirror::IndexLabels(const KeepNote& note)
+{
+    for (const auto& label : note.labels) {
+        m_byLabel[label].insert(note.id);
+    }
+}
+
+std::filesystem::path NoteMirror::IndexPath() const
+{
+    std::filesystem::path path = m_path;
+    path += ".idx";
+    return path;
+}
+
+void NoteMirror::UnindexLabels(const KeepNote& note)
+{
+    for (const auto& label : note.labels) {
+        auto it = m_byLabel.find(label);
+        if (it == m_byLabel.end()) continue;
+        it->second.erase(note.id);
+        if (it->second.empty()) {
+            m_byLabel.erase(it);
+        }
+    }
+}
+
+} // namespace NppGoogleKeepSync
@@ -0,0 +1,120 @@
+#pragma once
+
+/**
+ * NoteMirror - persistent local copy of the user's Google Keep notes
+ *
+ * Holds every note the bridge has seen, indexed by id and by label, so
+ * list/get reads can be answered without a round trip through the Python
+ * process. The mirror is refreshed from the bridge when it is older than
+ * the configured staleness bound and is updated in place whenever the
+ * plugin creates, updates or deletes a note. A full-text index is kept
+ * in step with the notes and persisted alongside the mirror file.
+ */
+
+#include "KeepNote.h"
+#include "NoteSearchIndex.h"
+
+#include <chrono>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace NppGoogleKeepSync {
+
+class NoteMirror {
+public:
+    using Clock = std::chrono::system_clock;
+
+    NoteMirror() = default;
+
+    // Non-copyable (owns a mutex)
+    NoteMirror(const NoteMirror&) = delete;
+    NoteMirror& operator=(const NoteMirror&) = delete;
+
+    /**
+     * Load the mirror from disk. A missing file leaves an empty, stale mirror.
+     * @param path Mirror file location (also used by Save)
+     * @return true if a mirror file was read
+     */
+    bool Load(const std::filesystem::path& path);
+
+    /**
+     * Write the mirror back to the path given to Load. No-op when unchanged.
+     */
+    bool Save();
+
+    /**
+     * Insert or replace a single note (write-through after create/update)
+     */
+    void Upsert(const KeepNote& note);
+
+    /**
+     * Drop a note from the mirror
+     * @return true if the note was present
+     */
+    bool Remove(const std::string& id);
+
+    /**
+     * Replace the whole mirror with a fresh pull and mark it refreshed
+     */
+    void ReplaceAll(std::vector<KeepNote> notes);
+
+    /**
+     * Look up a note by id
+     */
+    std::optional<KeepNote> Get(const std::string& id) const;
+
+    /**
+     * List notes, most recently edited first
+     * @param include_archived Include archived notes
+     * @param limit Maximum number of notes to return (0 for no limit)
+     * @param query Full-text query; when set, results are ranked by relevance
+     * @param labels Only notes carrying at least one of these labels
+     */
+    std::vector<KeepNote> List(bool include_archived, size_t limit,
+                               const std::string& query = "",
+                               const std::vector<std::string>& labels = {}) const;
+
+    /**
+     * Ranked full-text lookup
+     * @return Note ids, best match first
+     */
+    std::vector<std::string> Search(const std::string& query, size_t limit = 0) const;
+
+    /**
+     * Ids of all notes carrying a label
+     */
+    std::vector<std::string> IdsWithLabel(const std::string& label) const;
+
+    /**
+     * True if the mirror has never been refreshed or the last refresh is
+     * older than max_age
+     */
+    bool IsStale(std::chrono::seconds max_age) const;
+
+    void MarkRefreshed();
+    Clock::time_point LastRefresh() const;
+    size_t Size() const;
+
+private:
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, KeepNote> m_notes;
+    std::unordered_map<std::string, std::unordered_set<std::string>> m_byLabel;
+    NoteSearchIndex m_index;
+    Clock::time_point m_lastRefresh{};
+    std::filesystem::path m_path;
+    bool m_dirty = false;
+    // Bumped by every Save and written to both files: a crash between the
+    // two writes leaves them with different generations
+    uint64_t m_generation = 0;
+
+    void IndexLabels(const KeepNote& note);
+    void UnindexLabels(const KeepNote& note);
+    std::filesystem::path IndexPath() const;
+};
+
+} // namespace NppGoogleKeepSync
@@ -0,0 +1,370 @@
+// NoteSearchIndex - full-text inverted index over mirrored notes
+
+#include "NoteSearchIndex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace NppGoogleKeepSync {
+
+namespace {
+    const uint32_t kIndexMagic = 0x5849534B; // "KSIX"
+    const uint32_t kIndexVersion = 2;     // 2: stamp at the end
+    const uint32_t kTitleWeight = 3;
+    const size_t kMaxTermLength = 64;
+    const double kBm25K1 = 1.2;
+    const double kBm25B = 0.75;
+
+    void writeU32(std::ofstream& out, uint32_t value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void writeString(std::ofstream& out, const std::string& value) {
+        writeU32(out, static_cast<uint32_t>(value.size()));
+        out.write(value.data(), static_cast<std::streamsize>(value.size()));
+    }
+
+    bool readU32(std::ifstream& in, uint32_t& value) {
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+    }
+
+    // Bytes from the read position to fileSize; counts in the file are
+    // checked against it before anything is allocated for them
+    uint64_t bytesLeft(std::ifstream& in, uint64_t fileSize) {
+        auto pos = in.tellg();
+        if (pos < 0 || static_cast<uint64_t>(pos) > fileSize) return 0;
+        return fileSize - static_cast<uint64_t>(pos);
+    }
+
+    bool readString(std::ifstream& in, uint64_t fileSize, std::string& value) {
+        uint32_t size = 0;
+        if (!readU32(in, size) || size > (1u << 20) || size > bytesLeft(in, fileSize)) return false;
+        value.resize(size);
+        return static_cast<bool>(in.read(&value[0], size));
+    }
+
+    bool isWordByte(unsigned char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+               (c >= '0' && c <= '9') || c >= 0x80;
+    }
+}
+
+void NoteSearchIndex::Tokenize(const std::string& text, std::vector<std::string>& out)
+{
+    std::string term;
+    for (char ch : text) {
+        unsigned char c = static_cast<unsigned char>(ch);
+        if (isWordByte(c)) {
+            if (term.size() < kMaxTermLength) {
+                term += (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : ch;
+            }
+        } else if (!term.empty()) {
+            out.push_back(std::move(term));
+            term.clear();
+        }
+    }
+    if (!term.empty()) {
+        out.push_back(std::move(term));
+    }
+}
+
+void NoteSearchIndex::Upsert(const KeepNote& note)
+{
+    if (note.id.empty()) return;
+
+    auto existing = m_docByNoteId.find(note.id);
+    if (existing != m_docByNoteId.end()) {
+        Tombstone(existing->second);
+    }
+
+    std::unordered_map<std::string, uint32_t> termFreq;
+    std::vector<std::string> terms;
+    Tokenize(note.title, terms);
+    for (auto& term : terms) {
+        termFreq[std::move(term)] += kTitleWeight;
+    }
+    uint32_t length = static_cast<uint32_t>(terms.size()) * kTitleWeight;
+    terms.clear();
+    Tokenize(note.text, terms);
+    for (auto& term : terms) {
+        termFreq[std::move(term)] += 1;
+    }
+    length += static_cast<uint32_t>(terms.size());
+
+    // New versions always take a fresh slot, so postings stay sorted by doc
+    uint32_t doc = static_cast<uint32_t>(m_docs.size());
+    m_docs.push_back(Document{note.id, length, true});
+    m_docByNoteId[note.id] = doc;
+    for (const auto& pair : termFreq) {
+        m_postings[pair.first].push_back(Posting{doc, pair.second});
+    }
+    m_totalLength += length;
+    m_liveDocs++;
+
+    CompactIfNeeded();
+}
+
+void NoteSearchIndex::Remove(const std::string& id)
+{
+    auto it = m_docByNoteId.find(id);
+    if (it == m_docByNoteId.end()) return;
+    Tombstone(it->second);
+    m_docByNoteId.erase(it);
+    CompactIfNeeded();
+}
+
+void NoteSearchIndex::Clear()
+{
+    m_docs.clear();
+    m_docByNoteId.clear();
+    m_postings.clear();
+    m_totalLength = 0;
+    m_liveDocs = 0;
+}
+
+void NoteSearchIndex::Tombstone(uint32_t doc)
+{
+    Document& document = m_docs[doc];
+    if (!document.alive) return;
+    document.alive = false;
+    m_totalLength -= document.length;
+    m_liveDocs--;
+}
+
+void NoteSearchIndex::CompactIfNeeded()
+{
+    size_t dead = m_docs.size() - m_liveDocs;
+    if (dead < 1024 || dead * 2 < m_docs.size()) {
+        return;
+    }
+
+    std::vector<uint32_t> remap(m_docs.size(), UINT32_MAX);
+    std::vector<Document> docs;
+    docs.reserve(m_liveDocs);
+    for (uint32_t i = 0; i < m_docs.size(); ++i) {
+        if (!m_docs[i].alive) continue;
+        remap[i] = static_cast<uint32_t>(docs.size());
+        m_docByNoteId[m_docs[i].id] = remap[i];
+        docs.push_back(std::move(m_docs[i]));
+    }
+    m_docs = std::move(docs);
+
+    for (auto it = m_postings.begin(); it != m_postings.end();) {
+        auto& list = it->second;
+        size_t out = 0;
+        for (const Posting& posting : list) {
+            if (remap[posting.doc] != UINT32_MAX) {
+                list[out++] = Posting{remap[posting.doc], posting.tf};
+            }
+        }
+        list.resize(out);
+        if (list.empty()) {
+            it = m_postings.erase(it);
+        } else {
+            list.shrink_to_fit();
+            ++it;
+        }
+    }
+}
+
+std::vector<NoteSearchIndex::Hit> NoteSearchIndex::Search(const std::string& query, size_t limit) const
+{
+    std::vector<std::string> terms;
+    Tokenize(query, terms);
+    std::sort(terms.begin(), terms.end());
+    terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+    if (terms.empty() || m_liveDocs == 0) {
+        return {};
+    }
+
+    std::vector<const std::vector<Posting>*> lists;
+    for (const auto& term : terms) {
+        auto it = m_postings.find(term);
+        if (it == m_postings.end()) {
+            return {};
+        }
+        lists.push_back(&it->second);
+    }
+    // Intersect starting from the rarest term
+    std::sort(lists.begin(), lists.end(), [](const auto* a, const auto* b) {
+        return a->size() < b->size();
+    });
+
+    const double docCount = static_cast<double>(m_liveDocs);
+    const double avgLength = std::max(1.0, static_cast<double>(m_totalLength) / docCount);
+    auto termScore = [&](const Posting& posting, double idf) {
+        double tf = posting.tf;
+        double norm = 1.0 - kBm25B + kBm25B * m_docs[posting.doc].length / avgLength;
+        return idf * tf * (kBm25K1 + 1.0) / (tf + kBm25K1 * norm);
+    };
+    auto inverseDocFreq = [&](const std::vector<Posting>& list) {
+        double df = static_cast<double>(list.size());
+        return std::log(1.0 + (docCount - df + 0.5) / (df + 0.5));
+    };
+
+    std::vector<std::pair<uint32_t, double>> candidates;
+    double idf = inverseDocFreq(*lists[0]);
+    for (const Posting& posting : *lists[0]) {
+        if (m_docs[posting.doc].alive) {
+            candidates.emplace_back(posting.doc, termScore(posting, idf));
+        }
+    }
+
+    for (size_t i = 1; i < lists.size() && !candidates.empty(); ++i) {
+        const auto& list = *lists[i];
+        idf = inverseDocFreq(list);
+        size_t out = 0;
+        auto cursor = list.begin();
+        for (const auto& candidate : candidates) {
+            cursor = std::lower_bound(cursor, list.end(), candidate.first,
+                [](const Posting& posting, uint32_t doc) { return posting.doc < doc; });
+            if (cursor == list.end()) break;
+            if (cursor->doc == candidate.first) {
+                candidates[out++] = {candidate.first, candidate.second + termScore(*cursor, idf)};
+            }
+        }
+        candidates.resize(out);
+    }
+
+    auto better = [](const std::pair<uint32_t, double>& a, const std::pair<uint32_t, double>& b) {
+        if (a.second != b.second) return a.second > b.second;
+        return a.first > b.first;  // Newer slot (more recently indexed) first on ties
+    };
+    if (limit > 0 && limit < candidates.size()) {
+        std::partial_sort(candidates.begin(), candidates.begin() + limit, candidates.end(), better);
+        candidates.resize(limit);
+    } else {
+        std::sort(candidates.begin(), candidates.end(), better);
+    }
+
+    std::vector<Hit> hits;
+    hits.reserve(candidates.size());
+    for (const auto& candidate : candidates) {
+        hits.push_back(Hit{m_docs[candidate.first].id, candidate.second});
+    }
+    return hits;
+}
+
+bool NoteSearchIndex::Save(const std::filesystem::path& path, uint64_t stamp) const
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        return false;
+    }
+
+    // Only live documents are written, renumbered densely
+    std::vector<uint32_t> remap(m_docs.size(), UINT32_MAX);
+    uint32_t next = 0;
+    for (uint32_t i = 0; i < m_docs.size(); ++i) {
+        if (m_docs[i].alive) remap[i] = next++;
+    }
+
+    writeU32(out, kIndexMagic);
+    writeU32(out, kIndexVersion);
+    writeU32(out, next);
+    for (const Document& doc : m_docs) {
+        if (!doc.alive) continue;
+        writeString(out, doc.id);
+        writeU32(out, doc.length);
+    }
+
+    writeU32(out, static_cast<uint32_t>(m_postings.size()));
+    std::vector<Posting> live;
+    for (const auto& pair : m_postings) {
+        live.clear();
+        for (const Posting& posting : pair.second) {
+            if (remap[posting.doc] != UINT32_MAX) {
+                live.push_back(Posting{remap[posting.doc], posting.tf});
+            }
+        }
+        writeString(out, pair.first);
+        writeU32(out, static_cast<uint32_t>(live.size()));
+        for (const Posting& posting : live) {
+            writeU32(out, posting.doc);
+            writeU32(out, posting.tf);
+        }
+    }
+
+    writeU32(out, static_cast<uint32_t>(stamp));
+    writeU32(out, static_cast<uint32_t>(stamp >> 32));
+    return out.good();
+}
+
+bool NoteSearchIndex::Load(const std::filesystem::path& path, uint64_t* stamp)
+{
+    Clear();
+
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in.is_open()) {
+        return false;
+    }
+    auto end = in.tellg();
+    in.seekg(0);
+    if (end < 0) {
+        return false;
+    }
+    const uint64_t fileSize = static_cast<uint64_t>(end);
+
+    // A truncated or corrupt file must fail here rather than ask for
+    // gigabytes: every count is held to what the rest of the file can
+    // hold (a document, term or posting takes at least 8 bytes)
+    uint32_t magic = 0, version = 0, docCount = 0;
+    if (!readU32(in, magic) || magic != kIndexMagic ||
+        !readU32(in, version) || version != kIndexVersion ||
+        !readU32(in, docCount) || uint64_t(docCount) * 8 > bytesLeft(in, fileSize)) {
+        return false;
+    }
+
+    m_docs.reserve(docCount);
+    for (uint32_t i = 0; i < docCount; ++i) {
+        Document doc;
+        if (!readString(in, fileSize, doc.id) || !readU32(in, doc.length)) {
+            Clear();
+            return false;
+        }
+        doc.alive = true;
+        m_docByNoteId[doc.id] = i;
+        m_totalLength += doc.length;
+        m_docs.push_back(std::move(doc));
+    }
+    m_liveDocs = docCount;
+
+    uint32_t termCount = 0;
+    if (!readU32(in, termCount) || uint64_t(termCount) * 8 > bytesLeft(in, fileSize)) {
+        Clear();
+        return false;
+    }
+    m_postings.reserve(termCount);
+    std::string term;
+    for (uint32_t i = 0; i < termCount; ++i) {
+        uint32_t count = 0;
+        if (!readString(in, fileSize, term) || !readU32(in, count) ||
+            uint64_t(count) * 8 > bytesLeft(in, fileSize)) {
+            Clear();
+            return false;
+        }
+        auto& list = m_postings[term];
+        list.reserve(count);
+        for (uint32_t j = 0; j < count; ++j) {
+            Posting posting{};
+            if (!readU32(in, posting.doc) || !readU32(in, posting.tf) || posting.doc >= docCount) {
+                Clear();
+                return false;
+            }
+            list.push_back(posting);
+        }
+    }
+
+    uint32_t stampLow = 0, stampHigh = 0;
+    if (!readU32(in, stampLow) || !readU32(in, stampHigh)) {
+        Clear();
+        return false;
+    }
+    if (stamp) {
+        *stamp = uint64_t(stampHigh) << 32 | stampLow;
+    }
+    return true;
+}
+
+} // namespace NppGoogleKeepSync
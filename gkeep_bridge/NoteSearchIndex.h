@@ -0,0 +1,93 @@
+#pragma once
+
+/**
+ * NoteSearchIndex - full-text inverted index over mirrored notes
+ *
+ * Maps each term of a note's title and text to a postings list so a
+ * query is answered by intersecting a few lists instead of scanning every
+ * note. Matches require every query term and are ranked with BM25, with
+ * title terms weighted above body terms.
+ *
+ * Updates are incremental: replacing or removing a note tombstones its
+ * old document slot, and the index compacts itself once tombstones make
+ * up a large share of the slots. Not thread-safe; NoteMirror serialises
+ * access.
+ */
+
+#include "KeepNote.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace NppGoogleKeepSync {
+
+class NoteSearchIndex {
+public:
+    struct Hit {
+        std::string id;
+        double score = 0.0;
+    };
+
+    /**
+     * Index a note, replacing any previous version of it
+     */
+    void Upsert(const KeepNote& note);
+
+    /**
+     * Drop a note from the index
+     */
+    void Remove(const std::string& id);
+
+    void Clear();
+
+    /**
+     * Ranked lookup
+     * @param query Free text; every term must occur in a hit
+     * @param limit Maximum number of hits (0 for no limit)
+     * @return Hits ordered by descending score
+     */
+    std::vector<Hit> Search(const std::string& query, size_t limit = 0) const;
+
+    /**
+     * Persist to / restore from a binary file
+     * @param stamp Stored with the index and handed back by Load, so an
+     *        owner can tell whether the file matches its own data
+     */
+    bool Save(const std::filesystem::path& path, uint64_t stamp = 0) const;
+    bool Load(const std::filesystem::path& path, uint64_t* stamp = nullptr);
+
+    size_t DocumentCount() const { return m_liveDocs; }
+    size_t TermCount() const { return m_postings.size(); }
+
+    /**
+     * Split text into lower-cased terms. ASCII letters and digits form
+     * words; non-ASCII UTF-8 bytes are kept as word characters.
+     */
+    static void Tokenize(const std::string& text, std::vector<std::string>& out);
+
+private:
+    struct Posting {
+        uint32_t doc;
+        uint32_t tf;
+    };
+
+    struct Document {
+        std::string id;
+        uint32_t length = 0;
+        bool alive = false;
+    };
+
+    std::vector<Document> m_docs;
+    std::unordered_map<std::string, uint32_t> m_docByNoteId;
+    std::unordered_map<std::string, std::vector<Posting>> m_postings;
+    uint64_t m_totalLength = 0;
+    uint32_t m_liveDocs = 0;
+
+    void Tombstone(uint32_t doc);
+    void CompactIfNeeded();
+};
+
+} // namespace NppGoogleKeepSync
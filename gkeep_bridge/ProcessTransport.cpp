@@ -0,0 +1,393 @@
+// ProcessTransport - bridge process on its stdin/stdout
+
+#include "BridgeTransport.h"
+#include "Utf.h"
+
+#ifdef _WIN32
+
+namespace NppGoogleKeepSync {
+
+ProcessTransport::~ProcessTransport()
+{
+    Stop();
+}
+
+bool ProcessTransport::Start(const std::wstring& program, const std::vector<std::wstring>& args)
+{
+    std::lock_guard<std::mutex> lock(m_processMutex);
+    if (m_interrupted) {
+        m_last_error = "Bridge was interrupted";
+        return false;
+    }
+
+    SECURITY_ATTRIBUTES sa;
+    sa.nLength = sizeof(SECURITY_ATTRIBUTES);
+    sa.bInheritHandle = TRUE;
+    sa.lpSecurityDescriptor = nullptr;
+
+    HANDLE hStdInRd = nullptr;
+    HANDLE hStdOutWr = nullptr;
+
+    // Create pipes for stdin
+    if (!CreatePipe(&hStdInRd, &m_hStdInWr, &sa, 0)) {
+        m_last_error = "Failed to create stdin pipe";
+        return false;
+    }
+    SetHandleInformation(m_hStdInWr, HANDLE_FLAG_INHERIT, 0);
+
+    // Create pipes for stdout
+    if (!CreatePipe(&m_hStdOutRd, &hStdOutWr, &sa, 0)) {
+        m_last_error = "Failed to create stdout pipe";
+        CloseHandle(hStdInRd);
+        CloseHandle(m_hStdInWr);
+        m_hStdInWr = nullptr;
+        return false;
+    }
+    SetHandleInformation(m_hStdOutRd, HANDLE_FLAG_INHERIT, 0);
+
+    // Build command line
+    std::wstring cmdLine = L"\"" + program + L"\"";
+    for (const auto& arg : args) {
+        cmdLine += L" \"" + arg + L"\"";
+    }
+
+    STARTUPINFOW si;
+    ZeroMemory(&si, sizeof(si));
+    si.cb = sizeof(si);
+    si.hStdInput = hStdInRd;
+    si.hStdOutput = hStdOutWr;
+    si.hStdError = hStdOutWr;
+    si.dwFlags |= STARTF_USESTDHANDLES;
+
+    PROCESS_INFORMATION pi;
+    ZeroMemory(&pi, sizeof(pi));
+
+    BOOL created = CreateProcessW(nullptr, &cmdLine[0], nullptr, nullptr, TRUE,
+                                  CREATE_NO_WINDOW, nullptr, nullptr, &si, &pi);
+
+    // Close handles we don't need in parent
+    CloseHandle(hStdInRd);
+    CloseHandle(hStdOutWr);
+
+    if (!created) {
+        m_last_error = "Failed to create Python process";
+        CloseHandle(m_hStdInWr);
+        CloseHandle(m_hStdOutRd);
+        m_hStdInWr = nullptr;
+        m_hStdOutRd = nullptr;
+        return false;
+    }
+
+    m_hProcess = pi.hProcess;
+    m_hThread = pi.hThread;
+    return true;
+}
+
+void ProcessTransport::Stop()
+{
+    // Closing stdin makes the bridge's read loop end
+    if (m_hStdInWr) {
+        CloseHandle(m_hStdInWr);
+        m_hStdInWr = nullptr;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_processMutex);
+        if (m_hProcess) {
+            // Terminate if still running
+            if (WaitForSingleObject(m_hProcess, 1000) != WAIT_OBJECT_0) {
+                TerminateProcess(m_hProcess, 0);
+            }
+            CloseHandle(m_hProcess);
+            CloseHandle(m_hThread);
+            m_hProcess = nullptr;
+            m_hThread = nullptr;
+        }
+    }
+
+    if (m_hStdOutRd) {
+        CloseHandle(m_hStdOutRd);
+        m_hStdOutRd = nullptr;
+    }
+}
+
+void ProcessTransport::Interrupt()
+{
+    // Read polls IsAlive, so it returns -1 as soon as the process is gone
+    std::lock_guard<std::mutex> lock(m_processMutex);
+    m_interrupted = true;
+    if (m_hProcess) {
+        TerminateProcess(m_hProcess, 1);
+    }
+}
+
+bool ProcessTransport::IsAlive()
+{
+    std::lock_guard<std::mutex> lock(m_processMutex);
+    DWORD exitCode;
+    return m_hProcess && GetExitCodeProcess(m_hProcess, &exitCode) && exitCode == STILL_ACTIVE;
+}
+
+bool ProcessTransport::Write(const char* data, size_t size)
+{
+    if (!m_hStdInWr) {
+        m_last_error = "Not connected to Python process";
+        return false;
+    }
+
+    while (size > 0) {
+        DWORD chunk = size > 0x40000000 ? 0x40000000 : static_cast<DWORD>(size);
+        DWORD written = 0;
+        if (!WriteFile(m_hStdInWr, data, chunk, &written, nullptr) || written == 0) {
+            m_last_error = "Failed to write to Python process";
+            return false;
+        }
+        data += written;
+        size -= written;
+    }
+    return true;
+}
+
+long long ProcessTransport::Read(char* buffer, size_t size, uint32_t timeout_ms)
+{
+    if (!m_hStdOutRd) {
+        m_last_error = "Not connected to Python process";
+        return -1;
+    }
+
+    // Anonymous pipes have no overlapped reads, so poll. Yield for the
+    // first couple of milliseconds (most replies arrive within that), then
+    // back off to Sleep(1).
+    DWORD startTime = GetTickCount();
+    for (int spins = 0; ; ++spins) {
+        DWORD available = 0;
+        if (!PeekNamedPipe(m_hStdOutRd, nullptr, 0, nullptr, &available, nullptr)) {
+            m_last_error = "Python process exited unexpectedly";
+            return -1;
+        }
+
+        if (available > 0) {
+            DWORD toRead = available < size ? available : static_cast<DWORD>(size);
+            DWORD bytesRead = 0;
+            if (!ReadFile(m_hStdOutRd, buffer, toRead, &bytesRead, nullptr)) {
+                m_last_error = "Failed to read from Python process";
+                return -1;
+            }
+            return bytesRead;
+        }
+
+        if (!IsAlive()) {
+            m_last_error = "Python process exited unexpectedly";
+            return -1;
+        }
+        if (GetTickCount() - startTime >= timeout_ms) {
+            return 0;
+        }
+        if (spins < 2000) {
+            SwitchToThread();
+        } else {
+            Sleep(1);
+        }
+    }
+}
+
+} // namespace NppGoogleKeepSync
+
+#else // POSIX
+
+#include <cerrno>
+#include <csignal>
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <chrono>
+
+namespace NppGoogleKeepSync {
+
+ProcessTransport::~ProcessTransport()
+{
+    Stop();
+}
+
+bool ProcessTransport::Start(const std::wstring& program, const std::vector<std::wstring>& args)
+{
+    std::lock_guard<std::mutex> lock(m_processMutex);
+    if (m_interrupted) {
+        m_last_error = "Bridge was interrupted";
+        return false;
+    }
+
+    int inPipe[2];
+    int outPipe[2];
+    if (pipe(inPipe) != 0) {
+        m_last_error = "Failed to create stdin pipe";
+        return false;
+    }
+    if (pipe(outPipe) != 0) {
+        m_last_error = "Failed to create stdout pipe";
+        close(inPipe[0]);
+        close(inPipe[1]);
+        return false;
+    }
+
+    // A bridge that dies mid-write must surface as a write error, not kill us
+    signal(SIGPIPE, SIG_IGN);
+
+    std::vector<std::string> argStrings;
+    argStrings.push_back(Utf::ToUtf8(program));
+    for (const auto& arg : args) {
+        argStrings.push_back(Utf::ToUtf8(arg));
+    }
+    std::vector<char*> argv;
+    for (auto& arg : argStrings) {
+        argv.push_back(&arg[0]);
+    }
+    argv.push_back(nullptr);
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        m_last_error = "Failed to create Python process";
+        close(inPipe[0]);
+        close(inPipe[1]);
+        close(outPipe[0]);
+        close(outPipe[1]);
+        return false;
+    }
+    if (pid == 0) {
+        dup2(inPipe[0], STDIN_FILENO);
+        dup2(outPipe[1], STDOUT_FILENO);
+        close(inPipe[0]);
+        close(inPipe[1]);
+        close(outPipe[0]);
+        close(outPipe[1]);
+        execvp(argv[0], argv.data());
+        _exit(127);
+    }
+
+    close(inPipe[0]);
+    close(outPipe[1]);
+    m_stdinFd = inPipe[1];
+    m_stdoutFd = outPipe[0];
+    m_pid = pid;
+    return true;
+}
+
+void ProcessTransport::Stop()
+{
+    // Closing stdin makes the bridge's read loop end
+    if (m_stdinFd >= 0) {
+        close(m_stdinFd);
+        m_stdinFd = -1;
+    }
+
+    std::lock_guard<std::mutex> lock(m_processMutex);
+    if (m_pid > 0) {
+        // The bridge's stdout reaches end of file when it exits, so wait on
+        // that (up to a second) rather than polling the pid. Output still
+        // in the pipe is dropped.
+        bool exited = false;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        char discard[4096];
+        while (m_stdoutFd >= 0) {
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now()).count();
+            if (remaining <= 0) break;
+            pollfd pfd;
+            pfd.fd = m_stdoutFd;
+            pfd.events = POLLIN;
+            pfd.revents = 0;
+            int ready = poll(&pfd, 1, static_cast<int>(remaining));
+            if (ready < 0 && errno == EINTR) continue;
+            if (ready <= 0) break;
+            if (read(m_stdoutFd, discard, sizeof(discard)) <= 0) {
+                exited = true;
+                break;
+            }
+        }
+        if (!exited) {
+            kill(m_pid, SIGKILL);
+        }
+        waitpid(m_pid, nullptr, 0);
+        m_pid = -1;
+    }
+
+    if (m_stdoutFd >= 0) {
+        close(m_stdoutFd);
+        m_stdoutFd = -1;
+    }
+}
+
+void ProcessTransport::Interrupt()
+{
+    // The bridge's stdout then reaches end of file, failing a pending Read
+    std::lock_guard<std::mutex> lock(m_processMutex);
+    m_interrupted = true;
+    if (m_pid > 0) {
+        kill(m_pid, SIGKILL);
+    }
+}
+
+bool ProcessTransport::IsAlive()
+{
+    std::lock_guard<std::mutex> lock(m_processMutex);
+    if (m_pid <= 0) {
+        return false;
+    }
+    if (waitpid(m_pid, nullptr, WNOHANG) == m_pid) {
+        m_pid = -1;
+        return false;
+    }
+    return true;
+}
+
+bool ProcessTransport::Write(const char* data, size_t size)
+{
+    if (m_stdinFd < 0) {
+        m_last_error = "Not connected to Python process";
+        return false;
+    }
+
+    while (size > 0) {
+        ssize_t written = write(m_stdinFd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            m_last_error = "Failed to write to Python process";
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+long long ProcessTransport::Read(char* buffer, size_t size, uint32_t timeout_ms)
+{
+    if (m_stdoutFd < 0) {
+        m_last_error = "Not connected to Python process";
+        return -1;
+    }
+
+    pollfd pfd;
+    pfd.fd = m_stdoutFd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    int ready = poll(&pfd, 1, static_cast<int>(timeout_ms));
+    if (ready == 0 || (ready < 0 && errno == EINTR)) {
+        return 0;
+    }
+    if (ready < 0) {
+        m_last_error = "Failed to read from Python process";
+        return -1;
+    }
+
+    ssize_t bytesRead = read(m_stdoutFd, buffer, size);
+    if (bytesRead <= 0) {
+        m_last_error = "Python process exited unexpectedly";
+        return -1;
+    }
+    return bytesRead;
+}
+
+} // namespace NppGoogleKeepSync
+
+#endif
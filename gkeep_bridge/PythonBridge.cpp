@@ -1,53 +1,75 @@
 // PythonBridge - C++ to Python bridge for Google Keep integration
 
 #include "PythonBridge.h"
-#include <windows.h>
+#include "Json.h"
+#include "NoteList.h"
+#include "ContentHash.h"
+#include "TextMerge.h"
+#include "Utf.h"
+#include "Trace.h"
+#include "Diagnostics.h"
 #include <sstream>
-#include <iomanip>
 #include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <optional>
 
 namespace NppGoogleKeepSync {
 
-// Simple JSON parser functions
 namespace {
-    static std::string extractJsonValue(const std::string& json, const std::string& key) {
-        size_t pos = json.find("\"" + key + "\":");
-        if (pos == std::string::npos) return "";
-        
-        pos += key.length() + 3; // Move past key and colon
-        size_t start = json.find('"', pos);
-        if (start == std::string::npos) return "";
-        
-        start++; // Skip opening quote
-        size_t end = json.find('"', start);
-        if (end == std::string::npos) return "";
-        
-        return json.substr(start, end - start);
+    // A JSON object with a "success" member, as every reply is
+    bool IsReplyLine(const std::string& line)
+    {
+        size_t first = line.find_first_not_of(" \t");
+        size_t last = line.find_last_not_of(" \t\r\n");
+        return first != std::string::npos && line[first] == '{' && line[last] == '}' &&
+               !Json::ExtractValue(line, "success").empty();
     }
-    
-    static bool extractJsonBool(const std::string& json, const std::string& key) {
-        size_t pos = json.find("\"" + key + "\":");
-        if (pos == std::string::npos) return false;
-        
-        pos += key.length() + 3;
-        size_t start = json.find_first_of("tf", pos);
-        if (start == std::string::npos) return false;
-        
-        return json.substr(start, 4) == "true";
+
+    // Commands with the same effect however often they run. patch_note
+    // counts: a repeat finds the text already patched, gets base_mismatch
+    // and falls back to a full update_note.
+    bool IsIdempotent(const char* command)
+    {
+        static const char* const commands[] = {
+            "ping", "status", "login", "sync", "changes_since", "list", "get",
+            "update_note", "patch_note", "delete",
+        };
+        for (const char* name : commands) {
+            if (std::strcmp(name, command) == 0) return true;
+        }
+        return false;
     }
+
+    // Commands that routinely outlast the 30 s default: signing in and
+    // syncing a large account, streaming or diffing every note, batches
+    struct CommandTimeout {
+        const char* command;
+        std::chrono::milliseconds timeout;
+    };
+    const CommandTimeout kDefaultTimeouts[] = {
+        {"login", std::chrono::seconds(60)},
+        {"sync", std::chrono::seconds(60)},
+        {"changes_since", std::chrono::seconds(120)},
+        {"list", std::chrono::seconds(120)},
+        {"batch", std::chrono::seconds(120)},
+    };
 }
 
 PythonBridge::PythonBridge()
-    : m_hChildStdInRd(nullptr)
-    , m_hChildStdInWr(nullptr)
-    , m_hChildStdOutRd(nullptr)
-    , m_hChildStdOutWr(nullptr)
-    , m_hProcess(nullptr)
-    , m_hThread(nullptr)
+    : PythonBridge(std::make_unique<ProcessTransport>())
+{
+}
+
+PythonBridge::PythonBridge(std::unique_ptr<BridgeTransport> transport)
+    : m_transport(std::move(transport))
     , m_connected(false)
     , m_initialized(false)
 {
+    for (const auto& entry : kDefaultTimeouts) {
+        m_timeouts[entry.command] = entry.timeout;
+    }
 }
 
 PythonBridge::~PythonBridge()
@@ -65,32 +87,36 @@ PythonBridge& PythonBridge::operator=(PythonBridge&& other) noexcept
     if (this != &other) {
         Shutdown();
         
-        m_hChildStdInRd = other.m_hChildStdInRd;
-        m_hChildStdInWr = other.m_hChildStdInWr;
-        m_hChildStdOutRd = other.m_hChildStdOutRd;
-        m_hChildStdOutWr = other.m_hChildStdOutWr;
-        m_hProcess = other.m_hProcess;
-        m_hThread = other.m_hThread;
+        m_transport = std::move(other.m_transport);
+        m_read_buffer = std::move(other.m_read_buffer);
+        m_started_once = other.m_started_once;
+        m_startup_timeout = other.m_startup_timeout;
+        m_next_request_id = other.m_next_request_id;
+        m_default_timeout = other.m_default_timeout;
+        m_timeouts = std::move(other.m_timeouts);
         m_connected = other.m_connected;
         m_initialized = other.m_initialized;
         m_python_path = std::move(other.m_python_path);
         m_script_path = std::move(other.m_script_path);
+        m_script_args = std::move(other.m_script_args);
         m_last_error = std::move(other.m_last_error);
         m_callback = std::move(other.m_callback);
+        m_mirror = std::move(other.m_mirror);
+        m_mirror_max_age = other.m_mirror_max_age;
+        m_restart = other.m_restart;
+        m_backoff = other.m_backoff;
+        m_next_restart = other.m_next_restart;
+        m_login_params = std::move(other.m_login_params);
+        m_aborted = other.m_aborted.load();
         
-        other.m_hChildStdInRd = nullptr;
-        other.m_hChildStdInWr = nullptr;
-        other.m_hChildStdOutRd = nullptr;
-        other.m_hChildStdOutWr = nullptr;
-        other.m_hProcess = nullptr;
-        other.m_hThread = nullptr;
         other.m_connected = false;
         other.m_initialized = false;
     }
     return *this;
 }
 
-bool PythonBridge::Initialize(const std::wstring& python_path, const std::wstring& script_path)
+bool PythonBridge::Initialize(const std::wstring& python_path, const std::wstring& script_path,
+                              const std::vector<std::wstring>& script_args)
 {
     if (m_initialized) {
         return true;
@@ -98,9 +124,10 @@ bool PythonBridge::Initialize(const std::wstring& python_path, const std::wstrin
 
     m_python_path = python_path.empty() ? L"python" : python_path;
     m_script_path = script_path;
+    m_script_args = script_args;
 
     if (!StartPythonProcess()) {
-        m_last_error = "Failed to start Python process";
+        m_last_error = "Failed to start Python process: " + m_last_error;
         return false;
     }
 
@@ -110,6 +137,9 @@ bool PythonBridge::Initialize(const std::wstring& python_path, const std::wstrin
 
 void PythonBridge::Shutdown()
 {
+    if (m_mirror) {
+        m_mirror->Save();
+    }
     if (m_initialized) {
         StopPythonProcess();
         m_initialized = false;
@@ -117,175 +147,261 @@ void PythonBridge::Shutdown()
     }
 }
 
-bool PythonBridge::StartPythonProcess()
+// Marks a start or round trip in progress, so Abort knows to interrupt it
+struct PythonBridge::BusyScope {
+    PythonBridge& bridge;
+    explicit BusyScope(PythonBridge& owner) : bridge(owner) { ++bridge.m_busy; }
+    ~BusyScope() { --bridge.m_busy; }
+};
+
+void PythonBridge::Abort()
 {
-    SECURITY_ATTRIBUTES sa;
-    sa.nLength = sizeof(SECURITY_ATTRIBUTES);
-    sa.bInheritHandle = TRUE;
-    sa.lpSecurityDescriptor = nullptr;
+    // Set before looking at m_busy, which StartPythonProcess and RoundTrip
+    // raise before looking at m_aborted: one of the two sees the other
+    m_aborted = true;
+    if (m_busy > 0 && m_transport) {
+        m_transport->Interrupt();
+    }
+}
 
-    // Create pipes for stdin
-    if (!CreatePipe(&m_hChildStdInRd, &m_hChildStdInWr, &sa, 0)) {
-        m_last_error = "Failed to create stdin pipe";
-        return false;
+void PythonBridge::SetCommandTimeout(const std::string& command, std::chrono::milliseconds timeout)
+{
+    if (command.empty()) {
+        m_default_timeout = timeout;
+    } else {
+        m_timeouts[command] = timeout;
     }
-    SetHandleInformation(m_hChildStdInWr, HANDLE_FLAG_INHERIT, 0);
+}
 
-    // Create pipes for stdout
-    if (!CreatePipe(&m_hChildStdOutRd, &m_hChildStdOutWr, &sa, 0)) {
-        m_last_error = "Failed to create stdout pipe";
-        CloseHandle(m_hChildStdInRd);
-        CloseHandle(m_hChildStdInWr);
+std::chrono::milliseconds PythonBridge::GetCommandTimeout(const std::string& command) const
+{
+    auto it = m_timeouts.find(command);
+    return it != m_timeouts.end() ? it->second : m_default_timeout;
+}
+
+bool PythonBridge::StartPythonProcess()
+{
+    if (!m_transport) {
+        m_last_error = "No transport";
         return false;
     }
-    SetHandleInformation(m_hChildStdOutRd, HANDLE_FLAG_INHERIT, 0);
-
-    // Build command line
-    std::wstring cmdLine = L"\"" + m_python_path + L"\" \"" + m_script_path + L"\"";
-    
-    STARTUPINFOW si;
-    ZeroMemory(&si, sizeof(si));
-    si.cb = sizeof(si);
-    si.hStdInput = m_hChildStdInRd;
-    si.hStdOutput = m_hChildStdOutWr;
-    si.hStdError = m_hChildStdOutWr;
-    si.dwFlags |= STARTF_USESTDHANDLES;
-
-    PROCESS_INFORMATION pi;
-    ZeroMemory(&pi, sizeof(pi));
-
-    if (!CreateProcessW(nullptr, &cmdLine[0], nullptr, nullptr, TRUE, 
-                        CREATE_NO_WINDOW, nullptr, nullptr, &si, &pi)) {
-        m_last_error = "Failed to create Python process";
-        CloseHandle(m_hChildStdInRd);
-        CloseHandle(m_hChildStdInWr);
-        CloseHandle(m_hChildStdOutRd);
-        CloseHandle(m_hChildStdOutWr);
+    BusyScope busy(*this);
+    if (m_aborted) {
+        m_last_error = "Bridge is shutting down";
+        return false;
+    }
+    std::vector<std::wstring> args{m_script_path};
+    args.insert(args.end(), m_script_args.begin(), m_script_args.end());
+    if (!m_transport->Start(m_python_path, args)) {
+        m_last_error = m_transport->GetLastError();
         return false;
     }
-
-    m_hProcess = pi.hProcess;
-    m_hThread = pi.hThread;
-    
-    // Close handles we don't need in parent
-    CloseHandle(m_hChildStdInRd);
-    CloseHandle(m_hChildStdOutWr);
 
     m_connected = true;
+    m_read_buffer.clear();
+    if (m_started_once) {
+        Diagnostics::Add(m_counters.restarts);
+    }
+    m_started_once = true;
     
-    // Wait a moment for Python to initialize
-    Sleep(500);
-    
+    // Commands sent before the bridge finished importing would only queue
+    // up in the pipe, but a bridge that fails to start should be reported
+    // here rather than as the first command's timeout
+    if (!WaitForReady()) {
+        std::string error = m_last_error;
+        StopPythonProcess();
+        m_last_error = error;
+        return false;
+    }
     return true;
 }
 
-void PythonBridge::StopPythonProcess()
+bool PythonBridge::WaitForReady()
 {
-    if (m_hProcess) {
-        // Send exit command to gracefully shutdown Python
-        if (m_connected) {
-            std::string exit_cmd = "{\"command\":\"exit\"}\n";
-            DWORD written;
-            WriteFile(m_hChildStdInWr, exit_cmd.c_str(), static_cast<DWORD>(exit_cmd.length()), &written, nullptr);
-            Sleep(100);
+    TRACE_SCOPE("bridge_ready");
+    auto deadline = std::chrono::steady_clock::now() + m_startup_timeout;
+    
+    // Whatever the process wrote before the frame: an import error, the
+    // last line of a traceback
+    std::string said;
+    for (;;) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        std::string line;
+        if (remaining <= 0 || !ReadResponse(line, static_cast<uint32_t>(remaining))) {
+            m_last_error = m_connected ? "Timed out waiting for the Python bridge to start"
+                                       : "Python bridge exited during startup";
+            if (!said.empty()) {
+                m_last_error += ": " + said;
+            }
+            return false;
         }
-
-        // Terminate if still running
-        TerminateProcess(m_hProcess, 0);
         
-        CloseHandle(m_hProcess);
-        CloseHandle(m_hThread);
-        m_hProcess = nullptr;
-        m_hThread = nullptr;
+        if (Json::ExtractBool(line, "ready")) {
+            std::string protocol = Json::ExtractValue(line, "protocol");
+            if (protocol != std::to_string(kProtocolVersion)) {
+                m_last_error = "keep_bridge.py speaks protocol " + (protocol.empty() ? std::string("0") : protocol) +
+                               ", this plugin needs " + std::to_string(kProtocolVersion);
+                return false;
+            }
+            return true;
+        }
+        std::string error = Json::ExtractString(line, "error");
+        if (error.empty()) {
+            error = line;
+            while (!error.empty() && (error.back() == '\n' || error.back() == '\r')) {
+                error.pop_back();
+            }
+        }
+        if (!error.empty()) {
+            said = std::move(error);
+        }
     }
+}
 
-    if (m_hChildStdInWr) {
-        CloseHandle(m_hChildStdInWr);
-        m_hChildStdInWr = nullptr;
+void PythonBridge::StopPythonProcess()
+{
+    if (!m_transport) {
+        return;
     }
-    if (m_hChildStdOutRd) {
-        CloseHandle(m_hChildStdOutRd);
-        m_hChildStdOutRd = nullptr;
+    
+    // Send exit command to gracefully shutdown Python
+    if (m_connected) {
+        std::string exit_cmd = "{\"command\":\"exit\"}\n";
+        m_transport->Write(exit_cmd.data(), exit_cmd.size());
     }
+    m_transport->Stop();
+    m_read_buffer.clear();
 
     m_connected = false;
 }
 
+bool PythonBridge::Ping(uint32_t timeout_ms)
+{
+    if (!m_connected) {
+        return false;
+    }
+    BridgeResult result;
+    if (RoundTrip("ping", "", result, nullptr, timeout_ms)) {
+        return true;
+    }
+    if (m_connected && !result.raw_json.empty()) {
+        return true;    // Answered, just not with success
+    }
+    // Nothing else was waiting on an idle bridge, so it is hung
+    StopPythonProcess();
+    return false;
+}
+
+bool PythonBridge::WarmLogin()
+{
+    // keep_bridge.py signs in from the master token it cached at login,
+    // without another app password exchange
+    BridgeResult status;
+    if (!RoundTrip("status", "", status, nullptr) && status.raw_json.empty()) {
+        return false;
+    }
+    if (Json::ExtractBool(status.raw_json, "authenticated") || m_login_params.empty()) {
+        return true;
+    }
+    BridgeResult login;
+    return RoundTrip("login", m_login_params, login, nullptr) || !login.raw_json.empty();
+}
+
+bool PythonBridge::Recover()
+{
+    if (!m_initialized) {
+        return false;
+    }
+    if (m_connected) {
+        return true;
+    }
+    auto started = std::chrono::steady_clock::now();
+    if (started < m_next_restart) {
+        m_last_error = "Python process exited; waiting to restart it";
+        return false;
+    }
+
+    TRACE_SCOPE("bridge_restart");
+    StopPythonProcess();
+    if (!StartPythonProcess() || !WarmLogin()) {
+        std::string error = m_last_error;
+        StopPythonProcess();
+        m_last_error = error;
+        m_backoff = m_backoff.count() == 0 ? m_restart.min_backoff
+                                           : std::min(m_backoff * 2, m_restart.max_backoff);
+        m_next_restart = std::chrono::steady_clock::now() + m_backoff;
+        return false;
+    }
+    m_backoff = std::chrono::milliseconds(0);
+    m_next_restart = {};
+    m_counters.recovery.Record(static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started).count()));
+    return true;
+}
+
 bool PythonBridge::SendCommand(const std::string& json_command)
 {
-    if (!m_connected || !m_hChildStdInWr) {
+    if (!m_connected) {
         m_last_error = "Not connected to Python process";
         return false;
     }
 
-    DWORD written;
-    BOOL success = WriteFile(m_hChildStdInWr, json_command.c_str(), 
-                             static_cast<DWORD>(json_command.length()), &written, nullptr);
-    
-    if (!success || written != json_command.length()) {
-        m_last_error = "Failed to write to Python process";
+    if (!m_transport->Write(json_command.data(), json_command.size())) {
+        m_last_error = m_transport->GetLastError();
         return false;
     }
+    Diagnostics::Add(m_counters.bytesSent, json_command.size());
 
     return true;
 }
 
-bool PythonBridge::ReadResponse(std::string& response, DWORD timeout_ms)
+bool PythonBridge::ReadResponse(std::string& response, uint32_t timeout_ms)
 {
-    if (!m_connected || !m_hChildStdOutRd) {
+    if (!m_connected) {
         m_last_error = "Not connected to Python process";
         return false;
     }
 
-    char buffer[4096];
-    DWORD bytesRead;
     response.clear();
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
     
-    DWORD startTime = GetTickCount();
-    
+    // Bytes past the newline belong to the next response and stay buffered
+    size_t scanned = 0;
+    char buffer[65536];
     while (true) {
-        DWORD available = 0;
-        if (!PeekNamedPipe(m_hChildStdOutRd, nullptr, 0, nullptr, &available, nullptr)) {
-            break;
+        size_t newline = m_read_buffer.find('\n', scanned);
+        if (newline != std::string::npos) {
+            response.assign(m_read_buffer, 0, newline + 1);
+            m_read_buffer.erase(0, newline + 1);
+            return true;
         }
+        scanned = m_read_buffer.size();
         
-        if (available > 0) {
-            if (ReadFile(m_hChildStdOutRd, buffer, sizeof(buffer) - 1, &bytesRead, nullptr)) {
-                buffer[bytesRead] = '\0';
-                response += buffer;
-                
-                // Check if we have a complete JSON (contains newline)
-                if (response.find('\n') != std::string::npos) {
-                    break;
-                }
-            } else {
-                break;
-            }
-        } else {
-            // Check timeout
-            if (GetTickCount() - startTime > timeout_ms) {
-                m_last_error = "Timeout waiting for Python response";
-                return false;
-            }
-            Sleep(10);
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        if (remaining <= 0) {
+            m_last_error = "Timeout waiting for Python response";
+            return false;
         }
         
-        // Check if process is still alive
-        DWORD exitCode;
-        if (GetExitCodeProcess(m_hProcess, &exitCode) && exitCode != STILL_ACTIVE) {
+        long long bytesRead = m_transport->Read(buffer, sizeof(buffer), static_cast<uint32_t>(remaining));
+        if (bytesRead < 0) {
             m_last_error = "Python process exited unexpectedly";
             m_connected = false;
             return false;
         }
+        m_read_buffer.append(buffer, static_cast<size_t>(bytesRead));
+        Diagnostics::Add(m_counters.bytesReceived, static_cast<uint64_t>(bytesRead));
     }
-
-    return !response.empty();
 }
 
-std::string PythonBridge::BuildJsonCommand(const std::string& command, const std::string& params)
+std::string PythonBridge::BuildJsonCommand(const char* command, const std::string& params,
+                                           uint64_t request_id, int64_t deadline)
 {
     std::ostringstream oss;
-    oss << "{\"command\":\"" << command << "\",\"params\":";
+    oss << "{\"command\":\"" << command << "\",\"request_id\":" << request_id
+        << ",\"deadline\":" << deadline << ",\"params\":";
     if (params.empty()) {
         oss << "{}";
     } else {
@@ -297,54 +413,175 @@ std::string PythonBridge::BuildJsonCommand(const std::string& command, const std
 
 std::string PythonBridge::EscapeJsonString(const std::string& input)
 {
-    std::ostringstream oss;
-    for (char c : input) {
+    // The wire stays ASCII, as json.dumps writes it back: text is UTF-8
+    // and leaves as \u escapes, with surrogate pairs past the BMP
+    static const char hex[] = "0123456789abcdef";
+    std::string out;
+    out.reserve(input.size() + input.size() / 8);
+    auto escape = [&](uint32_t unit) {
+        char code[6] = {'\\', 'u', hex[(unit >> 12) & 0xF], hex[(unit >> 8) & 0xF], hex[(unit >> 4) & 0xF], hex[unit & 0xF]};
+        out.append(code, sizeof(code));
+    };
+    for (size_t i = 0; i < input.size(); ) {
+        unsigned char c = static_cast<unsigned char>(input[i]);
+        if (c >= 0x80) {
+            char32_t cp;
+            i += Utf::Decode(input, i, cp);
+            if (cp >= 0x10000) {
+                escape(0xD800 + ((cp - 0x10000) >> 10));
+                escape(0xDC00 + ((cp - 0x10000) & 0x3FF));
+            } else {
+                escape(cp);
+            }
+            continue;
+        }
         switch (c) {
-            case '"': oss << "\\\""; break;
-            case '\\': oss << "\\\\"; break;
-            case '\b': oss << "\\b"; break;
-            case '\f': oss << "\\f"; break;
-            case '\n': oss << "\\n"; break;
-            case '\r': oss << "\\r"; break;
-            case '\t': oss << "\\t"; break;
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
             default:
                 if (c >= 0x20 && c <= 0x7E) {
-                    oss << c;
+                    out += static_cast<char>(c);
                 } else {
-                    oss << "\\u" << std::hex << std::setfill('0') << std::setw(4) << (static_cast<int>(c) & 0xFF);
+                    escape(c);
                 }
         }
+        i++;
     }
-    return oss.str();
+    return out;
+}
+
+bool PythonBridge::ExecuteCommand(const char* command, const std::string& params_json, 
+                                  BridgeResult& result, const FrameHandler* on_frame)
+{
+    auto started = std::chrono::steady_clock::now();
+    bool ok;
+    {
+        Trace::Scope commandScope(Trace::Enabled() ? Trace::Intern(std::string("bridge:") + command) : nullptr);
+        if (!m_connected && m_restart.enabled) {
+            Recover();
+        }
+        
+        // Frames already handed on cannot be taken back, so a stream is
+        // only sent again if it died before its first frame
+        size_t frames = 0;
+        FrameHandler counted;
+        const FrameHandler* handler = on_frame;
+        if (on_frame) {
+            counted = [&](std::string& frame) {
+                ++frames;
+                (*on_frame)(frame);
+            };
+            handler = &counted;
+        }
+        ok = RoundTrip(command, params_json, result, handler);
+        if (!ok && !m_connected && m_restart.enabled && frames == 0 && IsIdempotent(command) && Recover()) {
+            Diagnostics::Add(m_counters.replayed);
+            result = BridgeResult();
+            ok = RoundTrip(command, params_json, result, handler);
+        }
+    }
+    
+    Diagnostics::Add(m_counters.commands);
+    if (!ok && !result.error_message.empty()) {
+        Diagnostics::Add(m_counters.errors);
+    }
+    m_counters.latency.Record(command, static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started).count()));
+    return ok;
 }
 
-bool PythonBridge::ExecuteCommand(const std::string& command, const std::string& params_json, 
-                                  BridgeResult& result)
+bool PythonBridge::RoundTrip(const char* command, const std::string& params_json, BridgeResult& result,
+                             const FrameHandler* on_frame, uint32_t timeout_ms)
 {
-    std::string json_cmd = BuildJsonCommand(command, params_json);
+    auto timeout = timeout_ms ? std::chrono::milliseconds(timeout_ms) : GetCommandTimeout(command);
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    uint64_t request_id = m_next_request_id++;
+    int64_t wall_deadline = std::chrono::duration_cast<std::chrono::milliseconds>(
+        (std::chrono::system_clock::now() + timeout).time_since_epoch()).count();
+    std::string json_cmd = BuildJsonCommand(command, params_json, request_id, wall_deadline);
+    const std::string id = std::to_string(request_id);
     
-    if (!SendCommand(json_cmd)) {
+    BusyScope busy(*this);
+    if (m_aborted) {
         result.success = false;
-        result.error_message = m_last_error;
+        result.error_message = m_last_error = "Bridge is shutting down";
         return false;
     }
-
-    std::string response;
-    if (!ReadResponse(response)) {
+    bool sent;
+    {
+        TRACE_SCOPE("ipc_send");
+        sent = SendCommand(json_cmd);
+    }
+    if (!sent) {
         result.success = false;
         result.error_message = m_last_error;
         return false;
     }
 
-    result.raw_json = response;
-    
-    // Parse response using simple JSON parsing
-    result.success = extractJsonBool(response, "success");
-    if (!result.success) {
-        result.error_message = extractJsonValue(response, "error");
-    }
+    // A streamed reply is frames until one without "more": true; the
+    // deadline covers them all
+    for (;;) {
+        // Time from the request being written until the reply is read back
+        std::string response;
+        bool received = false;
+        {
+            TRACE_SCOPE("python");
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now()).count();
+            if (remaining > 0) {
+                received = ReadResponse(response, static_cast<uint32_t>(remaining));
+            }
+        }
+        if (!received) {
+            if (m_connected) {
+                // Still running: its reply, if it ever comes, is dropped by
+                // id, and keep_bridge.py gives up on the command itself
+                Diagnostics::Add(m_counters.timeouts);
+                m_last_error = "Timed out after " + std::to_string(timeout.count()) + " ms waiting for " + command;
+            }
+            result.success = false;
+            result.error_message = m_last_error;
+            return false;
+        }
+        
+        // Frames of a command that timed out earlier. One without an id
+        // answers a line the bridge could not parse, which can only be ours,
+        // but only if it is a reply at all: on Windows the script's stderr
+        // (log warnings, "Trying cached master token...") shares the pipe.
+        std::string answers = Json::ExtractValue(response, "request_id");
+        if (answers.empty() && !IsReplyLine(response)) {
+            continue;
+        }
+        if (!answers.empty() && answers != id) {
+            Diagnostics::Add(m_counters.lateFrames);
+            continue;
+        }
 
-    return result.success;
+        TRACE_SCOPE("parse");
+        result.raw_json = std::move(response);
+        
+        // Parse response using simple JSON parsing
+        result.success = Json::ExtractBool(result.raw_json, "success");
+        if (!result.success) {
+            result.error_message = Json::ExtractString(result.raw_json, "error");
+        }
+        if (!on_frame) {
+            return result.success;
+        }
+        if (!result.success) {
+            return false;
+        }
+        bool more = Json::ExtractBool(result.raw_json, "more");
+        (*on_frame)(result.raw_json);
+        if (!more) {
+            return true;
+        }
+    }
 }
 
 // Public API methods
@@ -358,8 +595,7 @@ BridgeResult PythonBridge::Login(const std::string& email, const std::string& ap
            << "\"app_password\":\"" << EscapeJsonString(app_password) << "\"}";
     
     if (ExecuteCommand("login", params.str(), result) && result.success) {
-        // Parse email from response for confirmation
-        // Login successful
+        m_login_params = params.str();
     }
     
     return result;
@@ -387,7 +623,9 @@ BridgeResult PythonBridge::CreateNote(const std::string& title, const std::strin
     }
     params << "}";
     
-    ExecuteCommand("create_note", params.str(), result);
+    if (ExecuteCommand("create_note", params.str(), result) && m_mirror) {
+        m_mirror->Upsert(ParseNote(result.raw_json));
+    }
     return result;
 }
 
@@ -426,7 +664,120 @@ BridgeResult PythonBridge::UpdateNote(const std::string& note_id,
     }
     params << "}";
     
-    ExecuteCommand("update_note", params.str(), result);
+    if (ExecuteCommand("update_note", params.str(), result) && m_mirror) {
+        m_mirror->Upsert(ParseNote(result.raw_json));
+    }
+    return result;
+}
+
+BridgeResult PythonBridge::PatchNote(const std::string& note_id,
+                                    const std::string& base_text,
+                                    const std::string& new_text,
+                                    const std::optional<std::string>& title)
+{
+    auto base_lines = TextMerge::SplitLines(base_text);
+    auto new_lines = TextMerge::SplitLines(new_text);
+    auto hunks = TextMerge::DiffLines(base_lines, new_lines);
+    
+    std::ostringstream params;
+    params << "{\"id\":\"" << EscapeJsonString(note_id) << "\","
+           << "\"base_crc\":" << ContentHash::Crc32(base_text) << ","
+           << "\"base_lines\":" << base_lines.size() << ","
+           << "\"ops\":[";
+    for (size_t i = 0; i < hunks.size(); ++i) {
+        const auto& h = hunks[i];
+        std::string insert;
+        for (size_t j = h.otherStart; j < h.otherStart + h.otherCount; ++j) {
+            insert.append(new_lines[j].data(), new_lines[j].size());
+        }
+        if (i > 0) params << ",";
+        params << "[" << h.baseStart << "," << h.baseCount << ",\"" << EscapeJsonString(insert) << "\"]";
+    }
+    params << "]";
+    if (title.has_value()) {
+        params << ",\"title\":\"" << EscapeJsonString(title.value()) << "\"";
+    }
+    params << "}";
+    
+    // Not worth it when most of the text changed
+    std::string patch = params.str();
+    if (patch.size() >= new_text.size() / 2 + 256) {
+        return UpdateNote(note_id, title, new_text);
+    }
+    
+    BridgeResult result;
+    if (!ExecuteCommand("patch_note", patch, result)) {
+        if (Json::ExtractString(result.raw_json, "code") == "base_mismatch") {
+            return UpdateNote(note_id, title, new_text);
+        }
+        return result;
+    }
+    
+    // The response omits the text; the mirror gets it from our side
+    if (m_mirror) {
+        KeepNote note = ParseNote(result.raw_json);
+        note.text = new_text;
+        m_mirror->Upsert(note);
+    }
+    return result;
+}
+
+BridgeResult PythonBridge::Batch(const std::vector<BatchOp>& ops, std::vector<std::string>& out_ids)
+{
+    out_ids.clear();
+    
+    std::ostringstream params;
+    params << "{\"ops\":[";
+    for (size_t i = 0; i < ops.size(); ++i) {
+        const auto& op = ops[i];
+        if (i > 0) params << ",";
+        params << "{\"op\":\"";
+        switch (op.kind) {
+            case BatchOp::Kind::Create: params << "create"; break;
+            case BatchOp::Kind::Update: params << "update"; break;
+            case BatchOp::Kind::Delete: params << "delete"; break;
+        }
+        params << "\"";
+        if (!op.id.empty()) {
+            params << ",\"id\":\"" << EscapeJsonString(op.id) << "\"";
+        }
+        if (op.title.has_value()) {
+            params << ",\"title\":\"" << EscapeJsonString(op.title.value()) << "\"";
+        }
+        if (op.text.has_value()) {
+            params << ",\"text\":\"" << EscapeJsonString(op.text.value()) << "\"";
+        }
+        params << "}";
+    }
+    params << "]}";
+    
+    BridgeResult result;
+    if (!ExecuteCommand("batch", params.str(), result)) {
+        return result;
+    }
+    
+    Json::ForEachObject(result.raw_json, "results", [&](const std::string& entry) {
+        out_ids.push_back(Json::ExtractString(entry, "id"));
+        return true;
+    });
+    
+    // Write through to the mirror
+    if (m_mirror && out_ids.size() == ops.size()) {
+        for (size_t i = 0; i < ops.size(); ++i) {
+            const auto& op = ops[i];
+            KeepNote note;
+            if (op.kind != BatchOp::Kind::Create) {
+                if (auto existing = m_mirror->Get(out_ids[i])) {
+                    note = *existing;
+                }
+            }
+            note.id = out_ids[i];
+            if (op.kind == BatchOp::Kind::Delete) note.archived = true;
+            if (op.title.has_value()) note.title = op.title.value();
+            if (op.text.has_value()) note.text = op.text.value();
+            m_mirror->Upsert(note);
+        }
+    }
     return result;
 }
 
@@ -481,6 +832,50 @@ BridgeResult PythonBridge::ListNotes(bool all, int limit,
     return result;
 }
 
+BridgeResult PythonBridge::StreamNotes(const ListQuery& query, const std::function<bool(KeepNote&)>& on_note)
+{
+    BridgeResult result;
+    
+    std::ostringstream params;
+    params << "{\"all\":" << (query.all ? "true" : "false") << ","
+           << "\"limit\":" << query.limit << ","
+           << "\"full_text\":" << (query.full_text ? "true" : "false") << ","
+           << "\"page_size\":" << std::max<size_t>(query.page_size, 1) << ","
+           << "\"stream\":true";
+    if (!query.cursor.empty()) {
+        params << ",\"cursor\":\"" << EscapeJsonString(query.cursor) << "\"";
+    }
+    if (!query.query.empty()) {
+        params << ",\"query\":\"" << EscapeJsonString(query.query) << "\"";
+    }
+    if (!query.labels.empty()) {
+        params << ",\"labels\":[";
+        for (size_t i = 0; i < query.labels.size(); ++i) {
+            if (i > 0) params << ",";
+            params << "\"" << EscapeJsonString(query.labels[i]) << "\"";
+        }
+        params << "]";
+    }
+    params << "}";
+    
+    // Once the caller stops, later frames are still read off the pipe so
+    // the next command gets its own reply. Each frame is decoded in place
+    // into the same list.
+    bool wanted = true;
+    NoteList page;
+    FrameHandler on_frame = [&](std::string& frame) {
+        if (!wanted) return;
+        TRACE_SCOPE("parse_notes");
+        page.Parse(std::move(frame));
+        for (size_t i = 0; i < page.size() && wanted; ++i) {
+            KeepNote note = page[i].ToKeepNote();
+            wanted = on_note(note);
+        }
+    };
+    ExecuteCommand("list", params.str(), result, &on_frame);
+    return result;
+}
+
 BridgeResult PythonBridge::GetNote(const std::string& note_id)
 {
     BridgeResult result;
@@ -500,35 +895,141 @@ BridgeResult PythonBridge::DeleteNote(const std::string& note_id, bool permanent
     params << "{\"id\":\"" << EscapeJsonString(note_id) << "\","
            << "\"permanent\":" << (permanent ? "true" : "false") << "}";
     
-    ExecuteCommand("delete", params.str(), result);
+    if (ExecuteCommand("delete", params.str(), result) && m_mirror) {
+        if (permanent) {
+            m_mirror->Remove(note_id);
+        } else if (auto note = m_mirror->Get(note_id)) {
+            note->archived = true;
+            m_mirror->Upsert(*note);
+        }
+    }
     return result;
 }
 
-std::vector<KeepNote> PythonBridge::ParseNoteList(const std::string& json_response)
+void PythonBridge::EnableMirror(const std::wstring& mirror_path, std::chrono::seconds max_staleness)
+{
+    if (!m_mirror) {
+        m_mirror = std::make_unique<NoteMirror>();
+    }
+    m_mirror->Load(std::filesystem::path(mirror_path));
+    m_mirror_max_age = max_staleness;
+}
+
+bool PythonBridge::RefreshMirror(bool force)
 {
+    if (!m_mirror) {
+        return false;
+    }
+    if (!force && !m_mirror->IsStale(m_mirror_max_age)) {
+        return true;
+    }
+
+    ListQuery query;
+    query.all = true;
+    query.full_text = true;
     std::vector<KeepNote> notes;
-    size_t array_start = json_response.find("\"notes\":[");
-    if (array_start == std::string::npos) return notes;
-    size_t obj_start = json_response.find('{', array_start);
-    if (obj_start == std::string::npos) return notes;
-    int depth = 0;
-    size_t search_pos = obj_start;
-    while (search_pos < json_response.length()) {
-        char c = json_response[search_pos];
-        if (c == '{') {
-            if (depth == 0) obj_start = search_pos;
-            depth++;
-        } else if (c == '}') {
-            depth--;
-            if (depth == 0) {
-                std::string note_json = json_response.substr(obj_start, search_pos - obj_start + 1);
-                notes.push_back(ParseNote(note_json));
+    BridgeResult result = StreamNotes(query, [&](KeepNote& note) {
+        notes.push_back(std::move(note));
+        return true;
+    });
+    if (!result.success) {
+        return false;
+    }
+    m_mirror->ReplaceAll(std::move(notes));
+    m_mirror->Save();
+    return true;
+}
+
+BridgeResult PythonBridge::ChangesSince(const std::string& cursor, RemoteChanges& out_changes)
+{
+    BridgeResult result;
+    out_changes = RemoteChanges();
+
+    std::ostringstream params;
+    params << "{\"cursor\":\"" << EscapeJsonString(cursor) << "\"}";
+    if (!ExecuteCommand("changes_since", params.str(), result)) {
+        return result;
+    }
+
+    out_changes.full = Json::ExtractBool(result.raw_json, "full");
+    out_changes.cursor = Json::ExtractString(result.raw_json, "cursor");
+    out_changes.removed = Json::ExtractStringArray(result.raw_json, "removed");
+    NoteList changed;
+    changed.Parse(result.raw_json, "changed");
+    out_changes.changed = changed.ToKeepNotes();
+
+    // Apply the delta to the mirror; a full answer replaces it outright
+    if (m_mirror) {
+        if (out_changes.full) {
+            m_mirror->ReplaceAll(out_changes.changed);
+        } else {
+            for (const auto& note : out_changes.changed) {
+                m_mirror->Upsert(note);
             }
+            for (const auto& id : out_changes.removed) {
+                m_mirror->Remove(id);
+            }
+            m_mirror->MarkRefreshed();
+        }
+        // The caller persists the cursor; it must never get ahead of the
+        // mirror on disk, or a crash would lose this delta for good
+        if (!m_mirror->Save()) {
+            out_changes.cursor = cursor;
+        }
+    }
+    return result;
+}
+
+std::vector<KeepNote> PythonBridge::ListNotesCached(bool all, int limit,
+                                                    const std::string& query,
+                                                    const std::vector<std::string>& labels)
+{
+    if (!m_mirror) {
+        ListQuery list_query;
+        list_query.all = all;
+        list_query.limit = limit > 0 ? static_cast<size_t>(limit) : 0;
+        list_query.query = query;
+        list_query.labels = labels;
+        std::vector<KeepNote> notes;
+        BridgeResult result = StreamNotes(list_query, [&](KeepNote& note) {
+            notes.push_back(std::move(note));
+            return true;
+        });
+        return result.success ? notes : std::vector<KeepNote>();
+    }
+
+    // A failed refresh still serves the last known state (e.g. while offline)
+    RefreshMirror();
+    return m_mirror->List(all, limit > 0 ? static_cast<size_t>(limit) : 0, query, labels);
+}
+
+bool PythonBridge::GetNoteCached(const std::string& note_id, KeepNote& out_note)
+{
+    if (m_mirror) {
+        RefreshMirror();
+        if (auto note = m_mirror->Get(note_id)) {
+            out_note = std::move(*note);
+            return true;
         }
-        search_pos++;
-        if (notes.size() >= 1000) break;
     }
-    return notes;
+
+    BridgeResult result = GetNote(note_id);
+    if (!result.success) {
+        return false;
+    }
+    out_note = ParseNote(result.raw_json);
+    if (m_mirror) {
+        m_mirror->Upsert(out_note);
+    }
+    return true;
+}
+
+std::vector<KeepNote> PythonBridge::ParseNoteList(const std::string& json_response)
+{
+    TRACE_SCOPE("parse_notes");
+    NoteList notes;
+    notes.Parse(json_response);
+    return notes.ToKeepNotes();
 }
 
 KeepNote PythonBridge::ParseNote(const std::string& json_response)
@@ -536,38 +1037,24 @@ KeepNote PythonBridge::ParseNote(const std::string& json_response)
     KeepNote note;
     
     // Simple parsing for single note
-    note.id = extractJsonValue(json_response, "id");
-    note.title = extractJsonValue(json_response, "title");
-    note.text = extractJsonValue(json_response, "text");
+    note.id = Json::ExtractString(json_response, "id");
+    note.title = Json::ExtractString(json_response, "title");
+    note.text = Json::ExtractString(json_response, "text");
     
     // Parse boolean values
-    std::string pinned_str = extractJsonValue(json_response, "pinned");
-    note.pinned = (pinned_str == "true");
-    
-    std::string archived_str = extractJsonValue(json_response, "archived");
-    note.archived = (archived_str == "true");
-    
-    note.color = extractJsonValue(json_response, "color");
-    note.created_timestamp = extractJsonValue(json_response, "timestamp");
-    
-    // Parse labels array - simplified
-    size_t labels_start = json_response.find("\"labels\":[");
-    if (labels_start != std::string::npos) {
-        labels_start += 10; // Skip "\"labels\":["
-        size_t labels_end = json_response.find("]", labels_start);
-        if (labels_end != std::string::npos) {
-            std::string labels_str = json_response.substr(labels_start, labels_end - labels_start);
-            size_t start = 0;
-            while (true) {
-                size_t quote1 = labels_str.find('"', start);
-                if (quote1 == std::string::npos) break;
-                size_t quote2 = labels_str.find('"', quote1 + 1);
-                if (quote2 == std::string::npos) break;
-                note.labels.push_back(labels_str.substr(quote1 + 1, quote2 - quote1 - 1));
-                start = quote2 + 1;
-            }
-        }
+    note.pinned = Json::ExtractBool(json_response, "pinned");
+    note.archived = Json::ExtractBool(json_response, "archived");
+    
+    note.color = Json::ExtractString(json_response, "color");
+    
+    // List entries carry flat "timestamp"/"edited"; get/create/update nest them
+    note.created_timestamp = Json::ExtractString(json_response, "timestamp");
+    if (note.created_timestamp.empty()) {
+        note.created_timestamp = Json::ExtractString(json_response, "created");
     }
+    note.edited_timestamp = Json::ExtractString(json_response, "edited");
+    
+    note.labels = Json::ExtractStringArray(json_response, "labels");
     
     return note;
 }
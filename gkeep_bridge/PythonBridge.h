@@ -10,17 +10,22 @@
  * Uses App Password authentication instead of OAuth.
  */
 
+#include <atomic>
 #include <string>
 #include <vector>
 #include <memory>
 #include <functional>
 #include <optional>
-#include <windows.h>
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
 
-namespace NppGoogleKeepSync {
+#include "KeepNote.h"
+#include "NoteMirror.h"
+#include "BridgeTransport.h"
+#include "Diagnostics.h"
 
-// Forward declarations
-struct KeepNote;
+namespace NppGoogleKeepSync {
 
 /**
  * Result structure for bridge operations
@@ -32,18 +37,46 @@ struct BridgeResult {
 };
 
 /**
- * Simple note structure for C++ side
+ * Notes changed remotely since a change-feed cursor
+ */
+struct RemoteChanges {
+    bool full = false;                  // Cursor was empty or the bridge restarted; changed holds every note
+    std::string cursor;                 // Pass to the next ChangesSince call
+    std::vector<KeepNote> changed;      // Notes created or modified since the cursor
+    std::vector<std::string> removed;   // Ids of notes trashed or deleted since the cursor
+};
+
+/**
+ * One write in a batch; see PythonBridge::Batch
+ */
+struct BatchOp {
+    enum class Kind { Create, Update, Delete };
+    Kind kind = Kind::Update;
+    std::string id;                     // Target note (Update/Delete)
+    std::optional<std::string> title;   // nullopt leaves the title unchanged
+    std::optional<std::string> text;    // nullopt leaves the text unchanged
+};
+
+/**
+ * Filters and paging for PythonBridge::StreamNotes
  */
-struct KeepNote {
-    std::string id;
-    std::string title;
-    std::string text;
-    bool pinned = false;
-    bool archived = false;
-    std::string color;
-    std::vector<std::string> labels;
-    std::string created_timestamp;
-    std::string edited_timestamp;
+struct ListQuery {
+    bool all = false;                   // Include archived notes
+    size_t limit = 0;                   // Most notes to return (0 = all)
+    std::string query;                  // Search query string
+    std::vector<std::string> labels;    // Only notes with one of these labels
+    bool full_text = false;             // Untruncated note text
+    size_t page_size = 500;             // Notes per frame
+    std::string cursor;                 // Start after this (from an earlier page)
+};
+
+/**
+ * When and how often PythonBridge restarts a bridge process that died
+ */
+struct RestartPolicy {
+    bool enabled = false;                               // Off: a dead bridge stays dead
+    std::chrono::milliseconds min_backoff{250};         // Wait after the first failed restart
+    std::chrono::milliseconds max_backoff{30000};       // Doubling stops here
 };
 
 /**
@@ -51,7 +84,19 @@ struct KeepNote {
  */
 class PythonBridge {
 public:
+    /**
+     * Wire protocol version; keep_bridge.py announces its own in the
+     * ready frame it writes once started, and the two must match.
+     * 2: commands carry a request_id and a deadline, replies the id.
+     */
+    static constexpr int kProtocolVersion = 2;
+
     PythonBridge();
+    
+    /**
+     * Use a custom transport instead of a child process on stdin/stdout
+     */
+    explicit PythonBridge(std::unique_ptr<BridgeTransport> transport);
     ~PythonBridge();
 
     // Non-copyable
@@ -66,20 +111,76 @@ public:
      * Initialize the bridge - starts Python subprocess
      * @param python_path Path to Python executable (empty for default 'python')
      * @param script_path Path to keep_bridge.py script
+     * @param script_args Extra arguments for the script, e.g. --backend=fake
      * @return true if initialization succeeded
      */
-    bool Initialize(const std::wstring& python_path, const std::wstring& script_path);
+    bool Initialize(const std::wstring& python_path, const std::wstring& script_path,
+                    const std::vector<std::wstring>& script_args = {});
 
     /**
      * Shutdown the bridge - terminates Python subprocess
      */
     void Shutdown();
 
+    /**
+     * Fail whatever the bridge is doing, from any thread: a start, sign-in
+     * or command in progress on another thread ends now instead of at its
+     * deadline, and every later one fails at once. For shutting down while
+     * a worker thread still uses the bridge; Shutdown must follow.
+     */
+    void Abort();
+
+    /**
+     * Longest to wait for a starting bridge's ready frame (default 15 s;
+     * Python's first start after an install can be slow)
+     */
+    void SetStartupTimeout(std::chrono::milliseconds timeout) { m_startup_timeout = timeout; }
+
+    /**
+     * How long a command may take, from sending it to its last frame.
+     * The deadline goes to keep_bridge.py with the command, which skips a
+     * command already past it and stops a long one (a streamed list, a
+     * batch) at the next safe point. A reply that comes after the
+     * deadline is recognised by its request id and dropped.
+     * @param command Command name ("sync", "list", ...); empty sets the
+     *        default for commands without a timeout of their own
+     *        (30 s; login and sync 60 s, list, changes_since, batch 120 s)
+     */
+    void SetCommandTimeout(const std::string& command, std::chrono::milliseconds timeout);
+    std::chrono::milliseconds GetCommandTimeout(const std::string& command) const;
+
     /**
      * Check if bridge is currently connected to Python process
      */
     bool IsConnected() const { return m_connected; }
 
+    // Recovery
+
+    /**
+     * Restart the bridge process when it dies. A command that finds it
+     * dead restarts it first; one it dies under is sent again on the new
+     * process if it is safe to repeat (reads, update_note, patch_note,
+     * delete, login; not create_note or batch).
+     */
+    void SetRestartPolicy(const RestartPolicy& policy) { m_restart = policy; }
+
+    /**
+     * Send a ping, which the script answers without signing in or
+     * touching the network
+     * @param timeout_ms Longest to wait for the reply
+     * @return true if the bridge answered. One that died or did not
+     *         answer in time is stopped, ready for Recover.
+     */
+    bool Ping(uint32_t timeout_ms);
+
+    /**
+     * Restart a stopped bridge process and sign in again: from the token
+     * keep_bridge.py cached, or failing that with the last Login's
+     * credentials. Failed restarts back off per the RestartPolicy.
+     * @return true if the bridge is connected afterwards
+     */
+    bool Recover();
+
     // Authentication (using App Password instead of OAuth)
     
     /**
@@ -133,12 +234,47 @@ public:
                            const std::optional<std::string>& color = std::nullopt,
                            const std::optional<std::vector<std::string>>& labels = std::nullopt);
 
+    /**
+     * Update a note's text by sending a line diff instead of the full text
+     * @param note_id Google Keep note ID
+     * @param base_text Text the note currently holds in Keep (last synced)
+     * @param new_text Desired text
+     * @param title New title (nullopt to keep current)
+     * @return BridgeResult with updated note info. Falls back to a full
+     *         UpdateNote when Keep no longer holds base_text or the patch
+     *         would not be smaller than the text.
+     */
+    BridgeResult PatchNote(const std::string& note_id,
+                           const std::string& base_text,
+                           const std::string& new_text,
+                           const std::optional<std::string>& title = std::nullopt);
+
+    /**
+     * Apply several creates/updates/archives and push them in one sync
+     * @param ops Writes to apply, in order
+     * @param out_ids Note id of each op (new ids for creates)
+     * @return BridgeResult with batch status. Nothing is applied if any
+     *         target note is missing.
+     */
+    BridgeResult Batch(const std::vector<BatchOp>& ops, std::vector<std::string>& out_ids);
+
     /**
      * Sync notes with Google Keep
      * @return BridgeResult with sync status
      */
     BridgeResult Sync();
 
+    /**
+     * Sync and fetch only the notes changed since a cursor. The delta is
+     * applied to the mirror and saved when one is enabled; if the save
+     * fails the returned cursor is the one passed in, so the delta is
+     * fetched again next time.
+     * @param cursor Cursor from a previous call (empty for a full pull)
+     * @param out_changes Changed/removed notes and the next cursor
+     * @return BridgeResult with sync status
+     */
+    BridgeResult ChangesSince(const std::string& cursor, RemoteChanges& out_changes);
+
     /**
      * List notes with optional filtering
      * @param all Include archived notes
@@ -151,6 +287,18 @@ public:
                            const std::string& query = "",
                            const std::vector<std::string>& labels = {});
 
+    /**
+     * List notes a page at a time. The bridge answers one command with a
+     * frame per page, and each note is handed to on_note as its frame
+     * arrives, so memory stays bounded by the page size.
+     * @param query Filters and page size
+     * @param on_note Called per note in id order; return false to stop
+     *        (the remaining frames are read and dropped)
+     * @return BridgeResult; raw_json holds the reply only on failure
+     *         (frames are decoded in place as they arrive)
+     */
+    BridgeResult StreamNotes(const ListQuery& query, const std::function<bool(KeepNote&)>& on_note);
+
     /**
      * Get a specific note by ID
      * @param note_id Google Keep note ID
@@ -166,10 +314,47 @@ public:
      */
     BridgeResult DeleteNote(const std::string& note_id, bool permanent = false);
 
+    // Local mirror (reads served without a round trip)
+
+    /**
+     * Enable the persistent note mirror
+     * @param mirror_path File the mirror is loaded from and saved to
+     * @param max_staleness Mirror age after which reads force a refresh
+     */
+    void EnableMirror(const std::wstring& mirror_path, std::chrono::seconds max_staleness);
+
+    /**
+     * Pull all notes from the bridge into the mirror
+     * @param force Refresh even if the mirror is within its staleness bound
+     * @return true if the mirror is fresh afterwards
+     */
+    bool RefreshMirror(bool force = false);
+
+    /**
+     * List notes from the mirror, refreshing it first if stale.
+     * Falls back to a bridge round trip when the mirror is disabled.
+     */
+    std::vector<KeepNote> ListNotesCached(bool all = false, int limit = 100,
+                                          const std::string& query = "",
+                                          const std::vector<std::string>& labels = {});
+
+    /**
+     * Get a note from the mirror, refreshing it first if stale.
+     * A mirror miss falls back to GetNote and caches the result.
+     * @return true if the note was found
+     */
+    bool GetNoteCached(const std::string& note_id, KeepNote& out_note);
+
+    /**
+     * Access the mirror (nullptr until EnableMirror is called)
+     */
+    NoteMirror* GetMirror() { return m_mirror.get(); }
+
     // Utility methods
 
     /**
-     * Parse note list from JSON response
+     * Parse note list from JSON response. To read notes without a copy
+     * per field, decode the reply with a NoteList instead.
      * @param json_response Raw JSON from ListNotes
      * @return Vector of KeepNote structures
      */
@@ -193,31 +378,68 @@ public:
      */
     const std::string& GetLastError() const { return m_last_error; }
 
+    /**
+     * Command, traffic and latency counters for the Diagnostics page
+     */
+    const Diagnostics::BridgeCounters& GetCounters() const { return m_counters; }
+
 private:
-    // Process handles
-    HANDLE m_hChildStdInRd = nullptr;
-    HANDLE m_hChildStdInWr = nullptr;
-    HANDLE m_hChildStdOutRd = nullptr;
-    HANDLE m_hChildStdOutWr = nullptr;
-    HANDLE m_hProcess = nullptr;
-    HANDLE m_hThread = nullptr;
+    // Bridge process stream; bytes read past the last response
+    std::unique_ptr<BridgeTransport> m_transport;
+    std::string m_read_buffer;
+    bool m_started_once = false;
+    std::chrono::milliseconds m_startup_timeout{15000};
+    
+    // Deadlines: replies carry the request_id they answer
+    uint64_t m_next_request_id = 1;
+    std::chrono::milliseconds m_default_timeout{30000};
+    std::unordered_map<std::string, std::chrono::milliseconds> m_timeouts;
+    
+    // Counters stay with this object when it is moved from
+    Diagnostics::BridgeCounters m_counters;
+
+    // Recovery
+    RestartPolicy m_restart;
+    std::chrono::milliseconds m_backoff{0};             // 0 after a good restart
+    std::chrono::steady_clock::time_point m_next_restart;
+    std::string m_login_params;                         // Last successful login, for Recover
 
     // State
+    std::atomic<bool> m_aborted{false};
+    std::atomic<int> m_busy{0};         // Starts and round trips in progress, for Abort
     bool m_connected = false;
     bool m_initialized = false;
     std::wstring m_python_path;
     std::wstring m_script_path;
+    std::vector<std::wstring> m_script_args;
     std::string m_last_error;
     Callback m_callback;
 
+    // Mirror
+    std::unique_ptr<NoteMirror> m_mirror;
+    std::chrono::seconds m_mirror_max_age{300};
+
     // Internal methods
+    struct BusyScope;
     bool StartPythonProcess();
+    // Read up to the ready frame of a process just started
+    bool WaitForReady();
     void StopPythonProcess();
     bool SendCommand(const std::string& json_command);
-    bool ReadResponse(std::string& response, DWORD timeout_ms = 30000);
-    bool ExecuteCommand(const std::string& command, const std::string& params_json, 
-                        BridgeResult& result);
-    std::string BuildJsonCommand(const std::string& command, const std::string& params);
+    bool ReadResponse(std::string& response, uint32_t timeout_ms = 30000);
+    // Sees each frame of a streamed reply and may take it; see StreamNotes
+    using FrameHandler = std::function<void(std::string& frame)>;
+    // command must be a string literal (it keys the latency histograms)
+    bool ExecuteCommand(const char* command, const std::string& params_json, 
+                        BridgeResult& result, const FrameHandler* on_frame = nullptr);
+    // timeout_ms 0: the command's own timeout (GetCommandTimeout)
+    bool RoundTrip(const char* command, const std::string& params_json, BridgeResult& result,
+                   const FrameHandler* on_frame, uint32_t timeout_ms = 0);
+    // Status (and if need be login) on a fresh process
+    bool WarmLogin();
+    // deadline is Unix time in ms, the clock keep_bridge.py checks it on
+    std::string BuildJsonCommand(const char* command, const std::string& params,
+                                 uint64_t request_id, int64_t deadline);
     std::string EscapeJsonString(const std::string& input);
 };
 
@@ -0,0 +1,359 @@
+#!/usr/bin/env python3
+"""
+In-memory stand-in for gkeepapi, used by keep_bridge.py --backend=fake.
+
+Implements the part of the gkeepapi.Keep surface the bridge handlers use
+(createNote, get, all, find, findLabel, createLabel, sync, dump, restore,
+authenticate, resume) without network access or credentials, so the whole
+plugin -> bridge pipeline can be benchmarked and soak-tested offline.
+
+Runs are deterministic: note and label ids come from counters and
+timestamps from a logical clock that advances one millisecond per change.
+Every call that would reach Google (authenticate, resume, sync) can be
+given a simulated latency and can fail at a configurable rate, drawn from
+a seeded random generator so a failing run can be replayed.
+"""
+
+import json
+import random
+import re
+import time
+from datetime import datetime, timedelta
+from enum import Enum
+from pathlib import Path
+from typing import Any, Dict, List, Optional
+
+
+class ColorValue(Enum):
+    """Same members as gkeepapi.node.ColorValue."""
+    White = 'DEFAULT'
+    Red = 'RED'
+    Orange = 'ORANGE'
+    Yellow = 'YELLOW'
+    Green = 'GREEN'
+    Teal = 'TEAL'
+    Blue = 'BLUE'
+    DarkBlue = 'CERULEAN'
+    Purple = 'PURPLE'
+    Pink = 'PINK'
+    Brown = 'BROWN'
+    Gray = 'GRAY'
+
+
+class LoginException(Exception):
+    """Raised by authenticate/resume when a login fault is injected."""
+
+
+class FakeKeepError(Exception):
+    """Injected failure of a simulated network call."""
+
+
+class LabelException(Exception):
+    """Raised when creating a label that already exists."""
+
+
+EPOCH = datetime(2025, 1, 1)
+
+
+class Timestamps:
+    def __init__(self, now: datetime):
+        self.created = now
+        self.edited = now
+        self.updated = now
+
+
+class Label:
+    def __init__(self, label_id: str, name: str, now: datetime):
+        self.id = label_id
+        self.name = name
+        self.timestamps = Timestamps(now)
+
+
+class NoteLabels:
+    """Labels attached to a note (gkeepapi.node.NodeLabels)."""
+
+    def __init__(self, note: 'Note'):
+        self._note = note
+        self._labels: Dict[str, Label] = {}
+
+    def add(self, label: Label):
+        self._labels[label.id] = label
+        self._note._touch()
+
+    def remove(self, label: Label):
+        if self._labels.pop(label.id, None) is not None:
+            self._note._touch()
+
+    def clear(self):
+        if self._labels:
+            self._labels.clear()
+            self._note._touch()
+
+    def get(self, label_id: str) -> Optional[Label]:
+        return self._labels.get(label_id)
+
+    def all(self) -> List[Label]:
+        return list(self._labels.values())
+
+    def __iter__(self):
+        return iter(self.all())
+
+
+class Note:
+    def __init__(self, keep: 'FakeKeep', note_id: str, title: str, text: str):
+        self._keep = keep
+        self.id = note_id
+        self.timestamps = Timestamps(keep._tick())
+        self.labels = NoteLabels(self)
+        self._title = title
+        self._text = text
+        self._pinned = False
+        self._archived = False
+        self._trashed = False
+        self._color = ColorValue.White
+        self.deleted = False
+        self.dirty = True
+
+    def _touch(self):
+        now = self._keep._tick()
+        self.timestamps.edited = now
+        self.timestamps.updated = now
+        self.dirty = True
+
+    def _field(name):
+        attr = '_' + name
+
+        def get(self):
+            return getattr(self, attr)
+
+        def set(self, value):
+            setattr(self, attr, value)
+            self._touch()
+        return property(get, set)
+
+    title = _field('title')
+    text = _field('text')
+    pinned = _field('pinned')
+    archived = _field('archived')
+    trashed = _field('trashed')
+    color = _field('color')
+    del _field
+
+    def trash(self):
+        self.trashed = True
+
+    def untrash(self):
+        self.trashed = False
+
+    def delete(self):
+        self.deleted = True
+        self._touch()
+
+
+class FakeKeep:
+    """Drop-in for gkeepapi.Keep, holding every note in memory."""
+
+    def __init__(self, latency_ms: float = 0.0, jitter_ms: float = 0.0,
+                 fail_rate: float = 0.0, seed: int = 0, request_timeout=None):
+        self.latency_ms = latency_ms
+        # Seconds a call may take, as keep_bridge.py bounds gkeepapi's
+        # requests; None or returning None means no limit
+        self.request_timeout = request_timeout
+        self.jitter_ms = jitter_ms
+        self.fail_rate = fail_rate
+        self._random = random.Random(seed)
+        self._notes: Dict[str, Note] = {}
+        self._labels: Dict[str, Label] = {}
+        self._next_id = 1
+        self._clock = 0
+        self._authenticated = False
+        self.calls = {'authenticate': 0, 'sync': 0, 'faults': 0}
+
+    # Simulated network
+
+    def _remote_call(self, name: str, exception=FakeKeepError):
+        self.calls[name] = self.calls.get(name, 0) + 1
+        delay = self.latency_ms
+        if self.jitter_ms:
+            delay += self._random.uniform(-self.jitter_ms, self.jitter_ms)
+        # A call slower than what is left of the command's deadline times
+        # out as a bounded gkeepapi request does
+        timeout = self.request_timeout() if self.request_timeout else None
+        if timeout is not None and delay / 1000.0 > timeout:
+            time.sleep(timeout)
+            raise TimeoutError(f"{name} timed out")
+        if delay > 0:
+            time.sleep(delay / 1000.0)
+        if self.fail_rate and self._random.random() < self.fail_rate:
+            self.calls['faults'] += 1
+            raise exception(f"Injected fault in {name}")
+
+    def _tick(self) -> datetime:
+        self._clock += 1
+        return EPOCH + timedelta(milliseconds=self._clock)
+
+    def _new_id(self) -> str:
+        note_id = f"fake{self._next_id:012x}"
+        self._next_id += 1
+        return note_id
+
+    # Session
+
+    def authenticate(self, email, master_token, state=None, sync=True, device_id=None):
+        self._remote_call('authenticate', LoginException)
+        self._authenticated = True
+        if state is not None:
+            self.restore(state)
+        if sync:
+            self.sync()
+        return True
+
+    def resume(self, email, master_token, state=None, sync=True, device_id=None):
+        return self.authenticate(email, master_token, state, sync, device_id)
+
+    def sync(self):
+        """Push dirty notes; permanently deleted ones are dropped."""
+        self._remote_call('sync')
+        for note_id in [i for i, n in self._notes.items() if n.deleted]:
+            del self._notes[note_id]
+        for note in self._notes.values():
+            note.dirty = False
+
+    # Notes
+
+    def createNote(self, title: Optional[str] = None, text: Optional[str] = None) -> Note:
+        note = Note(self, self._new_id(), title or '', text or '')
+        self._notes[note.id] = note
+        return note
+
+    def get(self, note_id: str) -> Optional[Note]:
+        return self._notes.get(note_id)
+
+    def all(self) -> List[Note]:
+        return list(self._notes.values())
+
+    def find(self, query=None, func=None, labels=None, colors=None,
+             pinned=None, archived=None, trashed=False) -> List[Note]:
+        """Filter notes the way gkeepapi.Keep.find does.
+
+        query is a substring or compiled regex matched against title and
+        text; labels holds Label objects or ids.
+        """
+        label_ids = None
+        if labels is not None:
+            label_ids = {l.id if isinstance(l, Label) else l for l in labels}
+        results = []
+        for note in self._notes.values():
+            if note.deleted:
+                continue
+            if query is not None:
+                if isinstance(query, re.Pattern):
+                    if not (query.search(note.title) or query.search(note.text)):
+                        continue
+                elif query not in note.title and query not in note.text:
+                    continue
+            if func is not None and not func(note):
+                continue
+            if label_ids is not None and not any(l.id in label_ids for l in note.labels.all()):
+                continue
+            if colors is not None and note.color not in colors:
+                continue
+            if pinned is not None and note.pinned != pinned:
+                continue
+            if archived is not None and note.archived != archived:
+                continue
+            if trashed is not None and note.trashed != trashed:
+                continue
+            results.append(note)
+        return results
+
+    # Labels
+
+    def findLabel(self, query, create: bool = False) -> Optional[Label]:
+        name = query.lower() if isinstance(query, str) else None
+        for label in self._labels.values():
+            if name is not None and label.name.lower() == name:
+                return label
+            if isinstance(query, re.Pattern) and query.search(label.name):
+                return label
+        if create and isinstance(query, str):
+            return self.createLabel(query)
+        return None
+
+    def createLabel(self, name: str) -> Label:
+        if self.findLabel(name):
+            raise LabelException('Label exists')
+        label = Label(f"tag.{self._next_id:012x}", name, self._tick())
+        self._next_id += 1
+        self._labels[label.id] = label
+        return label
+
+    def getLabel(self, label_id: str) -> Optional[Label]:
+        return self._labels.get(label_id)
+
+    def labels(self) -> List[Label]:
+        return list(self._labels.values())
+
+    # State
+
+    def dump(self, path=None) -> Dict[str, Any]:
+        """Serialize everything; also written as JSON if a path is given."""
+        state = {
+            'keep_version': 'fake-1',
+            'next_id': self._next_id,
+            'clock': self._clock,
+            'labels': [{'id': l.id, 'name': l.name} for l in self._labels.values()],
+            'nodes': [{
+                'id': n.id,
+                'title': n.title,
+                'text': n.text,
+                'pinned': n.pinned,
+                'archived': n.archived,
+                'trashed': n.trashed,
+                'color': n.color.name if n.color else ColorValue.White.name,
+                'labels': [l.id for l in n.labels.all()],
+                'created': n.timestamps.created.isoformat(),
+                'updated': n.timestamps.updated.isoformat(),
+            } for n in self._notes.values() if not n.deleted],
+        }
+        if path is not None:
+            Path(path).write_text(json.dumps(state), encoding='utf-8')
+        return state
+
+    def restore(self, state):
+        """Load a dump() result, or the JSON file it was written to."""
+        if not isinstance(state, dict):
+            state = json.loads(Path(state).read_text(encoding='utf-8'))
+        self._next_id = state.get('next_id', 1)
+        self._clock = state.get('clock', 0)
+        self._labels = {}
+        for entry in state.get('labels', []):
+            self._labels[entry['id']] = Label(entry['id'], entry['name'], EPOCH)
+        self._notes = {}
+        for entry in state.get('nodes', []):
+            note = Note.__new__(Note)
+            note._keep = self
+            note.id = entry['id']
+            note.timestamps = Timestamps(datetime.fromisoformat(entry['created']))
+            note.timestamps.edited = note.timestamps.updated = datetime.fromisoformat(entry['updated'])
+            note.labels = NoteLabels(note)
+            note.labels._labels = {i: self._labels[i] for i in entry['labels'] if i in self._labels}
+            note._title = entry['title']
+            note._text = entry['text']
+            note._pinned = entry['pinned']
+            note._archived = entry['archived']
+            note._trashed = entry['trashed']
+            note._color = ColorValue[entry['color']]
+            note.deleted = False
+            note.dirty = False
+            self._notes[note.id] = note
+
+
+def exchange_token(email, app_password, android_id):
+    """gpsoauth.exchange_token stand-in: any password works."""
+    return {'Token': 'fake-master-token'}
+
+
+def perform_master_login(email, master_token, android_id):
+    """gpsoauth.perform_master_login stand-in."""
+    return {'Auth': f'fake-auth={android_id}'}
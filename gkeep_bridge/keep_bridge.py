@@ -8,20 +8,99 @@ This module provided a bridge between Notepad++ and Google Keep using gkeepapi.
 Authentication is now broken due to Google's deprecation of third-party access.
 """
 
+import argparse
 import sys
 import os
+import tempfile
+import time
 import json
 import base64
+import zlib
+import heapq
+from datetime import datetime
 from pathlib import Path
 from typing import Dict, List, Optional, Any
 
-try:
-    import gkeepapi
-    from gkeepapi.exception import LoginException
-    from gpsoauth import perform_master_login, exchange_token
-except ImportError:
-    print(json.dumps({"error": "gkeepapi and gpsoauth required. Run: pip install gkeepapi gpsoauth"}), file=sys.stderr)
-    sys.exit(1)
+# Wire protocol version, announced in the ready frame; PythonBridge's
+# kProtocolVersion must match. 2: commands carry "request_id" and
+# "deadline" (Unix time in ms), and every reply frame starts with the
+# request_id it answers.
+PROTOCOL_VERSION = 2
+
+# Keep client and login functions, bound by _use_backend() before the
+# bridge starts: gkeepapi/gpsoauth, or the in-memory fake_keep module
+Keep = None
+ColorValue = None
+LoginException = Exception
+perform_master_login = None
+exchange_token = None
+
+
+# Unix time the command being run must be done by; every request to Keep
+# made for it reads what is left through request_timeout()
+_request_deadline: Optional[float] = None
+
+
+def request_timeout() -> Optional[float]:
+    """Seconds a request to Keep started now may wait, or None for no limit."""
+    if _request_deadline is None:
+        return None
+    return max(_request_deadline - time.time(), 0.001)
+
+
+def _bound_requests(requests_module):
+    """Give requests made without a timeout of their own request_timeout().
+    
+    gkeepapi and gpsoauth call requests with timeout=None, which overrides
+    socket.setdefaulttimeout, so the bound goes where requests hands each
+    call to urllib3: HTTPAdapter.send, which gpsoauth's adapter subclasses.
+    The timeout bounds each connect and each read, so a request can run a
+    little past the deadline but never hangs on a stalled connection.
+    """
+    adapter = requests_module.adapters.HTTPAdapter
+    send = adapter.send
+
+    def send_within_deadline(self, request, *args, **kwargs):
+        if not args and kwargs.get('timeout') is None:
+            kwargs['timeout'] = request_timeout()
+        return send(self, request, *args, **kwargs)
+
+    adapter.send = send_within_deadline
+
+
+def _use_backend(name: str, options: argparse.Namespace):
+    """Bind the module-level Keep client and login functions for --backend."""
+    global Keep, ColorValue, LoginException, perform_master_login, exchange_token
+    if name == 'fake':
+        import fake_keep
+        ColorValue = fake_keep.ColorValue
+        LoginException = fake_keep.LoginException
+        perform_master_login = fake_keep.perform_master_login
+        exchange_token = fake_keep.exchange_token
+        Keep = lambda: fake_keep.FakeKeep(latency_ms=options.fake_latency_ms,
+                                          jitter_ms=options.fake_jitter_ms,
+                                          fail_rate=options.fake_fail_rate,
+                                          seed=options.fake_seed,
+                                          request_timeout=request_timeout)
+        return
+    try:
+        import gkeepapi
+        import gkeepapi.exception
+        import gpsoauth
+        import requests.adapters
+    except ImportError:
+        print(json.dumps({"error": "gkeepapi and gpsoauth required. Run: pip install gkeepapi gpsoauth"}), file=sys.stderr)
+        sys.exit(1)
+    _bound_requests(requests)
+    ColorValue = gkeepapi.node.ColorValue
+    LoginException = gkeepapi.exception.LoginException
+    perform_master_login = gpsoauth.perform_master_login
+    exchange_token = gpsoauth.exchange_token
+    Keep = gkeepapi.Keep
+
+
+class DeadlineExceeded(Exception):
+    """The plugin's deadline for the current command has passed."""
 
 
 class KeepBridge:
@@ -30,14 +109,41 @@ class KeepBridge:
     # Default Android ID for Google Keep
     ANDROID_ID = "ae7d752d1764a7b6"
     
-    def __init__(self):
-        self.keep = gkeepapi.Keep()
-        self.config_dir = self._get_config_dir()
+    # The state dump grows with the account, so writes save it at most this
+    # often (and once more when stdin closes) instead of after every command.
+    # A lost dump only costs a full sync on the next start.
+    STATE_SAVE_INTERVAL = 5.0
+    
+    # Notes per frame of a streamed list when the caller gives no page_size
+    LIST_PAGE_SIZE = 500
+    
+    def __init__(self, keep=None, config_dir: Optional[Path] = None):
+        self.keep = keep if keep is not None else Keep()
+        self.config_dir = config_dir if config_dir is not None else self._get_config_dir()
         self.auth_file = self.config_dir / "auth.json"
         self.state_file = self.config_dir / "state.bin"
         self.email: Optional[str] = None
         self.master_token: Optional[str] = None
         self.device_id: Optional[str] = None
+        self._state_loaded = False
+        self._state_dirty = False
+        self._state_saved_at = float('-inf')
+        # Note ids reported by changes_since, to detect notes that vanish
+        self._seen_ids: Optional[set] = None
+        # Labels by lower-cased name (findLabel ignores case), built on first
+        # use instead of findLabel's scan over every label per lookup. A
+        # sync may rename or remove labels, so after one each hit is checked
+        # against Keep before use; a miss rebuilds the index.
+        self._labels: Optional[Dict[str, Any]] = None
+        self._labels_checked = False
+        # Signed in during this process; status pings are answered from it
+        self._authenticated = False
+        # Fault injection (fake backend): exit without replying to every
+        # crash_every-th command
+        self.crash_every = 0
+        # Unix time the current command must be done by; past it the
+        # plugin has stopped waiting and will drop the reply
+        self._deadline: Optional[float] = None
         
     def _get_config_dir(self) -> Path:
         """Get configuration directory for storing auth data."""
@@ -78,22 +184,92 @@ class KeepBridge:
         except Exception:
             return False
     
-    def _save_state(self) -> bool:
+    def _save_state(self, force: bool = False) -> bool:
+        self._state_dirty = True
+        if not force and time.monotonic() - self._state_saved_at < self.STATE_SAVE_INTERVAL:
+            return True
         try:
             self.keep.dump(self.state_file)
+            self._state_dirty = False
+            self._state_saved_at = time.monotonic()
             return True
         except Exception:
             return False
     
     def _load_state(self) -> bool:
+        # This process is the only writer, so the in-memory state stays
+        # current after the first restore
+        if self._state_loaded:
+            return True
         try:
             if self.state_file.exists():
                 self.keep.restore(self.state_file)
+                self._labels = None
+                self._state_loaded = True
                 return True
             return False
         except Exception:
             return False
     
+    def _check_deadline(self):
+        """Give up on the current command once its deadline has passed.
+        
+        Only called where stopping leaves nothing half done: before a
+        command starts, between frames, before a batch writes anything.
+        """
+        if self._deadline is not None and time.time() >= self._deadline:
+            raise DeadlineExceeded("Deadline exceeded")
+    
+    def _sync(self):
+        try:
+            self.keep.sync()
+        finally:
+            self._labels_checked = False
+    
+    def _authenticate(self, email: str, master_token: str, device_id: str):
+        self._authenticated = False
+        try:
+            self.keep.authenticate(email, master_token, device_id=device_id)
+            self._authenticated = True
+        finally:
+            self._labels = None
+    
+    def _label(self, name: str):
+        """The label called name (any case), created if it does not exist."""
+        key = name.lower()
+        label = self._labels.get(key) if self._labels is not None else None
+        if label is not None and not self._labels_checked:
+            if self.keep.getLabel(label.id) is not label or label.name.lower() != key:
+                label = None
+        if label is None:
+            self._labels = {l.name.lower(): l for l in self.keep.labels()}
+            self._labels_checked = True
+            label = self._labels.get(key)
+            if label is None:
+                label = self.keep.createLabel(name)
+                self._labels[key] = label
+        return label
+    
+    @staticmethod
+    def _label_names(note) -> List[str]:
+        return [label.name for label in note.labels.all()]
+    
+    @staticmethod
+    def _note_to_dict(note, text_limit: Optional[int] = None,
+                      label_names: Optional[List[str]] = None) -> Dict[str, Any]:
+        text = note.text or ""
+        return {
+            "id": note.id,
+            "title": note.title or "Untitled",
+            "text": text[:text_limit] if text_limit else text,
+            "pinned": note.pinned,
+            "archived": note.archived,
+            "color": note.color.name if note.color else "UNKNOWN",
+            "labels": label_names if label_names is not None else KeepBridge._label_names(note),
+            "timestamp": str(note.timestamps.created) if note.timestamps else "",
+            "edited": str(note.timestamps.edited) if note.timestamps else ""
+        }
+    
     def handle_login(self, params: Dict[str, Any]) -> Dict[str, Any]:
         email = params.get('email')
         app_password = params.get('app_password')
@@ -112,8 +288,8 @@ class KeepBridge:
                 # Check if we have a cached token we can try
                 if self._load_auth() and self.master_token:
                     print("Trying cached master token...", file=sys.stderr)
-                    self.keep.authenticate(email, self.master_token, self.device_id)
-                    self._save_state()
+                    self._authenticate(email, self.master_token, self.device_id)
+                    self._save_state(force=True)
                     return {"success": True, "message": "Login successful (cached token)", "email": email}
                 return {"success": False, "error": f"Failed to get master token: {master_response.get('Error', 'Unknown error')}"}
             
@@ -132,11 +308,11 @@ class KeepBridge:
                 self.device_id = android_id
             
             # Step 3: Authenticate with gkeepapi
-            self.keep.authenticate(email, self.master_token, self.device_id)
+            self._authenticate(email, self.master_token, self.device_id)
             
             # Save auth for future use
             self._save_auth()
-            self._save_state()
+            self._save_state(force=True)
             
             return {"success": True, "message": "Login successful", "email": email}
         except LoginException as e:
@@ -144,8 +320,21 @@ class KeepBridge:
         except Exception as e:
             return {"success": False, "error": f"Unexpected error: {str(e)}"}
     
+    def handle_ping(self, params: Dict[str, Any]) -> Dict[str, Any]:
+        """Answer a health check without touching the network or the disk."""
+        return {"success": True, "authenticated": self._authenticated}
+    
     def handle_status(self, params: Dict[str, Any]) -> Dict[str, Any]:
-        """Check if authenticated and get status."""
+        """Check if authenticated and get status, signing in from a cached token."""
+        if self._authenticated:
+            return {
+                "success": True,
+                "authenticated": True,
+                "email": self.email,
+                "has_cached_token": True,
+                "message": "Authenticated"
+            }
+        
         # Try to load cached auth
         has_auth = self._load_auth()
         
@@ -153,8 +342,9 @@ class KeepBridge:
             try:
                 # Try to use cached token
                 if self.email:
-                    self.keep.authenticate(self.email, self.master_token, self.device_id)
+                    self._authenticate(self.email, self.master_token, self.device_id)
                 return {
+                    "success": True,
                     "authenticated": True,
                     "email": self.email,
                     "has_cached_token": True,
@@ -164,6 +354,7 @@ class KeepBridge:
                 pass
         
         return {
+            "success": True,
             "authenticated": False,
             "email": self.email,
             "has_cached_token": has_auth,
@@ -175,55 +366,182 @@ class KeepBridge:
             return {"success": False, "error": "Not authenticated. Login first."}
         try:
             self._load_state()
-            self.keep.sync()
+            self._sync()
             self._save_state()
             return {"success": True, "message": "Sync completed"}
         except Exception:
             # Try re-authenticating on sync failure
             try:
-                self.keep.authenticate(self.email, self.master_token, self.device_id)
-                self.keep.sync()
+                self._check_deadline()
+                self._authenticate(self.email, self.master_token, self.device_id)
+                self._sync()
                 self._save_state()
                 return {"success": True, "message": "Sync completed after re-auth"}
             except Exception as e2:
                 return {"success": False, "error": f"Sync failed: {str(e2)}"}
     
-    def handle_list(self, params: Dict[str, Any]) -> Dict[str, Any]:
+    def handle_changes_since(self, params: Dict[str, Any]) -> Dict[str, Any]:
+        """Sync, then return only notes updated after the cursor.
+        
+        The cursor is "<timestamp>|<ids>": the newest 'updated' timestamp
+        the previous call returned and the notes it returned with exactly
+        that timestamp. Notes at that timestamp are sent again unless
+        listed, so one saved in the same instant but seen only now is not
+        lost. An empty cursor returns every note and sets "full". So does
+        the first call of a process: notes hard-deleted in Keep are found
+        by comparing with the ids the previous call saw, which a restarted
+        bridge no longer has.
+        """
+        if not self._load_auth():
+            return {"success": False, "error": "Not authenticated. Login first."}
+        cursor = params.get('cursor', '')
+        stamp, _, ids = cursor.partition('|')
+        seen_at_since = set(filter(None, ids.split(',')))
+        try:
+            since = datetime.fromisoformat(stamp) if stamp else None
+        except ValueError:
+            since = None
+        if self._seen_ids is None:
+            since = None
+            seen_at_since = set()
+        try:
+            self._load_state()
+            self._sync()
+            changed = []
+            removed = []
+            newest = since
+            newest_ids = set(seen_at_since)
+            present = set()
+            for note in self.keep.all():
+                present.add(note.id)
+                updated = note.timestamps.updated if note.timestamps else None
+                if since is not None and updated is not None and (
+                        updated < since or (updated == since and note.id in seen_at_since)):
+                    continue
+                if note.trashed or note.deleted:
+                    removed.append(note.id)
+                else:
+                    changed.append(self._note_to_dict(note))
+                if updated is not None:
+                    if newest is None or updated > newest:
+                        newest = updated
+                        newest_ids = {note.id}
+                    elif updated == newest:
+                        newest_ids.add(note.id)
+            if since is not None:
+                removed.extend(self._seen_ids - present)
+            self._seen_ids = present
+            if changed or removed:
+                self._save_state()
+            return {
+                "success": True,
+                "full": since is None,
+                "cursor": (newest.isoformat() + '|' + ','.join(sorted(newest_ids))
+                           if newest is not None else cursor),
+                "changed": changed,
+                "removed": removed
+            }
+        except Exception as e:
+            return {"success": False, "error": f"Changes failed: {str(e)}"}
+    
+    def _matching_notes(self, params: Dict[str, Any]):
+        """(note, label names) for the notes passing the list filters."""
+        all_notes = params.get('all', False)
+        query = params.get('query', '')
+        wanted_labels = set(params.get('labels', []))
+        notes = self.keep.find(query=query) if query else self.keep.all()
+        for note in notes:
+            if note.archived and not all_notes:
+                continue
+            # Label names are read once per note, for the filter and the reply
+            label_names = self._label_names(note)
+            if wanted_labels and wanted_labels.isdisjoint(label_names):
+                continue
+            yield note, label_names
+    
+    def handle_list(self, params: Dict[str, Any]):
+        """List notes, in one reply or paged.
+        
+        With page_size, notes come in id order starting after the opaque
+        cursor, page_size per reply; "cursor" in a reply continues after it
+        and "more" says whether anything is left. With "stream": true every
+        page is sent at once as its own line (a frame) in answer to the one
+        command, the last with "more": false. limit caps the notes returned
+        either way (0 = no cap).
+        """
         if not self._load_auth():
             return {"success": False, "error": "Not authenticated. Login first."}
+        page_size = params.get('page_size')
+        if page_size is not None or params.get('stream'):
+            page_size = max(int(page_size or self.LIST_PAGE_SIZE), 1)
+            if params.get('stream'):
+                return self._stream_list(params, page_size)
+            return self._list_page(params, page_size)
         try:
             self._load_state()
-            all_notes = params.get('all', False)
             limit = params.get('limit', 100)
-            query = params.get('query', '')
-            labels = params.get('labels', [])
+            # The C++ note mirror pulls untruncated text with limit 0 (no limit)
+            full_text = params.get('full_text', False)
             notes_list = []
-            notes = self.keep.find(query=query) if query else self.keep.all()
-            count = 0
-            for note in notes:
-                if count >= limit:
+            for note, label_names in self._matching_notes(params):
+                if limit and len(notes_list) >= limit:
                     break
-                if note.archived and not all_notes:
-                    continue
-                if labels:
-                    note_labels = [l.name for l in note.labels.all()]
-                    if not any(l in note_labels for l in labels):
-                        continue
-                notes_list.append({
-                    "id": note.id,
-                    "title": note.title or "Untitled",
-                    "text": note.text[:500] if note.text else "",
-                    "pinned": note.pinned,
-                    "archived": note.archived,
-                    "color": note.color.name if note.color else "UNKNOWN",
-                    "labels": [l.name for l in note.labels.all()],
-                    "timestamp": str(note.timestamps.created) if note.timestamps else ""
-                })
-                count += 1
+                notes_list.append(self._note_to_dict(note, None if full_text else 500, label_names))
             return {"success": True, "count": len(notes_list), "notes": notes_list}
         except Exception as e:
             return {"success": False, "error": f"List failed: {str(e)}"}
     
+    def _list_page(self, params: Dict[str, Any], page_size: int) -> Dict[str, Any]:
+        try:
+            self._load_state()
+            after = params.get('cursor', '')
+            limit = params.get('limit', 0)
+            if limit:
+                page_size = min(page_size, limit)
+            text_limit = None if params.get('full_text', False) else 500
+            # One past the page tells whether there is more
+            page = heapq.nsmallest(page_size + 1,
+                                   ((note.id, note, names) for note, names in self._matching_notes(params)
+                                    if note.id > after),
+                                   key=lambda entry: entry[0])
+            more = len(page) > page_size
+            notes_list = [self._note_to_dict(note, text_limit, names) for _, note, names in page[:page_size]]
+            # Paging keys go first; the C++ reader finds keys by first match
+            return {
+                "success": True,
+                "more": more,
+                "cursor": notes_list[-1]["id"] if notes_list else after,
+                "count": len(notes_list),
+                "notes": notes_list
+            }
+        except Exception as e:
+            return {"success": False, "error": f"List failed: {str(e)}"}
+    
+    def _stream_list(self, params: Dict[str, Any], page_size: int):
+        try:
+            self._load_state()
+            after = params.get('cursor', '')
+            limit = params.get('limit', 0)
+            text_limit = None if params.get('full_text', False) else 500
+            matching = sorted(((note.id, note, names) for note, names in self._matching_notes(params)
+                               if note.id > after),
+                              key=lambda entry: entry[0])
+            if limit:
+                matching = matching[:limit]
+            # Notes become dicts one page at a time, as each frame is written
+            for start in range(0, max(len(matching), 1), page_size):
+                page = matching[start:start + page_size]
+                notes_list = [self._note_to_dict(note, text_limit, names) for _, note, names in page]
+                yield {
+                    "success": True,
+                    "more": start + page_size < len(matching),
+                    "cursor": notes_list[-1]["id"] if notes_list else after,
+                    "count": len(notes_list),
+                    "notes": notes_list
+                }
+        except Exception as e:
+            yield {"success": False, "error": f"List failed: {str(e)}", "more": False}
+    
     def handle_get(self, params: Dict[str, Any]) -> Dict[str, Any]:
         if not self._load_auth():
             return {"success": False, "error": "Not authenticated. Login first."}
@@ -244,7 +562,7 @@ class KeepBridge:
                     "pinned": note.pinned,
                     "archived": note.archived,
                     "color": note.color.name if note.color else "UNKNOWN",
-                    "labels": [l.name for l in note.labels.all()],
+                    "labels": self._label_names(note),
                     "timestamps": {
                         "created": str(note.timestamps.created) if note.timestamps else "",
                         "edited": str(note.timestamps.edited) if note.timestamps else "",
@@ -274,7 +592,7 @@ class KeepBridge:
             else:
                 note.archived = True
                 message = "Note archived"
-            self.keep.sync()
+            self._sync()
             self._save_state()
             return {"success": True, "message": message, "id": note_id}
         except Exception as e:
@@ -302,19 +620,16 @@ class KeepBridge:
             # Map color string to gkeepapi color
             if color != 'DEFAULT':
                 try:
-                    color_enum = getattr(gkeepapi.node.ColorValue, color.upper())
+                    color_enum = getattr(ColorValue, color.upper())
                     note.color = color_enum
                 except AttributeError:
                     pass
             
             # Add labels if any
             for label_name in labels:
-                label = self.keep.findLabel(label_name)
-                if not label:
-                    label = self.keep.createLabel(label_name)
-                note.labels.add(label)
+                note.labels.add(self._label(label_name))
             
-            self.keep.sync()
+            self._sync()
             self._save_state()
             
             return {
@@ -368,7 +683,7 @@ class KeepBridge:
                     if color == 'DEFAULT':
                         note.color = None
                     else:
-                        color_enum = getattr(gkeepapi.node.ColorValue, color.upper())
+                        color_enum = getattr(ColorValue, color.upper())
                         note.color = color_enum
                 except AttributeError:
                     pass
@@ -377,12 +692,9 @@ class KeepBridge:
             if labels is not None:
                 note.labels.clear()
                 for label_name in labels:
-                    label = self.keep.findLabel(label_name)
-                    if not label:
-                        label = self.keep.createLabel(label_name)
-                    note.labels.add(label)
+                    note.labels.add(self._label(label_name))
             
-            self.keep.sync()
+            self._sync()
             self._save_state()
             
             return {
@@ -404,6 +716,120 @@ class KeepBridge:
         except Exception as e:
             return {"success": False, "error": f"Failed to update note: {str(e)}"}
     
+    def handle_patch_note(self, params: Dict[str, Any]) -> Dict[str, Any]:
+        """Apply a line patch to a note's text.
+        
+        ops is a list of [start_line, delete_count, insert_text] against the
+        text identified by base_crc (CRC-32 of its UTF-8 bytes) and
+        base_lines. Lines are split on '\n' and keep their terminator. A
+        note whose text no longer matches the base is left untouched and
+        "code": "base_mismatch" tells the caller to send the full text.
+        """
+        if not self._load_auth():
+            return {"success": False, "error": "Not authenticated. Login first."}
+        
+        note_id = params.get('id')
+        ops = params.get('ops', [])
+        title = params.get('title')
+        if not note_id:
+            return {"success": False, "error": "Note ID required"}
+        
+        try:
+            self._load_state()
+            note = self.keep.get(note_id)
+            if not note:
+                return {"success": False, "error": "Note not found"}
+            
+            text = note.text or ""
+            lines = text.split('\n')
+            if lines[-1] == '':
+                lines.pop()
+                lines = [line + '\n' for line in lines]
+            else:
+                lines = [line + '\n' for line in lines[:-1]] + [lines[-1]]
+            if (zlib.crc32(text.encode('utf-8')) != params.get('base_crc') or
+                    len(lines) != params.get('base_lines')):
+                return {"success": False, "error": "Base text mismatch", "code": "base_mismatch"}
+            
+            # Ops are ordered by start line; apply back to front so earlier
+            # indices stay valid
+            for start, count, insert in reversed(ops):
+                lines[start:start + count] = [insert] if insert else []
+            note.text = ''.join(lines)
+            if title is not None:
+                note.title = title
+            
+            self._sync()
+            self._save_state()
+            
+            # The caller already has the text; don't echo it back
+            return {
+                "success": True,
+                "message": "Note patched",
+                "note": {
+                    "id": note.id,
+                    "title": note.title,
+                    "pinned": note.pinned,
+                    "color": note.color.name if note.color else 'DEFAULT',
+                    "labels": [label.name for label in note.labels],
+                    "timestamps": {
+                        "created": str(note.timestamps.created),
+                        "edited": str(note.timestamps.edited)
+                    }
+                }
+            }
+        except Exception as e:
+            return {"success": False, "error": f"Failed to patch note: {str(e)}"}
+    
+    def handle_batch(self, params: Dict[str, Any]) -> Dict[str, Any]:
+        """Apply several note writes and push them in a single sync.
+        
+        ops is a list of {"op": "create"|"update"|"delete", "id", "title",
+        "text"}. gkeepapi sends every dirty note in one changes request, so
+        the writes reach Keep together rather than one round trip each.
+        results holds the note id of each op, in order.
+        """
+        if not self._load_auth():
+            return {"success": False, "error": "Not authenticated. Login first."}
+        
+        ops = params.get('ops', [])
+        
+        try:
+            self._load_state()
+            
+            # Resolve every target first so a bad id leaves nothing half-applied
+            for op in ops:
+                if op.get('op') in ('update', 'delete') and not self.keep.get(op.get('id')):
+                    return {"success": False, "error": f"Note not found: {op.get('id')}"}
+            # Notes created past this point would be pushed by a later sync
+            # even though the plugin saw the batch fail
+            self._check_deadline()
+            
+            results = []
+            for op in ops:
+                kind = op.get('op')
+                if kind == 'create':
+                    note = self.keep.createNote(op.get('title', ''), op.get('text', ''))
+                elif kind == 'update':
+                    note = self.keep.get(op.get('id'))
+                    if op.get('title') is not None:
+                        note.title = op['title']
+                    if op.get('text') is not None:
+                        note.text = op['text']
+                elif kind == 'delete':
+                    note = self.keep.get(op.get('id'))
+                    note.archived = True
+                else:
+                    return {"success": False, "error": f"Unknown batch op: {kind}"}
+                results.append({"id": note.id})
+            
+            self._sync()
+            self._save_state()
+            
+            return {"success": True, "count": len(results), "results": results}
+        except Exception as e:
+            return {"success": False, "error": f"Batch failed: {str(e)}"}
+    
     def handle_set_token(self, params: Dict[str, Any]) -> Dict[str, Any]:
         """Debug: Manually set master token. Use this if you obtained a token externally."""
         email = params.get('email')
@@ -419,28 +845,32 @@ class KeepBridge:
             self.device_id = device_id
             
             # Test the token
-            self.keep.authenticate(email, master_token, device_id)
+            self._authenticate(email, master_token, device_id)
             
             # Save
             self._save_auth()
-            self._save_state()
+            self._save_state(force=True)
             
             return {"success": True, "message": "Token saved and validated", "email": email}
         except Exception as e:
             return {"success": False, "error": f"Token validation failed: {str(e)}"}
     
-    def process_command(self, command: Dict[str, Any]) -> Dict[str, Any]:
+    def process_command(self, command: Dict[str, Any]):
         cmd = command.get('command')
         params = command.get('params', {})
         handlers = {
             'login': self.handle_login,
             'sync': self.handle_sync,
+            'changes_since': self.handle_changes_since,
             'list': self.handle_list,
             'get': self.handle_get,
             'delete': self.handle_delete,
             'create_note': self.handle_create_note,
             'update_note': self.handle_update_note,
+            'patch_note': self.handle_patch_note,
+            'batch': self.handle_batch,
             'status': self.handle_status,
+            'ping': self.handle_ping,
             'set_token': self.handle_set_token  # Debug: manually set master token
         }
         handler = handlers.get(cmd)
@@ -448,8 +878,51 @@ class KeepBridge:
             return handler(params)
         return {"success": False, "error": f"Unknown command: {cmd}"}
     
-    def run(self):
+    def _execute(self, command: Dict[str, Any]):
+        """Run a command within its deadline, yielding its reply frames."""
+        global _request_deadline
+        deadline = command.get('deadline')
+        self._deadline = deadline / 1000.0 if deadline else None
+        try:
+            # It waited in the pipe behind a slow command until too late
+            self._check_deadline()
+        except DeadlineExceeded as e:
+            yield {"success": False, "error": str(e)}
+            return
+        
+        # Requests to Keep made for this command time out with it
+        _request_deadline = self._deadline
+        try:
+            result = self.process_command(command)
+            if isinstance(result, dict):
+                yield result
+                return
+            # Streamed reply
+            for frame in result:
+                yield frame
+                if frame.get('more') and self._deadline is not None and time.time() >= self._deadline:
+                    result.close()
+                    yield {"success": False, "error": "Deadline exceeded", "more": False}
+                    return
+        finally:
+            _request_deadline = None
+            self._deadline = None
+    
+    @staticmethod
+    def _reply(request_id, frame: Dict[str, Any]):
+        # The id goes first: the C++ reader finds keys by first match, and
+        # note dicts have ids of their own
+        if request_id is not None:
+            frame = {"request_id": request_id, **frame}
+        print(json.dumps(frame), flush=True)
+    
+    def run(self, backend: str = 'google'):
+        # Imports are done and commands are read from here on; the plugin
+        # waits for this frame instead of guessing how long startup takes
+        print(json.dumps({"ready": True, "protocol": PROTOCOL_VERSION, "backend": backend}), flush=True)
+        commands = 0
         while True:
+            request_id = None
             try:
                 line = sys.stdin.readline()
                 if not line:
@@ -457,21 +930,66 @@ class KeepBridge:
                 line = line.strip()
                 if not line:
                     continue
+                commands += 1
+                if self.crash_every and commands % self.crash_every == 0:
+                    os._exit(3)
                 try:
                     command = json.loads(line)
-                    result = self.process_command(command)
-                    print(json.dumps(result), flush=True)
+                    if command.get('command') == 'exit':
+                        break
+                    request_id = command.get('request_id')
+                    # One line per frame of a streamed reply
+                    for frame in self._execute(command):
+                        self._reply(request_id, frame)
                 except json.JSONDecodeError as e:
-                    print(json.dumps({"success": False, "error": f"Invalid JSON: {str(e)}"}), flush=True)
+                    self._reply(None, {"success": False, "error": f"Invalid JSON: {str(e)}"})
             except KeyboardInterrupt:
                 break
             except Exception as e:
-                print(json.dumps({"success": False, "error": f"Internal error: {str(e)}"}), flush=True)
+                self._reply(request_id, {"success": False, "error": f"Internal error: {str(e)}"})
+        
+        if self._state_dirty:
+            self._save_state(force=True)
 
 
-def main():
-    bridge = KeepBridge()
-    bridge.run()
+def _parse_args(argv: Optional[List[str]] = None) -> argparse.Namespace:
+    parser = argparse.ArgumentParser(description="Google Keep bridge for the Notepad++ plugin")
+    parser.add_argument('--backend', choices=['google', 'fake'], default='google',
+                        help="google: gkeepapi (default); fake: in-memory notes for offline testing")
+    parser.add_argument('--config-dir', type=Path,
+                        help="Where auth and state are kept (fake default: a temporary directory)")
+    fake = parser.add_argument_group('fake backend')
+    fake.add_argument('--fake-latency-ms', type=float, default=0.0,
+                      help="Delay added to every simulated network call")
+    fake.add_argument('--fake-jitter-ms', type=float, default=0.0,
+                      help="Uniform +/- variation of that delay")
+    fake.add_argument('--fake-fail-rate', type=float, default=0.0,
+                      help="Probability (0-1) that a simulated network call fails")
+    fake.add_argument('--fake-seed', type=int, default=0,
+                      help="Seed for jitter and fault injection")
+    fake.add_argument('--fake-crash-every', type=int, default=0,
+                      help="Exit without replying to every Nth command, as if the process died")
+    return parser.parse_args(argv)
+
+
+def main(argv: Optional[List[str]] = None):
+    options = _parse_args(argv)
+    _use_backend(options.backend, options)
+    
+    if options.backend != 'fake':
+        KeepBridge(config_dir=options.config_dir).run(options.backend)
+        return
+    
+    # The fake starts signed in so every command works without a login,
+    # and by default never touches a real account's cached auth
+    with tempfile.TemporaryDirectory(prefix='keep_bridge_fake_') as temp_dir:
+        bridge = KeepBridge(config_dir=options.config_dir or Path(temp_dir))
+        bridge.crash_every = options.fake_crash_every
+        if not bridge._load_auth():
+            bridge.email = 'fake@example.com'
+            bridge.master_token = 'fake-master-token'
+            bridge._save_auth()
+        bridge.run(options.backend)
 
 
 if __name__ == '__main__':
@@ -0,0 +1,80 @@
+// BulkImport - sync a whole directory tree to Keep
+// ARM64 Windows Compatible
+//
+// Enumerate walks the tree and drops excluded files. Run reads and hashes
+// the files on a ThreadPool (sniffing each one's first bytes, so a binary
+// file costs one small read), skips the ones the caller reports unchanged,
+// and hands the rest to the caller in batches sized for one bridge batch
+// call each. Uploads stay on the calling thread (the bridge is one process
+// on one pipe); reading runs ahead of them, bounded so a large tree is
+// never held in memory at once.
+
+#pragma once
+
+#include "ContentSniff.h"
+#include "SyncRules.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace BulkImport {
+
+struct Options {
+    SyncRules rules;                                // Files to leave out
+    size_t threads = 0;                             // Readers; 0 = one per hardware thread
+    size_t batchFiles = 100;                        // Files per upload call
+    size_t batchBytes = 4 * 1024 * 1024;            // Text per upload call
+    size_t readAhead = 512;                         // Files read or reading, not yet uploaded
+    bool ordered = false;                           // Upload in list order, not as read
+    bool onlyText = false;                          // Skip files ContentSniff takes for binary
+};
+
+struct File {
+    std::wstring path;
+    uint64_t size = 0;
+};
+
+// A file on its way to Keep; upload sets ok
+struct Item {
+    std::wstring path;
+    std::string content;        // Raw file bytes
+    std::wstring hash;          // ContentHash::HashFile of the same bytes
+    ContentSniff::Format format;
+    bool ok = false;
+};
+
+// Shared with the UI thread while an import runs
+struct Progress {
+    std::atomic<uint64_t> total{0};        // Files found by Enumerate
+    std::atomic<uint64_t> read{0};         // Files read and hashed
+    std::atomic<uint64_t> uploaded{0};
+    std::atomic<uint64_t> skipped{0};      // Unchanged since the last sync, empty, or binary
+    std::atomic<uint64_t> failed{0};       // Unreadable or rejected by the upload
+    std::atomic<bool> cancel{false};       // Set to stop; files in flight finish first
+    std::atomic<bool> done{false};
+};
+
+struct Hooks {
+    // Called from reader threads; false skips the file as unchanged
+    std::function<bool(const std::wstring& path, const std::wstring& hash)> needsSync;
+    // Called on the Run thread, in batches; sets each item's ok. Returning
+    // false abandons the import (e.g. the bridge went away).
+    std::function<bool(std::vector<Item>& batch)> upload;
+};
+
+// Regular, non-empty, non-excluded files under root, skipping hidden
+// directories (".git", ".vs", ...) and directories the rules exclude by
+// name. Sets progress.total.
+std::vector<File> Enumerate(const std::wstring& root, const Options& options, Progress& progress);
+
+// Import files; returns false if cancelled or the upload gave up. Sets
+// progress.done on return either way.
+bool Run(const std::vector<File>& files, const Options& options, const Hooks& hooks, Progress& progress);
+
+// One-line summary, e.g. "1200 / 20000 read, 1100 uploaded, 80 skipped, 0 failed"
+std::string FormatProgress(const Progress& progress);
+
+} // namespace BulkImport
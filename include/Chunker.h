@@ -0,0 +1,34 @@
+// Chunker - content-defined chunking for files too large for one note
+// ARM64 Windows Compatible
+//
+// Boundaries come from a gear rolling hash over the content, so an edit
+// only moves the boundaries near it and the other chunks hash the same as
+// before. Cuts are nudged to the end of a line where possible and never
+// split a UTF-8 sequence.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Chunker {
+
+struct Chunk {
+    size_t offset;
+    size_t length;
+    uint64_t hash;      // FNV-1a of the chunk bytes
+};
+
+// Split data into chunks of at most maxChunkSize bytes (average about half
+// that). Empty input yields no chunks.
+std::vector<Chunk> Split(std::string_view data, size_t maxChunkSize);
+
+// 64-bit FNV-1a
+uint64_t Hash(std::string_view data);
+
+// Hash as 16 lowercase hex digits
+std::wstring HashToString(uint64_t hash);
+
+} // namespace Chunker
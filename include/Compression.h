@@ -0,0 +1,20 @@
+// Compression - small LZ77 block codec for locally stored text snapshots
+// ARM64 Windows Compatible
+//
+// Byte-oriented LZ4-style format with a 64 KB window. Favours speed over
+// ratio; note text typically shrinks to a third or less.
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace Compression {
+
+// Compress a block. The result carries its own header and uncompressed size.
+std::string Compress(std::string_view input);
+
+// Decompress a block produced by Compress. Returns false on corrupt input.
+bool Decompress(std::string_view input, std::string& output);
+
+} // namespace Compression
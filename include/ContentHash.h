@@ -0,0 +1,44 @@
+// ContentHash - file and payload hashes used by the sync core
+// ARM64 Windows Compatible
+//
+// MD5 identifies file contents in the mappings file (the same digest the
+// plugin used to get from CryptoAPI, so stored hashes stay valid). CRC-32
+// checks patch bases against the bridge, matching Python's zlib.crc32.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace ContentHash {
+
+// Incremental MD5
+class Md5 {
+public:
+    Md5();
+
+    void Update(const void* data, size_t size);
+    void Update(std::string_view data) { Update(data.data(), data.size()); }
+
+    // Finish and return the 16-byte digest; the object must not be reused
+    void Final(uint8_t digest[16]);
+
+private:
+    void Transform(const uint8_t block[64]);
+
+    uint32_t m_state[4];
+    uint64_t m_length;      // Bytes hashed so far
+    uint8_t m_buffer[64];
+};
+
+// MD5 of data as 32 lowercase hex digits
+std::wstring Md5Hex(std::string_view data);
+
+// MD5 of a file's bytes as 32 lowercase hex digits; empty if it cannot be read
+std::wstring HashFile(const std::wstring& filePath);
+
+// CRC-32 (IEEE)
+uint32_t Crc32(std::string_view data);
+
+} // namespace ContentHash
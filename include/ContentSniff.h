@@ -0,0 +1,57 @@
+// ContentSniff - tell text files from binary ones by their first bytes
+// ARM64 Windows Compatible
+//
+// Sniff looks at the start of a file only (kSniffBytes): a byte order
+// mark settles the encoding; otherwise NUL bytes mean UTF-16 (when they
+// all fall on one side of each code unit) or binary, as does a high
+// share of control characters. What remains is UTF-8 if it validates and
+// an 8-bit code page (taken as Windows-1252) if not. The NUL and control scan
+// runs 16 bytes at a time with SSE2 or NEON.
+//
+// With OnlyTextFiles set, a file that sniffs as binary costs one small
+// read instead of a full read, hash and upload.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace ContentSniff {
+
+// Bytes of a file Sniff needs to see
+constexpr size_t kSniffBytes = 8 * 1024;
+
+enum class Encoding {
+    Utf8,
+    Utf16Le,
+    Utf16Be,
+    Cp1252,     // Not UTF-8; some 8-bit code page
+    Binary,
+};
+
+struct Format {
+    Encoding encoding = Encoding::Utf8;
+    bool bom = false;       // Starts with a byte order mark
+};
+
+// Format of a file from its first bytes. complete means head is the whole
+// file; otherwise a UTF-8 sequence cut off at the end is not an error.
+// Only the first kSniffBytes of head are looked at.
+Format Sniff(std::string_view head, bool complete = true);
+
+// Sniff the first kSniffBytes of a file. False if it cannot be read.
+bool SniffFile(const std::wstring& path, Format& format);
+
+inline bool IsText(const Format& format) { return format.encoding != Encoding::Binary; }
+
+// Note text (UTF-8, no byte order mark) from a file's bytes. UTF-8 that
+// turns out to be invalid past the sniffed head is taken as Windows-1252, and
+// format is updated to match; binary content is passed through the same way.
+std::string ToUtf8(std::string bytes, Format& format);
+
+// File bytes in the given format for UTF-8 text, for writing a merged
+// note back. Characters Windows-1252 cannot hold become '?'.
+std::string FromUtf8(std::string_view text, const Format& format);
+
+} // namespace ContentSniff
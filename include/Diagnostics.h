@@ -0,0 +1,94 @@
+// Diagnostics - always-on sync and bridge counters
+// ARM64 Windows Compatible
+//
+// Plain relaxed atomics: an update is a single uncontended fetch_add, so
+// the counters stay enabled in release builds. Shown by the Diagnostics
+// menu command.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace Diagnostics {
+
+// Latency histogram with power-of-two microsecond buckets:
+// bucket 0 holds samples under 2 us, bucket i holds [2^i, 2^(i+1)) us
+class Histogram {
+public:
+    static const int kBuckets = 32;
+
+    void Record(uint64_t micros);
+
+    uint64_t Count() const { return m_count.load(std::memory_order_relaxed); }
+    uint64_t SumUs() const { return m_sum.load(std::memory_order_relaxed); }
+    uint64_t MaxUs() const { return m_max.load(std::memory_order_relaxed); }
+    uint64_t Bucket(int i) const { return m_buckets[i].load(std::memory_order_relaxed); }
+
+    // Upper bound of the bucket holding the p-th sample (0 < p <= 1)
+    uint64_t PercentileUs(double p) const;
+
+private:
+    std::atomic<uint64_t> m_buckets[kBuckets] = {};
+    std::atomic<uint64_t> m_count{0};
+    std::atomic<uint64_t> m_sum{0};
+    std::atomic<uint64_t> m_max{0};
+};
+
+// One histogram per bridge command. Slots are claimed on first use; names
+// must be string literals (compared by pointer first, then by content).
+class CommandLatencies {
+public:
+    static const int kMaxCommands = 32;
+
+    void Record(const char* command, uint64_t micros);
+
+    const char* Name(int slot) const { return m_names[slot].load(std::memory_order_acquire); }
+    const Histogram& At(int slot) const { return m_histograms[slot]; }
+
+private:
+    std::atomic<const char*> m_names[kMaxCommands] = {};
+    Histogram m_histograms[kMaxCommands];
+};
+
+// Maintained by FileSyncManager
+struct SyncCounters {
+    std::atomic<uint64_t> attempted{0};         // SyncFile calls
+    std::atomic<uint64_t> skippedUnchanged{0};  // File hash matched the last sync
+    std::atomic<uint64_t> skippedBinary{0};     // Sniffed as binary (OnlyTextFiles)
+    std::atomic<uint64_t> failed{0};
+    std::atomic<uint64_t> retried{0};           // Attempts on files whose last sync failed
+    std::atomic<int64_t> queueDepth{0};         // Syncs waiting or running
+    std::atomic<uint64_t> externalChanges{0};   // Mapped files changed outside the editor
+    std::atomic<int64_t> watchedDirectories{0}; // Directory watch handles open
+
+    // Time from queued to started, by SyncPriority class (Interactive,
+    // Save, Background); for Bulk, time spent yielding between batches
+    static const int kPriorityClasses = 4;
+    Histogram queueWait[kPriorityClasses];
+};
+
+// Maintained by PythonBridge
+struct BridgeCounters {
+    std::atomic<uint64_t> commands{0};
+    std::atomic<uint64_t> errors{0};            // Transport failures and success:false replies
+    std::atomic<uint64_t> bytesSent{0};
+    std::atomic<uint64_t> bytesReceived{0};
+    std::atomic<uint64_t> restarts{0};          // Bridge process starts after the first
+    std::atomic<uint64_t> replayed{0};          // Commands sent again after a restart
+    std::atomic<uint64_t> timeouts{0};          // Commands past their deadline
+    std::atomic<uint64_t> lateFrames{0};        // Replies that came after it, dropped
+    Histogram recovery;                         // Restart to signed in again, per recovery
+    CommandLatencies latency;
+};
+
+inline void Add(std::atomic<uint64_t>& counter, uint64_t n = 1) {
+    counter.fetch_add(n, std::memory_order_relaxed);
+}
+
+// Human-readable snapshot (lines end in "\r\n" for Win32 edit controls).
+// bridge may be null when the bridge never started.
+std::string FormatReport(const SyncCounters& sync, const BridgeCounters* bridge);
+
+} // namespace Diagnostics
@@ -0,0 +1,36 @@
+// Diagnostics Dialog Header
+// ARM64 Windows Compatible
+
+#pragma once
+
+#include <windows.h>
+#include <functional>
+#include <string>
+
+// Dialog resource IDs
+#define IDD_DIAGNOSTICS_DIALOG  120
+#define IDC_DIAG_TEXT           121
+#define IDC_BUTTON_DIAG_COPY    122
+
+// Shows a counters report, refreshed once a second while open
+class DiagnosticsDialog {
+public:
+    using ReportFn = std::function<std::string()>;
+    
+    DiagnosticsDialog(HINSTANCE hInstance, HWND hwndParent, ReportFn report);
+    
+    void Show();
+    
+private:
+    static INT_PTR CALLBACK DialogProc(HWND hwndDlg, UINT uMsg, WPARAM wParam, LPARAM lParam);
+    INT_PTR OnInitDialog(HWND hwndDlg);
+    void Refresh();
+    void CopyToClipboard();
+    
+    HINSTANCE m_hInstance;
+    HWND m_hwndParent;
+    HWND m_hwndDialog;
+    HFONT m_hFont;
+    ReportFn m_report;
+    std::wstring m_text;
+};
@@ -0,0 +1,116 @@
+// DirectoryWatcher - notice mapped files changed outside the editor
+// ARM64 Windows Compatible
+//
+// Git checkouts, build tools and other editors write files without
+// Notepad++ seeing a save. The watcher listens on the directories holding
+// mapped files (ReadDirectoryChangesW on one completion port on Windows,
+// one inotify descriptor on Linux) and reports each changed file once it
+// has been quiet for a short delay, so a burst of writes to one file (an
+// editor's save-to-temp-and-rename, a tool rewriting it in pieces) becomes
+// one report.
+//
+// Watches are planned per directory, not per file: thousands of mapped
+// files in a few folders need a few handles. Where watches can cover a
+// subtree (Windows), a directory below another watched directory shares
+// its ancestor's handle, as long as that subtree is small. A drive root
+// or the user's profile is never watched recursively: every write on the
+// volume or in AppData would wake the watcher.
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct WatchRoot {
+    std::wstring directory;
+    bool recursive = false;     // Also covers every directory below
+
+    bool operator==(const WatchRoot& other) const {
+        return directory == other.directory && recursive == other.recursive;
+    }
+};
+
+// Groups change events per file and releases a file once no event has
+// arrived for `delay`, or `maxDelay` after its first event if it never
+// goes quiet (a log being appended to).
+class ChangeCoalescer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit ChangeCoalescer(std::chrono::milliseconds delay,
+                             std::chrono::milliseconds maxDelay = std::chrono::seconds(10));
+
+    void Add(const std::wstring& path, Clock::time_point now);
+
+    // Files due at `now`, removed from the pending set
+    std::vector<std::wstring> TakeDue(Clock::time_point now);
+
+    // When the next file falls due, if any are pending
+    std::optional<Clock::time_point> NextDue() const;
+
+    size_t Pending() const { return m_pending.size(); }
+
+private:
+    struct Entry {
+        Clock::time_point first;
+        Clock::time_point last;
+    };
+
+    Clock::time_point DueAt(const Entry& entry) const;
+
+    std::chrono::milliseconds m_delay;
+    std::chrono::milliseconds m_maxDelay;
+    std::unordered_map<std::wstring, Entry> m_pending;
+};
+
+class DirectoryWatcher {
+public:
+    // Called on the watcher thread with a changed file. A path ending in a
+    // separator is a watched directory whose events were lost (the OS
+    // queue overflowed); everything under it should be rechecked.
+    using Callback = std::function<void(const std::wstring& path)>;
+
+    DirectoryWatcher(Callback onChange, std::chrono::milliseconds delay);
+
+    // Stops the thread and closes every handle
+    ~DirectoryWatcher();
+
+    DirectoryWatcher(const DirectoryWatcher&) = delete;
+    DirectoryWatcher& operator=(const DirectoryWatcher&) = delete;
+
+    // Start the watcher thread; false where the platform has no watcher
+    bool Start();
+    void Stop();
+
+    // Watch exactly these directories from now on. Handles for directories
+    // already watched are kept; missing directories are skipped.
+    void SetRoots(const std::vector<WatchRoot>& roots);
+
+    // Directories currently holding an OS watch handle
+    size_t HandleCount() const;
+
+    // True where one watch covers a whole subtree
+    static bool SupportsRecursive();
+
+    // Subtrees with more entries than this are watched one directory at
+    // a time
+    static constexpr size_t kMaxRecursiveEntries = 2000;
+
+    // The directories to watch for every file's parent directory: distinct
+    // parents, and with recursive watches a parent below another one is
+    // left to its ancestor's watch. Only parents holding no more than
+    // maxRecursiveEntries entries below them (missing ones hold none), and
+    // that are neither a volume root nor the profile, are watched
+    // recursively.
+    static std::vector<WatchRoot> Plan(const std::vector<std::wstring>& files, bool recursive,
+                                       size_t maxRecursiveEntries = kMaxRecursiveEntries);
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+};
@@ -0,0 +1,54 @@
+// MappingStore - file-to-note mappings and their on-disk format
+// ARM64 Windows Compatible
+//
+// One mapping per line:
+//   filePath,keepNoteId,lastSyncHash,status,timestamp,baseSnapshot,chunks
+// where chunks is a ';'-separated list of noteId:hash pairs. Older files
+// with only the first five or six fields still load.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Note sync status
+enum class SyncStatus {
+    PENDING,
+    SYNCED,
+    FAILED,
+    DISABLED
+};
+
+struct NoteMapping {
+    std::wstring filePath;
+    std::wstring keepNoteId;
+    std::wstring lastSyncHash;
+    SyncStatus status = SyncStatus::PENDING;
+    uint64_t lastSyncTime = 0;  // FILETIME ticks: 100 ns units since 1601-01-01 UTC
+    std::wstring baseSnapshot;  // Snapshot file of the last synced text
+    std::vector<std::wstring> chunkNoteIds;  // Notes holding a large file, in order
+    std::vector<std::wstring> chunkHashes;   // Content hash of each chunk note
+};
+
+namespace MappingStore {
+
+using MappingTable = std::unordered_map<std::wstring, NoteMapping>;
+
+// One line of the mappings file, without the trailing newline
+std::string FormatLine(const NoteMapping& mapping);
+
+// Parse a line written by FormatLine. Returns false for malformed lines.
+bool ParseLine(const std::string& line, NoteMapping& mapping);
+
+// Add every mapping in the file to table. Returns false if it cannot be read.
+bool Load(const std::wstring& path, MappingTable& table);
+
+// Replace the file with the mappings in table
+bool Save(const std::wstring& path, const MappingTable& table);
+
+// Current time in FILETIME ticks
+uint64_t Now();
+
+} // namespace MappingStore
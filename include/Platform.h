@@ -0,0 +1,28 @@
+// Platform - the few OS services the sync core needs
+// ARM64 Windows Compatible
+//
+// Everything else in keepsync_core is plain C++17; Win32 and POSIX
+// specifics live behind these functions and BridgeTransport.
+
+#pragma once
+
+#include <string>
+
+namespace Platform {
+
+// Directory holding the plugin's state (mappings, mirror, snapshots, ini):
+// %APPDATA%\Notepad++ on Windows, $XDG_CONFIG_HOME/notepad++ (default
+// ~/.config/notepad++) elsewhere. Empty if it cannot be determined.
+std::wstring DataDirectory();
+
+// The user's profile directory (%USERPROFILE%, $HOME). Empty if unknown.
+std::wstring HomeDirectory();
+
+// dir and name joined with the native separator
+std::wstring JoinPath(const std::wstring& dir, const std::wstring& name);
+
+// Replace %NAME% references with environment variables; unknown names are
+// left as written
+std::wstring ExpandEnvironment(const std::wstring& text);
+
+} // namespace Platform
@@ -5,9 +5,15 @@
 
 #include "PluginInterface.h"
 #include "PythonBridge.h"
+#include "BridgeWatchdog.h"
+#include "Diagnostics.h"
+#include "BulkImport.h"
+#include "SyncRules.h"
+#include "SyncScheduler.h"
+#include "DirectoryWatcher.h"
+#include <chrono>
 #include <thread>
 #include <mutex>
-#include <queue>
 
 // Global instance handle (declared in DllMain.cpp)
 extern HINSTANCE g_hInstance;
@@ -24,13 +30,42 @@ public:
     FileSyncManager();
     ~FileSyncManager();
     
+    // Only takes the config: the bridge, mappings and watchers come up on
+    // the queue thread, so Notepad++ is not held up starting Python
     BOOL Initialize(const PluginConfig& config);
     void Shutdown();
     
+    // Start the bridge now if the queue thread has not yet, or wait for it
+    // to finish; FALSE if it failed to start. Called before first use.
+    BOOL EnsureStarted();
+    
+    // Sign in with new credentials, waiting for startup and for whatever
+    // else is talking to Keep
+    NppGoogleKeepSync::BridgeResult Login(const std::string& email, const std::string& appPassword);
+    
     BOOL RegisterFile(const std::wstring& filePath);
     BOOL UnregisterFile(const std::wstring& filePath);
     BOOL SyncFile(const std::wstring& filePath, BOOL force = FALSE);
     
+    // Sync every eligible file under root, reading and hashing in parallel
+    // and creating new notes in batches. Blocks until done or cancelled;
+    // meant for a worker thread.
+    BOOL SyncFolder(const std::wstring& root, BulkImport::Progress& progress);
+    
+    // Sync the given files (Notepad++'s open buffers) in one batch exchange,
+    // most recently modified first. Unchanged files are skipped.
+    BOOL SyncOpenFiles(const std::vector<std::wstring>& paths, BulkImport::Progress& progress);
+    
+    // Sync a file on the queue thread, higher priorities first. A file
+    // already waiting is not queued twice; it moves up if this priority is
+    // higher.
+    void QueueSync(const std::wstring& filePath, SyncPriority priority = SyncPriority::Background,
+                   BOOL force = FALSE);
+    
+    // The file in the active buffer; its syncs jump the queue and bulk
+    // imports pause between batches for them
+    void SetActiveFile(const std::wstring& filePath);
+    
     void SetAutoSync(BOOL enabled);
     BOOL IsAutoSyncEnabled() const;
     
@@ -40,20 +75,78 @@ public:
     void LoadMappings();
     void SaveMappings() const;
     
-    // Bridge access
+    // Pull notes changed in Keep since the stored cursor into the mirror,
+    // unless the last pull is less than PullMaxAgeSeconds old
+    BOOL PullRemoteChanges();
+    
+    // Bridge access; it may still be starting (see EnsureStarted)
     NppGoogleKeepSync::PythonBridge* GetBridge() { return m_keepBridge.get(); }
     
+    const Diagnostics::SyncCounters& GetCounters() const { return m_counters; }
+    
 private:
     mutable std::mutex m_mutex;
+    // Held by whatever is talking to Keep: the UI thread, the queue thread
+    // and folder imports share one bridge process
+    std::recursive_mutex m_syncMutex;
     PluginConfig m_config;
+    SyncRules m_rules;          // Compiled from m_config
     std::unordered_map<std::wstring, NoteMapping> m_mappings;
     std::wstring m_mappingsFile;
+    std::wstring m_cursorFile;
+    std::wstring m_snapshotDir;
+    std::string m_changeCursor;
+    std::chrono::steady_clock::time_point m_lastPull;  // Unset until the first pull
     BOOL m_autoSyncEnabled;
     std::unique_ptr<NppGoogleKeepSync::PythonBridge> m_keepBridge;
+    // Pings the bridge under m_syncMutex and restarts it if it died
+    std::unique_ptr<NppGoogleKeepSync::BridgeWatchdog> m_watchdog;
+    Diagnostics::SyncCounters m_counters;
+    
+    // Watches the directories of mapped files; changes go to the sync queue
+    std::unique_ptr<DirectoryWatcher> m_watcher;
+    std::atomic<bool> m_watchesStale{false};    // A mapping was added since the last plan
+    SyncScheduler m_scheduler;  // Records into m_counters, so declared after it
+    std::thread m_queueThread;
+    
+    // Start runs once, on the queue thread or the first caller that needs it
+    std::once_flag m_startOnce;
+    BOOL m_started = FALSE;
+    std::atomic<bool> m_stopping{false};
+    BOOL Start();
     
     std::wstring CalculateFileHash(const std::wstring& filePath);
-    std::wstring ReadFileContents(const std::wstring& filePath);
+    std::string ReadFileContents(const std::wstring& filePath);
+    BOOL WriteFileContents(const std::wstring& filePath, const std::string& content);
+    static std::string ToCrlf(const std::string& text);
+    
+    // Compressed copy of the last synced text, the base for three-way merges
+    BOOL LoadBaseSnapshot(const NoteMapping& mapping, std::string& content);
+    BOOL SaveBaseSnapshot(NoteMapping& mapping, const std::string& content);
+    
+    // Split a file over the size limit across several notes, uploading
+    // only chunks whose content changed
+    BOOL SyncChunkedFile(NoteMapping& mapping, const std::string& title, const std::string& content);
     BOOL ShouldSync(const std::wstring& filePath);
+    // Checked against m_rules, with the file size if a rule needs it
+    BOOL IsExcluded(const std::wstring& filePath) const;
+    BOOL EnsureAuthenticated();
+    
+    // Read and hash files on a thread pool and upload the changed ones
+    // through UploadBatch
+    BOOL RunBulkSync(const std::vector<BulkImport::File>& files, const BulkImport::Options& options,
+                     BulkImport::Progress& progress);
+    // Create new notes and overwrite notes unchanged in Keep with one bridge
+    // batch; the rest go through SyncFileStages. FALSE if the bridge is gone.
+    BOOL UploadBatch(std::vector<BulkImport::Item>& batch);
+    static std::string NoteTitle(const std::wstring& filePath);
+    BOOL SyncFileStages(const std::wstring& filePath, BOOL force);
+    
+    void RunSyncQueue();
+    // Point the watcher at the directories of the current mappings
+    void RefreshWatches();
+    // Watcher callback: a changed file, or a directory whose events were lost
+    void OnExternalChange(const std::wstring& path);
 };
 
 // Main Plugin Class
@@ -72,8 +165,11 @@ public:
     
     // Menu commands
     void OnSyncNow();
+    void OnSyncFolder();
+    void OnSyncAllOpen();
     void OnConfigure();
     void OnToggleAutoSync();
+    void OnDiagnostics();
     void OnAbout();
     
     // Plugin info
@@ -8,6 +8,8 @@
 #include <string>
 #include <vector>
 
+#include "MappingStore.h"
+
 // Plugin constants
 #define PLUGIN_NAME           L"GoogleKeepSync"
 #define PLUGIN_VERSION        L"2.0.0"
@@ -18,16 +20,26 @@
 #define ID_PLUGIN_CONFIGURE       0x02
 #define ID_PLUGIN_TOGGLE_AUTOSYNC 0x03
 #define ID_PLUGIN_ABOUT           0x04
+#define ID_PLUGIN_DIAGNOSTICS     0x05
+#define ID_PLUGIN_SYNC_FOLDER     0x06
+#define ID_PLUGIN_SYNC_ALL_OPEN   0x07
 
 // Function index for Notepad++
 #define NOTEPADPLUS_USER   (WM_USER + 1000)
 #define NPPM_GETCURRENTBUFFERID     (NOTEPADPLUS_USER + 4)
 #define NPPM_GETFULLCURRENTPATH     (NOTEPADPLUS_USER + 5)
+#define NPPM_GETNBOPENFILES         (NOTEPADPLUS_USER + 7)
+#define NPPM_GETOPENFILENAMES       (NOTEPADPLUS_USER + 8)
 #define NPPM_NOTIFYBUFFERACTIVATED  (NOTEPADPLUS_USER + 21)
 #define NPPM_FILEBEFORESAVE         (NOTEPADPLUS_USER + 23)
 #define NPPM_FILEDDELETED           (NOTEPADPLUS_USER + 33)
 #define NPPM_FILEBEFOREDELETE       (NOTEPADPLUS_USER + 32)
 
+// NPPM_GETNBOPENFILES views
+#define ALL_OPEN_FILES   0
+#define PRIMARY_VIEW     1
+#define SECOND_VIEW      2
+
 // Notification codes (from Notepad++ SDK)
 #define NPPN_FILEBEFORESAVE 2001
 #define NPPN_BUFFERSAVED    2002
@@ -65,22 +77,6 @@ struct SCNotification {
     void* _data;
 };
 
-// Note sync status
-enum class SyncStatus {
-    PENDING,
-    SYNCED,
-    FAILED,
-    DISABLED
-};
-
-struct NoteMapping {
-    std::wstring filePath;
-    std::wstring keepNoteId;
-    std::wstring lastSyncHash;
-    SyncStatus status;
-    FILETIME lastSyncTime;
-};
-
 // Plugin configuration
 struct PluginConfig {
     BOOL autoSyncEnabled;
@@ -90,6 +86,19 @@ struct PluginConfig {
     BOOL syncFileMetadata;
     BOOL createLabels;
     std::vector<std::wstring> excludedExtensions;
+    std::vector<std::wstring> excludePatterns;  // Globs, see SyncRules.h
+    std::vector<std::wstring> includePatterns;  // If any, only matching files sync
+    DWORD mirrorMaxAgeSeconds = 300;  // Note mirror staleness bound
+    DWORD pullMaxAgeSeconds = 30;     // Saves reuse a remote change pull this recent
+    DWORD maxFileSizeKB = 500;        // Larger files are split across several notes
+    BOOL watchMappedFiles = TRUE;     // Sync mapped files changed outside the editor
+    BOOL onlyTextFiles = TRUE;        // Skip files whose first bytes look binary
+    DWORD watchDelayMs = 500;         // Quiet time before such a change is synced
+    DWORD bridgeWatchdogSeconds = 15; // Bridge health ping interval (0 = off)
+    DWORD apiTimeoutSeconds = 30;     // Bridge command deadline...
+    std::vector<std::wstring> commandTimeouts;  // ...unless overridden here ("sync:90")
+    BOOL debugLogging = FALSE;        // Record per-stage sync timings
+    std::wstring logFilePath;         // Trace file written when debugLogging is set
 };
 
 // Helper function for JSON extraction
@@ -0,0 +1,46 @@
+// Sync Progress Dialog Header
+// ARM64 Windows Compatible
+
+#pragma once
+
+#include <windows.h>
+#include <functional>
+#include <string>
+#include <thread>
+
+#include "BulkImport.h"
+
+// Dialog resource IDs
+#define IDD_SYNC_PROGRESS_DIALOG  130
+#define IDC_SYNC_PROGRESS_LABEL   131
+#define IDC_SYNC_PROGRESS_BAR     132
+#define IDC_SYNC_PROGRESS_STATUS  133
+
+// Runs a multi-file sync (Sync Folder, Sync All Open) on a worker thread
+// and shows its progress until it finishes. Cancel stops it after the files
+// in flight.
+class SyncProgressDialog {
+public:
+    using WorkFn = std::function<void(BulkImport::Progress&)>;
+    
+    SyncProgressDialog(HINSTANCE hInstance, HWND hwndParent, const std::wstring& title,
+                       const std::wstring& label, WorkFn work);
+    
+    void Show();
+    
+private:
+    static INT_PTR CALLBACK DialogProc(HWND hwndDlg, UINT uMsg, WPARAM wParam, LPARAM lParam);
+    INT_PTR OnInitDialog(HWND hwndDlg);
+    void Refresh();
+    void OnCancel();
+    
+    HINSTANCE m_hInstance;
+    HWND m_hwndParent;
+    HWND m_hwndDialog;
+    std::wstring m_title;
+    std::wstring m_label;
+    WorkFn m_work;
+    BulkImport::Progress m_progress;
+    std::thread m_worker;
+    bool m_finished;
+};
@@ -0,0 +1,118 @@
+// SyncRules - which files auto-sync, Sync Folder and Sync All Open take
+// ARM64 Windows Compatible
+//
+// Rules come from the INI (ExcludedExtensions, ExcludePatterns,
+// IncludePatterns) and are compiled once per config load into hash tables
+// keyed by case-folded text:
+//   - extensions, from the extension list and patterns like "*.log";
+//   - names, for patterns naming a file or directory anywhere
+//     ("node_modules", "Thumbs.db", "build/");
+//   - directory prefixes, for rooted directories ("C:\build\");
+//   - globs that start with a literal directory ("docs/*/draft?.md",
+//     "C:\Work\**\*.bak"), by that directory;
+// and the remaining globs. Checking a path is one walk over it with a
+// lookup per component and separator, then the leftover globs, and never
+// allocates.
+//
+// Pattern syntax: '*' matches within one path component, '**' across
+// components, '?' one character other than a separator. '/' and '\' are
+// the same and case is ignored. A pattern without a separator matches
+// the file name or any directory name; one with a separator matches the
+// whole path if rooted ("C:\..." or "/..."), else a tail of it starting at
+// a component. A trailing separator matches directories only, and so
+// everything below them. A pattern may end in size bounds, ">100KB",
+// "<2MB" or both (B, KB, MB or GB), and then only matches files of that
+// size.
+//
+// A path is excluded if an exclude rule matches it, or if there are
+// include rules and none matches it.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+class SyncRules {
+public:
+    static constexpr uint64_t kUnknownSize = UINT64_MAX;
+
+    // Extensions are without dots (a leading dot is ignored). Patterns
+    // that do not parse (a bad size bound) are ignored.
+    static SyncRules Compile(const std::vector<std::wstring>& excludedExtensions,
+                             const std::vector<std::wstring>& excludePatterns = {},
+                             const std::vector<std::wstring>& includePatterns = {});
+
+    // Rules with size bounds never match a file of unknown size
+    bool IsExcluded(std::wstring_view path, uint64_t size = kUnknownSize) const;
+
+    // True if a name rule ("node_modules", "build/", "~$*") excludes the
+    // directory itself, and so everything below it; a tree walk can skip it
+    bool IsExcludedDirectory(std::wstring_view directory) const;
+
+    // True if some rule has size bounds, so IsExcluded wants the size
+    bool NeedsSize() const { return m_exclude.sized || m_include.sized; }
+
+    bool Empty() const { return m_exclude.Empty() && m_include.Empty(); }
+
+private:
+    struct Bounds {
+        uint64_t min = 0;               // Inclusive
+        uint64_t max = kUnknownSize;    // Inclusive
+        bool limited = false;
+
+        bool Contains(uint64_t size) const {
+            return !limited || (size != kUnknownSize && size >= min && size <= max);
+        }
+    };
+
+    // Case-folded keys with '/' for separators, by hash
+    class Table {
+    public:
+        void Add(std::wstring key, const Bounds& bounds, bool directoryOnly);
+        bool Find(std::wstring_view text, uint64_t hash, uint64_t size, bool isFile) const;
+        bool Empty() const { return m_entries.empty(); }
+
+    private:
+        struct Entry {
+            std::wstring key;
+            Bounds bounds;
+            bool directoryOnly;
+        };
+        std::unordered_multimap<uint64_t, Entry> m_entries;
+    };
+
+    struct Glob {
+        std::wstring pattern;       // Folded, '/' separators; what follows the anchor
+        std::wstring tail;          // Literal end every match has, for a quick reject
+        std::wstring anchor;        // Directory name or rooted prefix the pattern follows
+        Bounds bounds;
+        bool directoryOnly = false;
+    };
+    using GlobIndex = std::unordered_multimap<uint64_t, Glob>;     // By anchor hash
+
+    // Rules of one kind (exclude or include)
+    struct Group {
+        Table extensions;
+        Table names;
+        Table directories;
+        std::vector<Glob> componentGlobs;   // Matched against each component
+        GlobIndex nameAnchored;             // "**/name/...", tried below a directory "name"
+        GlobIndex prefixAnchored;           // "c:/dir/...", tried below "c:/dir/"
+        std::vector<Glob> pathGlobs;        // Matched against the whole path
+        bool sized = false;                 // Some rule has size bounds
+
+        void Add(std::wstring_view rule);
+        bool Matches(std::wstring_view path, uint64_t size) const;
+        bool MatchesDirectoryName(std::wstring_view directory) const;
+        bool Empty() const {
+            return extensions.Empty() && names.Empty() && directories.Empty() && componentGlobs.empty() &&
+                   nameAnchored.empty() && prefixAnchored.empty() && pathGlobs.empty();
+        }
+    };
+
+    Group m_exclude;
+    Group m_include;
+};
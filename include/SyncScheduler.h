@@ -0,0 +1,103 @@
+// SyncScheduler - the order files are synced in
+// ARM64 Windows Compatible
+//
+// Single-file syncs (saves, Sync Now, files changed outside the editor) go
+// through one queue with four priority classes. The file in the active
+// buffer always runs as Interactive, so it does not wait behind a git
+// checkout's worth of background changes. Bulk imports (Sync Folder, Sync
+// All Open) do not queue; they call Yield between upload batches and
+// stand aside while higher-priority work is waiting or running.
+//
+// Nothing starves: a queued job climbs one class for every agingStep it
+// has waited, and Yield gives up waiting after maxWait. Time from queued
+// to started is recorded per class.
+
+#pragma once
+
+#include "Diagnostics.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+enum class SyncPriority {
+    Interactive,    // Sync Now, the active buffer
+    Save,           // Auto-sync on save
+    Background,     // Changed outside the editor
+    Bulk,           // Sync Folder, Sync All Open
+};
+
+const int kSyncPriorities = 4;
+static_assert(kSyncPriorities == Diagnostics::SyncCounters::kPriorityClasses, "one histogram per class");
+
+class SyncScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Job {
+        std::wstring path;
+        SyncPriority priority = SyncPriority::Background;   // Class it was taken from
+        bool force = false;                                 // Sync even if unchanged
+        Clock::time_point queued;
+    };
+
+    // queueWait, if given, is kSyncPriorities histograms indexed by class
+    explicit SyncScheduler(std::chrono::milliseconds agingStep = std::chrono::seconds(2),
+                           Diagnostics::Histogram* queueWait = nullptr);
+
+    // The file in the active buffer; its jobs run as Interactive, and one
+    // already queued moves up
+    void SetActive(const std::wstring& path);
+
+    // Queue a file. One already queued keeps its place and age but moves
+    // up to priority if that is higher. True if a new job was added.
+    bool Push(const std::wstring& path, SyncPriority priority, bool force = false,
+              Clock::time_point now = Clock::now());
+
+    // Next job, highest class first (after aging) and oldest first within
+    // a class; blocks while the queue is empty. False once stopped. Call
+    // Done when the job has run.
+    bool Pop(Job& job);
+
+    // Pop without blocking, as of `now`
+    bool TryPop(Job& job, Clock::time_point now);
+
+    void Done(const Job& job);
+
+    // For bulk work between batches: wait while a job of higher priority
+    // than `priority` is queued or running, for at most maxWait
+    void Yield(SyncPriority priority, std::chrono::milliseconds maxWait);
+
+    // Wakes Pop and Yield; Pop returns false from then on
+    void Stop();
+
+    size_t Size() const;
+
+private:
+    struct Entry {
+        std::wstring path;
+        bool force;
+        Clock::time_point queued;
+    };
+    using Queue = std::list<Entry>;
+
+    bool TakeLocked(Job& job, Clock::time_point now);
+    void MoveLocked(const std::wstring& path, int to);
+    bool HigherWorkLocked(int priority) const;
+    void RecordWait(int priority, Clock::duration waited);
+
+    std::chrono::milliseconds m_agingStep;
+    Diagnostics::Histogram* m_queueWait;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_ready;        // Job queued, or stopping
+    std::condition_variable m_drained;      // A job finished, or stopping
+    Queue m_queues[kSyncPriorities];
+    std::unordered_map<std::wstring, std::pair<int, Queue::iterator>> m_index;
+    int m_running[kSyncPriorities] = {};
+    std::wstring m_active;
+    bool m_stop = false;
+};
@@ -0,0 +1,47 @@
+// TextMerge - line-based diff and three-way merge
+// ARM64 Windows Compatible
+//
+// Used to reconcile a local file with a Keep note that was edited
+// elsewhere since the last sync, given the last synced text as the base.
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace TextMerge {
+
+// A changed region: lines [baseStart, baseStart + baseCount) of the old
+// text were replaced by lines [otherStart, otherStart + otherCount) of
+// the new one. Lines keep their terminating '\n'.
+struct Hunk {
+    size_t baseStart;
+    size_t baseCount;
+    size_t otherStart;
+    size_t otherCount;
+};
+
+struct MergeResult {
+    std::string text;
+    size_t conflicts = 0;   // Regions both sides changed differently
+};
+
+// Split text into lines, each keeping its trailing '\n'
+std::vector<std::string_view> SplitLines(std::string_view text);
+
+// Changed regions between two texts, in order
+std::vector<Hunk> Diff(std::string_view oldText, std::string_view newText);
+std::vector<Hunk> DiffLines(const std::vector<std::string_view>& oldLines,
+                            const std::vector<std::string_view>& newLines);
+
+// Three-way merge of two descendants of base. Regions changed on only one
+// side take that side; identical changes are taken once; differing changes
+// are emitted between conflict markers labelled with the side names.
+MergeResult Merge(std::string_view base, std::string_view local, std::string_view remote,
+                  const char* localLabel = "local", const char* remoteLabel = "keep");
+
+// Convert CRLF line endings to LF (Keep stores '\n' only)
+std::string NormalizeNewlines(std::string_view text);
+
+} // namespace TextMerge
@@ -0,0 +1,72 @@
+// ThreadPool - work-stealing pool for the sync core's CPU and disk work
+// ARM64 Windows Compatible
+//
+// Each worker owns a deque. Tasks submitted from a worker go to the back of
+// its own deque and it pops from the back (newest first, still hot in
+// cache); tasks from other threads are dealt round-robin. A worker whose
+// deque is empty steals the oldest task from the front of another's, so a
+// few slow files (a large file, a cold disk) do not leave the other threads
+// idle while their share waits behind them.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    // threads == 0 uses one thread per hardware thread
+    explicit ThreadPool(size_t threads = 0);
+
+    // Finishes every queued task, then joins the workers
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void Submit(Task task);
+
+    // Block until every submitted task has finished. Rethrows the first
+    // exception a task threw since the last Wait.
+    void Wait();
+
+    size_t Size() const { return m_threads.size(); }
+
+    // Tasks taken from another worker's deque
+    uint64_t Steals() const { return m_steals.load(std::memory_order_relaxed); }
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void Run(size_t index);
+    bool PopLocal(size_t index, Task& task);
+    bool Steal(size_t thief, Task& task);
+    void Finished();
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_mutex;                     // Guards sleeping, m_stop and m_error
+    std::condition_variable m_wake;         // Work queued or stopping
+    std::condition_variable m_idle;         // m_pending reached zero
+    bool m_stop = false;
+    std::exception_ptr m_error;
+
+    std::atomic<size_t> m_queued{0};        // Tasks sitting in a deque
+    std::atomic<size_t> m_pending{0};       // Queued plus running
+    std::atomic<size_t> m_next{0};          // Round-robin target for outside submits
+    std::atomic<uint64_t> m_steals{0};
+};
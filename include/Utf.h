@@ -0,0 +1,53 @@
+// Utf - UTF-8 / wide string transcoding
+// ARM64 Windows Compatible
+//
+// The plugin talks to Win32 and Notepad++ in wide strings (UTF-16 on
+// Windows, UTF-32 where wchar_t is 32 bits) and to the bridge, the
+// mappings file and Keep in UTF-8. Every crossing goes through here.
+//
+// Runs of ASCII, the bulk of most notes and all ids and hashes, are
+// converted 16 characters at a time with SSE2 or NEON; everything else
+// takes the scalar path. Malformed input (invalid UTF-8, unpaired
+// surrogates) becomes U+FFFD rather than failing.
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace Utf {
+
+// UTF-8 from wide text
+std::string ToUtf8(std::wstring_view text);
+
+// Wide text from UTF-8
+std::wstring FromUtf8(std::string_view text);
+
+// The same for UTF-16 held in char16_t (files saved as UTF-16)
+std::string ToUtf8(std::u16string_view text);
+std::u16string ToUtf16(std::string_view text);
+
+// UTF-8 from bytes taken as Windows-1252, for text written in a legacy
+// 8-bit code page. Unlike Latin-1 it gives 0x80-0x9F their printable
+// meanings (euro sign, curly quotes, dashes).
+std::string FromCp1252(std::string_view text);
+
+// The Windows-1252 byte for codePoint; false if it has none
+bool ToCp1252(char32_t codePoint, char& byte);
+
+// Length of the leading run of ASCII bytes
+size_t AsciiPrefix(std::string_view text);
+
+// True if text is well-formed UTF-8 (no overlong forms, surrogates or
+// code points past U+10FFFF)
+bool IsValidUtf8(std::string_view text);
+
+// Decode the code point starting at text[pos]. Returns the bytes used;
+// a malformed sequence yields U+FFFD and consumes its longest valid prefix
+// (at least one byte). pos must be inside text.
+size_t Decode(std::string_view text, size_t pos, char32_t& codePoint);
+
+// Append codePoint to out as UTF-8
+void Append(std::string& out, char32_t codePoint);
+
+} // namespace Utf
@@ -16,6 +16,15 @@
 #define IDC_BUTTON_REMOVE_EXCL  109
 #define IDC_EDIT_EXCLUSION      110
 
+#define IDD_DIAGNOSTICS_DIALOG  120
+#define IDC_DIAG_TEXT           121
+#define IDC_BUTTON_DIAG_COPY    122
+
+#define IDD_SYNC_PROGRESS_DIALOG  130
+#define IDC_SYNC_PROGRESS_LABEL   131
+#define IDC_SYNC_PROGRESS_BAR     132
+#define IDC_SYNC_PROGRESS_STATUS  133
+
 // Icons
 #define IDI_PLUGIN_ICON         100
 
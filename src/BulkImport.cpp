@@ -0,0 +1,208 @@
+// BulkImport - sync a whole directory tree to Keep
+
+#include "../include/BulkImport.h"
+#include "../include/ContentHash.h"
+#include "../include/ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <optional>
+
+namespace BulkImport {
+
+namespace {
+    namespace fs = std::filesystem;
+
+    enum class ReadResult { Ok, Failed, Binary };
+
+    // The head is read and sniffed first, so with onlyText a binary file
+    // is dropped after one small read
+    ReadResult readFile(const std::wstring& path, bool onlyText, Item& item) {
+        std::ifstream file(fs::path(path), std::ios::binary);
+        if (!file) return ReadResult::Failed;
+        file.seekg(0, std::ios::end);
+        std::streamoff size = file.tellg();
+        if (size < 0) return ReadResult::Failed;
+        file.seekg(0, std::ios::beg);
+
+        std::string& content = item.content;
+        size_t total = static_cast<size_t>(size);
+        size_t head = std::min(total, ContentSniff::kSniffBytes);
+        content.resize(head);
+        file.read(&content[0], head);
+        size_t got = static_cast<size_t>(file.gcount());
+        item.format = ContentSniff::Sniff(std::string_view(content).substr(0, got), got == total);
+        if (onlyText && !ContentSniff::IsText(item.format)) return ReadResult::Binary;
+
+        content.resize(total);
+        if (got == head && total > head) {
+            file.read(&content[head], total - head);
+            got += static_cast<size_t>(file.gcount());
+        }
+        content.resize(got);
+        return file.bad() ? ReadResult::Failed : ReadResult::Ok;
+    }
+
+    bool isHidden(const fs::path& path) {
+        std::wstring name = path.filename().wstring();
+        return !name.empty() && name[0] == L'.';
+    }
+
+    // Files read by the pool, keyed by their index in the file list. An
+    // empty slot means the file was skipped or failed.
+    struct ReadResults {
+        std::mutex mutex;
+        std::condition_variable ready;
+        std::map<size_t, std::optional<Item>> slots;
+    };
+}
+
+std::vector<File> Enumerate(const std::wstring& root, const Options& options, Progress& progress)
+{
+    std::vector<File> files;
+    std::error_code ec;
+    fs::recursive_directory_iterator it(fs::path(root), fs::directory_options::skip_permission_denied, ec);
+    for (fs::recursive_directory_iterator end; !ec && it != end; it.increment(ec)) {
+        if (progress.cancel.load(std::memory_order_relaxed)) break;
+
+        const fs::directory_entry& entry = *it;
+        std::error_code entryEc;
+        if (entry.is_directory(entryEc)) {
+            if (isHidden(entry.path()) || options.rules.IsExcludedDirectory(entry.path().wstring())) {
+                it.disable_recursion_pending();
+            }
+            continue;
+        }
+        if (!entry.is_regular_file(entryEc) || isHidden(entry.path())) continue;
+
+        uint64_t size = entry.file_size(entryEc);
+        if (entryEc || size == 0) continue;
+
+        std::wstring path = entry.path().wstring();
+        if (options.rules.IsExcluded(path, size)) continue;
+        files.push_back({std::move(path), size});
+    }
+
+    // Stable order, so repeated imports create notes in the same order
+    std::sort(files.begin(), files.end(), [](const File& a, const File& b) { return a.path < b.path; });
+    progress.total.store(files.size(), std::memory_order_relaxed);
+    return files;
+}
+
+bool Run(const std::vector<File>& files, const Options& options, const Hooks& hooks, Progress& progress)
+{
+    ReadResults results;
+    size_t readAhead = std::max<size_t>(options.readAhead, 1);
+    bool completed = true;
+
+    // Reads one file; every submitted file leaves exactly one slot
+    auto read = [&](size_t index) {
+        std::optional<Item> slot;
+        Item item;
+        item.path = files[index].path;
+        ReadResult result = readFile(item.path, options.onlyText, item);
+        if (result == ReadResult::Failed) {
+            progress.failed.fetch_add(1, std::memory_order_relaxed);
+        } else if (result == ReadResult::Binary) {
+            progress.skipped.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            progress.read.fetch_add(1, std::memory_order_relaxed);
+            if (!item.content.empty()) {
+                item.hash = ContentHash::Md5Hex(item.content);
+            }
+            if (item.content.empty() || (hooks.needsSync && !hooks.needsSync(item.path, item.hash))) {
+                progress.skipped.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                slot = std::move(item);
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(results.mutex);
+            results.slots.emplace(index, std::move(slot));
+        }
+        results.ready.notify_one();
+    };
+
+    {
+        // Joined at the end of this block, before anything it uses goes away
+        ThreadPool pool(options.threads);
+
+        // Files are submitted only while fewer than readAhead are read or
+        // in flight, so memory stays bounded and no reader ever waits
+        size_t submitted = 0;
+        size_t consumed = 0;
+        std::vector<Item> batch;
+        size_t batchBytes = 0;
+        for (;;) {
+            while (submitted < files.size() && submitted - consumed < readAhead) {
+                pool.Submit([&read, index = submitted] { read(index); });
+                submitted++;
+            }
+
+            {
+                std::unique_lock<std::mutex> lock(results.mutex);
+                auto available = [&] {
+                    return !results.slots.empty() &&
+                           (!options.ordered || results.slots.begin()->first == consumed);
+                };
+                // Wakes periodically to notice progress.cancel
+                results.ready.wait_for(lock, std::chrono::milliseconds(100), [&] {
+                    return available() || consumed == files.size();
+                });
+                if (available()) {
+                    auto first = results.slots.begin();
+                    if (first->second) {
+                        batchBytes += first->second->content.size();
+                        batch.push_back(std::move(*first->second));
+                    }
+                    results.slots.erase(first);
+                    consumed++;
+                }
+            }
+            bool finished = consumed == files.size();
+
+            if (progress.cancel.load(std::memory_order_relaxed)) {
+                completed = false;
+                break;
+            }
+
+            bool full = batch.size() >= options.batchFiles || batchBytes >= options.batchBytes;
+            if (!batch.empty() && (full || finished)) {
+                if (!hooks.upload(batch)) {
+                    progress.failed.fetch_add(batch.size(), std::memory_order_relaxed);
+                    completed = false;
+                    break;
+                }
+                for (const Item& item : batch) {
+                    (item.ok ? progress.uploaded : progress.failed).fetch_add(1, std::memory_order_relaxed);
+                }
+                batch.clear();
+                batchBytes = 0;
+            }
+            if (finished) break;
+        }
+    }
+
+    progress.done.store(true, std::memory_order_release);
+    return completed;
+}
+
+std::string FormatProgress(const Progress& progress)
+{
+    char line[160];
+    std::snprintf(line, sizeof(line), "%llu / %llu read, %llu uploaded, %llu skipped, %llu failed",
+                  static_cast<unsigned long long>(progress.read.load(std::memory_order_relaxed)),
+                  static_cast<unsigned long long>(progress.total.load(std::memory_order_relaxed)),
+                  static_cast<unsigned long long>(progress.uploaded.load(std::memory_order_relaxed)),
+                  static_cast<unsigned long long>(progress.skipped.load(std::memory_order_relaxed)),
+                  static_cast<unsigned long long>(progress.failed.load(std::memory_order_relaxed)));
+    return line;
+}
+
+} // namespace BulkImport
@@ -0,0 +1,127 @@
+// Chunker - content-defined chunking for files too large for one note
+
+#include "../include/Chunker.h"
+
+#include <cstring>
+
+namespace Chunker {
+
+namespace {
+    // Gear table: one pseudo-random 64-bit value per byte, fixed so that
+    // boundaries are stable across runs
+    struct GearTable {
+        uint64_t values[256];
+        GearTable() {
+            uint64_t state = 0x9E3779B97F4A7C15ull;
+            for (auto& v : values) {
+                // splitmix64
+                state += 0x9E3779B97F4A7C15ull;
+                uint64_t z = state;
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+                v = z ^ (z >> 31);
+            }
+        }
+    };
+    const GearTable kGear;
+
+    bool isContinuation(unsigned char c) {
+        return (c & 0xC0) == 0x80;
+    }
+
+    // Cut point for the chunk starting at start
+    size_t findCut(const unsigned char* data, size_t n, size_t start,
+                   size_t minSize, size_t maxSize, uint64_t mask) {
+        size_t limit = (n - start > maxSize) ? start + maxSize : n;
+        if (limit - start <= minSize) {
+            return limit;
+        }
+
+        size_t cut = 0;
+        uint64_t h = 0;
+        for (size_t i = start + minSize; i < limit; ++i) {
+            h = (h << 1) + kGear.values[data[i]];
+            if ((h & mask) == 0) {
+                cut = i + 1;
+                break;
+            }
+        }
+
+        if (cut != 0) {
+            // Finish the current line if it ends before the size limit
+            const void* nl = std::memchr(data + cut, '\n', limit - cut);
+            if (nl) {
+                cut = static_cast<const unsigned char*>(nl) - data + 1;
+            }
+        } else {
+            cut = limit;
+            if (limit < n) {
+                // Forced cut: fall back to the last line end past the minimum
+                for (size_t i = limit; i > start + minSize; --i) {
+                    if (data[i - 1] == '\n') {
+                        cut = i;
+                        break;
+                    }
+                }
+            }
+        }
+
+        while (cut < n && cut > start + 1 && isContinuation(data[cut])) {
+            cut--;
+        }
+        return cut;
+    }
+}
+
+std::vector<Chunk> Split(std::string_view text, size_t maxChunkSize)
+{
+    std::vector<Chunk> chunks;
+    if (text.empty()) {
+        return chunks;
+    }
+    if (maxChunkSize < 16) {
+        maxChunkSize = 16;
+    }
+
+    // Aim for an average chunk of about half the maximum: skip the first
+    // quarter, then expect a boundary within another quarter
+    size_t minSize = maxChunkSize / 4;
+    int bits = 0;
+    while ((size_t(2) << bits) <= minSize && bits < 62) {
+        bits++;
+    }
+    uint64_t mask = ((uint64_t(1) << bits) - 1) << (64 - bits);
+
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(text.data());
+    size_t n = text.size();
+    size_t start = 0;
+    while (start < n) {
+        size_t cut = findCut(data, n, start, minSize, maxChunkSize, mask);
+        chunks.push_back({start, cut - start, Hash(text.substr(start, cut - start))});
+        start = cut;
+    }
+    return chunks;
+}
+
+uint64_t Hash(std::string_view data)
+{
+    uint64_t h = 0xCBF29CE484222325ull;
+    for (unsigned char c : data) {
+        h ^= c;
+        h *= 0x100000001B3ull;
+    }
+    return h;
+}
+
+std::wstring HashToString(uint64_t hash)
+{
+    static const wchar_t digits[] = L"0123456789abcdef";
+    std::wstring out(16, L'0');
+    for (int i = 15; i >= 0; --i) {
+        out[i] = digits[hash & 0xF];
+        hash >>= 4;
+    }
+    return out;
+}
+
+} // namespace Chunker
@@ -0,0 +1,149 @@
+// Compression - small LZ77 block codec for locally stored text snapshots
+
+#include "../include/Compression.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace Compression {
+
+namespace {
+    const char kMagic[4] = {'G', 'K', 'Z', '1'};
+    const size_t kHeaderSize = 8;
+    const size_t kMinMatch = 4;
+    const size_t kMaxOffset = 65535;
+    const int kHashBits = 16;
+    // No payload byte expands to more than this many output bytes
+    const size_t kMaxExpansion = 255;
+
+    uint32_t read32(const char* p) {
+        uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    uint32_t hash32(uint32_t v) {
+        return (v * 2654435761u) >> (32 - kHashBits);
+    }
+
+    void writeLength(std::string& out, size_t length) {
+        while (length >= 255) {
+            out += static_cast<char>(255);
+            length -= 255;
+        }
+        out += static_cast<char>(length);
+    }
+
+    void emitSequence(std::string& out, const char* literals, size_t literalCount,
+                      size_t offset, size_t matchLength) {
+        size_t matchCode = matchLength ? matchLength - kMinMatch : 0;
+        unsigned char token = static_cast<unsigned char>(
+            ((literalCount < 15 ? literalCount : 15) << 4) | (matchCode < 15 ? matchCode : 15));
+        out += static_cast<char>(token);
+        if (literalCount >= 15) writeLength(out, literalCount - 15);
+        out.append(literals, literalCount);
+        if (matchLength == 0) return;
+        out += static_cast<char>(offset & 0xFF);
+        out += static_cast<char>((offset >> 8) & 0xFF);
+        if (matchCode >= 15) writeLength(out, matchCode - 15);
+    }
+
+    bool readLength(const unsigned char*& p, const unsigned char* end, size_t& length) {
+        unsigned char b;
+        do {
+            if (p >= end) return false;
+            b = *p++;
+            length += b;
+        } while (b == 255);
+        return true;
+    }
+}
+
+std::string Compress(std::string_view input)
+{
+    std::string out;
+    out.reserve(kHeaderSize + input.size() / 2 + 16);
+    out.append(kMagic, sizeof(kMagic));
+    uint32_t size = static_cast<uint32_t>(input.size());
+    out.append(reinterpret_cast<const char*>(&size), sizeof(size));
+
+    const char* src = input.data();
+    const size_t n = input.size();
+    std::vector<uint32_t> table(size_t(1) << kHashBits, UINT32_MAX);
+
+    size_t anchor = 0;
+    size_t i = 0;
+    while (i + kMinMatch <= n) {
+        uint32_t seq = read32(src + i);
+        uint32_t& slot = table[hash32(seq)];
+        size_t candidate = slot;
+        slot = static_cast<uint32_t>(i);
+
+        if (candidate != UINT32_MAX && i - candidate <= kMaxOffset && read32(src + candidate) == seq) {
+            size_t length = kMinMatch;
+            while (i + length < n && src[candidate + length] == src[i + length]) {
+                length++;
+            }
+            emitSequence(out, src + anchor, i - anchor, i - candidate, length);
+            i += length;
+            anchor = i;
+        } else {
+            i++;
+        }
+    }
+
+    // The final sequence carries literals only
+    emitSequence(out, src + anchor, n - anchor, 0, 0);
+    return out;
+}
+
+bool Decompress(std::string_view input, std::string& output)
+{
+    output.clear();
+    if (input.size() < kHeaderSize || std::memcmp(input.data(), kMagic, sizeof(kMagic)) != 0) {
+        return false;
+    }
+    uint32_t size;
+    std::memcpy(&size, input.data() + sizeof(kMagic), sizeof(size));
+    // The header is untrusted: refuse to allocate more than the payload could yield
+    if (size > (input.size() - kHeaderSize) * kMaxExpansion) return false;
+    output.resize(size);
+
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(input.data()) + kHeaderSize;
+    const unsigned char* end = reinterpret_cast<const unsigned char*>(input.data()) + input.size();
+    size_t written = 0;
+
+    while (p < end) {
+        unsigned char token = *p++;
+
+        size_t literalCount = token >> 4;
+        if (literalCount == 15 && !readLength(p, end, literalCount)) return false;
+        if (literalCount > static_cast<size_t>(end - p) || literalCount > size - written) return false;
+        std::memcpy(&output[written], p, literalCount);
+        p += literalCount;
+        written += literalCount;
+
+        if (p == end) break;  // Last sequence
+
+        if (end - p < 2) return false;
+        size_t offset = p[0] | (static_cast<size_t>(p[1]) << 8);
+        p += 2;
+        size_t matchLength = token & 0x0F;
+        if (matchLength == 15 && !readLength(p, end, matchLength)) return false;
+        matchLength += kMinMatch;
+
+        if (offset == 0 || offset > written || matchLength > size - written) return false;
+        // Byte-wise copy: matches may overlap their own output
+        char* dst = &output[written];
+        const char* from = dst - offset;
+        for (size_t k = 0; k < matchLength; ++k) {
+            dst[k] = from[k];
+        }
+        written += matchLength;
+    }
+
+    return written == size;
+}
+
+} // namespace Compression
@@ -0,0 +1,184 @@
+// ContentHash - file and payload hashes used by the sync core
+
+#include "../include/ContentHash.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace ContentHash {
+
+namespace {
+    // RFC 1321 per-round shift amounts and sine-derived constants
+    const uint32_t kShift[64] = {
+        7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22,
+        5,  9, 14, 20, 5,  9, 14, 20, 5,  9, 14, 20, 5,  9, 14, 20,
+        4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23,
+        6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21
+    };
+
+    const uint32_t kSine[64] = {
+        0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+        0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+        0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+        0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+        0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+        0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+        0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+        0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391
+    };
+
+    uint32_t rotl(uint32_t x, uint32_t n) {
+        return (x << n) | (x >> (32 - n));
+    }
+
+    std::wstring toHex(const uint8_t* bytes, size_t size) {
+        static const wchar_t digits[] = L"0123456789abcdef";
+        std::wstring out(size * 2, L'0');
+        for (size_t i = 0; i < size; ++i) {
+            out[2 * i] = digits[bytes[i] >> 4];
+            out[2 * i + 1] = digits[bytes[i] & 0x0F];
+        }
+        return out;
+    }
+}
+
+Md5::Md5()
+    : m_state{0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476}
+    , m_length(0)
+{
+}
+
+void Md5::Transform(const uint8_t block[64])
+{
+    uint32_t m[16];
+    for (int i = 0; i < 16; ++i) {
+        m[i] = static_cast<uint32_t>(block[i * 4]) |
+               (static_cast<uint32_t>(block[i * 4 + 1]) << 8) |
+               (static_cast<uint32_t>(block[i * 4 + 2]) << 16) |
+               (static_cast<uint32_t>(block[i * 4 + 3]) << 24);
+    }
+
+    uint32_t a = m_state[0], b = m_state[1], c = m_state[2], d = m_state[3];
+    for (int i = 0; i < 64; ++i) {
+        uint32_t f;
+        int g;
+        if (i < 16) {
+            f = (b & c) | (~b & d);
+            g = i;
+        } else if (i < 32) {
+            f = (d & b) | (~d & c);
+            g = (5 * i + 1) & 15;
+        } else if (i < 48) {
+            f = b ^ c ^ d;
+            g = (3 * i + 5) & 15;
+        } else {
+            f = c ^ (b | ~d);
+            g = (7 * i) & 15;
+        }
+        uint32_t next = d;
+        d = c;
+        c = b;
+        b = b + rotl(a + f + kSine[i] + m[g], kShift[i]);
+        a = next;
+    }
+    m_state[0] += a;
+    m_state[1] += b;
+    m_state[2] += c;
+    m_state[3] += d;
+}
+
+void Md5::Update(const void* data, size_t size)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    size_t used = static_cast<size_t>(m_length & 63);
+    m_length += size;
+
+    if (used > 0) {
+        size_t take = 64 - used < size ? 64 - used : size;
+        std::memcpy(m_buffer + used, bytes, take);
+        bytes += take;
+        size -= take;
+        if (used + take < 64) return;
+        Transform(m_buffer);
+    }
+    // Whole blocks straight from the input
+    for (; size >= 64; bytes += 64, size -= 64) {
+        Transform(bytes);
+    }
+    std::memcpy(m_buffer, bytes, size);
+}
+
+void Md5::Final(uint8_t digest[16])
+{
+    uint64_t bits = m_length * 8;
+    static const uint8_t padding[64] = {0x80};
+    size_t used = static_cast<size_t>(m_length & 63);
+    Update(padding, used < 56 ? 56 - used : 120 - used);
+
+    uint8_t length[8];
+    for (int i = 0; i < 8; ++i) {
+        length[i] = static_cast<uint8_t>(bits >> (8 * i));
+    }
+    Update(length, 8);
+
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            digest[i * 4 + j] = static_cast<uint8_t>(m_state[i] >> (8 * j));
+        }
+    }
+}
+
+std::wstring Md5Hex(std::string_view data)
+{
+    Md5 md5;
+    md5.Update(data);
+    uint8_t digest[16];
+    md5.Final(digest);
+    return toHex(digest, sizeof(digest));
+}
+
+std::wstring HashFile(const std::wstring& filePath)
+{
+    std::ifstream file(std::filesystem::path(filePath), std::ios::binary);
+    if (!file) return L"";
+
+    Md5 md5;
+    std::vector<char> buffer(64 * 1024);
+    while (file) {
+        file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        if (file.gcount() > 0) {
+            md5.Update(buffer.data(), static_cast<size_t>(file.gcount()));
+        }
+    }
+    if (file.bad()) return L"";
+
+    uint8_t digest[16];
+    md5.Final(digest);
+    return toHex(digest, sizeof(digest));
+}
+
+uint32_t Crc32(std::string_view data)
+{
+    static const struct Table {
+        uint32_t values[256];
+        Table() {
+            for (uint32_t i = 0; i < 256; ++i) {
+                uint32_t c = i;
+                for (int k = 0; k < 8; ++k) {
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                }
+                values[i] = c;
+            }
+        }
+    } table;
+
+    uint32_t crc = 0xFFFFFFFFu;
+    for (unsigned char b : data) {
+        crc = table.values[(crc ^ b) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+} // namespace ContentHash
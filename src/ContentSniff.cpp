@@ -0,0 +1,229 @@
+// ContentSniff - tell text files from binary ones by their first bytes
+
+#include "../include/ContentSniff.h"
+#include "../include/Utf.h"
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define KEEPSYNC_SNIFF_SSE2 1
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define KEEPSYNC_SNIFF_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace ContentSniff {
+
+namespace {
+    const size_t kBlock = 16;
+
+    // Text with more than one control character in this many bytes is binary
+    const size_t kControlRatio = 16;
+
+    struct Scan {
+        size_t nulEven = 0;     // NUL bytes at even offsets
+        size_t nulOdd = 0;
+        size_t controls = 0;    // C0 controls other than NUL, whitespace and ESC
+    };
+
+    // True if any of the 16 bytes at p is below 0x20
+    inline bool controlBlock(const char* p) {
+#if defined(KEEPSYNC_SNIFF_SSE2)
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i low = _mm_cmpeq_epi8(_mm_min_epu8(bytes, _mm_set1_epi8(0x1F)), bytes);
+        return _mm_movemask_epi8(low) != 0;
+#elif defined(KEEPSYNC_SNIFF_NEON)
+        uint8x16_t bytes = vld1q_u8(reinterpret_cast<const uint8_t*>(p));
+        return vmaxvq_u8(vcltq_u8(bytes, vdupq_n_u8(0x20))) != 0;
+#else
+        uint64_t a, b;
+        std::memcpy(&a, p, 8);
+        std::memcpy(&b, p + 8, 8);
+        const uint64_t ones = 0x0101010101010101ull;
+        const uint64_t highs = 0x8080808080808080ull;
+        return (((a - ones * 0x20) & ~a) | ((b - ones * 0x20) & ~b)) & highs;
+#endif
+    }
+
+    inline void classify(unsigned char c, size_t offset, Scan& scan) {
+        if (c >= 0x20) return;
+        if (c == 0) {
+            ++((offset & 1) ? scan.nulOdd : scan.nulEven);
+        } else if (c < '\t' || (c > '\r' && c != 0x1B)) {
+            ++scan.controls;
+        }
+    }
+
+    // Most text has no control characters but tabs and newlines, so whole
+    // blocks are skipped and only blocks holding one are looked at bytewise
+    Scan scanControls(std::string_view text) {
+        Scan scan;
+        const char* p = text.data();
+        size_t size = text.size();
+        size_t i = 0;
+        for (; i + kBlock <= size; i += kBlock) {
+            if (!controlBlock(p + i)) continue;
+            for (size_t j = i; j < i + kBlock; ++j) {
+                classify(static_cast<unsigned char>(p[j]), j, scan);
+            }
+        }
+        for (; i < size; ++i) {
+            classify(static_cast<unsigned char>(p[i]), i, scan);
+        }
+        return scan;
+    }
+
+    // head without a UTF-8 sequence cut off by its end
+    std::string_view trimPartial(std::string_view head) {
+        size_t size = head.size();
+        for (size_t back = 1; back <= 3 && back <= size; ++back) {
+            unsigned char c = static_cast<unsigned char>(head[size - back]);
+            if (c < 0x80) break;
+            if (c >= 0xC0) {
+                size_t length = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : 2;
+                if (length > back) return head.substr(0, size - back);
+                break;
+            }
+        }
+        return head;
+    }
+
+    bool startsWith(std::string_view text, const char* prefix) {
+        return text.compare(0, std::strlen(prefix), prefix) == 0;
+    }
+}
+
+Format Sniff(std::string_view head, bool complete)
+{
+    Format format;
+    if (head.size() > kSniffBytes) {
+        head = head.substr(0, kSniffBytes);
+        complete = false;
+    }
+
+    format.bom = true;
+    if (startsWith(head, "\xEF\xBB\xBF")) return format;
+    if (startsWith(head, "\xFF\xFE")) {
+        format.encoding = Encoding::Utf16Le;
+        return format;
+    }
+    if (startsWith(head, "\xFE\xFF")) {
+        format.encoding = Encoding::Utf16Be;
+        return format;
+    }
+    format.bom = false;
+
+    Scan scan = scanControls(head);
+    if (scan.nulEven + scan.nulOdd > 0) {
+        // ASCII saved as UTF-16 has a NUL in every other byte, always on
+        // the same side; NULs anywhere else mean binary
+        size_t units = head.size() / 2;
+        if (scan.nulEven == 0 && scan.nulOdd * 4 >= units) {
+            format.encoding = Encoding::Utf16Le;
+        } else if (scan.nulOdd == 0 && scan.nulEven * 4 >= units) {
+            format.encoding = Encoding::Utf16Be;
+        } else {
+            format.encoding = Encoding::Binary;
+        }
+        return format;
+    }
+    if (scan.controls * kControlRatio > head.size()) {
+        format.encoding = Encoding::Binary;
+        return format;
+    }
+
+    if (!complete) head = trimPartial(head);
+    format.encoding = Utf::IsValidUtf8(head) ? Encoding::Utf8 : Encoding::Cp1252;
+    return format;
+}
+
+bool SniffFile(const std::wstring& path, Format& format)
+{
+    std::ifstream file(std::filesystem::path(path), std::ios::binary);
+    if (!file) return false;
+
+    char head[kSniffBytes];
+    file.read(head, sizeof(head));
+    if (file.bad()) return false;
+    size_t size = static_cast<size_t>(file.gcount());
+    bool complete = file.peek() == std::ifstream::traits_type::eof();
+    format = Sniff(std::string_view(head, size), complete);
+    return true;
+}
+
+std::string ToUtf8(std::string bytes, Format& format)
+{
+    if (format.encoding == Encoding::Utf16Le || format.encoding == Encoding::Utf16Be) {
+        const unsigned char* b = reinterpret_cast<const unsigned char*>(bytes.data());
+        size_t start = format.bom ? 2 : 0;
+        size_t count = bytes.size() > start ? (bytes.size() - start) / 2 : 0;
+        int hi = format.encoding == Encoding::Utf16Le ? 1 : 0;
+        std::u16string units(count, u'\0');
+        for (size_t i = 0; i < count; ++i) {
+            const unsigned char* unit = b + start + 2 * i;
+            units[i] = static_cast<char16_t>(unit[hi] << 8 | unit[1 - hi]);
+        }
+        return Utf::ToUtf8(units);
+    }
+
+    if (format.encoding == Encoding::Utf8 && format.bom) {
+        bytes.erase(0, 3);
+    }
+    if (format.encoding != Encoding::Cp1252 && Utf::IsValidUtf8(bytes)) {
+        return bytes;
+    }
+    // Files that are not UTF-8 were written in an 8-bit code page, almost
+    // always Windows-1252; decoding it keeps every character instead of
+    // mangling the bytes
+    if (format.encoding == Encoding::Utf8 && !format.bom) {
+        format.encoding = Encoding::Cp1252;
+    }
+    return Utf::FromCp1252(bytes);
+}
+
+std::string FromUtf8(std::string_view text, const Format& format)
+{
+    std::string out;
+    switch (format.encoding) {
+    case Encoding::Utf16Le:
+    case Encoding::Utf16Be: {
+        std::u16string units = Utf::ToUtf16(text);
+        bool le = format.encoding == Encoding::Utf16Le;
+        out.reserve((units.size() + 1) * 2);
+        auto put = [&](char16_t unit) {
+            char lo = static_cast<char>(unit & 0xFF);
+            char hi = static_cast<char>(unit >> 8);
+            out += le ? lo : hi;
+            out += le ? hi : lo;
+        };
+        if (format.bom) put(0xFEFF);
+        for (char16_t unit : units) put(unit);
+        return out;
+    }
+    case Encoding::Cp1252: {
+        out.reserve(text.size());
+        for (size_t i = 0; i < text.size(); ) {
+            size_t ascii = Utf::AsciiPrefix(text.substr(i));
+            out.append(text, i, ascii);
+            i += ascii;
+            if (i < text.size()) {
+                char32_t cp;
+                i += Utf::Decode(text, i, cp);
+                char byte;
+                out += Utf::ToCp1252(cp, byte) ? byte : '?';
+            }
+        }
+        return out;
+    }
+    default:
+        if (format.bom) out = "\xEF\xBB\xBF";
+        out.append(text);
+        return out;
+    }
+}
+
+} // namespace ContentSniff
@@ -0,0 +1,167 @@
+// Diagnostics - always-on sync and bridge counters
+
+#include "../include/Diagnostics.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace Diagnostics {
+
+namespace {
+    int bucketFor(uint64_t micros) {
+        int bucket = 0;
+        while (micros >= 2 && bucket < Histogram::kBuckets - 1) {
+            micros >>= 1;
+            bucket++;
+        }
+        return bucket;
+    }
+
+    void formatDuration(char* buffer, size_t size, uint64_t micros) {
+        if (micros < 1000) {
+            std::snprintf(buffer, size, "%llu us", static_cast<unsigned long long>(micros));
+        } else if (micros < 1000000) {
+            std::snprintf(buffer, size, "%.1f ms", micros / 1000.0);
+        } else {
+            std::snprintf(buffer, size, "%.2f s", micros / 1000000.0);
+        }
+    }
+
+    void formatBytes(char* buffer, size_t size, uint64_t bytes) {
+        if (bytes < 1024) {
+            std::snprintf(buffer, size, "%llu B", static_cast<unsigned long long>(bytes));
+        } else if (bytes < 1024 * 1024) {
+            std::snprintf(buffer, size, "%.1f KB", bytes / 1024.0);
+        } else {
+            std::snprintf(buffer, size, "%.1f MB", bytes / (1024.0 * 1024.0));
+        }
+    }
+
+    unsigned long long load(const std::atomic<uint64_t>& counter) {
+        return counter.load(std::memory_order_relaxed);
+    }
+
+    const char* const kPriorityNames[SyncCounters::kPriorityClasses] = {
+        "interactive", "save", "background", "bulk (yielding)",
+    };
+
+    void formatHistogram(std::string& out, const char* name, const Histogram& h) {
+        char line[256];
+        char p50[32];
+        char p90[32];
+        char p99[32];
+        char max[32];
+        formatDuration(p50, sizeof(p50), h.PercentileUs(0.50));
+        formatDuration(p90, sizeof(p90), h.PercentileUs(0.90));
+        formatDuration(p99, sizeof(p99), h.PercentileUs(0.99));
+        formatDuration(max, sizeof(max), h.MaxUs());
+        std::snprintf(line, sizeof(line), "  %-18s %8llu  %8s  %8s  %8s  %8s\r\n",
+                      name, static_cast<unsigned long long>(h.Count()), p50, p90, p99, max);
+        out += line;
+    }
+}
+
+void Histogram::Record(uint64_t micros)
+{
+    m_buckets[bucketFor(micros)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(micros, std::memory_order_relaxed);
+    uint64_t seen = m_max.load(std::memory_order_relaxed);
+    while (micros > seen && !m_max.compare_exchange_weak(seen, micros, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t Histogram::PercentileUs(double p) const
+{
+    uint64_t total = Count();
+    if (total == 0) {
+        return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(p * total);
+    if (rank == 0) rank = 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < kBuckets; ++i) {
+        seen += Bucket(i);
+        if (seen >= rank) {
+            uint64_t upper = uint64_t(2) << i;
+            return upper < MaxUs() ? upper : MaxUs();
+        }
+    }
+    return MaxUs();
+}
+
+void CommandLatencies::Record(const char* command, uint64_t micros)
+{
+    for (int i = 0; i < kMaxCommands; ++i) {
+        const char* name = m_names[i].load(std::memory_order_acquire);
+        if (name == nullptr) {
+            // Claim the free slot; if another thread beat us to it, check
+            // whether it claimed it for the same command
+            if (m_names[i].compare_exchange_strong(name, command, std::memory_order_acq_rel)) {
+                m_histograms[i].Record(micros);
+                return;
+            }
+        }
+        if (name == command || std::strcmp(name, command) == 0) {
+            m_histograms[i].Record(micros);
+            return;
+        }
+    }
+    // More distinct commands than slots: dropped
+}
+
+std::string FormatReport(const SyncCounters& sync, const BridgeCounters* bridge)
+{
+    std::string out;
+    char line[256];
+    char a[32];
+    char b[32];
+
+    out += "Sync\r\n";
+    std::snprintf(line, sizeof(line),
+                  "  attempted %llu   unchanged (skipped) %llu   binary (skipped) %llu   failed %llu   retried %llu\r\n",
+                  load(sync.attempted), load(sync.skippedUnchanged), load(sync.skippedBinary),
+                  load(sync.failed), load(sync.retried));
+    out += line;
+    std::snprintf(line, sizeof(line), "  queue depth %lld   changed outside the editor %llu   watched directories %lld\r\n",
+                  static_cast<long long>(sync.queueDepth.load(std::memory_order_relaxed)),
+                  load(sync.externalChanges),
+                  static_cast<long long>(sync.watchedDirectories.load(std::memory_order_relaxed)));
+    out += line;
+
+    out += "\r\nQueue wait             count       p50       p90       p99       max\r\n";
+    for (int i = 0; i < SyncCounters::kPriorityClasses; ++i) {
+        formatHistogram(out, kPriorityNames[i], sync.queueWait[i]);
+    }
+
+    out += "\r\nBridge\r\n";
+    if (!bridge) {
+        out += "  not running\r\n";
+        return out;
+    }
+    formatBytes(a, sizeof(a), load(bridge->bytesSent));
+    formatBytes(b, sizeof(b), load(bridge->bytesReceived));
+    std::snprintf(line, sizeof(line),
+                  "  commands %llu   errors %llu   restarts %llu\r\n  uploaded %s   downloaded %s\r\n",
+                  load(bridge->commands), load(bridge->errors), load(bridge->restarts), a, b);
+    out += line;
+    formatDuration(a, sizeof(a), bridge->recovery.PercentileUs(0.50));
+    formatDuration(b, sizeof(b), bridge->recovery.MaxUs());
+    std::snprintf(line, sizeof(line), "  recovered %llu (p50 %s, max %s)   replayed %llu\r\n",
+                  static_cast<unsigned long long>(bridge->recovery.Count()), a, b, load(bridge->replayed));
+    out += line;
+    std::snprintf(line, sizeof(line), "  timed out %llu   late replies dropped %llu\r\n",
+                  load(bridge->timeouts), load(bridge->lateFrames));
+    out += line;
+
+    out += "\r\nCommand latency        count       p50       p90       p99       max\r\n";
+    for (int i = 0; i < CommandLatencies::kMaxCommands; ++i) {
+        const char* name = bridge->latency.Name(i);
+        if (!name) break;
+        formatHistogram(out, name, bridge->latency.At(i));
+    }
+    out += "  (percentiles are histogram bucket upper bounds)\r\n";
+    return out;
+}
+
+} // namespace Diagnostics
@@ -0,0 +1,111 @@
+// Diagnostics Dialog Implementation
+
+#include "../include/DiagnosticsDialog.h"
+#include "../include/Utf.h"
+#include <cstring>
+
+namespace {
+    const UINT_PTR kRefreshTimer = 1;
+    const UINT kRefreshMs = 1000;
+}
+
+DiagnosticsDialog::DiagnosticsDialog(HINSTANCE hInstance, HWND hwndParent, ReportFn report)
+    : m_hInstance(hInstance), m_hwndParent(hwndParent), m_hwndDialog(NULL), m_hFont(NULL),
+      m_report(std::move(report)) {
+}
+
+void DiagnosticsDialog::Show() {
+    DialogBoxParamW(m_hInstance, MAKEINTRESOURCEW(IDD_DIAGNOSTICS_DIALOG),
+                    m_hwndParent, DialogProc, (LPARAM)this);
+    if (m_hFont) {
+        DeleteObject(m_hFont);
+        m_hFont = NULL;
+    }
+}
+
+INT_PTR CALLBACK DiagnosticsDialog::DialogProc(HWND hwndDlg, UINT uMsg, WPARAM wParam, LPARAM lParam) {
+    DiagnosticsDialog* pDlg = NULL;
+    
+    if (uMsg == WM_INITDIALOG) {
+        pDlg = reinterpret_cast<DiagnosticsDialog*>(lParam);
+        SetWindowLongPtr(hwndDlg, DWLP_USER, lParam);
+        return pDlg->OnInitDialog(hwndDlg);
+    } else {
+        pDlg = reinterpret_cast<DiagnosticsDialog*>(GetWindowLongPtr(hwndDlg, DWLP_USER));
+    }
+    
+    if (pDlg) {
+        switch (uMsg) {
+            case WM_TIMER:
+                if (wParam == kRefreshTimer) {
+                    pDlg->Refresh();
+                }
+                return TRUE;
+            case WM_COMMAND:
+                switch (LOWORD(wParam)) {
+                    case IDC_BUTTON_DIAG_COPY:
+                        pDlg->CopyToClipboard();
+                        return TRUE;
+                    case IDOK:
+                    case IDCANCEL:
+                        KillTimer(hwndDlg, kRefreshTimer);
+                        EndDialog(hwndDlg, LOWORD(wParam));
+                        return TRUE;
+                }
+                break;
+            case WM_CLOSE:
+                KillTimer(hwndDlg, kRefreshTimer);
+                EndDialog(hwndDlg, IDCANCEL);
+                return TRUE;
+        }
+    }
+    
+    return FALSE;
+}
+
+INT_PTR DiagnosticsDialog::OnInitDialog(HWND hwndDlg) {
+    m_hwndDialog = hwndDlg;
+    
+    // Columns in the report line up only in a fixed-pitch font
+    m_hFont = CreateFontW(-12, 0, 0, 0, FW_NORMAL, FALSE, FALSE, FALSE, DEFAULT_CHARSET,
+                          OUT_DEFAULT_PRECIS, CLIP_DEFAULT_PRECIS, DEFAULT_QUALITY,
+                          FIXED_PITCH | FF_MODERN, L"Consolas");
+    if (m_hFont) {
+        SendDlgItemMessageW(hwndDlg, IDC_DIAG_TEXT, WM_SETFONT, (WPARAM)m_hFont, FALSE);
+    }
+    
+    Refresh();
+    SetTimer(hwndDlg, kRefreshTimer, kRefreshMs, NULL);
+    return TRUE;
+}
+
+void DiagnosticsDialog::Refresh() {
+    if (!m_hwndDialog || !m_report) return;
+    
+    // Report text is ASCII
+    std::string report = m_report();
+    std::wstring text = Utf::FromUtf8(report);
+    if (text == m_text) return;     // Avoid flicker and keep the selection
+    m_text = text;
+    SetDlgItemTextW(m_hwndDialog, IDC_DIAG_TEXT, m_text.c_str());
+}
+
+void DiagnosticsDialog::CopyToClipboard() {
+    if (!OpenClipboard(m_hwndDialog)) return;
+    EmptyClipboard();
+    size_t bytes = (m_text.size() + 1) * sizeof(wchar_t);
+    HGLOBAL hMem = GlobalAlloc(GMEM_MOVEABLE, bytes);
+    if (hMem) {
+        void* data = GlobalLock(hMem);
+        if (data) {
+            memcpy(data, m_text.c_str(), bytes);
+            GlobalUnlock(hMem);
+            if (!SetClipboardData(CF_UNICODETEXT, hMem)) {
+                GlobalFree(hMem);
+            }
+        } else {
+            GlobalFree(hMem);
+        }
+    }
+    CloseClipboard();
+}
@@ -0,0 +1,511 @@
+// DirectoryWatcher - notice mapped files changed outside the editor
+
+#include "../include/DirectoryWatcher.h"
+#include "../include/Platform.h"
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <set>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace fs = std::filesystem;
+
+// ---------------------------------------------------------------------------
+// ChangeCoalescer
+
+ChangeCoalescer::ChangeCoalescer(std::chrono::milliseconds delay, std::chrono::milliseconds maxDelay)
+    : m_delay(delay), m_maxDelay(std::max(maxDelay, delay))
+{
+}
+
+void ChangeCoalescer::Add(const std::wstring& path, Clock::time_point now)
+{
+    auto inserted = m_pending.emplace(path, Entry{now, now});
+    if (!inserted.second) {
+        inserted.first->second.last = now;
+    }
+}
+
+ChangeCoalescer::Clock::time_point ChangeCoalescer::DueAt(const Entry& entry) const
+{
+    return std::min(entry.last + m_delay, entry.first + m_maxDelay);
+}
+
+std::vector<std::wstring> ChangeCoalescer::TakeDue(Clock::time_point now)
+{
+    std::vector<std::wstring> due;
+    for (auto it = m_pending.begin(); it != m_pending.end();) {
+        if (DueAt(it->second) <= now) {
+            due.push_back(it->first);
+            it = m_pending.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    std::sort(due.begin(), due.end());
+    return due;
+}
+
+std::optional<ChangeCoalescer::Clock::time_point> ChangeCoalescer::NextDue() const
+{
+    std::optional<Clock::time_point> next;
+    for (const auto& entry : m_pending) {
+        Clock::time_point at = DueAt(entry.second);
+        if (!next || at < *next) next = at;
+    }
+    return next;
+}
+
+// ---------------------------------------------------------------------------
+// Watch planning
+
+namespace {
+    bool samePath(const fs::path& a, const fs::path& b) {
+        std::wstring left = a.lexically_normal().wstring();
+        std::wstring right = b.lexically_normal().wstring();
+        auto trim = [](std::wstring& s) {
+            while (s.size() > 1 && (s.back() == L'/' || s.back() == L'\\')) s.pop_back();
+        };
+        trim(left);
+        trim(right);
+#ifdef _WIN32
+        return CompareStringOrdinal(left.c_str(), -1, right.c_str(), -1, TRUE) == CSTR_EQUAL;
+#else
+        return left == right;
+#endif
+    }
+
+    // True if the tree below directory holds at most limit entries; stops
+    // counting once past it
+    bool smallSubtree(const fs::path& directory, size_t limit) {
+        std::error_code ec;
+        fs::recursive_directory_iterator it(directory, fs::directory_options::skip_permission_denied, ec);
+        size_t entries = 0;
+        for (; !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+            if (++entries > limit) return false;
+        }
+        return true;
+    }
+
+    bool mayWatchRecursively(const fs::path& directory, const std::wstring& home, size_t limit) {
+        if (directory.relative_path().empty()) return false;   // "/" or "C:\\"
+        if (!home.empty() && samePath(directory, home)) return false;
+        return smallSubtree(directory, limit);
+    }
+}
+
+std::vector<WatchRoot> DirectoryWatcher::Plan(const std::vector<std::wstring>& files, bool recursive,
+                                              size_t maxRecursiveEntries)
+{
+    std::set<std::wstring> directories;
+    for (const auto& file : files) {
+        fs::path parent = fs::path(file).parent_path();
+        if (!parent.empty()) directories.insert(parent.wstring());
+    }
+
+    std::wstring home = recursive ? Platform::HomeDirectory() : std::wstring();
+    std::vector<WatchRoot> roots;
+    std::set<std::wstring> kept;    // Recursively watched so far
+    for (const auto& directory : directories) {
+        bool covered = false;
+        if (recursive) {
+            fs::path ancestor = fs::path(directory);
+            for (;;) {
+                fs::path up = ancestor.parent_path();
+                if (up.empty() || up == ancestor) break;
+                if (kept.count(up.wstring())) {
+                    covered = true;
+                    break;
+                }
+                ancestor = up;
+            }
+        }
+        if (covered) continue;
+        bool subtree = recursive && mayWatchRecursively(directory, home, maxRecursiveEntries);
+        if (subtree) kept.insert(directory);
+        roots.push_back({directory, subtree});
+    }
+    return roots;
+}
+
+// ---------------------------------------------------------------------------
+// Watcher thread
+//
+// The thread owns every OS handle and the coalescer. SetRoots only records
+// the wanted roots and wakes it; the thread opens and closes watches
+// itself, so no handle is touched from two threads.
+
+struct DirectoryWatcher::Impl {
+    Callback onChange;
+    ChangeCoalescer coalescer;
+    std::thread thread;
+
+    std::mutex mutex;                       // Guards the fields below
+    std::vector<WatchRoot> wanted;
+    bool rootsChanged = false;
+    bool stop = false;
+
+    std::atomic<size_t> handles{0};
+
+    Impl(Callback callback, std::chrono::milliseconds delay)
+        : onChange(std::move(callback)), coalescer(delay) {}
+
+    bool Open();
+    void Close();
+    void Wake();
+    void Apply(const std::vector<WatchRoot>& roots);
+    // Wait up to timeoutMs (-1 = no limit) and feed events to the coalescer
+    void WaitEvents(int timeoutMs);
+
+    void Loop() {
+        for (;;) {
+            std::optional<std::vector<WatchRoot>> roots;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (stop) break;
+                if (rootsChanged) {
+                    roots = wanted;
+                    rootsChanged = false;
+                }
+            }
+            if (roots) Apply(*roots);
+
+            int timeoutMs = -1;
+            if (auto next = coalescer.NextDue()) {
+                auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    *next - ChangeCoalescer::Clock::now()).count();
+                timeoutMs = static_cast<int>(std::clamp<long long>(wait + 1, 0, 60000));
+            }
+            WaitEvents(timeoutMs);
+
+            for (const auto& path : coalescer.TakeDue(ChangeCoalescer::Clock::now())) {
+                onChange(path);
+            }
+        }
+        Apply({});
+    }
+
+#ifdef _WIN32
+    struct Watch {
+        HANDLE directory = INVALID_HANDLE_VALUE;
+        OVERLAPPED overlapped{};
+        WatchRoot root;
+        alignas(DWORD) BYTE buffer[64 * 1024];
+    };
+
+    HANDLE port = nullptr;
+    // Keyed by completion key; a packet whose key is gone belongs to a
+    // watch already closed and is dropped
+    std::unordered_map<ULONG_PTR, std::unique_ptr<Watch>> watches;
+    ULONG_PTR nextKey = 1;
+
+    bool Arm(Watch& watch) {
+        const DWORD filter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE |
+                             FILE_NOTIFY_CHANGE_SIZE;
+        return ReadDirectoryChangesW(watch.directory, watch.buffer, sizeof(watch.buffer),
+                                     watch.root.recursive ? TRUE : FALSE, filter, nullptr,
+                                     &watch.overlapped, nullptr) != FALSE;
+    }
+
+    void CloseWatch(Watch& watch) {
+        DWORD bytes = 0;
+        if (CancelIoEx(watch.directory, &watch.overlapped)) {
+            // The buffer stays in use until the cancelled read completes
+            GetOverlappedResult(watch.directory, &watch.overlapped, &bytes, TRUE);
+        }
+        CloseHandle(watch.directory);
+    }
+#elif defined(__linux__)
+    int inotify = -1;
+    int wakePipe[2] = {-1, -1};
+    std::unordered_map<int, std::wstring> directories;     // Watch descriptor to directory
+#endif
+};
+
+#ifdef _WIN32
+
+bool DirectoryWatcher::Impl::Open()
+{
+    port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1);
+    return port != nullptr;
+}
+
+void DirectoryWatcher::Impl::Close()
+{
+    if (port) {
+        CloseHandle(port);
+        port = nullptr;
+    }
+}
+
+void DirectoryWatcher::Impl::Wake()
+{
+    PostQueuedCompletionStatus(port, 0, 0, nullptr);
+}
+
+void DirectoryWatcher::Impl::Apply(const std::vector<WatchRoot>& roots)
+{
+    std::set<std::pair<std::wstring, bool>> keep;
+    for (const auto& root : roots) keep.emplace(root.directory, root.recursive);
+
+    for (auto it = watches.begin(); it != watches.end();) {
+        const WatchRoot& current = it->second->root;
+        if (!keep.erase({current.directory, current.recursive})) {
+            CloseWatch(*it->second);
+            it = watches.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    for (const auto& entry : keep) {
+        WatchRoot root{entry.first, entry.second};
+        auto watch = std::make_unique<Watch>();
+        watch->root = root;
+        watch->directory = CreateFileW(root.directory.c_str(), FILE_LIST_DIRECTORY,
+                                       FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                       nullptr, OPEN_EXISTING,
+                                       FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+        if (watch->directory == INVALID_HANDLE_VALUE) continue;
+
+        ULONG_PTR key = nextKey++;
+        if (!CreateIoCompletionPort(watch->directory, port, key, 0) || !Arm(*watch)) {
+            CloseHandle(watch->directory);
+            continue;
+        }
+        watches.emplace(key, std::move(watch));
+    }
+    handles.store(watches.size(), std::memory_order_relaxed);
+}
+
+void DirectoryWatcher::Impl::WaitEvents(int timeoutMs)
+{
+    DWORD bytes = 0;
+    ULONG_PTR key = 0;
+    OVERLAPPED* overlapped = nullptr;
+    BOOL ok = GetQueuedCompletionStatus(port, &bytes, &key, &overlapped,
+                                        timeoutMs < 0 ? INFINITE : static_cast<DWORD>(timeoutMs));
+    if (!overlapped) return;        // Timed out or woken
+
+    auto it = watches.find(key);
+    if (it == watches.end()) return;
+    Watch& watch = *it->second;
+    auto now = ChangeCoalescer::Clock::now();
+
+    if (!ok) {
+        // The directory went away (or was renamed); drop its watch
+        CloseHandle(watch.directory);
+        watches.erase(it);
+        handles.store(watches.size(), std::memory_order_relaxed);
+        return;
+    }
+
+    if (bytes == 0) {
+        // The notification buffer overflowed and events were lost
+        coalescer.Add(watch.root.directory + L"\\", now);
+    } else {
+        const BYTE* cursor = watch.buffer;
+        for (;;) {
+            auto info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(cursor);
+            if (info->Action == FILE_ACTION_ADDED || info->Action == FILE_ACTION_MODIFIED ||
+                info->Action == FILE_ACTION_RENAMED_NEW_NAME) {
+                std::wstring name(info->FileName, info->FileNameLength / sizeof(WCHAR));
+                coalescer.Add(watch.root.directory + L"\\" + name, now);
+            }
+            if (info->NextEntryOffset == 0) break;
+            cursor += info->NextEntryOffset;
+        }
+    }
+
+    if (!Arm(watch)) {
+        CloseHandle(watch.directory);
+        watches.erase(it);
+        handles.store(watches.size(), std::memory_order_relaxed);
+    }
+}
+
+bool DirectoryWatcher::SupportsRecursive()
+{
+    return true;
+}
+
+#elif defined(__linux__)
+
+bool DirectoryWatcher::Impl::Open()
+{
+    inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify < 0) return false;
+    if (pipe2(wakePipe, O_NONBLOCK | O_CLOEXEC) != 0) {
+        close(inotify);
+        inotify = -1;
+        return false;
+    }
+    return true;
+}
+
+void DirectoryWatcher::Impl::Close()
+{
+    for (int* fd : {&inotify, &wakePipe[0], &wakePipe[1]}) {
+        if (*fd >= 0) {
+            close(*fd);
+            *fd = -1;
+        }
+    }
+}
+
+void DirectoryWatcher::Impl::Wake()
+{
+    char byte = 1;
+    ssize_t written = write(wakePipe[1], &byte, 1);
+    (void)written;      // A full pipe already means a pending wake-up
+}
+
+void DirectoryWatcher::Impl::Apply(const std::vector<WatchRoot>& roots)
+{
+    // inotify watches are never recursive; each root is its own directory
+    std::set<std::wstring> keep;
+    for (const auto& root : roots) keep.insert(root.directory);
+
+    for (auto it = directories.begin(); it != directories.end();) {
+        if (!keep.erase(it->second)) {
+            inotify_rm_watch(inotify, it->first);
+            it = directories.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    for (const auto& directory : keep) {
+        int wd = inotify_add_watch(inotify, fs::path(directory).c_str(),
+                                   IN_CLOSE_WRITE | IN_MOVED_TO | IN_ONLYDIR);
+        // Two names for one directory share a descriptor; keep the first
+        if (wd >= 0) directories.emplace(wd, directory);
+    }
+    handles.store(directories.size(), std::memory_order_relaxed);
+}
+
+void DirectoryWatcher::Impl::WaitEvents(int timeoutMs)
+{
+    pollfd fds[2] = {{inotify, POLLIN, 0}, {wakePipe[0], POLLIN, 0}};
+    if (poll(fds, 2, timeoutMs) <= 0) return;
+
+    if (fds[1].revents & POLLIN) {
+        char drain[64];
+        while (read(wakePipe[0], drain, sizeof(drain)) > 0) {}
+    }
+    if (!(fds[0].revents & POLLIN)) return;
+
+    auto now = ChangeCoalescer::Clock::now();
+    alignas(inotify_event) char buffer[16 * 1024];
+    for (;;) {
+        ssize_t length = read(inotify, buffer, sizeof(buffer));
+        if (length <= 0) break;
+        for (char* cursor = buffer; cursor < buffer + length;) {
+            auto event = reinterpret_cast<const inotify_event*>(cursor);
+            cursor += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                for (const auto& entry : directories) coalescer.Add(entry.second + L"/", now);
+                continue;
+            }
+            auto it = directories.find(event->wd);
+            if (it == directories.end()) continue;
+            if (event->mask & IN_IGNORED) {
+                // Directory deleted or unmounted
+                directories.erase(it);
+                handles.store(directories.size(), std::memory_order_relaxed);
+                continue;
+            }
+            if (event->len > 0 && !(event->mask & IN_ISDIR)) {
+                coalescer.Add((fs::path(it->second) / event->name).wstring(), now);
+            }
+        }
+    }
+}
+
+bool DirectoryWatcher::SupportsRecursive()
+{
+    return false;
+}
+
+#else // No watcher on this platform
+
+bool DirectoryWatcher::Impl::Open() { return false; }
+void DirectoryWatcher::Impl::Close() {}
+void DirectoryWatcher::Impl::Wake() {}
+void DirectoryWatcher::Impl::Apply(const std::vector<WatchRoot>&) {}
+void DirectoryWatcher::Impl::WaitEvents(int) {}
+
+bool DirectoryWatcher::SupportsRecursive()
+{
+    return false;
+}
+
+#endif
+
+// ---------------------------------------------------------------------------
+// DirectoryWatcher
+
+DirectoryWatcher::DirectoryWatcher(Callback onChange, std::chrono::milliseconds delay)
+    : m_impl(std::make_unique<Impl>(std::move(onChange), delay))
+{
+}
+
+DirectoryWatcher::~DirectoryWatcher()
+{
+    Stop();
+}
+
+bool DirectoryWatcher::Start()
+{
+    if (m_impl->thread.joinable()) return true;
+    if (!m_impl->Open()) return false;
+    {
+        std::lock_guard<std::mutex> lock(m_impl->mutex);
+        m_impl->stop = false;
+        m_impl->rootsChanged = true;    // Reopen the roots closed by a Stop
+    }
+    m_impl->thread = std::thread([impl = m_impl.get()] { impl->Loop(); });
+    return true;
+}
+
+void DirectoryWatcher::Stop()
+{
+    if (!m_impl->thread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(m_impl->mutex);
+        m_impl->stop = true;
+    }
+    m_impl->Wake();
+    m_impl->thread.join();
+    m_impl->Close();
+}
+
+void DirectoryWatcher::SetRoots(const std::vector<WatchRoot>& roots)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_impl->mutex);
+        m_impl->wanted = roots;
+        m_impl->rootsChanged = true;
+    }
+    if (m_impl->thread.joinable()) {
+        m_impl->Wake();
+    }
+}
+
+size_t DirectoryWatcher::HandleCount() const
+{
+    return m_impl->handles.load(std::memory_order_relaxed);
+}
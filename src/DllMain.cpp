@@ -29,8 +29,11 @@ struct FuncItem {
 
 FuncItem g_funcItems[] = {
     {L"&Sync Now", [](void*) { GoogleKeepSyncPlugin::Instance().OnSyncNow(); }, 0, FALSE, NULL},
+    {L"Sync &All Open", [](void*) { GoogleKeepSyncPlugin::Instance().OnSyncAllOpen(); }, 0, FALSE, NULL},
+    {L"Sync &Folder...", [](void*) { GoogleKeepSyncPlugin::Instance().OnSyncFolder(); }, 0, FALSE, NULL},
     {L"&Toggle Auto-Sync", [](void*) { GoogleKeepSyncPlugin::Instance().OnToggleAutoSync(); }, 0, FALSE, NULL},
     {L"&Configure...", [](void*) { GoogleKeepSyncPlugin::Instance().OnConfigure(); }, 0, FALSE, NULL},
+    {L"&Diagnostics...", [](void*) { GoogleKeepSyncPlugin::Instance().OnDiagnostics(); }, 0, FALSE, NULL},
     {L"&About", [](void*) { GoogleKeepSyncPlugin::Instance().OnAbout(); }, 0, FALSE, NULL}
 };
 
@@ -0,0 +1,147 @@
+// MappingStore - file-to-note mappings and their on-disk format
+
+#include "../include/MappingStore.h"
+#include "../include/Utf.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+
+namespace MappingStore {
+
+namespace {
+    // FILETIME ticks between 1601-01-01 and the Unix epoch
+    const uint64_t kUnixEpochTicks = 116444736000000000ull;
+
+    const char* statusName(SyncStatus status) {
+        switch (status) {
+            case SyncStatus::SYNCED: return "SYNCED";
+            case SyncStatus::FAILED: return "FAILED";
+            case SyncStatus::PENDING: return "PENDING";
+            default: return "DISABLED";
+        }
+    }
+
+    SyncStatus parseStatus(const std::string& name) {
+        if (name == "SYNCED") return SyncStatus::SYNCED;
+        if (name == "FAILED") return SyncStatus::FAILED;
+        if (name == "PENDING") return SyncStatus::PENDING;
+        return SyncStatus::DISABLED;
+    }
+
+    void appendNarrow(std::string& out, const std::wstring& text) {
+        out += Utf::ToUtf8(text);
+    }
+
+    // Lines are UTF-8. Files written before that held one byte per
+    // character in the ANSI code page, taken as Windows-1252 for any line
+    // that is not valid UTF-8.
+    std::wstring widen(const std::string& line, size_t begin, size_t end, bool utf8) {
+        std::string_view field = std::string_view(line).substr(begin, end - begin);
+        return Utf::FromUtf8(utf8 ? std::string(field) : Utf::FromCp1252(field));
+    }
+}
+
+std::string FormatLine(const NoteMapping& mapping)
+{
+    std::string line;
+    appendNarrow(line, mapping.filePath);
+    line += ',';
+    appendNarrow(line, mapping.keepNoteId);
+    line += ',';
+    appendNarrow(line, mapping.lastSyncHash);
+    line += ',';
+    line += statusName(mapping.status);
+    line += ',';
+    line += std::to_string(mapping.lastSyncTime);
+    line += ',';
+    appendNarrow(line, mapping.baseSnapshot);
+    line += ',';
+    for (size_t i = 0; i < mapping.chunkNoteIds.size(); ++i) {
+        if (i > 0) line += ';';
+        appendNarrow(line, mapping.chunkNoteIds[i]);
+        line += ':';
+        if (i < mapping.chunkHashes.size()) {
+            appendNarrow(line, mapping.chunkHashes[i]);
+        }
+    }
+    return line;
+}
+
+bool ParseLine(const std::string& line, NoteMapping& mapping)
+{
+    size_t pos1 = line.find(',');
+    if (pos1 == std::string::npos) return false;
+    size_t pos2 = line.find(',', pos1 + 1);
+    if (pos2 == std::string::npos) return false;
+    size_t pos3 = line.find(',', pos2 + 1);
+    if (pos3 == std::string::npos) return false;
+    size_t pos4 = line.find(',', pos3 + 1);
+    if (pos4 == std::string::npos) return false;
+
+    bool utf8 = Utf::IsValidUtf8(line);
+    mapping = NoteMapping();
+    mapping.filePath = widen(line, 0, pos1, utf8);
+    mapping.keepNoteId = widen(line, pos1 + 1, pos2, utf8);
+    mapping.lastSyncHash = widen(line, pos2 + 1, pos3, utf8);
+    mapping.status = parseStatus(line.substr(pos3 + 1, pos4 - pos3 - 1));
+    mapping.lastSyncTime = std::strtoull(line.c_str() + pos4 + 1, nullptr, 10);
+
+    size_t pos5 = line.find(',', pos4 + 1);
+    if (pos5 == std::string::npos) return true;
+    size_t pos6 = line.find(',', pos5 + 1);
+    size_t snapshotEnd = (pos6 == std::string::npos) ? line.size() : pos6;
+    mapping.baseSnapshot = widen(line, pos5 + 1, snapshotEnd, utf8);
+
+    // Chunk notes: id:hash pairs separated by ';'
+    size_t pos = snapshotEnd;
+    while (pos < line.size()) {
+        size_t start = pos + 1;
+        size_t end = line.find(';', start);
+        if (end == std::string::npos) end = line.size();
+        size_t colon = line.find(':', start);
+        if (colon != std::string::npos && colon < end) {
+            mapping.chunkNoteIds.push_back(widen(line, start, colon, utf8));
+            mapping.chunkHashes.push_back(widen(line, colon + 1, end, utf8));
+        }
+        pos = end;
+    }
+    return true;
+}
+
+bool Load(const std::wstring& path, MappingTable& table)
+{
+    std::ifstream file{std::filesystem::path(path)};
+    if (!file.is_open()) return false;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        NoteMapping mapping;
+        if (ParseLine(line, mapping)) {
+            table[mapping.filePath] = std::move(mapping);
+        }
+    }
+    return true;
+}
+
+bool Save(const std::wstring& path, const MappingTable& table)
+{
+    std::ofstream file(std::filesystem::path(path), std::ios::trunc);
+    if (!file.is_open()) return false;
+
+    for (const auto& pair : table) {
+        file << FormatLine(pair.second) << "\n";
+    }
+    return file.good();
+}
+
+uint64_t Now()
+{
+    auto sinceEpoch = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch());
+    return kUnixEpochTicks + static_cast<uint64_t>(sinceEpoch.count()) * 10;
+}
+
+} // namespace MappingStore
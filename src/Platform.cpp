@@ -0,0 +1,112 @@
+// Platform - the few OS services the sync core needs
+
+#include "../include/Platform.h"
+#include "../include/Utf.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <shlobj.h>
+#pragma comment(lib, "shell32.lib")
+#else
+#include <cstdlib>
+#endif
+
+namespace Platform {
+
+#ifdef _WIN32
+
+std::wstring DataDirectory()
+{
+    wchar_t appDataPath[MAX_PATH];
+    if (FAILED(SHGetFolderPathW(NULL, CSIDL_APPDATA, NULL, 0, appDataPath))) {
+        return L"";
+    }
+    return std::wstring(appDataPath) + L"\\Notepad++";
+}
+
+std::wstring HomeDirectory()
+{
+    wchar_t profilePath[MAX_PATH];
+    if (FAILED(SHGetFolderPathW(NULL, CSIDL_PROFILE, NULL, 0, profilePath))) {
+        return L"";
+    }
+    return profilePath;
+}
+
+std::wstring JoinPath(const std::wstring& dir, const std::wstring& name)
+{
+    if (dir.empty() || dir.back() == L'\\' || dir.back() == L'/') return dir + name;
+    return dir + L"\\" + name;
+}
+
+std::wstring ExpandEnvironment(const std::wstring& text)
+{
+    DWORD needed = ExpandEnvironmentStringsW(text.c_str(), NULL, 0);
+    if (needed == 0) return text;
+    std::wstring expanded(needed, L'\0');
+    if (ExpandEnvironmentStringsW(text.c_str(), &expanded[0], needed) == 0) return text;
+    expanded.resize(needed - 1);    // Drop the terminator
+    return expanded;
+}
+
+#else
+
+namespace {
+    // Environment values are taken to be UTF-8
+    std::wstring widen(const char* s) {
+        return Utf::FromUtf8(s);
+    }
+}
+
+std::wstring DataDirectory()
+{
+    const char* config = std::getenv("XDG_CONFIG_HOME");
+    if (config && *config) return widen(config) + L"/notepad++";
+    const char* home = std::getenv("HOME");
+    if (home && *home) return widen(home) + L"/.config/notepad++";
+    return L"";
+}
+
+std::wstring HomeDirectory()
+{
+    const char* home = std::getenv("HOME");
+    return home && *home ? widen(home) : L"";
+}
+
+std::wstring JoinPath(const std::wstring& dir, const std::wstring& name)
+{
+    if (dir.empty() || dir.back() == L'/') return dir + name;
+    return dir + L"/" + name;
+}
+
+std::wstring ExpandEnvironment(const std::wstring& text)
+{
+    std::wstring out;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t open = text.find(L'%', pos);
+        size_t close = open == std::wstring::npos ? open : text.find(L'%', open + 1);
+        if (close == std::wstring::npos) break;
+
+        std::wstring wideName = text.substr(open + 1, close - open - 1);
+        std::string name = Utf::ToUtf8(wideName);
+        const char* value = name.empty() ? nullptr : std::getenv(name.c_str());
+        // %TEMP% is the usual reference in the ini; POSIX spells it TMPDIR
+        if (!value && name == "TEMP") value = std::getenv("TMPDIR");
+        if (!value && name == "TEMP") value = "/tmp";
+
+        out.append(text, pos, open - pos);
+        if (value) {
+            out += widen(value);
+        } else {
+            out.append(text, open, close - open + 1);
+        }
+        pos = close + 1;
+    }
+    out.append(text, pos, std::wstring::npos);
+    return out;
+}
+
+#endif
+
+} // namespace Platform
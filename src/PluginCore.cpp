@@ -3,11 +3,26 @@
 
 #include "../include/PluginCore.h"
 #include "../include/ConfigDialog.h"
-#include <wincrypt.h>
+#include "../include/DiagnosticsDialog.h"
+#include "../include/SyncProgressDialog.h"
+#include "../include/Compression.h"
+#include "../include/TextMerge.h"
+#include "../include/Chunker.h"
+#include "../include/Trace.h"
+#include "../include/Diagnostics.h"
+#include "../include/ContentHash.h"
+#include "../include/Platform.h"
+#include "../include/BulkImport.h"
+#include "../include/ContentSniff.h"
+#include "../include/Utf.h"
+#include "Json.h"
 #include <sstream>
 #include <fstream>
 #include <shlobj.h>
-#include <iomanip>
+#include <filesystem>
+#include <algorithm>
+#include <unordered_set>
+#include <cwchar>
 
 #pragma comment(lib, "shell32.lib")
 
@@ -19,45 +34,16 @@ GoogleKeepSyncPlugin& GoogleKeepSyncPlugin::Instance() {
 
 // Helper function to extract value from JSON response
 std::string extractJsonValue(const std::string& json, const std::string& key) {
-    std::string search = "\"" + key + "\"";
-    size_t pos = json.find(search);
-    if (pos == std::string::npos) {
-        // Try with : delimiter
-        search = "\"" + key + "\":";
-        pos = json.find(search);
-        if (pos == std::string::npos) return "";
-    }
-    
-    size_t valuePos = json.find(":", pos);
-    if (valuePos == std::string::npos) return "";
-    valuePos++;
-    
-    // Skip whitespace
-    while (valuePos < json.size() && json[valuePos] == ' ') valuePos++;
-    if (valuePos >= json.size()) return "";
-    
-    // Check for string value
-    if (json[valuePos] == '"') {
-        valuePos++;
-        size_t endPos = json.find("\"", valuePos);
-        if (endPos == std::string::npos) return "";
-        return json.substr(valuePos, endPos - valuePos);
-    }
-    
-    // Check for numeric/boolean value
-    size_t endPos = valuePos;
-    while (endPos < json.size() && json[endPos] != ',' && json[endPos] != '}' && json[endPos] != ']') {
-        endPos++;
-    }
-    std::string value = json.substr(valuePos, endPos - valuePos);
-    // Trim whitespace
-    while (!value.empty() && value[0] == ' ') value.erase(0, 1);
-    while (!value.empty() && value[value.size()-1] == ' ') value.erase(value.size()-1);
-    return value;
+    return NppGoogleKeepSync::Json::ExtractValue(json, key);
 }
 
 // FileSyncManager implementation
-FileSyncManager::FileSyncManager() : m_autoSyncEnabled(TRUE) {}
+
+// Longest a bulk import waits between batches for queued syncs to drain
+static const std::chrono::milliseconds kBulkMaxYield(1500);
+
+FileSyncManager::FileSyncManager()
+    : m_autoSyncEnabled(TRUE), m_scheduler(std::chrono::seconds(2), m_counters.queueWait) {}
 
 FileSyncManager::~FileSyncManager() {
     Shutdown();
@@ -66,9 +52,28 @@ FileSyncManager::~FileSyncManager() {
 BOOL FileSyncManager::Initialize(const PluginConfig& config) {
     m_config = config;
     m_autoSyncEnabled = config.autoSyncEnabled;
+    m_rules = SyncRules::Compile(config.excludedExtensions, config.excludePatterns, config.includePatterns);
     
-    // Initialize Python bridge for Google Keep
+    // Runs inside setInfo, before Notepad++ shows a window: nothing here
+    // touches the disk, Python or the network. The queue thread starts the
+    // bridge (see Start) and syncs queued meanwhile wait in m_scheduler.
     m_keepBridge = std::make_unique<NppGoogleKeepSync::PythonBridge>();
+    m_queueThread = std::thread([this] { RunSyncQueue(); });
+    return TRUE;
+}
+
+BOOL FileSyncManager::EnsureStarted() {
+    std::call_once(m_startOnce, [this] { m_started = Start(); });
+    return m_started;
+}
+
+BOOL FileSyncManager::Start() {
+    if (m_stopping) return FALSE;
+    
+    if (m_config.debugLogging) {
+        Trace::Enable(m_config.logFilePath);
+    }
+    TRACE_SCOPE("startup");
     
     // Get path to keep_bridge.py relative to plugin DLL
     wchar_t pluginPath[MAX_PATH];
@@ -81,32 +86,98 @@ BOOL FileSyncManager::Initialize(const PluginConfig& config) {
     
     std::wstring pythonScript = pluginDir + L"\\keep_bridge.py";
     
-    // Debug: Show path being used (remove after debugging)
-    // MessageBoxW(NULL, pythonScript.c_str(), L"Python Script Path", MB_OK);
+    // Load mappings first: they do not need the bridge, and a failed start
+    // must not leave Shutdown saving an empty table over them
+    LoadMappings();
     
-    // Initialize Python bridge
-    if (!m_keepBridge->Initialize(L"python", pythonScript)) {
-        std::wstring error = L"Failed to initialize Python bridge:\n" + 
-                            std::wstring(m_keepBridge->GetLastError().begin(), m_keepBridge->GetLastError().end()) +
-                            L"\n\nMake sure Python is in PATH and keep_bridge.py is in the plugin folder.";
-        MessageBoxW(NULL, error.c_str(), L"Python Bridge Error", MB_OK | MB_ICONERROR);
-        return FALSE;
+    // Shutdown aborts the bridge, failing whichever step below is running;
+    // each step checks m_stopping so none of the later ones starts
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_syncMutex);
+        if (m_stopping) return FALSE;
+        
+        // Initialize Python bridge
+        if (!m_keepBridge->Initialize(L"python", pythonScript)) {
+            if (m_stopping) return FALSE;
+            std::wstring error = L"Failed to initialize Python bridge:\n" + 
+                                Utf::FromUtf8(m_keepBridge->GetLastError()) +
+                                L"\n\nMake sure Python is in PATH and keep_bridge.py is in the plugin folder.";
+            MessageBoxW(NULL, error.c_str(), L"Python Bridge Error", MB_OK | MB_ICONERROR);
+            return FALSE;
+        }
+        
+        // A bridge that dies is restarted by the next command or the watchdog
+        NppGoogleKeepSync::RestartPolicy restart;
+        restart.enabled = true;
+        m_keepBridge->SetRestartPolicy(restart);
+        
+        // Deadlines, before the first command: the default, then
+        // "command:seconds" overrides. Malformed entries are skipped.
+        if (m_config.apiTimeoutSeconds > 0) {
+            m_keepBridge->SetCommandTimeout("", std::chrono::seconds(m_config.apiTimeoutSeconds));
+        }
+        for (const auto& entry : m_config.commandTimeouts) {
+            size_t colon = entry.find(L':');
+            if (colon == std::wstring::npos) continue;
+            std::wstring name = entry.substr(0, colon);
+            name.erase(0, name.find_first_not_of(L' '));
+            name.erase(name.find_last_not_of(L' ') + 1);
+            unsigned long seconds = std::wcstoul(entry.c_str() + colon + 1, nullptr, 10);
+            if (!name.empty() && seconds > 0) {
+                m_keepBridge->SetCommandTimeout(Utf::ToUtf8(name), std::chrono::seconds(seconds));
+            }
+        }
+        
+        // Serve note list/get reads from the local mirror
+        std::wstring dataDir = Platform::DataDirectory();
+        if (!dataDir.empty()) {
+            m_keepBridge->EnableMirror(Platform::JoinPath(dataDir, L"GoogleKeepSync.mirror"),
+                                       std::chrono::seconds(m_config.mirrorMaxAgeSeconds));
+        }
+        
+        // Auto-login with stored credentials if available
+        if (!m_stopping && !m_config.email.empty() && !m_config.appPassword.empty()) {
+            m_keepBridge->Login(Utf::ToUtf8(m_config.email), Utf::ToUtf8(m_config.appPassword));
+        }
     }
+    if (m_stopping) return FALSE;
     
-    // Auto-login with stored credentials if available
-    if (!m_config.email.empty() && !m_config.appPassword.empty()) {
-        std::string email(m_config.email.begin(), m_config.email.end());
-        std::string password(m_config.appPassword.begin(), m_config.appPassword.end());
-        m_keepBridge->Login(email, password);
+    if (m_config.bridgeWatchdogSeconds > 0) {
+        m_watchdog = std::make_unique<NppGoogleKeepSync::BridgeWatchdog>(
+            *m_keepBridge, m_syncMutex, std::chrono::seconds(m_config.bridgeWatchdogSeconds));
+        m_watchdog->Start();
     }
     
-    // Load mappings
-    LoadMappings();
-    
+    if (m_config.watchMappedFiles) {
+        m_watcher = std::make_unique<DirectoryWatcher>(
+            [this](const std::wstring& path) { OnExternalChange(path); },
+            std::chrono::milliseconds(m_config.watchDelayMs));
+        RefreshWatches();
+        m_watcher->Start();
+    }
     return TRUE;
 }
 
 void FileSyncManager::Shutdown() {
+    // The queue thread may be starting the bridge; it finishes first, so
+    // the watchdog and watcher are not created behind our back. Aborting
+    // the bridge fails the start, sign-in or sync it is waiting on, which
+    // could otherwise hold Notepad++'s exit for a minute or more.
+    m_stopping = true;
+    if (m_queueThread.joinable()) {
+        m_scheduler.Stop();
+        if (m_keepBridge) {
+            m_keepBridge->Abort();
+        }
+        m_queueThread.join();
+    }
+    m_watchdog.reset();
+    m_watcher.reset();
+    
+    if (Trace::Enabled()) {
+        Trace::Flush();
+        Trace::Disable();
+    }
     SaveMappings();
     if (m_keepBridge) {
         m_keepBridge->Shutdown();
@@ -123,73 +194,81 @@ BOOL FileSyncManager::IsAutoSyncEnabled() const {
 }
 
 std::wstring FileSyncManager::CalculateFileHash(const std::wstring& filePath) {
-    // Read file and calculate MD5 hash
-    std::ifstream file(filePath, std::ios::binary);
-    if (!file) return L"";
-    
-    HCRYPTPROV hProv;
-    if (!CryptAcquireContext(&hProv, NULL, NULL, PROV_RSA_FULL, CRYPT_VERIFYCONTEXT)) {
-        return L"";
-    }
-    
-    HCRYPTHASH hHash;
-    if (!CryptCreateHash(hProv, CALG_MD5, 0, 0, &hHash)) {
-        CryptReleaseContext(hProv, 0);
-        return L"";
-    }
-    
-    std::vector<BYTE> buffer(8192);
-    while (file.good()) {
-        file.read((char*)buffer.data(), buffer.size());
-        if (file.gcount() > 0) {
-            CryptHashData(hHash, buffer.data(), (DWORD)file.gcount(), 0);
-        }
-    }
-    
-    BYTE hash[16];
-    DWORD hashLen = 16;
-    BOOL result = CryptGetHashParam(hHash, HP_HASHVAL, hash, &hashLen, 0);
-    
-    std::wostringstream hashStr;
-    if (result) {
-        for (DWORD i = 0; i < hashLen; i++) {
-            hashStr << std::hex << std::setw(2) << std::setfill(L'0') << hash[i];
-        }
-    }
-    
-    CryptDestroyHash(hHash);
-    CryptReleaseContext(hProv, 0);
-    
-    return hashStr.str();
+    TRACE_SCOPE("hash");
+    return ContentHash::HashFile(filePath);
 }
 
-std::wstring FileSyncManager::ReadFileContents(const std::wstring& filePath) {
-    std::wifstream file(filePath);
-    if (!file) return L"";
+std::string FileSyncManager::ReadFileContents(const std::wstring& filePath) {
+    TRACE_SCOPE("read");
+    std::ifstream file(std::filesystem::path(filePath), std::ios::binary);
+    if (!file) return "";
     
-    std::wostringstream content;
+    std::ostringstream content;
     content << file.rdbuf();
     return content.str();
 }
 
-BOOL FileSyncManager::SyncFile(const std::wstring& filePath, BOOL force) {
-    if (!force && !ShouldSync(filePath)) {
-        return FALSE;
+BOOL FileSyncManager::WriteFileContents(const std::wstring& filePath, const std::string& content) {
+    std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+    if (!file) return FALSE;
+    file.write(content.data(), content.size());
+    return file.good() ? TRUE : FALSE;
+}
+
+std::string FileSyncManager::ToCrlf(const std::string& text) {
+    std::string out;
+    out.reserve(text.size() + text.size() / 32);
+    for (char c : text) {
+        if (c == '\n') out += '\r';
+        out += c;
     }
+    return out;
+}
+
+BOOL FileSyncManager::LoadBaseSnapshot(const NoteMapping& mapping, std::string& content) {
+    if (mapping.baseSnapshot.empty() || m_snapshotDir.empty()) return FALSE;
     
-    if (!m_keepBridge) {
-        return FALSE;
-    }
+    std::ifstream file(Platform::JoinPath(m_snapshotDir, mapping.baseSnapshot), std::ios::binary);
+    if (!file) return FALSE;
+    std::ostringstream compressed;
+    compressed << file.rdbuf();
+    return Compression::Decompress(compressed.str(), content) ? TRUE : FALSE;
+}
+
+BOOL FileSyncManager::SaveBaseSnapshot(NoteMapping& mapping, const std::string& content) {
+    if (mapping.keepNoteId.empty() || m_snapshotDir.empty()) return FALSE;
+    
+    std::error_code ec;
+    std::filesystem::create_directories(m_snapshotDir, ec);
+    
+    std::wstring name = mapping.keepNoteId + L".base";
+    std::ofstream file(Platform::JoinPath(m_snapshotDir, name), std::ios::binary | std::ios::trunc);
+    if (!file) return FALSE;
+    std::string compressed = Compression::Compress(content);
+    file.write(compressed.data(), compressed.size());
+    if (!file.good()) return FALSE;
+    
+    mapping.baseSnapshot = name;
+    return TRUE;
+}
+
+BOOL FileSyncManager::EnsureAuthenticated() {
+    // Not under m_syncMutex: Start takes it while the bridge comes up
+    if (!EnsureStarted()) return FALSE;
+    
+    std::lock_guard<std::recursive_mutex> lock(m_syncMutex);
+    if (!m_keepBridge) return FALSE;
     
     // Login with stored credentials if not authenticated
     auto status = m_keepBridge->GetStatus();
-    if (!status.success || status.raw_json.find("\"authenticated\":true") == std::string::npos) {
+    // An aborted bridge fails everything; no one is left to read a message box
+    if (m_stopping) return FALSE;
+    if (!status.success || !NppGoogleKeepSync::Json::ExtractBool(status.raw_json, "authenticated")) {
         // Try to login with stored credentials
         if (!m_config.email.empty() && !m_config.appPassword.empty()) {
-            std::string email(m_config.email.begin(), m_config.email.end());
-            std::string password(m_config.appPassword.begin(), m_config.appPassword.end());
-            auto loginResult = m_keepBridge->Login(email, password);
+            auto loginResult = m_keepBridge->Login(Utf::ToUtf8(m_config.email), Utf::ToUtf8(m_config.appPassword));
             if (!loginResult.success) {
+                if (m_stopping) return FALSE;
                 MessageBoxW(NULL, L"Failed to authenticate with Google Keep. Please check your credentials.", L"Sync Failed", MB_OK | MB_ICONWARNING);
                 return FALSE;
             }
@@ -198,10 +277,27 @@ BOOL FileSyncManager::SyncFile(const std::wstring& filePath, BOOL force) {
             return FALSE;
         }
     }
+    return TRUE;
+}
+
+NppGoogleKeepSync::BridgeResult FileSyncManager::Login(const std::string& email, const std::string& appPassword) {
+    NppGoogleKeepSync::BridgeResult result;
+    // Not under m_syncMutex, as in EnsureAuthenticated
+    BOOL started = EnsureStarted();
     
-    std::wstring content = ReadFileContents(filePath);
-    if (content.empty()) return FALSE;
-    
+    std::lock_guard<std::recursive_mutex> lock(m_syncMutex);
+    if (!m_keepBridge) {
+        result.error_message = "Sync manager not initialized";
+        return result;
+    }
+    if (!started) {
+        result.error_message = "Python bridge is not running: " + m_keepBridge->GetLastError();
+        return result;
+    }
+    return m_keepBridge->Login(email, appPassword);
+}
+
+std::string FileSyncManager::NoteTitle(const std::wstring& filePath) {
     // Generate title from filename
     size_t lastSlash = filePath.find_last_of(L"/\\");
     size_t lastDot = filePath.find_last_of(L".");
@@ -210,64 +306,519 @@ BOOL FileSyncManager::SyncFile(const std::wstring& filePath, BOOL force) {
     
     // Create note title with prefix
     std::wstring keepTitle = L"Notepad++ Sync: " + title;
+    return Utf::ToUtf8(keepTitle);
+}
+
+BOOL FileSyncManager::SyncFile(const std::wstring& filePath, BOOL force) {
+    std::lock_guard<std::recursive_mutex> lock(m_syncMutex);
+    Diagnostics::Add(m_counters.attempted);
+    if (GetMapping(filePath).status == SyncStatus::FAILED) {
+        Diagnostics::Add(m_counters.retried);
+    }
+    
+    BOOL result;
+    m_counters.queueDepth.fetch_add(1, std::memory_order_relaxed);
+    {
+        TRACE_SCOPE("SyncFile");
+        result = SyncFileStages(filePath, force);
+    }
+    m_counters.queueDepth.fetch_sub(1, std::memory_order_relaxed);
+    if (Trace::Enabled()) {
+        Trace::Flush();
+    }
+    if (m_watchesStale.exchange(false)) {
+        RefreshWatches();
+    }
+    return result;
+}
+
+BOOL FileSyncManager::SyncFileStages(const std::wstring& filePath, BOOL force) {
+    if (!force && !ShouldSync(filePath)) {
+        return FALSE;
+    }
+    
+    if (!EnsureAuthenticated()) {
+        Diagnostics::Add(m_counters.failed);
+        return FALSE;
+    }
+    
+    std::string content = ReadFileContents(filePath);
+    if (content.empty()) return FALSE;
+    
+    // Forced syncs skip ShouldSync, so binary files are also caught here
+    ContentSniff::Format format = ContentSniff::Sniff(content);
+    if (m_config.onlyTextFiles && !ContentSniff::IsText(format)) {
+        Diagnostics::Add(m_counters.skippedBinary);
+        return FALSE;
+    }
     
     NoteMapping mapping = GetMapping(filePath);
     
-    // Convert to UTF-8 for Python bridge
-    std::string utf8Title(keepTitle.begin(), keepTitle.end());
-    std::string utf8Content(content.begin(), content.end());
+    // UTF-8 for the Python bridge
+    std::string utf8Title = NoteTitle(filePath);
+    std::string utf8Content;
+    {
+        TRACE_SCOPE("transcode");
+        utf8Content = ContentSniff::ToUtf8(std::move(content), format);
+    }
     
     BOOL result = FALSE;
+    std::string uploadContent = utf8Content;
     
-    if (mapping.keepNoteId.empty()) {
-        // Create NEW note on first sync
-        auto createResult = m_keepBridge->CreateNote(utf8Title, utf8Content);
+    // Bring the mirror up to date before overwriting an existing note
+    if (!mapping.keepNoteId.empty()) {
+        PullRemoteChanges();
+    }
+    
+    size_t maxBytes = static_cast<size_t>(m_config.maxFileSizeKB) * 1024;
+    if (maxBytes > 0 && (utf8Content.size() > maxBytes || !mapping.chunkNoteIds.empty())) {
+        // Once chunked, a file stays chunked even if it shrinks
+        result = SyncChunkedFile(mapping, utf8Title, utf8Content);
+    } else if (mapping.keepNoteId.empty()) {
+        // Create NEW note on first sync; Keep stores LF like every other upload
+        auto createResult = m_keepBridge->CreateNote(utf8Title, TextMerge::NormalizeNewlines(uploadContent));
         if (createResult.success) {
             // Extract note ID from response
             std::string id = extractJsonValue(createResult.raw_json, "id");
             if (!id.empty()) {
-                mapping.keepNoteId = std::wstring(id.begin(), id.end());
+                mapping.keepNoteId = Utf::FromUtf8(id);
             }
             result = TRUE;
         }
     } else {
         // Update EXISTING note on subsequent syncs
-        std::string noteId(mapping.keepNoteId.begin(), mapping.keepNoteId.end());
-        auto updateResult = m_keepBridge->UpdateNote(noteId, utf8Title, utf8Content);
+        std::string noteId = Utf::ToUtf8(mapping.keepNoteId);
+        
+        // Text Keep currently holds, if known, so only a diff is sent
+        std::optional<std::string> keepText;
+        
+        // If the note was also edited in Keep since the last sync, merge
+        // both sides against the last synced text instead of overwriting
+        std::string base;
+        NppGoogleKeepSync::KeepNote remote;
+        bool haveBase = LoadBaseSnapshot(mapping, base) != FALSE;
+        bool haveRemote = m_keepBridge->GetNoteCached(noteId, remote);
+        if (haveRemote) {
+            keepText = remote.text;
+        } else if (haveBase) {
+            keepText = base;
+        }
+        if (haveBase && haveRemote) {
+            std::string localText = TextMerge::NormalizeNewlines(utf8Content);
+            std::string remoteText = TextMerge::NormalizeNewlines(remote.text);
+            if (remoteText != base && remoteText != localText) {
+                auto merged = TextMerge::Merge(base, localText, remoteText);
+                uploadContent = merged.text;
+                if (utf8Content.find("\r\n") != std::string::npos) {
+                    uploadContent = ToCrlf(merged.text);
+                }
+                if (uploadContent != utf8Content) {
+                    WriteFileContents(filePath, ContentSniff::FromUtf8(uploadContent, format));
+                }
+                if (merged.conflicts > 0) {
+                    std::wstring msg = L"The note was edited in Google Keep since the last sync.\n\n" +
+                                       std::to_wstring(merged.conflicts) +
+                                       L" conflicting region(s) were marked with <<<<<<< / >>>>>>> in the file and the note.";
+                    MessageBoxW(NULL, msg.c_str(), L"Sync Merge Conflict", MB_OK | MB_ICONWARNING);
+                }
+            }
+        }
+        
+        std::string keepContent = TextMerge::NormalizeNewlines(uploadContent);
+        auto updateResult = keepText
+            ? m_keepBridge->PatchNote(noteId, *keepText, keepContent, utf8Title)
+            : m_keepBridge->UpdateNote(noteId, utf8Title, keepContent);
         result = updateResult.success;
     }
     
     if (result) {
+        if (mapping.chunkNoteIds.empty()) {
+            SaveBaseSnapshot(mapping, TextMerge::NormalizeNewlines(uploadContent));
+        }
         mapping.filePath = filePath;
         mapping.lastSyncHash = CalculateFileHash(filePath);
-        GetSystemTimeAsFileTime(&mapping.lastSyncTime);
+        mapping.lastSyncTime = MappingStore::Now();
         mapping.status = SyncStatus::SYNCED;
         SetMapping(filePath, mapping);
     } else {
+        // Remembered so the next attempt counts as a retry
+        Diagnostics::Add(m_counters.failed);
+        mapping.filePath = filePath;
         mapping.status = SyncStatus::FAILED;
+        SetMapping(filePath, mapping);
     }
     
     return result;
 }
 
+BOOL FileSyncManager::SyncChunkedFile(NoteMapping& mapping, const std::string& title, const std::string& content) {
+    std::string text = TextMerge::NormalizeNewlines(content);
+    auto chunks = Chunker::Split(text, static_cast<size_t>(m_config.maxFileSizeKB) * 1024);
+    
+    auto chunkTitle = [&](size_t index, size_t count) {
+        if (count <= 1) return title;
+        return title + " (" + std::to_string(index + 1) + "/" + std::to_string(count) + ")";
+    };
+    
+    // Notes from the previous sync; a file that used to fit in one note
+    // reuses that note for its first new chunk
+    std::vector<std::wstring> oldIds = mapping.chunkNoteIds;
+    std::vector<std::wstring> oldHashes = mapping.chunkHashes;
+    if (oldIds.empty() && !mapping.keepNoteId.empty()) {
+        oldIds.push_back(mapping.keepNoteId);
+        oldHashes.push_back(L"");
+    }
+    oldHashes.resize(oldIds.size());
+    
+    // Chunks whose content is unchanged keep their note, wherever they moved to
+    std::unordered_multimap<std::wstring, size_t> byHash;
+    for (size_t i = 0; i < oldIds.size(); ++i) {
+        if (!oldHashes[i].empty()) byHash.emplace(oldHashes[i], i);
+    }
+    std::vector<bool> oldUsed(oldIds.size(), false);
+    std::vector<size_t> source(chunks.size(), SIZE_MAX);
+    std::vector<std::wstring> hashes(chunks.size());
+    for (size_t j = 0; j < chunks.size(); ++j) {
+        hashes[j] = Chunker::HashToString(chunks[j].hash);
+        auto range = byHash.equal_range(hashes[j]);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (!oldUsed[it->second]) {
+                oldUsed[it->second] = true;
+                source[j] = it->second;
+                break;
+            }
+        }
+    }
+    
+    // Changed chunks overwrite leftover notes before any new note is created
+    std::vector<NppGoogleKeepSync::BatchOp> ops;
+    std::vector<size_t> opChunk;
+    size_t nextFree = 0;
+    for (size_t j = 0; j < chunks.size(); ++j) {
+        NppGoogleKeepSync::BatchOp op;
+        std::string newTitle = chunkTitle(j, chunks.size());
+        if (source[j] != SIZE_MAX) {
+            // Unchanged content; only renumber if its position moved
+            if (chunkTitle(source[j], oldIds.size()) == newTitle) continue;
+            op.kind = NppGoogleKeepSync::BatchOp::Kind::Update;
+            op.id = Utf::ToUtf8(oldIds[source[j]]);
+        } else {
+            while (nextFree < oldIds.size() && oldUsed[nextFree]) nextFree++;
+            if (nextFree < oldIds.size()) {
+                oldUsed[nextFree] = true;
+                source[j] = nextFree;
+                op.kind = NppGoogleKeepSync::BatchOp::Kind::Update;
+                op.id = Utf::ToUtf8(oldIds[nextFree]);
+            } else {
+                op.kind = NppGoogleKeepSync::BatchOp::Kind::Create;
+            }
+            op.text = text.substr(chunks[j].offset, chunks[j].length);
+        }
+        op.title = newTitle;
+        ops.push_back(std::move(op));
+        opChunk.push_back(j);
+    }
+    
+    // Notes no longer needed are archived
+    for (size_t i = 0; i < oldIds.size(); ++i) {
+        if (oldUsed[i]) continue;
+        NppGoogleKeepSync::BatchOp op;
+        op.kind = NppGoogleKeepSync::BatchOp::Kind::Delete;
+        op.id = Utf::ToUtf8(oldIds[i]);
+        ops.push_back(std::move(op));
+        opChunk.push_back(SIZE_MAX);
+    }
+    
+    std::vector<std::wstring> ids(chunks.size());
+    for (size_t j = 0; j < chunks.size(); ++j) {
+        if (source[j] != SIZE_MAX) ids[j] = oldIds[source[j]];
+    }
+    
+    if (!ops.empty()) {
+        std::vector<std::string> resultIds;
+        auto batchResult = m_keepBridge->Batch(ops, resultIds);
+        if (!batchResult.success || resultIds.size() != ops.size()) {
+            return FALSE;
+        }
+        for (size_t k = 0; k < ops.size(); ++k) {
+            if (opChunk[k] != SIZE_MAX) {
+                ids[opChunk[k]] = Utf::FromUtf8(resultIds[k]);
+            }
+        }
+    }
+    
+    mapping.chunkNoteIds = ids;
+    mapping.chunkHashes = hashes;
+    mapping.keepNoteId = ids.empty() ? std::wstring() : ids.front();
+    return TRUE;
+}
+
+BOOL FileSyncManager::UploadBatch(std::vector<BulkImport::Item>& batch) {
+    std::lock_guard<std::recursive_mutex> lock(m_syncMutex);
+    TRACE_SCOPE("upload_batch");
+    size_t maxBytes = static_cast<size_t>(m_config.maxFileSizeKB) * 1024;
+    
+    // Mirror up to date before deciding which notes changed in Keep
+    bool anyExisting = std::any_of(batch.begin(), batch.end(), [this](const BulkImport::Item& item) {
+        return !GetMapping(item.path).keepNoteId.empty();
+    });
+    if (anyExisting) {
+        PullRemoteChanges();
+    }
+    
+    // New files that fit in one note are created, and notes Keep has not
+    // changed since the last sync are overwritten, all in one batch. Notes
+    // that need a merge and files over the size limit go through the
+    // single-file path.
+    std::vector<NppGoogleKeepSync::BatchOp> ops;
+    std::vector<size_t> opItem;
+    std::vector<size_t> single;
+    for (size_t i = 0; i < batch.size(); ++i) {
+        Diagnostics::Add(m_counters.attempted);
+        BulkImport::Item& item = batch[i];
+        {
+            TRACE_SCOPE("transcode");
+            item.content = ContentSniff::ToUtf8(std::move(item.content), item.format);
+        }
+        NoteMapping mapping = GetMapping(item.path);
+        if ((maxBytes > 0 && item.content.size() > maxBytes) || !mapping.chunkNoteIds.empty()) {
+            single.push_back(i);
+            continue;
+        }
+        
+        NppGoogleKeepSync::BatchOp op;
+        op.title = NoteTitle(item.path);
+        if (mapping.keepNoteId.empty()) {
+            op.kind = NppGoogleKeepSync::BatchOp::Kind::Create;
+            op.text = item.content;
+        } else {
+            std::string noteId = Utf::ToUtf8(mapping.keepNoteId);
+            std::string base;
+            NppGoogleKeepSync::KeepNote remote;
+            if (!LoadBaseSnapshot(mapping, base) || !m_keepBridge->GetNoteCached(noteId, remote) ||
+                TextMerge::NormalizeNewlines(remote.text) != base) {
+                single.push_back(i);
+                continue;
+            }
+            op.kind = NppGoogleKeepSync::BatchOp::Kind::Update;
+            op.id = noteId;
+            op.text = TextMerge::NormalizeNewlines(item.content);
+        }
+        ops.push_back(std::move(op));
+        opItem.push_back(i);
+    }
+    
+    if (!ops.empty()) {
+        std::vector<std::string> ids;
+        auto batchResult = m_keepBridge->Batch(ops, ids);
+        if (!m_keepBridge->IsConnected()) {
+            return FALSE;
+        }
+        bool applied = batchResult.success && ids.size() == ops.size();
+        for (size_t k = 0; k < ops.size(); ++k) {
+            BulkImport::Item& item = batch[opItem[k]];
+            NoteMapping mapping = GetMapping(item.path);
+            mapping.filePath = item.path;
+            if (applied) {
+                mapping.keepNoteId = Utf::FromUtf8(ids[k]);
+                SaveBaseSnapshot(mapping, TextMerge::NormalizeNewlines(item.content));
+                mapping.lastSyncHash = item.hash;
+                mapping.lastSyncTime = MappingStore::Now();
+                mapping.status = SyncStatus::SYNCED;
+                item.ok = true;
+            } else {
+                Diagnostics::Add(m_counters.failed);
+                mapping.status = SyncStatus::FAILED;
+            }
+            SetMapping(item.path, mapping);
+        }
+    }
+    
+    for (size_t i : single) {
+        batch[i].ok = SyncFileStages(batch[i].path, TRUE) != FALSE;
+    }
+    return TRUE;
+}
+
+BOOL FileSyncManager::SyncFolder(const std::wstring& root, BulkImport::Progress& progress) {
+    if (!EnsureAuthenticated()) {
+        progress.done = true;
+        return FALSE;
+    }
+    
+    BulkImport::Options options;
+    options.rules = m_rules;
+    options.onlyText = m_config.onlyTextFiles != FALSE;
+    auto files = BulkImport::Enumerate(root, options, progress);
+    return RunBulkSync(files, options, progress);
+}
+
+BOOL FileSyncManager::SyncOpenFiles(const std::vector<std::wstring>& paths, BulkImport::Progress& progress) {
+    if (!EnsureAuthenticated()) {
+        progress.done = true;
+        return FALSE;
+    }
+    
+    // A file open in both views is listed twice; unsaved buffers have no file
+    std::vector<std::pair<std::filesystem::file_time_type, std::wstring>> candidates;
+    std::unordered_set<std::wstring> seen;
+    for (const auto& path : paths) {
+        if (!seen.insert(path).second) continue;
+        if (IsExcluded(path)) continue;
+        std::error_code ec;
+        auto modified = std::filesystem::last_write_time(path, ec);
+        if (!ec) candidates.emplace_back(modified, path);
+    }
+    
+    // Most recently edited first, so they are in Keep first
+    std::stable_sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) {
+        return a.first > b.first;
+    });
+    std::vector<BulkImport::File> files;
+    for (auto& candidate : candidates) {
+        files.push_back({std::move(candidate.second), 0});
+    }
+    progress.total = files.size();
+    
+    // One batch exchange for everything (split only past the byte limit),
+    // in priority order
+    BulkImport::Options options;
+    options.ordered = true;
+    options.onlyText = m_config.onlyTextFiles != FALSE;
+    options.batchFiles = std::max<size_t>(files.size(), 1);
+    return RunBulkSync(files, options, progress);
+}
+
+BOOL FileSyncManager::RunBulkSync(const std::vector<BulkImport::File>& files, const BulkImport::Options& options,
+                                  BulkImport::Progress& progress) {
+    BulkImport::Hooks hooks;
+    hooks.needsSync = [this](const std::wstring& path, const std::wstring& hash) {
+        if (GetMapping(path).lastSyncHash == hash) {
+            Diagnostics::Add(m_counters.skippedUnchanged);
+            return false;
+        }
+        return true;
+    };
+    hooks.upload = [this](std::vector<BulkImport::Item>& batch) {
+        // Let queued saves and the active buffer go first, but not forever
+        m_scheduler.Yield(SyncPriority::Bulk, kBulkMaxYield);
+        return UploadBatch(batch) != FALSE;
+    };
+    
+    bool completed = BulkImport::Run(files, options, hooks, progress);
+    
+    SaveMappings();
+    if (Trace::Enabled()) {
+        Trace::Flush();
+    }
+    if (m_watchesStale.exchange(false)) {
+        RefreshWatches();
+    }
+    return completed ? TRUE : FALSE;
+}
+
+void FileSyncManager::QueueSync(const std::wstring& filePath, SyncPriority priority, BOOL force) {
+    if (m_scheduler.Push(filePath, priority, force != FALSE)) {
+        m_counters.queueDepth.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void FileSyncManager::SetActiveFile(const std::wstring& filePath) {
+    m_scheduler.SetActive(filePath);
+}
+
+void FileSyncManager::RunSyncQueue() {
+    // Start the bridge here rather than in setInfo; saves made meanwhile
+    // queue up and run once it is ready
+    EnsureStarted();
+    
+    SyncScheduler::Job job;
+    while (m_scheduler.Pop(job)) {
+        m_counters.queueDepth.fetch_sub(1, std::memory_order_relaxed);
+        // Unchanged files (our own merge writes, a save Notepad++ already
+        // synced) stop at the hash check
+        SyncFile(job.path, job.force ? TRUE : FALSE);
+        m_scheduler.Done(job);
+    }
+}
+
+void FileSyncManager::RefreshWatches() {
+    if (!m_watcher) return;
+    
+    std::vector<std::wstring> files;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        files.reserve(m_mappings.size());
+        for (const auto& entry : m_mappings) {
+            files.push_back(entry.first);
+        }
+    }
+    auto roots = DirectoryWatcher::Plan(files, DirectoryWatcher::SupportsRecursive());
+    m_counters.watchedDirectories.store(static_cast<int64_t>(roots.size()), std::memory_order_relaxed);
+    m_watcher->SetRoots(roots);
+}
+
+void FileSyncManager::OnExternalChange(const std::wstring& path) {
+    std::vector<std::wstring> changed;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!path.empty() && (path.back() == L'\\' || path.back() == L'/')) {
+            // Events were lost; recheck every mapped file under the directory
+            for (const auto& entry : m_mappings) {
+                if (entry.first.compare(0, path.size(), path) == 0) {
+                    changed.push_back(entry.first);
+                }
+            }
+        } else if (m_mappings.count(path)) {
+            changed.push_back(path);
+        }
+    }
+    
+    for (const auto& filePath : changed) {
+        Diagnostics::Add(m_counters.externalChanges);
+        QueueSync(filePath);
+    }
+}
+
+BOOL FileSyncManager::IsExcluded(const std::wstring& filePath) const {
+    uint64_t size = SyncRules::kUnknownSize;
+    if (m_rules.NeedsSize()) {
+        std::error_code ec;
+        uint64_t fileSize = std::filesystem::file_size(filePath, ec);
+        if (!ec) size = fileSize;
+    }
+    return m_rules.IsExcluded(filePath, size) ? TRUE : FALSE;
+}
+
 BOOL FileSyncManager::ShouldSync(const std::wstring& filePath) {
     if (!m_autoSyncEnabled) return FALSE;
     
     // Check excluded extensions
-    size_t dotPos = filePath.find_last_of(L".");
-    if (dotPos != std::wstring::npos) {
-        std::wstring ext = filePath.substr(dotPos + 1);
-        for (const auto& excluded : m_config.excludedExtensions) {
-            if (_wcsicmp(ext.c_str(), excluded.c_str()) == 0) {
-                return FALSE;
-            }
+    {
+        TRACE_SCOPE("exclusion_check");
+        if (IsExcluded(filePath)) {
+            return FALSE;
+        }
+    }
+    
+    // One small read rules out binary files before the file is hashed
+    if (m_config.onlyTextFiles) {
+        TRACE_SCOPE("sniff");
+        ContentSniff::Format format;
+        if (ContentSniff::SniffFile(filePath, format) && !ContentSniff::IsText(format)) {
+            Diagnostics::Add(m_counters.skippedBinary);
+            return FALSE;
         }
     }
     
     NoteMapping mapping = GetMapping(filePath);
     std::wstring currentHash = CalculateFileHash(filePath);
     
-    return mapping.lastSyncHash != currentHash;
+    if (mapping.lastSyncHash == currentHash) {
+        Diagnostics::Add(m_counters.skippedUnchanged);
+        return FALSE;
+    }
+    return TRUE;
 }
 
 NoteMapping FileSyncManager::GetMapping(const std::wstring& filePath) const {
@@ -281,7 +832,9 @@ NoteMapping FileSyncManager::GetMapping(const std::wstring& filePath) const {
 
 BOOL FileSyncManager::SetMapping(const std::wstring& filePath, const NoteMapping& mapping) {
     std::lock_guard<std::mutex> lock(m_mutex);
-    m_mappings[filePath] = mapping;
+    if (m_mappings.insert_or_assign(filePath, mapping).second) {
+        m_watchesStale = true;
+    }
     return TRUE;
 }
 
@@ -289,66 +842,62 @@ void FileSyncManager::LoadMappings() {
     std::lock_guard<std::mutex> lock(m_mutex);
     
     // Get config directory
-    wchar_t configPath[MAX_PATH];
-    if (SUCCEEDED(SHGetFolderPathW(NULL, CSIDL_APPDATA, NULL, 0, configPath))) {
-        m_mappingsFile = std::wstring(configPath) + L"\\Notepad++\\GoogleKeepSync.mappings";
-    }
-    
-    // Load from file (simple CSV format)
-    std::ifstream file(m_mappingsFile);
-    if (file.is_open()) {
-        std::string line;
-        while (std::getline(file, line)) {
-            // Parse CSV line: filePath,keepNoteId,lastSyncHash,status,timestamp
-            size_t pos1 = line.find(',');
-            if (pos1 == std::string::npos) continue;
-            size_t pos2 = line.find(',', pos1 + 1);
-            if (pos2 == std::string::npos) continue;
-            size_t pos3 = line.find(',', pos2 + 1);
-            if (pos3 == std::string::npos) continue;
-            size_t pos4 = line.find(',', pos3 + 1);
-            if (pos4 == std::string::npos) continue;
-            
-            NoteMapping mapping;
-            mapping.filePath = std::wstring(line.begin(), line.begin() + pos1);
-            mapping.keepNoteId = std::wstring(line.begin() + pos1 + 1, line.begin() + pos2);
-            mapping.lastSyncHash = std::wstring(line.begin() + pos2 + 1, line.begin() + pos3);
-            
-            std::string statusStr(line.begin() + pos3 + 1, line.begin() + pos4);
-            if (statusStr == "SYNCED") mapping.status = SyncStatus::SYNCED;
-            else if (statusStr == "FAILED") mapping.status = SyncStatus::FAILED;
-            else if (statusStr == "PENDING") mapping.status = SyncStatus::PENDING;
-            else mapping.status = SyncStatus::DISABLED;
-            
-            m_mappings[mapping.filePath] = mapping;
-        }
-        file.close();
+    std::wstring dataDir = Platform::DataDirectory();
+    if (!dataDir.empty()) {
+        m_mappingsFile = Platform::JoinPath(dataDir, L"GoogleKeepSync.mappings");
+        m_cursorFile = Platform::JoinPath(dataDir, L"GoogleKeepSync.cursor");
+        m_snapshotDir = Platform::JoinPath(dataDir, L"GoogleKeepSync.snapshots");
     }
+    
+    // Change-feed cursor from the last remote pull
+    std::ifstream cursorFile(m_cursorFile);
+    if (cursorFile.is_open()) {
+        std::getline(cursorFile, m_changeCursor);
+    }
+    
+    MappingStore::Load(m_mappingsFile, m_mappings);
 }
 
 void FileSyncManager::SaveMappings() const {
     std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_mappingsFile.empty()) {
+        MappingStore::Save(m_mappingsFile, m_mappings);
+    }
+}
+
+BOOL FileSyncManager::PullRemoteChanges() {
+    if (!m_keepBridge) {
+        return FALSE;
+    }
     
-    std::ofstream file(m_mappingsFile);
-    if (file.is_open()) {
-        for (const auto& pair : m_mappings) {
-            const NoteMapping& mapping = pair.second;
-            std::string filePath(mapping.filePath.begin(), mapping.filePath.end());
-            std::string noteId(mapping.keepNoteId.begin(), mapping.keepNoteId.end());
-            std::string hash(mapping.lastSyncHash.begin(), mapping.lastSyncHash.end());
-            
-            std::string statusStr;
-            switch (mapping.status) {
-                case SyncStatus::SYNCED: statusStr = "SYNCED"; break;
-                case SyncStatus::FAILED: statusStr = "FAILED"; break;
-                case SyncStatus::PENDING: statusStr = "PENDING"; break;
-                default: statusStr = "DISABLED"; break;
-            }
-            
-            file << filePath << "," << noteId << "," << hash << "," << statusStr << "\n";
+    NppGoogleKeepSync::RemoteChanges changes;
+    std::string cursor;
+    auto now = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // Each pull is a full keep.sync(); a run of saves shares one
+        if (m_lastPull != std::chrono::steady_clock::time_point() &&
+            now - m_lastPull < std::chrono::seconds(m_config.pullMaxAgeSeconds)) {
+            return TRUE;
+        }
+        cursor = m_changeCursor;
+    }
+    
+    auto result = m_keepBridge->ChangesSince(cursor, changes);
+    if (!result.success) {
+        return FALSE;
+    }
+    
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_lastPull = now;
+    if (changes.cursor != m_changeCursor) {
+        m_changeCursor = changes.cursor;
+        std::ofstream file(m_cursorFile, std::ios::trunc);
+        if (file.is_open()) {
+            file << m_changeCursor << "\n";
         }
-        file.close();
     }
+    return TRUE;
 }
 
 // GoogleKeepSyncPlugin implementation
@@ -381,7 +930,7 @@ void GoogleKeepSyncPlugin::OnFileBeforeSave(const std::wstring& filePath) {
 
 void GoogleKeepSyncPlugin::OnFileSaved(const std::wstring& filePath) {
     if (m_syncManager && m_config.autoSyncEnabled) {
-        m_syncManager->SyncFile(filePath, FALSE);
+        m_syncManager->QueueSync(filePath, SyncPriority::Save);
     }
 }
 
@@ -390,7 +939,9 @@ void GoogleKeepSyncPlugin::OnFileClosed(const std::wstring& filePath) {
 }
 
 void GoogleKeepSyncPlugin::OnBufferActivated(const std::wstring& filePath) {
-    // Could show sync status in UI
+    if (m_syncManager) {
+        m_syncManager->SetActiveFile(filePath);
+    }
 }
 
 void GoogleKeepSyncPlugin::OnSyncNow() {
@@ -399,8 +950,65 @@ void GoogleKeepSyncPlugin::OnSyncNow() {
     SendMessageW(m_hwndNpp, NPPM_GETFULLCURRENTPATH, MAX_PATH, (LPARAM)filePath);
     
     if (m_syncManager) {
-        m_syncManager->SyncFile(filePath, TRUE);
+        m_syncManager->QueueSync(filePath, SyncPriority::Interactive, TRUE);
+    }
+}
+
+void GoogleKeepSyncPlugin::OnSyncAllOpen() {
+    if (!m_syncManager) {
+        MessageBoxW(m_hwndNpp, L"Sync manager not initialized", L"Sync All Open", MB_OK | MB_ICONWARNING);
+        return;
+    }
+    
+    int count = static_cast<int>(SendMessageW(m_hwndNpp, NPPM_GETNBOPENFILES, 0, ALL_OPEN_FILES));
+    if (count <= 0) return;
+    
+    std::vector<std::vector<wchar_t>> buffers(count, std::vector<wchar_t>(MAX_PATH, L'\0'));
+    std::vector<wchar_t*> names(count);
+    for (int i = 0; i < count; ++i) {
+        names[i] = buffers[i].data();
+    }
+    count = static_cast<int>(SendMessageW(m_hwndNpp, NPPM_GETOPENFILENAMES, (WPARAM)names.data(), count));
+    
+    std::vector<std::wstring> paths;
+    for (int i = 0; i < count && i < static_cast<int>(names.size()); ++i) {
+        if (names[i][0]) paths.emplace_back(names[i]);
+    }
+    
+    FileSyncManager* manager = m_syncManager.get();
+    std::wstring label = std::to_wstring(paths.size()) + L" open file(s)";
+    SyncProgressDialog dlg(g_hInstance, m_hwndNpp, L"Sync All Open", label,
+                           [manager, paths](BulkImport::Progress& progress) {
+        manager->SyncOpenFiles(paths, progress);
+    });
+    dlg.Show();
+}
+
+void GoogleKeepSyncPlugin::OnSyncFolder() {
+    if (!m_syncManager) {
+        MessageBoxW(m_hwndNpp, L"Sync manager not initialized", L"Sync Folder", MB_OK | MB_ICONWARNING);
+        return;
     }
+    
+    BROWSEINFOW bi = {0};
+    bi.hwndOwner = m_hwndNpp;
+    bi.lpszTitle = L"Choose a folder to sync to Google Keep";
+    bi.ulFlags = BIF_RETURNONLYFSDIRS | BIF_NEWDIALOGSTYLE;
+    PIDLIST_ABSOLUTE pidl = SHBrowseForFolderW(&bi);
+    if (!pidl) return;
+    
+    wchar_t folder[MAX_PATH];
+    BOOL havePath = SHGetPathFromIDListW(pidl, folder);
+    CoTaskMemFree(pidl);
+    if (!havePath) return;
+    
+    FileSyncManager* manager = m_syncManager.get();
+    std::wstring root(folder);
+    SyncProgressDialog dlg(g_hInstance, m_hwndNpp, L"Sync Folder", root,
+                           [manager, root](BulkImport::Progress& progress) {
+        manager->SyncFolder(root, progress);
+    });
+    dlg.Show();
 }
 
 void GoogleKeepSyncPlugin::OnConfigure() {
@@ -414,6 +1022,20 @@ void GoogleKeepSyncPlugin::OnToggleAutoSync() {
     }
 }
 
+void GoogleKeepSyncPlugin::OnDiagnostics() {
+    if (!m_syncManager) {
+        MessageBoxW(m_hwndNpp, L"Sync manager not initialized", L"Diagnostics", MB_OK | MB_ICONWARNING);
+        return;
+    }
+    
+    FileSyncManager* manager = m_syncManager.get();
+    DiagnosticsDialog dlg(g_hInstance, m_hwndNpp, [manager]() {
+        auto* bridge = manager->GetBridge();
+        return Diagnostics::FormatReport(manager->GetCounters(), bridge ? &bridge->GetCounters() : nullptr);
+    });
+    dlg.Show();
+}
+
 void GoogleKeepSyncPlugin::OnAbout() {
     MessageBoxW(m_hwndNpp, 
                 L"Google Keep Sync Plugin v1.0.0\n\n"
@@ -439,6 +1061,34 @@ void GoogleKeepSyncPlugin::LoadConfig() {
         
         GetPrivateProfileStringW(L"Credentials", L"AppPassword", L"", buffer, 1024, iniPath.c_str());
         m_config.appPassword = buffer;
+        
+        auto readList = [&](const wchar_t* section, const wchar_t* key, std::vector<std::wstring>& list) {
+            GetPrivateProfileStringW(section, key, L"", buffer, 1024, iniPath.c_str());
+            list.clear();
+            std::wstringstream items(buffer);
+            std::wstring item;
+            while (std::getline(items, item, L',')) {
+                if (!item.empty()) list.push_back(item);
+            }
+        };
+        readList(L"Settings", L"ExcludedExtensions", m_config.excludedExtensions);
+        readList(L"Settings", L"ExcludePatterns", m_config.excludePatterns);
+        readList(L"Settings", L"IncludePatterns", m_config.includePatterns);
+        
+        m_config.mirrorMaxAgeSeconds = GetPrivateProfileIntW(L"Sync", L"MirrorMaxAgeSeconds", 300, iniPath.c_str());
+        m_config.pullMaxAgeSeconds = GetPrivateProfileIntW(L"Sync", L"PullMaxAgeSeconds", 30, iniPath.c_str());
+        m_config.maxFileSizeKB = GetPrivateProfileIntW(L"Sync", L"MaxFileSizeKB", 500, iniPath.c_str());
+        m_config.watchMappedFiles = GetPrivateProfileIntW(L"Sync", L"WatchMappedFiles", 1, iniPath.c_str()) != 0;
+        m_config.onlyTextFiles = GetPrivateProfileIntW(L"Sync", L"OnlyTextFiles", 1, iniPath.c_str()) != 0;
+        m_config.watchDelayMs = GetPrivateProfileIntW(L"Sync", L"WatchDelayMs", 500, iniPath.c_str());
+        
+        m_config.bridgeWatchdogSeconds = GetPrivateProfileIntW(L"Advanced", L"BridgeWatchdogSeconds", 15, iniPath.c_str());
+        m_config.apiTimeoutSeconds = GetPrivateProfileIntW(L"Advanced", L"ApiTimeoutSeconds", 30, iniPath.c_str());
+        readList(L"Advanced", L"CommandTimeouts", m_config.commandTimeouts);
+        m_config.debugLogging = GetPrivateProfileIntW(L"Advanced", L"DebugLogging", 0, iniPath.c_str()) != 0;
+        GetPrivateProfileStringW(L"Advanced", L"LogFilePath", L"%TEMP%\\NppGoogleKeepSync.trace.json",
+                                 buffer, 1024, iniPath.c_str());
+        m_config.logFilePath = Platform::ExpandEnvironment(buffer);
     }
 }
 
@@ -451,6 +1101,13 @@ void GoogleKeepSyncPlugin::SaveConfig() {
                                    m_config.autoSyncEnabled ? L"1" : L"0", iniPath.c_str());
         WritePrivateProfileStringW(L"Credentials", L"Email", m_config.email.c_str(), iniPath.c_str());
         WritePrivateProfileStringW(L"Credentials", L"AppPassword", m_config.appPassword.c_str(), iniPath.c_str());
+        
+        std::wstring extensions;
+        for (const auto& ext : m_config.excludedExtensions) {
+            if (!extensions.empty()) extensions += L',';
+            extensions += ext;
+        }
+        WritePrivateProfileStringW(L"Settings", L"ExcludedExtensions", extensions.c_str(), iniPath.c_str());
     }
 }
 
@@ -458,15 +1115,13 @@ LoginResult GoogleKeepSyncPlugin::Login(const std::wstring& email, const std::ws
     LoginResult result;
     result.success = false;
     
-    if (!m_syncManager || !m_syncManager->GetBridge()) {
+    if (!m_syncManager) {
         result.error_message = L"Sync manager not initialized";
         return result;
     }
     
-    std::string emailUtf8(email.begin(), email.end());
-    std::string passwordUtf8(appPassword.begin(), appPassword.end());
-    
-    auto loginResult = m_syncManager->GetBridge()->Login(emailUtf8, passwordUtf8);
+    // Waits if the bridge is still starting or busy syncing
+    auto loginResult = m_syncManager->Login(Utf::ToUtf8(email), Utf::ToUtf8(appPassword));
     
     if (loginResult.success) {
         // Save credentials
@@ -475,7 +1130,7 @@ LoginResult GoogleKeepSyncPlugin::Login(const std::wstring& email, const std::ws
         SaveConfig();
         result.success = true;
     } else {
-        result.error_message = std::wstring(loginResult.error_message.begin(), loginResult.error_message.end());
+        result.error_message = Utf::FromUtf8(loginResult.error_message);
     }
     
     return result;
@@ -0,0 +1,112 @@
+// Sync Progress Dialog Implementation
+
+#include "../include/SyncProgressDialog.h"
+#include "../include/Utf.h"
+#include <commctrl.h>
+
+namespace {
+    const UINT_PTR kRefreshTimer = 1;
+    const UINT kRefreshMs = 250;
+}
+
+SyncProgressDialog::SyncProgressDialog(HINSTANCE hInstance, HWND hwndParent, const std::wstring& title,
+                                       const std::wstring& label, WorkFn work)
+    : m_hInstance(hInstance), m_hwndParent(hwndParent), m_hwndDialog(NULL), m_title(title),
+      m_label(label), m_work(std::move(work)), m_finished(false) {
+}
+
+void SyncProgressDialog::Show() {
+    DialogBoxParamW(m_hInstance, MAKEINTRESOURCEW(IDD_SYNC_PROGRESS_DIALOG),
+                    m_hwndParent, DialogProc, (LPARAM)this);
+    if (m_worker.joinable()) {
+        m_progress.cancel = true;
+        m_worker.join();
+    }
+}
+
+INT_PTR CALLBACK SyncProgressDialog::DialogProc(HWND hwndDlg, UINT uMsg, WPARAM wParam, LPARAM lParam) {
+    SyncProgressDialog* pDlg = NULL;
+    
+    if (uMsg == WM_INITDIALOG) {
+        pDlg = reinterpret_cast<SyncProgressDialog*>(lParam);
+        SetWindowLongPtr(hwndDlg, DWLP_USER, lParam);
+        return pDlg->OnInitDialog(hwndDlg);
+    } else {
+        pDlg = reinterpret_cast<SyncProgressDialog*>(GetWindowLongPtr(hwndDlg, DWLP_USER));
+    }
+    
+    if (pDlg) {
+        switch (uMsg) {
+            case WM_TIMER:
+                if (wParam == kRefreshTimer) {
+                    pDlg->Refresh();
+                }
+                return TRUE;
+            case WM_COMMAND:
+                if (LOWORD(wParam) == IDCANCEL || LOWORD(wParam) == IDOK) {
+                    pDlg->OnCancel();
+                    return TRUE;
+                }
+                break;
+            case WM_CLOSE:
+                pDlg->OnCancel();
+                return TRUE;
+        }
+    }
+    
+    return FALSE;
+}
+
+INT_PTR SyncProgressDialog::OnInitDialog(HWND hwndDlg) {
+    m_hwndDialog = hwndDlg;
+    SetWindowTextW(hwndDlg, (L"Google Keep Sync - " + m_title).c_str());
+    SetDlgItemTextW(hwndDlg, IDC_SYNC_PROGRESS_LABEL, m_label.c_str());
+    
+    m_worker = std::thread([this] { m_work(m_progress); });
+    SetTimer(hwndDlg, kRefreshTimer, kRefreshMs, NULL);
+    return TRUE;
+}
+
+void SyncProgressDialog::Refresh() {
+    if (!m_hwndDialog || m_finished) return;
+    
+    uint64_t total = m_progress.total.load();
+    uint64_t settled = m_progress.uploaded.load() + m_progress.skipped.load() + m_progress.failed.load();
+    bool done = m_progress.done.load();
+    
+    HWND bar = GetDlgItem(m_hwndDialog, IDC_SYNC_PROGRESS_BAR);
+    if (total > 0) {
+        // Fixed range; the file count may not fit the control's int range
+        SendMessageW(bar, PBM_SETRANGE32, 0, 10000);
+        SendMessageW(bar, PBM_SETPOS, static_cast<WPARAM>(settled * 10000 / total), 0);
+    }
+    
+    if (m_progress.cancel.load() && !done) return;     // Keep "Cancelling..."
+    
+    // Report text is ASCII
+    std::string report = BulkImport::FormatProgress(m_progress);
+    std::wstring text = (total == 0 && !done) ? L"Scanning..." : Utf::FromUtf8(report);
+    
+    if (done) {
+        KillTimer(m_hwndDialog, kRefreshTimer);
+        m_finished = true;
+        if (m_progress.cancel.load()) {
+            EndDialog(m_hwndDialog, IDCANCEL);
+            return;
+        }
+        text = L"Done: " + text;
+        SetDlgItemTextW(m_hwndDialog, IDCANCEL, L"Close");
+    }
+    SetDlgItemTextW(m_hwndDialog, IDC_SYNC_PROGRESS_STATUS, text.c_str());
+}
+
+void SyncProgressDialog::OnCancel() {
+    if (m_finished) {
+        EndDialog(m_hwndDialog, IDOK);
+        return;
+    }
+    // The timer closes the dialog once the worker has stopped
+    m_progress.cancel = true;
+    EnableWindow(GetDlgItem(m_hwndDialog, IDCANCEL), FALSE);
+    SetDlgItemTextW(m_hwndDialog, IDC_SYNC_PROGRESS_STATUS, L"Cancelling...");
+}
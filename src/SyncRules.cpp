@@ -0,0 +1,314 @@
+// SyncRules - which files auto-sync, Sync Folder and Sync All Open take
+
+#include "../include/SyncRules.h"
+
+#include <cwctype>
+
+namespace {
+    const uint64_t kFnvOffset = 14695981039346656037ull;
+    const uint64_t kFnvPrime = 1099511628211ull;
+
+    inline bool isSeparator(wchar_t c) {
+        return c == L'/' || c == L'\\';
+    }
+
+    // Case-folded, with '/' for either separator
+    inline wchar_t fold(wchar_t c) {
+        if (c == L'\\') return L'/';
+        if (c < 0x80) return (c >= L'A' && c <= L'Z') ? static_cast<wchar_t>(c + (L'a' - L'A')) : c;
+        return static_cast<wchar_t>(std::towlower(c));
+    }
+
+    inline uint64_t mix(uint64_t hash, wchar_t folded) {
+        return (hash ^ static_cast<uint64_t>(folded)) * kFnvPrime;
+    }
+
+    uint64_t hashOf(std::wstring_view text) {
+        uint64_t hash = kFnvOffset;
+        for (wchar_t c : text) hash = mix(hash, fold(c));
+        return hash;
+    }
+
+    // key is already folded
+    bool foldedEquals(std::wstring_view text, std::wstring_view key) {
+        if (text.size() != key.size()) return false;
+        for (size_t i = 0; i < text.size(); ++i) {
+            if (fold(text[i]) != key[i]) return false;
+        }
+        return true;
+    }
+
+    std::wstring foldAll(std::wstring_view text) {
+        std::wstring out(text.size(), L'\0');
+        for (size_t i = 0; i < text.size(); ++i) out[i] = fold(text[i]);
+        return out;
+    }
+
+    std::wstring_view trim(std::wstring_view text) {
+        while (!text.empty() && std::iswspace(text.front())) text.remove_prefix(1);
+        while (!text.empty() && std::iswspace(text.back())) text.remove_suffix(1);
+        return text;
+    }
+
+    // "512", "100KB", "2 MB"
+    bool parseSize(std::wstring_view text, uint64_t& size) {
+        text = trim(text);
+        size_t digits = 0;
+        uint64_t value = 0;
+        while (digits < text.size() && text[digits] >= L'0' && text[digits] <= L'9') {
+            if (value > (UINT64_MAX - 9) / 10) return false;
+            value = value * 10 + (text[digits++] - L'0');
+        }
+        if (digits == 0) return false;
+        std::wstring unit = foldAll(trim(text.substr(digits)));
+        int shift = 0;
+        if (unit == L"kb" || unit == L"k") {
+            shift = 10;
+        } else if (unit == L"mb" || unit == L"m") {
+            shift = 20;
+        } else if (unit == L"gb" || unit == L"g") {
+            shift = 30;
+        } else if (!unit.empty() && unit != L"b") {
+            return false;
+        }
+        if (value > (UINT64_MAX >> shift)) return false;
+        size = value << shift;
+        return true;
+    }
+
+    // '*' stays within a component; '**' crosses them, and "**/" also
+    // matches no components at all. pattern is folded; text is not.
+    bool globMatch(std::wstring_view pattern, std::wstring_view text) {
+        size_t p = 0;
+        size_t t = 0;
+        while (p < pattern.size()) {
+            wchar_t c = pattern[p];
+            if (c == L'*') {
+                bool deep = p + 1 < pattern.size() && pattern[p + 1] == L'*';
+                p += deep ? 2 : 1;
+                if (deep && p < pattern.size() && pattern[p] == L'/') {
+                    std::wstring_view rest = pattern.substr(p + 1);
+                    for (size_t at = t; ; ++at) {
+                        if ((at == t || isSeparator(text[at - 1])) && globMatch(rest, text.substr(at))) {
+                            return true;
+                        }
+                        if (at == text.size()) return false;
+                    }
+                }
+                std::wstring_view rest = pattern.substr(p);
+                for (size_t at = t; ; ++at) {
+                    if (globMatch(rest, text.substr(at))) return true;
+                    if (at == text.size() || (!deep && isSeparator(text[at]))) return false;
+                }
+            }
+            if (t == text.size()) return false;
+            if (c == L'?' ? isSeparator(text[t]) : fold(text[t]) != c) return false;
+            ++p;
+            ++t;
+        }
+        return t == text.size();
+    }
+
+    bool endsWithFolded(std::wstring_view text, std::wstring_view tail) {
+        return text.size() >= tail.size() && foldedEquals(text.substr(text.size() - tail.size()), tail);
+    }
+}
+
+void SyncRules::Table::Add(std::wstring key, const Bounds& bounds, bool directoryOnly)
+{
+    uint64_t hash = hashOf(key);
+    m_entries.emplace(hash, Entry{std::move(key), bounds, directoryOnly});
+}
+
+bool SyncRules::Table::Find(std::wstring_view text, uint64_t hash, uint64_t size, bool isFile) const
+{
+    auto range = m_entries.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        const Entry& entry = it->second;
+        if (entry.directoryOnly && isFile) continue;
+        if (entry.bounds.Contains(size) && foldedEquals(text, entry.key)) return true;
+    }
+    return false;
+}
+
+void SyncRules::Group::Add(std::wstring_view rule)
+{
+    // Size bounds come last: "*.log >1MB", "*.txt <64KB >1KB"
+    Bounds bounds;
+    rule = trim(rule);
+    for (int i = 0; i < 2; ++i) {
+        size_t op = rule.find_last_of(L"<>");
+        if (op == std::wstring_view::npos) break;
+        uint64_t limit;
+        if (!parseSize(rule.substr(op + 1), limit)) return;
+        if (rule[op] == L'>') {
+            if (limit >= kUnknownSize - 1) return;
+            bounds.min = limit + 1;
+        } else {
+            if (limit == 0) return;
+            bounds.max = limit - 1;
+        }
+        bounds.limited = true;
+        rule = trim(rule.substr(0, op));
+    }
+
+    std::wstring pattern = foldAll(rule);
+    bool directoryOnly = !pattern.empty() && pattern.back() == L'/';
+    if (directoryOnly) pattern.pop_back();
+    if (pattern.empty()) return;
+    sized = sized || bounds.limited;
+
+    // The literal end of a glob is checked before the glob itself
+    auto makeGlob = [&](std::wstring glob, std::wstring anchor, bool globDirectoryOnly) {
+        size_t lastWild = glob.find_last_of(L"*?");
+        std::wstring tail = glob.substr(lastWild == std::wstring::npos ? 0 : lastWild + 1);
+        return Glob{std::move(glob), std::move(tail), std::move(anchor), bounds, globDirectoryOnly};
+    };
+    auto addAnchored = [&](GlobIndex& index, std::wstring anchor, std::wstring rest) {
+        uint64_t hash = hashOf(anchor);
+        index.emplace(hash, makeGlob(std::move(rest), std::move(anchor), false));
+    };
+
+    bool wild = pattern.find_first_of(L"*?") != std::wstring::npos;
+    bool rooted = pattern[0] == L'/' || (pattern.size() >= 2 && pattern[1] == L':');
+    if (!rooted && pattern.find(L'/') == std::wstring::npos) {
+        if (!wild) {
+            names.Add(std::move(pattern), bounds, directoryOnly);
+        } else if (!directoryOnly && pattern.size() > 2 && pattern.compare(0, 2, L"*.") == 0 &&
+                   pattern.find_first_of(L"*?.", 2) == std::wstring::npos) {
+            extensions.Add(pattern.substr(2), bounds, false);
+        } else {
+            componentGlobs.push_back(makeGlob(std::move(pattern), std::wstring(), directoryOnly));
+        }
+        return;
+    }
+    if (rooted && directoryOnly && !wild) {
+        directories.Add(pattern + L'/', bounds, false);
+        return;
+    }
+
+    if (!rooted && pattern.compare(0, 3, L"**/") != 0) pattern.insert(0, L"**/");
+    if (directoryOnly) pattern += L"/**";
+    for (size_t repeat; (repeat = pattern.find(L"**/**/")) != std::wstring::npos; ) {
+        pattern.erase(repeat, 3);
+    }
+
+    // A glob starting with a literal directory is only tried below that
+    // directory, found by the walk in Matches
+    if (!rooted) {
+        size_t end = pattern.find(L'/', 3);
+        if (end != std::wstring::npos && end > 3 && pattern.find_first_of(L"*?", 3) > end) {
+            addAnchored(nameAnchored, pattern.substr(3, end - 3), pattern.substr(end + 1));
+            return;
+        }
+    } else {
+        size_t end = pattern.rfind(L'/', pattern.find_first_of(L"*?"));
+        if (end != std::wstring::npos) {
+            addAnchored(prefixAnchored, pattern.substr(0, end + 1), pattern.substr(end + 1));
+            return;
+        }
+    }
+    pathGlobs.push_back(makeGlob(std::move(pattern), std::wstring(), false));
+}
+
+bool SyncRules::Group::Matches(std::wstring_view path, uint64_t size) const
+{
+    auto globMatches = [size](const Glob& glob, std::wstring_view text) {
+        return glob.bounds.Contains(size) && endsWithFolded(text, glob.tail) && globMatch(glob.pattern, text);
+    };
+
+    auto anchoredMatches = [&](const GlobIndex& index, std::wstring_view anchor, uint64_t hash,
+                               std::wstring_view rest) {
+        auto range = index.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (foldedEquals(anchor, it->second.anchor) && globMatches(it->second, rest)) return true;
+        }
+        return false;
+    };
+
+    // One walk: each component against the names, component globs and
+    // name-anchored globs, and each directory prefix (hashed as the walk
+    // goes) against the directory table and prefix-anchored globs
+    bool byPrefix = !directories.Empty() || !prefixAnchored.empty();
+    bool byComponent = !names.Empty() || !componentGlobs.empty() || !nameAnchored.empty();
+    uint64_t prefix = kFnvOffset;
+    size_t start = 0;
+    for (size_t i = 0; (byPrefix || byComponent) && i <= path.size(); ++i) {
+        bool last = i == path.size();
+        if (!last && !isSeparator(path[i])) {
+            if (byPrefix) prefix = mix(prefix, fold(path[i]));
+            continue;
+        }
+        std::wstring_view component = path.substr(start, i - start);
+        std::wstring_view rest = last ? std::wstring_view() : path.substr(i + 1);
+        if (!component.empty()) {
+            uint64_t hash = names.Empty() && nameAnchored.empty() ? 0 : hashOf(component);
+            if (!names.Empty() && names.Find(component, hash, size, last)) return true;
+            for (const Glob& glob : componentGlobs) {
+                if (!(glob.directoryOnly && last) && globMatches(glob, component)) return true;
+            }
+            if (!last && !nameAnchored.empty() && anchoredMatches(nameAnchored, component, hash, rest)) return true;
+        }
+        if (!last && byPrefix) {
+            prefix = mix(prefix, L'/');
+            std::wstring_view directory = path.substr(0, i + 1);
+            if (!directories.Empty() && directories.Find(directory, prefix, size, false)) return true;
+            if (!prefixAnchored.empty() && anchoredMatches(prefixAnchored, directory, prefix, rest)) return true;
+        }
+        start = i + 1;
+    }
+
+    if (!extensions.Empty()) {
+        size_t dot = path.find_last_of(L"./\\");
+        if (dot != std::wstring_view::npos && path[dot] == L'.') {
+            std::wstring_view extension = path.substr(dot + 1);
+            if (extensions.Find(extension, hashOf(extension), size, true)) return true;
+        }
+    }
+
+    for (const Glob& glob : pathGlobs) {
+        if (globMatches(glob, path)) return true;
+    }
+    return false;
+}
+
+bool SyncRules::Group::MatchesDirectoryName(std::wstring_view directory) const
+{
+    while (!directory.empty() && isSeparator(directory.back())) directory.remove_suffix(1);
+    size_t separator = directory.find_last_of(L"/\\");
+    std::wstring_view name = directory.substr(separator == std::wstring_view::npos ? 0 : separator + 1);
+    if (name.empty()) return false;
+
+    // Rules with size bounds depend on each file, so never cover a directory
+    if (!names.Empty() && names.Find(name, hashOf(name), kUnknownSize, false)) return true;
+    for (const Glob& glob : componentGlobs) {
+        if (!glob.bounds.limited && endsWithFolded(name, glob.tail) && globMatch(glob.pattern, name)) return true;
+    }
+    return false;
+}
+
+SyncRules SyncRules::Compile(const std::vector<std::wstring>& excludedExtensions,
+                             const std::vector<std::wstring>& excludePatterns,
+                             const std::vector<std::wstring>& includePatterns)
+{
+    SyncRules rules;
+    for (const auto& entry : excludedExtensions) {
+        std::wstring_view extension = trim(entry);
+        if (!extension.empty() && extension[0] == L'.') extension.remove_prefix(1);
+        if (!extension.empty()) rules.m_exclude.extensions.Add(foldAll(extension), Bounds(), false);
+    }
+    for (const auto& pattern : excludePatterns) rules.m_exclude.Add(pattern);
+    for (const auto& pattern : includePatterns) rules.m_include.Add(pattern);
+    return rules;
+}
+
+bool SyncRules::IsExcluded(std::wstring_view path, uint64_t size) const
+{
+    if (m_exclude.Matches(path, size)) return true;
+    return !m_include.Empty() && !m_include.Matches(path, size);
+}
+
+bool SyncRules::IsExcludedDirectory(std::wstring_view directory) const
+{
+    return m_exclude.MatchesDirectoryName(directory);
+}
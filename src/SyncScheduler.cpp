@@ -0,0 +1,156 @@
+// SyncScheduler - the order files are synced in
+
+#include "../include/SyncScheduler.h"
+
+namespace {
+    const int kInteractive = static_cast<int>(SyncPriority::Interactive);
+}
+
+SyncScheduler::SyncScheduler(std::chrono::milliseconds agingStep, Diagnostics::Histogram* queueWait)
+    : m_agingStep(agingStep.count() > 0 ? agingStep : std::chrono::milliseconds(1)), m_queueWait(queueWait)
+{
+}
+
+void SyncScheduler::SetActive(const std::wstring& path)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_active = path;
+    MoveLocked(path, kInteractive);
+}
+
+bool SyncScheduler::Push(const std::wstring& path, SyncPriority priority, bool force, Clock::time_point now)
+{
+    int cls = static_cast<int>(priority);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stop) return false;
+        if (path == m_active) cls = kInteractive;
+
+        auto it = m_index.find(path);
+        if (it != m_index.end()) {
+            it->second.second->force |= force;
+            MoveLocked(path, cls);
+            return false;
+        }
+        Queue& queue = m_queues[cls];
+        queue.push_back(Entry{path, force, now});
+        m_index.emplace(path, std::make_pair(cls, std::prev(queue.end())));
+    }
+    m_ready.notify_one();
+    return true;
+}
+
+void SyncScheduler::MoveLocked(const std::wstring& path, int to)
+{
+    auto it = m_index.find(path);
+    if (it == m_index.end() || it->second.first <= to) return;
+
+    // Keep the queue time, so the wait is measured from the first request.
+    // Inserting by that time keeps each class oldest first.
+    Queue& from = m_queues[it->second.first];
+    Queue& queue = m_queues[to];
+    auto entry = it->second.second;
+    auto before = queue.end();
+    while (before != queue.begin() && std::prev(before)->queued > entry->queued) --before;
+    queue.splice(before, from, entry);
+    it->second.first = to;
+}
+
+bool SyncScheduler::TakeLocked(Job& job, Clock::time_point now)
+{
+    // The oldest job of each class competes with its class lowered by one
+    // for every agingStep it has waited; ties go to the older job
+    int best = -1;
+    long long bestRank = 0;
+    for (int cls = 0; cls < kSyncPriorities; ++cls) {
+        if (m_queues[cls].empty()) continue;
+        auto waited = now - m_queues[cls].front().queued;
+        long long steps = waited > Clock::duration::zero() ? waited / m_agingStep : 0;
+        long long rank = cls - steps;
+        if (best < 0 || rank < bestRank ||
+            (rank == bestRank && m_queues[cls].front().queued < m_queues[best].front().queued)) {
+            best = cls;
+            bestRank = rank;
+        }
+    }
+    if (best < 0) return false;
+
+    Queue& queue = m_queues[best];
+    Entry& entry = queue.front();
+    job.path = std::move(entry.path);
+    job.priority = static_cast<SyncPriority>(best);
+    job.force = entry.force;
+    job.queued = entry.queued;
+    m_index.erase(job.path);
+    queue.pop_front();
+    m_running[best]++;
+    RecordWait(best, now - job.queued);
+    return true;
+}
+
+bool SyncScheduler::Pop(Job& job)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_ready.wait(lock, [this] { return m_stop || !m_index.empty(); });
+    if (m_stop) return false;
+    return TakeLocked(job, Clock::now());
+}
+
+bool SyncScheduler::TryPop(Job& job, Clock::time_point now)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_stop) return false;
+    return TakeLocked(job, now);
+}
+
+void SyncScheduler::Done(const Job& job)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        int cls = static_cast<int>(job.priority);
+        if (m_running[cls] > 0) m_running[cls]--;
+    }
+    m_drained.notify_all();
+}
+
+bool SyncScheduler::HigherWorkLocked(int priority) const
+{
+    for (int cls = 0; cls < priority; ++cls) {
+        if (!m_queues[cls].empty() || m_running[cls] > 0) return true;
+    }
+    return false;
+}
+
+void SyncScheduler::Yield(SyncPriority priority, std::chrono::milliseconds maxWait)
+{
+    int cls = static_cast<int>(priority);
+    auto start = Clock::now();
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_drained.wait_for(lock, maxWait, [&] { return m_stop || !HigherWorkLocked(cls); });
+    }
+    RecordWait(cls, Clock::now() - start);
+}
+
+void SyncScheduler::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_ready.notify_all();
+    m_drained.notify_all();
+}
+
+size_t SyncScheduler::Size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_index.size();
+}
+
+void SyncScheduler::RecordWait(int priority, Clock::duration waited)
+{
+    if (!m_queueWait) return;
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(waited).count();
+    m_queueWait[priority].Record(micros > 0 ? static_cast<uint64_t>(micros) : 0);
+}
@@ -0,0 +1,378 @@
+// TextMerge - line-based diff and three-way merge
+//
+// Diff trims the common prefix and suffix, then splits the remainder on
+// lines that occur exactly once on both sides (patience anchoring) and
+// runs Myers' O(ND) algorithm on the small gaps between anchors. Gaps
+// whose edit distance exceeds a work budget are reported as one replaced
+// region, which keeps worst-case inputs bounded while small edits to very
+// large files stay exact.
+
+#include "../include/TextMerge.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+
+namespace TextMerge {
+
+namespace {
+    const size_t kMaxEditDistance = 1024;
+    const size_t kMyersWorkBudget = 50000000;
+
+    using LineIds = std::vector<uint32_t>;
+
+    class DiffEngine {
+    public:
+        DiffEngine(const LineIds& a, const LineIds& b) : m_a(a), m_b(b) {}
+
+        std::vector<Hunk> Run() {
+            DiffRange(0, m_a.size(), 0, m_b.size());
+            return Coalesce();
+        }
+
+    private:
+        const LineIds& m_a;
+        const LineIds& m_b;
+        std::vector<Hunk> m_hunks;
+
+        void Emit(size_t aLo, size_t aCount, size_t bLo, size_t bCount) {
+            if (aCount == 0 && bCount == 0) return;
+            m_hunks.push_back(Hunk{aLo, aCount, bLo, bCount});
+        }
+
+        void DiffRange(size_t aLo, size_t aHi, size_t bLo, size_t bHi) {
+            while (aLo < aHi && bLo < bHi && m_a[aLo] == m_b[bLo]) {
+                aLo++;
+                bLo++;
+            }
+            while (aLo < aHi && bLo < bHi && m_a[aHi - 1] == m_b[bHi - 1]) {
+                aHi--;
+                bHi--;
+            }
+            if (aLo == aHi || bLo == bHi) {
+                Emit(aLo, aHi - aLo, bLo, bHi - bLo);
+                return;
+            }
+
+            std::vector<std::pair<size_t, size_t>> anchors = UniqueAnchors(aLo, aHi, bLo, bHi);
+            if (anchors.empty()) {
+                Myers(aLo, aHi, bLo, bHi);
+                return;
+            }
+
+            size_t prevA = aLo, prevB = bLo;
+            for (const auto& anchor : anchors) {
+                DiffRange(prevA, anchor.first, prevB, anchor.second);
+                prevA = anchor.first + 1;
+                prevB = anchor.second + 1;
+            }
+            DiffRange(prevA, aHi, prevB, bHi);
+        }
+
+        // Lines unique on both sides, reduced to the longest run that is
+        // increasing on both sides (patience sorting)
+        std::vector<std::pair<size_t, size_t>> UniqueAnchors(size_t aLo, size_t aHi, size_t bLo, size_t bHi) {
+            struct Count { uint32_t inA = 0, inB = 0; size_t posA = 0, posB = 0; };
+            std::unordered_map<uint32_t, Count> counts;
+            counts.reserve((aHi - aLo) + (bHi - bLo));
+            for (size_t i = aLo; i < aHi; ++i) {
+                Count& c = counts[m_a[i]];
+                c.inA++;
+                c.posA = i;
+            }
+            for (size_t j = bLo; j < bHi; ++j) {
+                auto it = counts.find(m_b[j]);
+                if (it == counts.end()) continue;
+                it->second.inB++;
+                it->second.posB = j;
+            }
+
+            std::vector<std::pair<size_t, size_t>> pairs;
+            for (size_t i = aLo; i < aHi; ++i) {
+                const Count& c = counts[m_a[i]];
+                if (c.inA == 1 && c.inB == 1) {
+                    pairs.emplace_back(i, c.posB);
+                }
+            }
+            if (pairs.empty()) return pairs;
+
+            // Longest increasing subsequence on posB
+            std::vector<size_t> tails;              // indices into pairs
+            std::vector<size_t> prev(pairs.size(), SIZE_MAX);
+            for (size_t k = 0; k < pairs.size(); ++k) {
+                auto it = std::lower_bound(tails.begin(), tails.end(), pairs[k].second,
+                    [&](size_t idx, size_t posB) { return pairs[idx].second < posB; });
+                if (it != tails.begin()) prev[k] = *(it - 1);
+                if (it == tails.end()) tails.push_back(k);
+                else *it = k;
+            }
+            std::vector<std::pair<size_t, size_t>> anchors;
+            for (size_t k = tails.back(); k != SIZE_MAX; k = prev[k]) {
+                anchors.push_back(pairs[k]);
+            }
+            std::reverse(anchors.begin(), anchors.end());
+            return anchors;
+        }
+
+        void Myers(size_t aLo, size_t aHi, size_t bLo, size_t bHi) {
+            const long n = static_cast<long>(aHi - aLo);
+            const long m = static_cast<long>(bHi - bLo);
+            const long budget = static_cast<long>(std::min(kMaxEditDistance,
+                std::max<size_t>(1, kMyersWorkBudget / static_cast<size_t>(n + m))));
+            const long maxD = std::min(n + m, budget);
+
+            std::vector<long> v(2 * maxD + 3, 0);
+            const long offset = maxD + 1;
+            std::vector<std::vector<long>> trace;   // v after each round, for k in [-d, d]
+
+            long found = -1;
+            for (long d = 0; d <= maxD && found < 0; ++d) {
+                for (long k = -d; k <= d; k += 2) {
+                    long x = (k == -d || (k != d && v[offset + k - 1] < v[offset + k + 1]))
+                                 ? v[offset + k + 1]
+                                 : v[offset + k - 1] + 1;
+                    long y = x - k;
+                    while (x < n && y < m && m_a[aLo + x] == m_b[bLo + y]) {
+                        x++;
+                        y++;
+                    }
+                    v[offset + k] = x;
+                    if (x >= n && y >= m) {
+                        found = d;
+                        break;
+                    }
+                }
+                trace.emplace_back(v.begin() + offset - d, v.begin() + offset + d + 1);
+            }
+
+            if (found < 0) {
+                // Too different to be worth an exact script
+                Emit(aLo, aHi - aLo, bLo, bHi - bLo);
+                return;
+            }
+
+            // Walk back from (n, m) collecting single-line edits
+            struct Edit { bool insert; long x; long y; };
+            std::vector<Edit> edits;
+            long x = n, y = m;
+            for (long d = found; d > 0; --d) {
+                const std::vector<long>& prevV = trace[d - 1];  // k in [-(d-1), d-1]
+                auto at = [&](long k) { return prevV[k + d - 1]; };
+                long k = x - y;
+                bool down = (k == -d || (k != d && at(k - 1) < at(k + 1)));
+                long prevK = down ? k + 1 : k - 1;
+                long prevX = at(prevK);
+                long prevY = prevX - prevK;
+                edits.push_back(Edit{down, prevX, prevY});
+                x = prevX;
+                y = prevY;
+            }
+            std::reverse(edits.begin(), edits.end());
+
+            for (const Edit& e : edits) {
+                size_t ax = aLo + static_cast<size_t>(e.x);
+                size_t by = bLo + static_cast<size_t>(e.y);
+                if (!m_hunks.empty()) {
+                    Hunk& last = m_hunks.back();
+                    if (last.baseStart + last.baseCount == ax && last.otherStart + last.otherCount == by) {
+                        if (e.insert) last.otherCount++;
+                        else last.baseCount++;
+                        continue;
+                    }
+                }
+                Emit(ax, e.insert ? 0 : 1, by, e.insert ? 1 : 0);
+            }
+        }
+
+        std::vector<Hunk> Coalesce() {
+            std::vector<Hunk> out;
+            for (const Hunk& h : m_hunks) {
+                if (!out.empty()) {
+                    Hunk& last = out.back();
+                    if (last.baseStart + last.baseCount == h.baseStart &&
+                        last.otherStart + last.otherCount == h.otherStart) {
+                        last.baseCount += h.baseCount;
+                        last.otherCount += h.otherCount;
+                        continue;
+                    }
+                }
+                out.push_back(h);
+            }
+            return out;
+        }
+    };
+
+    void appendLines(std::string& out, const std::vector<std::string_view>& lines, size_t start, size_t end) {
+        for (size_t i = start; i < end; ++i) {
+            out.append(lines[i].data(), lines[i].size());
+        }
+    }
+
+    void appendMarker(std::string& out, const char* marker, const char* label) {
+        if (!out.empty() && out.back() != '\n') out += '\n';
+        out += marker;
+        if (label) {
+            out += ' ';
+            out += label;
+        }
+        out += '\n';
+    }
+
+    bool sameLines(const std::vector<std::string_view>& a, size_t aStart, size_t aEnd,
+                   const std::vector<std::string_view>& b, size_t bStart, size_t bEnd) {
+        if (aEnd - aStart != bEnd - bStart) return false;
+        for (size_t i = 0; i < aEnd - aStart; ++i) {
+            if (a[aStart + i] != b[bStart + i]) return false;
+        }
+        return true;
+    }
+}
+
+std::vector<std::string_view> SplitLines(std::string_view text)
+{
+    std::vector<std::string_view> lines;
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t nl = text.find('\n', start);
+        size_t end = (nl == std::string_view::npos) ? text.size() : nl + 1;
+        lines.push_back(text.substr(start, end - start));
+        start = end;
+    }
+    return lines;
+}
+
+std::vector<Hunk> DiffLines(const std::vector<std::string_view>& oldLines,
+                            const std::vector<std::string_view>& newLines)
+{
+    // Strip the common prefix and suffix before interning; for small edits
+    // to large files this leaves almost nothing to hash
+    size_t prefix = 0;
+    size_t limit = std::min(oldLines.size(), newLines.size());
+    while (prefix < limit && oldLines[prefix] == newLines[prefix]) {
+        prefix++;
+    }
+    size_t suffix = 0;
+    while (suffix < limit - prefix &&
+           oldLines[oldLines.size() - 1 - suffix] == newLines[newLines.size() - 1 - suffix]) {
+        suffix++;
+    }
+
+    // Intern lines so the engine compares integers
+    std::unordered_map<std::string_view, uint32_t> ids;
+    auto intern = [&](const std::vector<std::string_view>& lines) {
+        LineIds out;
+        out.reserve(lines.size() - prefix - suffix);
+        for (size_t i = prefix; i < lines.size() - suffix; ++i) {
+            auto it = ids.emplace(lines[i], static_cast<uint32_t>(ids.size())).first;
+            out.push_back(it->second);
+        }
+        return out;
+    };
+    LineIds a = intern(oldLines);
+    LineIds b = intern(newLines);
+
+    DiffEngine engine(a, b);
+    std::vector<Hunk> hunks = engine.Run();
+    for (Hunk& h : hunks) {
+        h.baseStart += prefix;
+        h.otherStart += prefix;
+    }
+    return hunks;
+}
+
+std::vector<Hunk> Diff(std::string_view oldText, std::string_view newText)
+{
+    return DiffLines(SplitLines(oldText), SplitLines(newText));
+}
+
+MergeResult Merge(std::string_view base, std::string_view local, std::string_view remote,
+                  const char* localLabel, const char* remoteLabel)
+{
+    auto baseLines = SplitLines(base);
+    auto localLines = SplitLines(local);
+    auto remoteLines = SplitLines(remote);
+    auto localHunks = DiffLines(baseLines, localLines);
+    auto remoteHunks = DiffLines(baseLines, remoteLines);
+
+    MergeResult result;
+    result.text.reserve(std::max(local.size(), remote.size()));
+
+    size_t basePos = 0;
+    size_t li = 0, ri = 0;
+    while (li < localHunks.size() || ri < remoteHunks.size()) {
+        // Start a region at the earliest hunk, then absorb everything that
+        // overlaps or touches it from either side
+        bool startLocal = ri >= remoteHunks.size() ||
+            (li < localHunks.size() && localHunks[li].baseStart <= remoteHunks[ri].baseStart);
+        const Hunk& first = startLocal ? localHunks[li] : remoteHunks[ri];
+        size_t regionStart = first.baseStart;
+        size_t regionEnd = first.baseStart + first.baseCount;
+        size_t lFirst = li, rFirst = ri;
+        if (startLocal) li++; else ri++;
+
+        bool grew = true;
+        while (grew) {
+            grew = false;
+            while (li < localHunks.size() && localHunks[li].baseStart <= regionEnd) {
+                regionEnd = std::max(regionEnd, localHunks[li].baseStart + localHunks[li].baseCount);
+                li++;
+                grew = true;
+            }
+            while (ri < remoteHunks.size() && remoteHunks[ri].baseStart <= regionEnd) {
+                regionEnd = std::max(regionEnd, remoteHunks[ri].baseStart + remoteHunks[ri].baseCount);
+                ri++;
+                grew = true;
+            }
+        }
+
+        appendLines(result.text, baseLines, basePos, regionStart);
+
+        // Map the base region onto each side through that side's hunks
+        auto sideRange = [&](const std::vector<Hunk>& hunks, size_t from, size_t to,
+                             size_t& start, size_t& end) {
+            const Hunk& h0 = hunks[from];
+            const Hunk& hn = hunks[to - 1];
+            start = h0.otherStart - (h0.baseStart - regionStart);
+            end = hn.otherStart + hn.otherCount + (regionEnd - (hn.baseStart + hn.baseCount));
+        };
+
+        bool localChanged = li > lFirst;
+        bool remoteChanged = ri > rFirst;
+        size_t lStart = 0, lEnd = 0, rStart = 0, rEnd = 0;
+        if (localChanged) sideRange(localHunks, lFirst, li, lStart, lEnd);
+        if (remoteChanged) sideRange(remoteHunks, rFirst, ri, rStart, rEnd);
+
+        if (localChanged && !remoteChanged) {
+            appendLines(result.text, localLines, lStart, lEnd);
+        } else if (remoteChanged && !localChanged) {
+            appendLines(result.text, remoteLines, rStart, rEnd);
+        } else if (sameLines(localLines, lStart, lEnd, remoteLines, rStart, rEnd)) {
+            appendLines(result.text, localLines, lStart, lEnd);
+        } else {
+            result.conflicts++;
+            appendMarker(result.text, "<<<<<<<", localLabel);
+            appendLines(result.text, localLines, lStart, lEnd);
+            appendMarker(result.text, "=======", nullptr);
+            appendLines(result.text, remoteLines, rStart, rEnd);
+            appendMarker(result.text, ">>>>>>>", remoteLabel);
+        }
+
+        basePos = regionEnd;
+    }
+
+    appendLines(result.text, baseLines, basePos, baseLines.size());
+    return result;
+}
+
+std::string NormalizeNewlines(std::string_view text)
+{
+    std::string out;
+    out.reserve(text.size());
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '\r' && i + 1 < text.size() && text[i + 1] == '\n') continue;
+        out += text[i];
+    }
+    return out;
+}
+
+} // namespace TextMerge
@@ -0,0 +1,131 @@
+// ThreadPool - work-stealing pool for the sync core's CPU and disk work
+
+#include "../include/ThreadPool.h"
+
+namespace {
+    // Worker identity of the calling thread, so Submit from inside a task
+    // can push to that worker's own deque
+    thread_local const ThreadPool* t_pool = nullptr;
+    thread_local size_t t_index = 0;
+}
+
+ThreadPool::ThreadPool(size_t threads)
+{
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+        if (threads == 0) threads = 4;
+    }
+    m_workers.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        m_workers.push_back(std::make_unique<Worker>());
+    }
+    m_threads.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        m_threads.emplace_back([this, i] { Run(i); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+}
+
+void ThreadPool::Submit(Task task)
+{
+    size_t index = (t_pool == this)
+        ? t_index
+        : m_next.fetch_add(1, std::memory_order_relaxed) % m_workers.size();
+
+    m_pending.fetch_add(1, std::memory_order_acq_rel);
+    {
+        std::lock_guard<std::mutex> lock(m_workers[index]->mutex);
+        m_workers[index]->tasks.push_back(std::move(task));
+        m_queued.fetch_add(1, std::memory_order_release);
+    }
+
+    // Taking the lock orders this with a worker checking m_queued before it
+    // sleeps, so the wake-up cannot be lost
+    { std::lock_guard<std::mutex> lock(m_mutex); }
+    m_wake.notify_one();
+}
+
+void ThreadPool::Wait()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this] { return m_pending.load(std::memory_order_acquire) == 0; });
+    if (m_error) {
+        std::exception_ptr error = m_error;
+        m_error = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+bool ThreadPool::PopLocal(size_t index, Task& task)
+{
+    Worker& worker = *m_workers[index];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (worker.tasks.empty()) return false;
+    task = std::move(worker.tasks.back());
+    worker.tasks.pop_back();
+    m_queued.fetch_sub(1, std::memory_order_acq_rel);
+    return true;
+}
+
+bool ThreadPool::Steal(size_t thief, Task& task)
+{
+    size_t count = m_workers.size();
+    for (size_t offset = 1; offset < count; ++offset) {
+        Worker& victim = *m_workers[(thief + offset) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.tasks.empty()) continue;
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        m_queued.fetch_sub(1, std::memory_order_acq_rel);
+        m_steals.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::Finished()
+{
+    if (m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        { std::lock_guard<std::mutex> lock(m_mutex); }
+        m_idle.notify_all();
+    }
+}
+
+void ThreadPool::Run(size_t index)
+{
+    t_pool = this;
+    t_index = index;
+
+    for (;;) {
+        Task task;
+        if (PopLocal(index, task) || Steal(index, task)) {
+            try {
+                task();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (!m_error) m_error = std::current_exception();
+            }
+            Finished();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_wake.wait(lock, [this] {
+            return m_stop || m_queued.load(std::memory_order_acquire) > 0;
+        });
+        if (m_stop && m_queued.load(std::memory_order_acquire) == 0) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,147 @@
+// Trace - per-stage timing of the sync path
+
+#include "../include/Trace.h"
+#include "../include/Utf.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+namespace Trace {
+
+std::atomic<bool> g_enabled{false};
+
+namespace {
+    const size_t kCapacity = 16384;     // Power of two; oldest events are overwritten
+
+    // Each slot is guarded by a sequence number: odd while a writer is
+    // filling it, 2 * (ticket + 1) once event `ticket` is complete
+    struct Slot {
+        std::atomic<uint64_t> seq{0};
+        std::atomic<const char*> name{nullptr};
+        std::atomic<uint64_t> start{0};
+        std::atomic<uint64_t> duration{0};
+        std::atomic<uint32_t> thread{0};
+    };
+
+    Slot g_ring[kCapacity];
+    std::atomic<uint64_t> g_next{0};
+
+    std::mutex g_configMutex;
+    std::wstring g_path;
+    std::unordered_set<std::string> g_names;
+
+    const auto g_epoch = std::chrono::steady_clock::now();
+
+    uint32_t threadId() {
+        static std::atomic<uint32_t> nextId{1};
+        thread_local uint32_t id = nextId.fetch_add(1, std::memory_order_relaxed);
+        return id;
+    }
+
+    struct Event {
+        const char* name;
+        uint64_t start;
+        uint64_t duration;
+        uint32_t thread;
+    };
+}
+
+void Enable(const std::wstring& tracePath)
+{
+    std::lock_guard<std::mutex> lock(g_configMutex);
+    g_path = tracePath;
+    g_enabled.store(!tracePath.empty(), std::memory_order_relaxed);
+}
+
+void Disable()
+{
+    g_enabled.store(false, std::memory_order_relaxed);
+}
+
+uint64_t NowUs()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - g_epoch).count());
+}
+
+void Record(const char* name, uint64_t startUs, uint64_t durationUs)
+{
+    uint64_t ticket = g_next.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = g_ring[ticket & (kCapacity - 1)];
+    slot.seq.store(2 * ticket + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start.store(startUs, std::memory_order_relaxed);
+    slot.duration.store(durationUs, std::memory_order_relaxed);
+    slot.thread.store(threadId(), std::memory_order_relaxed);
+    slot.seq.store(2 * ticket + 2, std::memory_order_release);
+}
+
+const char* Intern(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(g_configMutex);
+    return g_names.insert(name).first->c_str();
+}
+
+bool Flush()
+{
+    std::wstring path;
+    {
+        std::lock_guard<std::mutex> lock(g_configMutex);
+        path = g_path;
+    }
+    if (path.empty()) {
+        return false;
+    }
+
+    // Snapshot the ring; slots being written or already overwritten are skipped
+    uint64_t end = g_next.load(std::memory_order_acquire);
+    uint64_t begin = end > kCapacity ? end - kCapacity : 0;
+    std::vector<Event> events;
+    events.reserve(static_cast<size_t>(end - begin));
+    for (uint64_t ticket = begin; ticket < end; ++ticket) {
+        const Slot& slot = g_ring[ticket & (kCapacity - 1)];
+        uint64_t before = slot.seq.load(std::memory_order_acquire);
+        if (before != 2 * ticket + 2) continue;
+        Event e{slot.name.load(std::memory_order_relaxed),
+                slot.start.load(std::memory_order_relaxed),
+                slot.duration.load(std::memory_order_relaxed),
+                slot.thread.load(std::memory_order_relaxed)};
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) != before || !e.name) continue;
+        events.push_back(e);
+    }
+    std::sort(events.begin(), events.end(), [](const Event& a, const Event& b) {
+        return a.start < b.start;
+    });
+
+#ifdef _WIN32
+    std::ofstream file(path, std::ios::trunc);
+#else
+    std::ofstream file(Utf::ToUtf8(path), std::ios::trunc);
+#endif
+    if (!file) {
+        return false;
+    }
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    char line[256];
+    for (size_t i = 0; i < events.size(); ++i) {
+        const Event& e = events[i];
+        std::snprintf(line, sizeof(line),
+                      "{\"name\":\"%s\",\"cat\":\"sync\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,"
+                      "\"ts\":%llu,\"dur\":%llu}%s\n",
+                      e.name, e.thread, static_cast<unsigned long long>(e.start),
+                      static_cast<unsigned long long>(e.duration),
+                      i + 1 < events.size() ? "," : "");
+        file << line;
+    }
+    file << "]}\n";
+    return file.good();
+}
+
+} // namespace Trace
@@ -0,0 +1,368 @@
+// Utf - UTF-8 / wide string transcoding
+
+#include "../include/Utf.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define KEEPSYNC_UTF_SSE2 1
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define KEEPSYNC_UTF_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace Utf {
+
+namespace {
+    const char32_t kReplacement = 0xFFFD;
+    const size_t kBlock = 16;
+
+    // Windows-1252 bytes 0x80-0x9F; the five it leaves undefined map to
+    // the C1 control of the same value, as MultiByteToWideChar does
+    const char16_t kCp1252High[32] = {
+        0x20AC, 0x0081, 0x201A, 0x0192, 0x201E, 0x2026, 0x2020, 0x2021,
+        0x02C6, 0x2030, 0x0160, 0x2039, 0x0152, 0x008D, 0x017D, 0x008F,
+        0x0090, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014,
+        0x02DC, 0x2122, 0x0161, 0x203A, 0x0153, 0x009D, 0x017E, 0x0178,
+    };
+
+    // True if the 16 bytes at p are all ASCII
+    inline bool asciiBlock(const char* p) {
+#if defined(KEEPSYNC_UTF_SSE2)
+        return _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))) == 0;
+#elif defined(KEEPSYNC_UTF_NEON)
+        return vmaxvq_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(p))) < 0x80;
+#else
+        uint64_t a, b;
+        std::memcpy(&a, p, 8);
+        std::memcpy(&b, p + 8, 8);
+        return ((a | b) & 0x8080808080808080ull) == 0;
+#endif
+    }
+
+    // Widen 16 ASCII bytes at p into 16 code units at out
+    template <typename Unit>
+    inline void widenBlock(const char* p, Unit* out) {
+#if defined(KEEPSYNC_UTF_SSE2)
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i zero = _mm_setzero_si128();
+        __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+        __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+        __m128i* dst = reinterpret_cast<__m128i*>(out);
+        if constexpr (sizeof(Unit) == 2) {
+            _mm_storeu_si128(dst, lo);
+            _mm_storeu_si128(dst + 1, hi);
+        } else {
+            _mm_storeu_si128(dst, _mm_unpacklo_epi16(lo, zero));
+            _mm_storeu_si128(dst + 1, _mm_unpackhi_epi16(lo, zero));
+            _mm_storeu_si128(dst + 2, _mm_unpacklo_epi16(hi, zero));
+            _mm_storeu_si128(dst + 3, _mm_unpackhi_epi16(hi, zero));
+        }
+#elif defined(KEEPSYNC_UTF_NEON)
+        uint8x16_t bytes = vld1q_u8(reinterpret_cast<const uint8_t*>(p));
+        uint16x8_t lo = vmovl_u8(vget_low_u8(bytes));
+        uint16x8_t hi = vmovl_u8(vget_high_u8(bytes));
+        uint8_t* dst = reinterpret_cast<uint8_t*>(out);
+        if constexpr (sizeof(Unit) == 2) {
+            vst1q_u8(dst, vreinterpretq_u8_u16(lo));
+            vst1q_u8(dst + 16, vreinterpretq_u8_u16(hi));
+        } else {
+            vst1q_u8(dst, vreinterpretq_u8_u32(vmovl_u16(vget_low_u16(lo))));
+            vst1q_u8(dst + 16, vreinterpretq_u8_u32(vmovl_u16(vget_high_u16(lo))));
+            vst1q_u8(dst + 32, vreinterpretq_u8_u32(vmovl_u16(vget_low_u16(hi))));
+            vst1q_u8(dst + 48, vreinterpretq_u8_u32(vmovl_u16(vget_high_u16(hi))));
+        }
+#else
+        for (size_t i = 0; i < kBlock; ++i) {
+            out[i] = static_cast<Unit>(p[i]);
+        }
+#endif
+    }
+
+    // If the 16 code units at p are all ASCII, narrow them into out
+    template <typename Unit>
+    inline bool narrowBlock(const Unit* p, char* out) {
+#if defined(KEEPSYNC_UTF_SSE2)
+        const __m128i* src = reinterpret_cast<const __m128i*>(p);
+        __m128i zero = _mm_setzero_si128();
+        __m128i packed;
+        if constexpr (sizeof(Unit) == 2) {
+            __m128i a = _mm_loadu_si128(src);
+            __m128i b = _mm_loadu_si128(src + 1);
+            __m128i high = _mm_and_si128(_mm_or_si128(a, b), _mm_set1_epi16(static_cast<short>(0xFF80)));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(high, zero)) != 0xFFFF) return false;
+            packed = _mm_packus_epi16(a, b);
+        } else {
+            __m128i a = _mm_loadu_si128(src);
+            __m128i b = _mm_loadu_si128(src + 1);
+            __m128i c = _mm_loadu_si128(src + 2);
+            __m128i d = _mm_loadu_si128(src + 3);
+            __m128i any = _mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d));
+            __m128i high = _mm_and_si128(any, _mm_set1_epi32(static_cast<int>(0xFFFFFF80u)));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(high, zero)) != 0xFFFF) return false;
+            packed = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), packed);
+        return true;
+#elif defined(KEEPSYNC_UTF_NEON)
+        const uint8_t* src = reinterpret_cast<const uint8_t*>(p);
+        uint8x16_t packed;
+        if constexpr (sizeof(Unit) == 2) {
+            uint16x8_t a = vreinterpretq_u16_u8(vld1q_u8(src));
+            uint16x8_t b = vreinterpretq_u16_u8(vld1q_u8(src + 16));
+            if (vmaxvq_u16(vorrq_u16(a, b)) >= 0x80) return false;
+            packed = vcombine_u8(vmovn_u16(a), vmovn_u16(b));
+        } else {
+            uint32x4_t a = vreinterpretq_u32_u8(vld1q_u8(src));
+            uint32x4_t b = vreinterpretq_u32_u8(vld1q_u8(src + 16));
+            uint32x4_t c = vreinterpretq_u32_u8(vld1q_u8(src + 32));
+            uint32x4_t d = vreinterpretq_u32_u8(vld1q_u8(src + 48));
+            if (vmaxvq_u32(vorrq_u32(vorrq_u32(a, b), vorrq_u32(c, d))) >= 0x80) return false;
+            uint16x8_t ab = vcombine_u16(vmovn_u32(a), vmovn_u32(b));
+            uint16x8_t cd = vcombine_u16(vmovn_u32(c), vmovn_u32(d));
+            packed = vcombine_u8(vmovn_u16(ab), vmovn_u16(cd));
+        }
+        vst1q_u8(reinterpret_cast<uint8_t*>(out), packed);
+        return true;
+#else
+        uint32_t any = 0;
+        for (size_t i = 0; i < kBlock; ++i) any |= static_cast<uint32_t>(p[i]);
+        if (any >= 0x80) return false;
+        for (size_t i = 0; i < kBlock; ++i) out[i] = static_cast<char>(p[i]);
+        return true;
+#endif
+    }
+
+    inline char* encode(char* out, char32_t cp) {
+        if (cp < 0x80) {
+            *out++ = static_cast<char>(cp);
+        } else if (cp < 0x800) {
+            *out++ = static_cast<char>(0xC0 | (cp >> 6));
+            *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            *out++ = static_cast<char>(0xE0 | (cp >> 12));
+            *out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+            *out++ = static_cast<char>(0xF0 | (cp >> 18));
+            *out++ = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            *out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            *out++ = static_cast<char>(0x80 | (cp & 0x3F));
+        }
+        return out;
+    }
+
+    // Decode at p; valid is false for a malformed sequence
+    size_t decode(const unsigned char* p, size_t avail, char32_t& codePoint, bool& valid) {
+        valid = false;
+        unsigned char lead = p[0];
+        if (lead < 0x80) {
+            codePoint = lead;
+            valid = true;
+            return 1;
+        }
+
+        // Continuation bytes needed, and the range the first one must fall in
+        // to rule out overlong forms, surrogates and values past U+10FFFF
+        size_t need;
+        unsigned char lo = 0x80, hi = 0xBF;
+        char32_t cp;
+        if (lead >= 0xC2 && lead <= 0xDF) {
+            need = 1;
+            cp = lead & 0x1F;
+        } else if (lead >= 0xE0 && lead <= 0xEF) {
+            need = 2;
+            cp = lead & 0x0F;
+            if (lead == 0xE0) lo = 0xA0;
+            if (lead == 0xED) hi = 0x9F;
+        } else if (lead >= 0xF0 && lead <= 0xF4) {
+            need = 3;
+            cp = lead & 0x07;
+            if (lead == 0xF0) lo = 0x90;
+            if (lead == 0xF4) hi = 0x8F;
+        } else {
+            codePoint = kReplacement;
+            return 1;
+        }
+
+        for (size_t i = 1; i <= need; ++i) {
+            if (i >= avail || p[i] < lo || p[i] > hi) {
+                codePoint = kReplacement;
+                return i;
+            }
+            cp = (cp << 6) | (p[i] & 0x3F);
+            lo = 0x80;
+            hi = 0xBF;
+        }
+        codePoint = cp;
+        valid = true;
+        return need + 1;
+    }
+
+    template <typename Unit>
+    std::string toUtf8(std::basic_string_view<Unit> text) {
+        // Sized as if the rest were ASCII, plus a block of slack; grown when a
+        // character needs more than one byte
+        size_t n = text.size();
+        std::string out(n + kBlock, '\0');
+        size_t pos = 0;
+        size_t i = 0;
+        auto reserve = [&](size_t bytes, size_t units) {
+            size_t needed = pos + bytes + (n - i - units) + kBlock;
+            if (needed > out.size()) {
+                out.resize(std::max(needed, out.size() * 2));
+            }
+        };
+
+        while (i < n) {
+            if (i + kBlock <= n && narrowBlock(text.data() + i, &out[pos])) {
+                i += kBlock;
+                pos += kBlock;
+                continue;
+            }
+            uint32_t unit = static_cast<uint32_t>(text[i]);
+            if (unit < 0x80) {
+                out[pos++] = static_cast<char>(unit);
+                i++;
+                continue;
+            }
+
+            char32_t cp = unit;
+            size_t units = 1;
+            if constexpr (sizeof(Unit) == 2) {
+                if (unit >= 0xD800 && unit <= 0xDBFF && i + 1 < n &&
+                    text[i + 1] >= 0xDC00 && text[i + 1] <= 0xDFFF) {
+                    cp = 0x10000 + ((unit - 0xD800) << 10) + (static_cast<uint32_t>(text[i + 1]) - 0xDC00);
+                    units = 2;
+                } else if (unit >= 0xD800 && unit <= 0xDFFF) {
+                    cp = kReplacement;
+                }
+            } else if ((unit >= 0xD800 && unit <= 0xDFFF) || unit > 0x10FFFF) {
+                cp = kReplacement;
+            }
+            reserve(4, units);
+            pos = static_cast<size_t>(encode(&out[pos], cp) - out.data());
+            i += units;
+        }
+        out.resize(pos);
+        return out;
+    }
+
+    template <typename Unit>
+    std::basic_string<Unit> fromUtf8(std::string_view text) {
+        // Never more code units than bytes
+        size_t n = text.size();
+        std::basic_string<Unit> out(n, Unit(0));
+        size_t pos = 0;
+        size_t i = 0;
+        while (i < n) {
+            if (i + kBlock <= n && asciiBlock(text.data() + i)) {
+                widenBlock(text.data() + i, &out[pos]);
+                i += kBlock;
+                pos += kBlock;
+                continue;
+            }
+            char32_t cp;
+            i += Decode(text, i, cp);
+            if (sizeof(Unit) == 2 && cp >= 0x10000) {
+                out[pos++] = static_cast<Unit>(0xD800 + ((cp - 0x10000) >> 10));
+                out[pos++] = static_cast<Unit>(0xDC00 + ((cp - 0x10000) & 0x3FF));
+            } else {
+                out[pos++] = static_cast<Unit>(cp);
+            }
+        }
+        out.resize(pos);
+        return out;
+    }
+}
+
+size_t Decode(std::string_view text, size_t pos, char32_t& codePoint)
+{
+    bool valid;
+    return decode(reinterpret_cast<const unsigned char*>(text.data()) + pos, text.size() - pos, codePoint, valid);
+}
+
+void Append(std::string& out, char32_t codePoint)
+{
+    char buffer[4];
+    out.append(buffer, static_cast<size_t>(encode(buffer, codePoint) - buffer));
+}
+
+size_t AsciiPrefix(std::string_view text)
+{
+    size_t i = 0;
+    while (i + kBlock <= text.size() && asciiBlock(text.data() + i)) {
+        i += kBlock;
+    }
+    while (i < text.size() && static_cast<unsigned char>(text[i]) < 0x80) {
+        i++;
+    }
+    return i;
+}
+
+bool IsValidUtf8(std::string_view text)
+{
+    size_t i = 0;
+    while (i < text.size()) {
+        i += AsciiPrefix(text.substr(i));
+        if (i == text.size()) break;
+        char32_t cp;
+        bool valid;
+        i += decode(reinterpret_cast<const unsigned char*>(text.data()) + i, text.size() - i, cp, valid);
+        if (!valid) return false;
+    }
+    return true;
+}
+
+std::string ToUtf8(std::wstring_view text)
+{
+    return toUtf8(text);
+}
+
+std::string ToUtf8(std::u16string_view text)
+{
+    return toUtf8(text);
+}
+
+std::wstring FromUtf8(std::string_view text)
+{
+    return fromUtf8<wchar_t>(text);
+}
+
+std::u16string ToUtf16(std::string_view text)
+{
+    return fromUtf8<char16_t>(text);
+}
+
+std::string FromCp1252(std::string_view text)
+{
+    size_t ascii = AsciiPrefix(text);
+    std::string out;
+    out.reserve(text.size() + (text.size() - ascii));
+    out.append(text.data(), ascii);
+    for (size_t i = ascii; i < text.size(); ++i) {
+        unsigned char byte = static_cast<unsigned char>(text[i]);
+        Append(out, byte >= 0x80 && byte < 0xA0 ? kCp1252High[byte - 0x80] : byte);
+    }
+    return out;
+}
+
+bool ToCp1252(char32_t codePoint, char& byte)
+{
+    if (codePoint < 0x80 || (codePoint >= 0xA0 && codePoint <= 0xFF)) {
+        byte = static_cast<char>(codePoint);
+        return true;
+    }
+    for (int i = 0; i < 32; ++i) {
+        if (kCp1252High[i] == codePoint) {
+            byte = static_cast<char>(0x80 + i);
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace Utf
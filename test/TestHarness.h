@@ -0,0 +1,113 @@
+// TestHarness - minimal self-contained unit test runner
+//
+// Each test/*.cpp file builds into its own executable (see CMakeLists.txt)
+// and is registered with ctest. Tests register themselves with TEST(name);
+// CHECK records a failure and carries on, REQUIRE stops the current test.
+//
+//   TEST(RoundTrip) {
+//       CHECK_EQ(Decode(Encode("x")), "x");
+//   }
+
+#pragma once
+
+#include <cstdio>
+#include <exception>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace TestHarness {
+
+struct TestCase {
+    const char* name;
+    void (*fn)();
+};
+
+inline std::vector<TestCase>& Registry() {
+    static std::vector<TestCase> tests;
+    return tests;
+}
+
+inline int& FailureCount() {
+    static int failures = 0;
+    return failures;
+}
+
+struct Registrar {
+    Registrar(const char* name, void (*fn)()) { Registry().push_back({name, fn}); }
+};
+
+// Thrown by REQUIRE to abandon the current test
+struct Abort {};
+
+inline void Fail(const char* file, int line, const std::string& message) {
+    FailureCount()++;
+    std::fprintf(stderr, "%s:%d: FAILED: %s\n", file, line, message.c_str());
+}
+
+template <typename T>
+std::string Describe(const T& value) {
+    std::ostringstream out;
+    out << value;
+    return out.str();
+}
+
+inline std::string Describe(const std::wstring& value) {
+    return std::string(value.begin(), value.end());
+}
+
+inline std::string Describe(bool value) {
+    return value ? "true" : "false";
+}
+
+inline int RunAll() {
+    int failedTests = 0;
+    for (const TestCase& test : Registry()) {
+        int before = FailureCount();
+        try {
+            test.fn();
+        } catch (const Abort&) {
+        } catch (const std::exception& e) {
+            Fail(__FILE__, __LINE__, std::string(test.name) + " threw " + e.what());
+        }
+        bool passed = FailureCount() == before;
+        if (!passed) failedTests++;
+        std::printf("[%s] %s\n", passed ? "  OK  " : " FAIL ", test.name);
+    }
+    std::printf("%zu tests, %d failed\n", Registry().size(), failedTests);
+    return failedTests == 0 ? 0 : 1;
+}
+
+} // namespace TestHarness
+
+#define TEST(name)                                                            \
+    static void name();                                                       \
+    static TestHarness::Registrar name##_registrar(#name, name);              \
+    static void name()
+
+#define CHECK(cond)                                                           \
+    do {                                                                      \
+        if (!(cond)) TestHarness::Fail(__FILE__, __LINE__, #cond);            \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                            \
+    do {                                                                      \
+        const auto& actual_ = (actual);                                       \
+        const auto& expected_ = (expected);                                   \
+        if (!(actual_ == expected_)) {                                        \
+            TestHarness::Fail(__FILE__, __LINE__, std::string(#actual " == " #expected) + \
+                " (got " + TestHarness::Describe(actual_) +                   \
+                ", expected " + TestHarness::Describe(expected_) + ")");     \
+        }                                                                     \
+    } while (0)
+
+#define REQUIRE(cond)                                                         \
+    do {                                                                      \
+        if (!(cond)) {                                                        \
+            TestHarness::Fail(__FILE__, __LINE__, #cond);                     \
+            throw TestHarness::Abort();                                       \
+        }                                                                     \
+    } while (0)
+
+#define TEST_MAIN()                                                           \
+    int main() { return TestHarness::RunAll(); }
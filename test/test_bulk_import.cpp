@@ -0,0 +1,273 @@
+// BulkImport tests: enumeration filters, batching, skipping and cancellation
+
+#include "TestHarness.h"
+#include "BulkImport.h"
+#include "ContentHash.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <set>
+
+namespace fs = std::filesystem;
+
+namespace {
+    // Scratch tree, removed again when the test ends
+    struct TempTree {
+        fs::path root;
+
+        explicit TempTree(const char* name) : root(fs::temp_directory_path() / name) {
+            fs::remove_all(root);
+            fs::create_directories(root);
+        }
+        ~TempTree() {
+            std::error_code ec;
+            fs::remove_all(root, ec);
+        }
+        void Write(const fs::path& relative, const std::string& content) {
+            fs::create_directories((root / relative).parent_path());
+            std::ofstream file(root / relative, std::ios::binary);
+            file << content;
+        }
+    };
+
+    std::set<std::wstring> names(const std::vector<BulkImport::File>& files, const fs::path& root) {
+        std::set<std::wstring> out;
+        for (const auto& file : files) {
+            out.insert(fs::path(file.path).lexically_relative(root).generic_wstring());
+        }
+        return out;
+    }
+}
+
+TEST(EnumerateFilters) {
+    TempTree tree("keepsync_test_import_enum");
+    tree.Write("a.txt", "a");
+    tree.Write("sub/b.md", "b");
+    tree.Write("sub/deeper/c.txt", "c");
+    tree.Write("sub/image.PNG", "png");
+    tree.Write("empty.txt", "");
+    tree.Write(".git/config", "x");
+    tree.Write(".hidden", "x");
+    tree.Write("node_modules/pkg/index.txt", "x");
+    tree.Write("sub/Thumbs.db", "x");
+
+    BulkImport::Options options;
+    options.rules = SyncRules::Compile({L"png"}, {L"node_modules", L"thumbs.db"});
+    BulkImport::Progress progress;
+    auto files = BulkImport::Enumerate(tree.root.wstring(), options, progress);
+
+    std::set<std::wstring> expected = {L"a.txt", L"sub/b.md", L"sub/deeper/c.txt"};
+    CHECK(names(files, tree.root) == expected);
+    CHECK_EQ(progress.total.load(), uint64_t(3));
+    CHECK(std::is_sorted(files.begin(), files.end(),
+                         [](const auto& a, const auto& b) { return a.path < b.path; }));
+}
+
+TEST(EnumerateMissingRoot) {
+    BulkImport::Options options;
+    BulkImport::Progress progress;
+    auto files = BulkImport::Enumerate((fs::temp_directory_path() / "keepsync_no_such_dir").wstring(),
+                                       options, progress);
+    CHECK(files.empty());
+}
+
+TEST(RunBatchesAndSkips) {
+    TempTree tree("keepsync_test_import_run");
+    for (int i = 0; i < 250; ++i) {
+        tree.Write("n" + std::to_string(i) + ".txt", "note " + std::to_string(i));
+    }
+
+    BulkImport::Options options;
+    options.threads = 4;
+    options.batchFiles = 40;
+    options.readAhead = 16;
+    BulkImport::Progress progress;
+    auto files = BulkImport::Enumerate(tree.root.wstring(), options, progress);
+    REQUIRE(files.size() == 250);
+
+    // Every tenth file is already in sync
+    std::wstring unchanged = ContentHash::Md5Hex("note 0");
+    std::vector<size_t> batchSizes;
+    std::set<std::wstring> uploaded;
+    BulkImport::Hooks hooks;
+    hooks.needsSync = [](const std::wstring& path, const std::wstring&) {
+        std::wstring name = fs::path(path).filename().wstring();
+        return std::stoi(name.substr(1)) % 10 != 0;
+    };
+    hooks.upload = [&](std::vector<BulkImport::Item>& batch) {
+        batchSizes.push_back(batch.size());
+        for (auto& item : batch) {
+            CHECK_EQ(item.hash, ContentHash::HashFile(item.path));
+            CHECK(!item.content.empty());
+            uploaded.insert(item.path);
+            item.ok = true;
+        }
+        return true;
+    };
+
+    CHECK(BulkImport::Run(files, options, hooks, progress));
+    CHECK(progress.done.load());
+    CHECK_EQ(progress.read.load(), uint64_t(250));
+    CHECK_EQ(progress.skipped.load(), uint64_t(25));
+    CHECK_EQ(progress.uploaded.load(), uint64_t(225));
+    CHECK_EQ(progress.failed.load(), uint64_t(0));
+    CHECK_EQ(uploaded.size(), size_t(225));
+    for (size_t i = 0; i + 1 < batchSizes.size(); ++i) {
+        CHECK_EQ(batchSizes[i], size_t(40));
+    }
+    CHECK_EQ(BulkImport::FormatProgress(progress),
+             std::string("250 / 250 read, 225 uploaded, 25 skipped, 0 failed"));
+}
+
+TEST(RunBatchBytesLimit) {
+    TempTree tree("keepsync_test_import_bytes");
+    for (int i = 0; i < 10; ++i) {
+        tree.Write("n" + std::to_string(i) + ".txt", std::string(1000, 'x'));
+    }
+    BulkImport::Options options;
+    options.batchBytes = 2500;
+    BulkImport::Progress progress;
+    auto files = BulkImport::Enumerate(tree.root.wstring(), options, progress);
+
+    size_t largest = 0;
+    BulkImport::Hooks hooks;
+    hooks.upload = [&](std::vector<BulkImport::Item>& batch) {
+        largest = std::max(largest, batch.size());
+        for (auto& item : batch) item.ok = true;
+        return true;
+    };
+    CHECK(BulkImport::Run(files, options, hooks, progress));
+    CHECK_EQ(largest, size_t(3));
+    CHECK_EQ(progress.uploaded.load(), uint64_t(10));
+}
+
+TEST(RunUploadFailures) {
+    TempTree tree("keepsync_test_import_fail");
+    for (int i = 0; i < 20; ++i) {
+        tree.Write("n" + std::to_string(i) + ".txt", "x");
+    }
+    BulkImport::Options options;
+    options.batchFiles = 5;
+    BulkImport::Progress progress;
+    auto files = BulkImport::Enumerate(tree.root.wstring(), options, progress);
+
+    // Individual rejections are counted; a false return stops the import
+    int calls = 0;
+    BulkImport::Hooks hooks;
+    hooks.upload = [&](std::vector<BulkImport::Item>& batch) {
+        if (++calls == 3) return false;
+        for (size_t i = 0; i < batch.size(); ++i) batch[i].ok = (i != 0);
+        return true;
+    };
+    CHECK(!BulkImport::Run(files, options, hooks, progress));
+    CHECK(progress.done.load());
+    CHECK_EQ(calls, 3);
+    CHECK_EQ(progress.uploaded.load(), uint64_t(8));
+    CHECK_EQ(progress.failed.load(), uint64_t(7));
+}
+
+TEST(RunCancel) {
+    TempTree tree("keepsync_test_import_cancel");
+    for (int i = 0; i < 200; ++i) {
+        tree.Write("n" + std::to_string(i) + ".txt", "x");
+    }
+    BulkImport::Options options;
+    options.batchFiles = 10;
+    options.readAhead = 4;
+    BulkImport::Progress progress;
+    auto files = BulkImport::Enumerate(tree.root.wstring(), options, progress);
+
+    BulkImport::Hooks hooks;
+    hooks.upload = [&](std::vector<BulkImport::Item>& batch) {
+        for (auto& item : batch) item.ok = true;
+        progress.cancel = true;
+        return true;
+    };
+    CHECK(!BulkImport::Run(files, options, hooks, progress));
+    CHECK(progress.done.load());
+    CHECK_EQ(progress.uploaded.load(), uint64_t(10));
+}
+
+TEST(RunOrdered) {
+    TempTree tree("keepsync_test_import_ordered");
+    std::vector<BulkImport::File> files;
+    for (int i = 0; i < 300; ++i) {
+        // Sizes vary so reads finish out of order
+        std::string name = "n" + std::to_string(i) + ".txt";
+        tree.Write(name, std::string(1 + (i * 7919) % 20000, 'x'));
+        files.push_back({(tree.root / name).wstring(), 0});
+    }
+    std::reverse(files.begin(), files.end());
+
+    BulkImport::Options options;
+    options.threads = 4;
+    options.batchFiles = 7;
+    options.readAhead = 8;
+    options.ordered = true;
+    BulkImport::Progress progress;
+
+    std::vector<std::wstring> order;
+    BulkImport::Hooks hooks;
+    hooks.needsSync = [](const std::wstring& path, const std::wstring&) {
+        return fs::path(path).filename() != "n150.txt";
+    };
+    hooks.upload = [&](std::vector<BulkImport::Item>& batch) {
+        for (auto& item : batch) {
+            order.push_back(item.path);
+            item.ok = true;
+        }
+        return true;
+    };
+    CHECK(BulkImport::Run(files, options, hooks, progress));
+    files.erase(files.begin() + 149);       // n150, skipped
+    REQUIRE(order.size() == files.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        CHECK(order[i] == files[i].path);
+    }
+}
+
+TEST(RunNothing) {
+    BulkImport::Options options;
+    BulkImport::Progress progress;
+    BulkImport::Hooks hooks;
+    hooks.upload = [](std::vector<BulkImport::Item>&) { return true; };
+    CHECK(BulkImport::Run({}, options, hooks, progress));
+    CHECK(progress.done.load());
+}
+
+TEST(RunSkipsBinaryWithOnlyText) {
+    TempTree tree("keepsync_test_import_binary");
+    tree.Write("notes.txt", "plain text");
+    tree.Write("data.txt", std::string("\x7F" "ELF\x02\x01\x01\0\0\0\0\0", 12) + std::string(20000, '\0'));
+    tree.Write("wide.txt", std::string("\xFF\xFEh\0i\0", 6));
+
+    BulkImport::Options options;
+    options.onlyText = true;
+    BulkImport::Progress progress;
+    auto files = BulkImport::Enumerate(tree.root.wstring(), options, progress);
+    REQUIRE(files.size() == 3);
+
+    std::set<std::wstring> uploaded;
+    BulkImport::Hooks hooks;
+    hooks.upload = [&](std::vector<BulkImport::Item>& batch) {
+        for (auto& item : batch) {
+            CHECK_EQ(item.hash, ContentHash::HashFile(item.path));
+            uploaded.insert(fs::path(item.path).filename().wstring());
+            item.ok = true;
+        }
+        return true;
+    };
+    CHECK(BulkImport::Run(files, options, hooks, progress));
+    CHECK(uploaded == std::set<std::wstring>({L"notes.txt", L"wide.txt"}));
+    CHECK_EQ(progress.skipped.load(), uint64_t(1));
+
+    // Without onlyText the binary file goes through as before
+    uploaded.clear();
+    BulkImport::Progress again;
+    options.onlyText = false;
+    CHECK(BulkImport::Run(files, options, hooks, again));
+    CHECK_EQ(uploaded.size(), size_t(3));
+}
+
+TEST_MAIN()
@@ -0,0 +1,67 @@
+// Chunker tests: content-defined chunking of large files
+
+#include "TestHarness.h"
+#include "Chunker.h"
+
+#include <random>
+#include <set>
+
+namespace {
+    std::string makeText(size_t bytes, unsigned seed) {
+        std::mt19937 rng(seed);
+        static const char* const words[] = {"alpha", "beta", "gamma", "delta", "\xC3\xA9t\xC3\xA9", "\xE2\x82\xAC", "note"};
+        std::string text;
+        while (text.size() < bytes) {
+            text += words[rng() % 7];
+            text += (rng() % 9 == 0) ? '\n' : ' ';
+        }
+        return text;
+    }
+}
+
+TEST(ChunksCoverInputWithinLimit) {
+    std::string text = makeText(400000, 1);
+    const size_t maxSize = 16 * 1024;
+    auto chunks = Chunker::Split(text, maxSize);
+    REQUIRE(!chunks.empty());
+
+    size_t expected = 0;
+    for (const auto& c : chunks) {
+        CHECK_EQ(c.offset, expected);
+        CHECK(c.length > 0 && c.length <= maxSize);
+        CHECK_EQ(c.hash, Chunker::Hash(std::string_view(text).substr(c.offset, c.length)));
+        // Never split a UTF-8 sequence
+        if (c.offset + c.length < text.size()) {
+            CHECK((static_cast<unsigned char>(text[c.offset + c.length]) & 0xC0) != 0x80);
+        }
+        expected += c.length;
+    }
+    CHECK_EQ(expected, text.size());
+    CHECK(Chunker::Split("", maxSize).empty());
+}
+
+TEST(EditOnlyChangesNearbyChunks) {
+    std::string text = makeText(600000, 2);
+    const size_t maxSize = 16 * 1024;
+    auto before = Chunker::Split(text, maxSize);
+
+    std::string edited = text;
+    edited.insert(text.size() / 2, "an inserted line of text\n");
+    auto after = Chunker::Split(edited, maxSize);
+
+    std::set<uint64_t> oldHashes;
+    for (const auto& c : before) oldHashes.insert(c.hash);
+    size_t changed = 0;
+    for (const auto& c : after) {
+        if (!oldHashes.count(c.hash)) changed++;
+    }
+    CHECK(changed <= 3);
+}
+
+TEST(HashToString) {
+    CHECK_EQ(Chunker::HashToString(0xABCull), std::wstring(L"0000000000000abc"));
+    // FNV-1a 64 offset basis for empty input
+    CHECK_EQ(Chunker::Hash(""), 0xcbf29ce484222325ull);
+}
+
+TEST_MAIN()
@@ -0,0 +1,74 @@
+// Compression tests: snapshot codec round trips
+
+#include "TestHarness.h"
+#include "Compression.h"
+
+#include <cstring>
+#include <random>
+
+namespace {
+    bool roundTrips(const std::string& input) {
+        std::string output;
+        return Compression::Decompress(Compression::Compress(input), output) && output == input;
+    }
+}
+
+TEST(RoundTripsTypicalInputs) {
+    CHECK(roundTrips(""));
+    CHECK(roundTrips("a"));
+    CHECK(roundTrips("short note"));
+
+    std::string text;
+    for (int i = 0; i < 2000; ++i) text += "- [ ] item " + std::to_string(i % 37) + " follow up\n";
+    CHECK(roundTrips(text));
+    // Repetitive text must actually shrink
+    CHECK(Compression::Compress(text).size() < text.size() / 3);
+}
+
+TEST(RoundTripsIncompressibleInput) {
+    std::mt19937 rng(7);
+    std::string noise(100000, '\0');
+    for (auto& c : noise) c = static_cast<char>(rng());
+    CHECK(roundTrips(noise));
+}
+
+TEST(RoundTripsLongRunsAndFarMatches) {
+    CHECK(roundTrips(std::string(300000, 'z')));
+
+    // A repeat further back than the 64 KB window
+    std::mt19937 rng(11);
+    std::string block(70000, '\0');
+    for (auto& c : block) c = static_cast<char>('a' + rng() % 26);
+    CHECK(roundTrips(block + block));
+}
+
+TEST(RejectsCorruptInput) {
+    std::string output;
+    CHECK(!Compression::Decompress("", output));
+    CHECK(!Compression::Decompress("garbage that is not a block", output));
+
+    std::string compressed = Compression::Compress(std::string(5000, 'q') + "end");
+    compressed.resize(compressed.size() / 2);
+    CHECK(!Compression::Decompress(compressed, output));
+}
+
+TEST(RejectsForgedSizeHeader) {
+    std::string compressed = Compression::Compress("a short note");
+    REQUIRE(compressed.size() > 8);
+    std::string output;
+
+    // Claim 4 GiB of output from a few payload bytes
+    std::string forged = compressed;
+    std::memset(&forged[4], 0xFF, 4);
+    CHECK(!Compression::Decompress(forged, output));
+    CHECK(output.empty());
+
+    // A header with no payload may only claim an empty output
+    forged = compressed.substr(0, 8);
+    CHECK(!Compression::Decompress(forged, output));
+    std::memset(&forged[4], 0, 4);
+    CHECK(Compression::Decompress(forged, output));
+    CHECK(output.empty());
+}
+
+TEST_MAIN()
@@ -0,0 +1,59 @@
+// ContentHash tests: MD5 (RFC 1321 vectors) and CRC-32
+
+#include "TestHarness.h"
+#include "ContentHash.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+TEST(Md5KnownVectors) {
+    CHECK_EQ(ContentHash::Md5Hex(""), std::wstring(L"d41d8cd98f00b204e9800998ecf8427e"));
+    CHECK_EQ(ContentHash::Md5Hex("abc"), std::wstring(L"900150983cd24fb0d6963f7d28e17f72"));
+    CHECK_EQ(ContentHash::Md5Hex("message digest"), std::wstring(L"f96b697d7cb7938d525a2f31aaf161d0"));
+    CHECK_EQ(ContentHash::Md5Hex("12345678901234567890123456789012345678901234567890123456789012345678901234567890"),
+             std::wstring(L"57edf4a22be3c955ac49da2e2107b67a"));
+    CHECK_EQ(ContentHash::Md5Hex(std::string(1000, 'a')), std::wstring(L"cabe45dcc9ae5b66ba86600cca6b8ba8"));
+}
+
+TEST(Md5IncrementalMatchesOneShot) {
+    std::string data;
+    for (int i = 0; i < 5000; ++i) data += static_cast<char>(i * 31);
+    std::wstring expected = ContentHash::Md5Hex(data);
+
+    // Feed in uneven pieces that straddle the 64-byte block boundaries
+    for (size_t step : {1, 7, 63, 64, 65, 1000}) {
+        ContentHash::Md5 md5;
+        for (size_t pos = 0; pos < data.size(); pos += step) {
+            md5.Update(std::string_view(data).substr(pos, step));
+        }
+        uint8_t digest[16];
+        md5.Final(digest);
+        char hex[33];
+        for (int i = 0; i < 16; ++i) std::snprintf(hex + 2 * i, 3, "%02x", digest[i]);
+        std::string narrow(expected.begin(), expected.end());
+        CHECK_EQ(std::string(hex), narrow);
+    }
+}
+
+TEST(HashFileMatchesContent) {
+    auto path = std::filesystem::temp_directory_path() / "keepsync_test_hash.txt";
+    std::string content(200000, 'x');
+    content += "tail\n";
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << content;
+    }
+    CHECK_EQ(ContentHash::HashFile(path.wstring()), ContentHash::Md5Hex(content));
+    std::filesystem::remove(path);
+
+    CHECK(ContentHash::HashFile(path.wstring()).empty());
+}
+
+TEST(Crc32MatchesZlib) {
+    CHECK_EQ(ContentHash::Crc32(""), 0u);
+    CHECK_EQ(ContentHash::Crc32("123456789"), 3421780262u);
+    CHECK_EQ(ContentHash::Crc32("hello\nworld\n"), 3301268991u);
+}
+
+TEST_MAIN()
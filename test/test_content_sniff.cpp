@@ -0,0 +1,104 @@
+// ContentSniff tests: text, UTF-16 and binary detection, and decoding
+
+#include "TestHarness.h"
+#include "ContentSniff.h"
+
+#include <filesystem>
+#include <fstream>
+
+using ContentSniff::Encoding;
+
+namespace {
+    Encoding sniff(const std::string& bytes, bool complete = true) {
+        return ContentSniff::Sniff(bytes, complete).encoding;
+    }
+
+    std::string utf16le(const std::string& ascii) {
+        std::string out;
+        for (char c : ascii) {
+            out += c;
+            out += '\0';
+        }
+        return out;
+    }
+}
+
+TEST(TextEncodings) {
+    CHECK(sniff("") == Encoding::Utf8);
+    CHECK(sniff("plain\ttext\r\nwith a form feed\f and ESC \x1B[0m") == Encoding::Utf8);
+    CHECK(sniff("Gr\xC3\xBC\xC3\x9F" "e \xE6\x9D\xB1\xE4\xBA\xAC") == Encoding::Utf8);
+    CHECK(sniff("caf\xE9 cr\xE8me") == Encoding::Cp1252);
+
+    auto bom = ContentSniff::Sniff("\xEF\xBB\xBF" "abc");
+    CHECK(bom.encoding == Encoding::Utf8);
+    CHECK(bom.bom);
+
+    // UTF-16 with and without a byte order mark
+    CHECK(sniff("\xFF\xFE" + utf16le("hi")) == Encoding::Utf16Le);
+    CHECK(sniff(utf16le("hello, world")) == Encoding::Utf16Le);
+    CHECK(sniff(std::string("\0h\0e\0l\0l\0o", 10)) == Encoding::Utf16Be);
+    CHECK(!ContentSniff::Sniff(utf16le("hello")).bom);
+}
+
+TEST(BinaryContent) {
+    std::string elf("\x7F" "ELF\x02\x01\x01\0\0\0\0\0\0\0\0\0\x02\0\x3E\0", 20);
+    CHECK(sniff(elf) == Encoding::Binary);
+    CHECK(sniff(std::string(100, 'a') + '\0' + std::string(100, 'b')) == Encoding::Binary);
+
+    // Control characters but no NULs
+    std::string noisy;
+    for (int i = 0; i < 64; ++i) noisy += static_cast<char>(i % 2 ? 0x01 : 'x');
+    CHECK(sniff(noisy) == Encoding::Binary);
+    CHECK(sniff(std::string(200, 'x') + "\x01") == Encoding::Utf8);
+
+    // Only the head is looked at
+    CHECK(sniff(std::string(ContentSniff::kSniffBytes, 'x') + std::string(64, '\0')) == Encoding::Utf8);
+}
+
+TEST(TruncatedHead) {
+    // A sequence cut off at the end of the head is not an error, unless
+    // the head is the whole file
+    std::string head = std::string(40, 'x') + "\xE6\x9D";
+    CHECK(sniff(head, false) == Encoding::Utf8);
+    CHECK(sniff(head, true) == Encoding::Cp1252);
+    CHECK(sniff(std::string(40, 'x') + "\xE9 and more", false) == Encoding::Cp1252);
+}
+
+TEST(ToUtf8AndBack) {
+    auto roundTrip = [](const std::string& bytes, const std::string& text) {
+        ContentSniff::Format format = ContentSniff::Sniff(bytes);
+        std::string utf8 = ContentSniff::ToUtf8(bytes, format);
+        CHECK_EQ(utf8, text);
+        CHECK_EQ(ContentSniff::FromUtf8(utf8, format), bytes);
+    };
+    roundTrip("caf\xC3\xA9", "caf\xC3\xA9");
+    roundTrip("\xEF\xBB\xBF" "caf\xC3\xA9", "caf\xC3\xA9");
+    roundTrip("caf\xE9", "caf\xC3\xA9");
+    roundTrip("\x93" "caf\xE9\x94 \x96 \x80" "5", "\xE2\x80\x9C" "caf\xC3\xA9\xE2\x80\x9D \xE2\x80\x93 \xE2\x82\xAC" "5");
+    roundTrip("\xFF\xFE" + utf16le("hi") + std::string("\x3D\xD8\x00\xDE", 4), "hi\xF0\x9F\x98\x80");
+    roundTrip(std::string("\xFE\xFF\0h\0i\x6C\x34", 8), "hi\xE6\xB0\xB4");
+
+    // Invalid UTF-8 after a valid head falls back to Windows-1252
+    ContentSniff::Format format = ContentSniff::Sniff("valid");
+    CHECK_EQ(ContentSniff::ToUtf8("valid \xE9", format), std::string("valid \xC3\xA9"));
+    CHECK(format.encoding == Encoding::Cp1252);
+
+    CHECK_EQ(ContentSniff::FromUtf8("\xE6\x9D\xB1", format), std::string("?"));
+}
+
+TEST(SniffFile) {
+    auto path = std::filesystem::temp_directory_path() / "keepsync_test_sniff.bin";
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << std::string(ContentSniff::kSniffBytes - 1, 'x') << "\xC3\xA9" << std::string(10, '\0');
+    }
+    ContentSniff::Format format;
+    REQUIRE(ContentSniff::SniffFile(path.wstring(), format));
+    CHECK(format.encoding == Encoding::Utf8);
+    std::filesystem::remove(path);
+
+    CHECK(!ContentSniff::SniffFile((std::filesystem::temp_directory_path() / "keepsync_no_such_file").wstring(),
+                                   format));
+}
+
+TEST_MAIN()
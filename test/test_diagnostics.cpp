@@ -0,0 +1,73 @@
+// Diagnostics tests: histograms, per-command latency and the report
+
+#include "TestHarness.h"
+#include "Diagnostics.h"
+
+#include <thread>
+#include <vector>
+
+TEST(HistogramBucketsAndPercentiles) {
+    Diagnostics::Histogram h;
+    for (int i = 0; i < 90; ++i) h.Record(10);     // Bucket [8, 16)
+    for (int i = 0; i < 10; ++i) h.Record(5000);   // Bucket [4096, 8192)
+    CHECK_EQ(h.Count(), uint64_t(100));
+    CHECK_EQ(h.SumUs(), uint64_t(90 * 10 + 10 * 5000));
+    CHECK_EQ(h.MaxUs(), uint64_t(5000));
+    CHECK_EQ(h.Bucket(3), uint64_t(90));
+    CHECK_EQ(h.PercentileUs(0.5), uint64_t(16));
+    // Capped at the observed maximum
+    CHECK_EQ(h.PercentileUs(0.99), uint64_t(5000));
+
+    Diagnostics::Histogram empty;
+    CHECK_EQ(empty.PercentileUs(0.5), uint64_t(0));
+}
+
+TEST(ConcurrentRecording) {
+    Diagnostics::CommandLatencies latencies;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 10000; ++i) {
+                latencies.Record(i % 2 ? "get" : "status", 100);
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    uint64_t total = 0;
+    int names = 0;
+    for (int i = 0; i < Diagnostics::CommandLatencies::kMaxCommands && latencies.Name(i); ++i) {
+        total += latencies.At(i).Count();
+        names++;
+    }
+    CHECK_EQ(names, 2);
+    CHECK_EQ(total, uint64_t(40000));
+}
+
+TEST(ReportListsCounters) {
+    Diagnostics::SyncCounters sync;
+    Diagnostics::Add(sync.attempted, 3);
+    Diagnostics::Add(sync.failed);
+    Diagnostics::BridgeCounters bridge;
+    Diagnostics::Add(bridge.commands, 2);
+    bridge.latency.Record("create_note", 1500);
+    sync.queueWait[1].Record(2500);
+    bridge.recovery.Record(300000);
+    Diagnostics::Add(bridge.replayed);
+    Diagnostics::Add(bridge.timeouts, 2);
+    Diagnostics::Add(bridge.lateFrames);
+
+    std::string report = Diagnostics::FormatReport(sync, &bridge);
+    CHECK(report.find("attempted 3") != std::string::npos);
+    CHECK(report.find("failed 1") != std::string::npos);
+    CHECK(report.find("create_note") != std::string::npos);
+    CHECK(report.find("changed outside the editor 0") != std::string::npos);
+    CHECK(report.find("  save                      1") != std::string::npos);
+    CHECK(report.find("recovered 1 (") != std::string::npos);
+    CHECK(report.find("max 300.0 ms)   replayed 1") != std::string::npos);
+    CHECK(report.find("timed out 2   late replies dropped 1") != std::string::npos);
+
+    CHECK(Diagnostics::FormatReport(sync, nullptr).find("not running") != std::string::npos);
+}
+
+TEST_MAIN()
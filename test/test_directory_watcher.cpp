@@ -0,0 +1,195 @@
+// DirectoryWatcher tests: watch planning, coalescing and live inotify events
+
+#include "TestHarness.h"
+#include "DirectoryWatcher.h"
+#include "Platform.h"
+
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+using namespace std::chrono_literals;
+
+TEST(PlanDeduplicatesParents) {
+    std::vector<std::wstring> files;
+    for (int i = 0; i < 3000; ++i) {
+        std::wstring dir = (i % 3 == 0) ? L"/notes/work" : (i % 3 == 1) ? L"/notes/home" : L"/tmp";
+        files.push_back(dir + L"/file" + std::to_wstring(i) + L".txt");
+    }
+    auto roots = DirectoryWatcher::Plan(files, false);
+    REQUIRE(roots.size() == 3);
+    CHECK_EQ(roots[0].directory, std::wstring(L"/notes/home"));
+    CHECK_EQ(roots[1].directory, std::wstring(L"/notes/work"));
+    CHECK_EQ(roots[2].directory, std::wstring(L"/tmp"));
+    CHECK(!roots[0].recursive);
+}
+
+TEST(PlanRecursiveKeepsTopmost) {
+    std::vector<std::wstring> files = {
+        L"/notes/a.txt",
+        L"/notes/work/b.txt",
+        L"/notes/work/deep/c.txt",
+        L"/notes two/d.txt",        // Sorts between /notes and /notes/work
+        L"/other/e.txt",
+        L"relative.txt",            // No directory to watch
+    };
+    auto roots = DirectoryWatcher::Plan(files, true);
+    REQUIRE(roots.size() == 3);
+    CHECK_EQ(roots[0].directory, std::wstring(L"/notes"));
+    CHECK_EQ(roots[1].directory, std::wstring(L"/notes two"));
+    CHECK_EQ(roots[2].directory, std::wstring(L"/other"));
+    CHECK(roots[0].recursive);
+}
+
+TEST(PlanNeverWatchesRootOrProfileRecursively) {
+    fs::path home = Platform::HomeDirectory();
+    REQUIRE(!home.empty());
+    std::vector<std::wstring> files = {
+        (fs::path(L"/") / L"a.txt").wstring(),
+        (home / L"b.txt").wstring(),
+        (home / L"notes" / L"c.txt").wstring(),
+    };
+    auto roots = DirectoryWatcher::Plan(files, true, size_t(-1));
+    REQUIRE(roots.size() == 3);
+    CHECK(!roots[0].recursive);
+    CHECK_EQ(roots[1].directory, home.wstring());
+    CHECK(!roots[1].recursive);
+    CHECK_EQ(roots[2].directory, (home / L"notes").wstring());
+}
+
+TEST(PlanWatchesLargeSubtreePerDirectory) {
+    fs::path root = fs::temp_directory_path() / "keepsync_test_plan";
+    fs::remove_all(root);
+    fs::create_directories(root / "src" / "deep");
+    for (int i = 0; i < 10; ++i) {
+        std::ofstream(root / "src" / ("f" + std::to_string(i)));
+    }
+    std::vector<std::wstring> files = {
+        (root / "a.txt").wstring(),
+        (root / "src" / "deep" / "b.txt").wstring(),
+    };
+
+    auto roots = DirectoryWatcher::Plan(files, true, 100);
+    REQUIRE(roots.size() == 1);
+    CHECK(roots[0].recursive);
+
+    roots = DirectoryWatcher::Plan(files, true, 5);
+    REQUIRE(roots.size() == 2);
+    CHECK_EQ(roots[0].directory, root.wstring());
+    CHECK(!roots[0].recursive);
+    CHECK_EQ(roots[1].directory, (root / "src" / "deep").wstring());
+    CHECK(roots[1].recursive);
+    fs::remove_all(root);
+}
+
+TEST(CoalescerWaitsForQuiet) {
+    ChangeCoalescer coalescer(100ms);
+    auto t0 = ChangeCoalescer::Clock::time_point{};
+    CHECK(!coalescer.NextDue());
+
+    coalescer.Add(L"a", t0);
+    coalescer.Add(L"a", t0 + 50ms);
+    coalescer.Add(L"b", t0 + 60ms);
+    CHECK_EQ(coalescer.Pending(), size_t(2));
+    CHECK(*coalescer.NextDue() == t0 + 150ms);
+
+    CHECK(coalescer.TakeDue(t0 + 149ms).empty());
+    auto due = coalescer.TakeDue(t0 + 150ms);
+    REQUIRE(due.size() == 1);
+    CHECK_EQ(due[0], std::wstring(L"a"));
+
+    due = coalescer.TakeDue(t0 + 200ms);
+    REQUIRE(due.size() == 1);
+    CHECK_EQ(due[0], std::wstring(L"b"));
+    CHECK_EQ(coalescer.Pending(), size_t(0));
+}
+
+TEST(CoalescerBoundsBusyFiles) {
+    ChangeCoalescer coalescer(100ms, 1s);
+    auto t0 = ChangeCoalescer::Clock::time_point{};
+    // An event every 50ms never leaves a 100ms gap
+    for (int i = 0; i < 19; ++i) {
+        coalescer.Add(L"log", t0 + i * 50ms);
+        CHECK(coalescer.TakeDue(t0 + i * 50ms).empty());
+    }
+    coalescer.Add(L"log", t0 + 950ms);
+    CHECK_EQ(coalescer.TakeDue(t0 + 1s).size(), size_t(1));
+}
+
+#ifdef __linux__
+namespace {
+    struct Changes {
+        std::mutex mutex;
+        std::condition_variable arrived;
+        std::multiset<std::wstring> paths;
+
+        void Add(const std::wstring& path) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                paths.insert(path);
+            }
+            arrived.notify_all();
+        }
+        bool WaitFor(const std::wstring& path) {
+            std::unique_lock<std::mutex> lock(mutex);
+            return arrived.wait_for(lock, 5s, [&] { return paths.count(path) > 0; });
+        }
+    };
+
+    void write(const fs::path& path, const std::string& content) {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file << content;
+    }
+}
+
+TEST(ReportsWritesAndRenames) {
+    fs::path root = fs::temp_directory_path() / "keepsync_test_watcher";
+    fs::remove_all(root);
+    fs::create_directories(root / "a");
+    fs::create_directories(root / "b");
+
+    Changes changes;
+    DirectoryWatcher watcher([&](const std::wstring& path) { changes.Add(path); }, 50ms);
+    std::vector<std::wstring> mapped;
+    for (int i = 0; i < 100; ++i) {
+        mapped.push_back((root / (i % 2 ? "a" : "b") / ("n" + std::to_string(i) + ".txt")).wstring());
+    }
+    watcher.SetRoots(DirectoryWatcher::Plan(mapped, DirectoryWatcher::SupportsRecursive()));
+    REQUIRE(watcher.Start());
+
+    // Writes coalesce into one report per file
+    std::wstring note = (root / "a" / "n1.txt").wstring();
+    for (int i = 0; i < 20; ++i) {
+        write(note, "edit " + std::to_string(i));
+    }
+    CHECK(changes.WaitFor(note));
+    CHECK_EQ(watcher.HandleCount(), size_t(2));
+
+    // Save-by-rename, as editors and git do
+    std::wstring renamed = (root / "b" / "n0.txt").wstring();
+    write(root / "b" / "n0.txt.tmp", "new");
+    fs::rename(root / "b" / "n0.txt.tmp", root / "b" / "n0.txt");
+    CHECK(changes.WaitFor(renamed));
+
+    std::this_thread::sleep_for(200ms);
+    {
+        std::lock_guard<std::mutex> lock(changes.mutex);
+        CHECK_EQ(changes.paths.count(note), size_t(1));
+    }
+
+    // Dropped roots give their handles back
+    watcher.SetRoots({{(root / "b").wstring(), false}});
+    std::this_thread::sleep_for(100ms);
+    CHECK_EQ(watcher.HandleCount(), size_t(1));
+
+    watcher.Stop();
+    fs::remove_all(root);
+}
+#endif
+
+TEST_MAIN()
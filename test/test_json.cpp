@@ -0,0 +1,70 @@
+// Json tests: value extraction from bridge replies
+
+#include "TestHarness.h"
+#include "Json.h"
+
+using namespace NppGoogleKeepSync;
+
+TEST(ExtractStringDecodesEscapes) {
+    std::string json = R"({"success": true, "text": "a\nb\t\"q\" \\ \u00e9 \ud83d\ude00"})";
+    CHECK_EQ(Json::ExtractString(json, "text"), std::string("a\nb\t\"q\" \\ \xC3\xA9 \xF0\x9F\x98\x80"));
+    CHECK_EQ(Json::ExtractString(json, "missing"), std::string());
+    // Non-string values are not strings
+    CHECK_EQ(Json::ExtractString(json, "success"), std::string());
+}
+
+TEST(ExtractStringRejectsShortUnicodeEscapes) {
+    // Fewer than four hex digits, or digits strtoul would stretch to accept
+    for (const char* json : {R"({"text": "a\u12"})", R"({"text": "a\u12g4b"})",
+                             R"({"text": "a\u+1f2"})", R"({"text": "a\u 123"})",
+                             "{\"text\": \"a\\u1"}) {
+        CHECK_EQ(Json::ExtractString(json, "text"), std::string());
+    }
+    // A lone high surrogate before a bad escape is not paired with it
+    CHECK_EQ(Json::ExtractString(R"({"text": "\ud83d\udXYZ"})", "text"), std::string());
+    CHECK_EQ(Json::ExtractString(R"({"text": "\u00E9"})", "text"), std::string("\xC3\xA9"));
+}
+
+TEST(ExtractValueReturnsRawScalars) {
+    std::string json = R"({"id": "abc", "count": 42 , "ok":false})";
+    CHECK_EQ(Json::ExtractValue(json, "id"), std::string("abc"));
+    CHECK_EQ(Json::ExtractValue(json, "count"), std::string("42"));
+    CHECK_EQ(Json::ExtractValue(json, "ok"), std::string("false"));
+    CHECK_EQ(Json::ExtractValue(json, "nope"), std::string());
+}
+
+TEST(ExtractBool) {
+    std::string json = R"({"success": true, "full": false})";
+    CHECK(Json::ExtractBool(json, "success"));
+    CHECK(!Json::ExtractBool(json, "full"));
+    CHECK(!Json::ExtractBool(json, "missing"));
+}
+
+TEST(ExtractStringArray) {
+    std::string json = R"({"labels": ["work", "a \"quoted\" one", ""], "other": ["x"]})";
+    auto labels = Json::ExtractStringArray(json, "labels");
+    REQUIRE(labels.size() == 3);
+    CHECK_EQ(labels[0], std::string("work"));
+    CHECK_EQ(labels[1], std::string("a \"quoted\" one"));
+    CHECK_EQ(labels[2], std::string());
+    CHECK(Json::ExtractStringArray(json, "missing").empty());
+}
+
+TEST(ForEachObjectSkipsBracesInStrings) {
+    std::string json = R"({"notes": [{"id": "1", "text": "{not} [an] object"}, {"id": "2", "nested": {"a": 1}}], "after": [{"id": "x"}]})";
+    std::vector<std::string> ids;
+    Json::ForEachObject(json, "notes", [&](const std::string& obj) {
+        ids.push_back(Json::ExtractString(obj, "id"));
+        return true;
+    });
+    REQUIRE(ids.size() == 2);
+    CHECK_EQ(ids[0], std::string("1"));
+    CHECK_EQ(ids[1], std::string("2"));
+
+    // Returning false stops the walk
+    size_t seen = 0;
+    Json::ForEachObject(json, "notes", [&](const std::string&) { seen++; return false; });
+    CHECK_EQ(seen, size_t(1));
+}
+
+TEST_MAIN()
@@ -0,0 +1,103 @@
+// MappingStore tests: mappings file format and persistence
+
+#include "TestHarness.h"
+#include "MappingStore.h"
+
+#include <filesystem>
+#include <fstream>
+
+TEST(FormatParseRoundTrip) {
+    NoteMapping mapping;
+    mapping.filePath = L"C:\\notes\\todo.txt";
+    mapping.keepNoteId = L"1a2b3c";
+    mapping.lastSyncHash = L"d41d8cd98f00b204e9800998ecf8427e";
+    mapping.status = SyncStatus::SYNCED;
+    mapping.lastSyncTime = 133500000000000000ull;
+    mapping.baseSnapshot = L"1a2b3c.base";
+    mapping.chunkNoteIds = {L"n1", L"n2"};
+    mapping.chunkHashes = {L"00000000000000aa", L"00000000000000bb"};
+
+    std::string line = MappingStore::FormatLine(mapping);
+    CHECK_EQ(line, std::string("C:\\notes\\todo.txt,1a2b3c,d41d8cd98f00b204e9800998ecf8427e,SYNCED,"
+                               "133500000000000000,1a2b3c.base,n1:00000000000000aa;n2:00000000000000bb"));
+
+    NoteMapping parsed;
+    REQUIRE(MappingStore::ParseLine(line, parsed));
+    CHECK_EQ(parsed.filePath, mapping.filePath);
+    CHECK_EQ(parsed.keepNoteId, mapping.keepNoteId);
+    CHECK_EQ(parsed.lastSyncHash, mapping.lastSyncHash);
+    CHECK(parsed.status == SyncStatus::SYNCED);
+    CHECK_EQ(parsed.lastSyncTime, mapping.lastSyncTime);
+    CHECK_EQ(parsed.baseSnapshot, mapping.baseSnapshot);
+    CHECK(parsed.chunkNoteIds == mapping.chunkNoteIds);
+    CHECK(parsed.chunkHashes == mapping.chunkHashes);
+}
+
+TEST(ParsesOlderLines) {
+    // Five fields: written before snapshots and chunking existed
+    NoteMapping mapping;
+    REQUIRE(MappingStore::ParseLine("a.txt,id,hash,FAILED,42", mapping));
+    CHECK(mapping.status == SyncStatus::FAILED);
+    CHECK_EQ(mapping.lastSyncTime, uint64_t(42));
+    CHECK(mapping.baseSnapshot.empty());
+    CHECK(mapping.chunkNoteIds.empty());
+
+    // Six fields: snapshot but no chunks
+    REQUIRE(MappingStore::ParseLine("a.txt,id,hash,SYNCED,42,id.base", mapping));
+    CHECK_EQ(mapping.baseSnapshot, std::wstring(L"id.base"));
+    CHECK(mapping.chunkNoteIds.empty());
+
+    CHECK(!MappingStore::ParseLine("not,enough,fields", mapping));
+}
+
+TEST(SaveAndLoad) {
+    auto path = std::filesystem::temp_directory_path() / "keepsync_test.mappings";
+    MappingStore::MappingTable table;
+    for (int i = 0; i < 50; ++i) {
+        NoteMapping mapping;
+        mapping.filePath = L"/notes/file" + std::to_wstring(i) + L".txt";
+        mapping.keepNoteId = L"note" + std::to_wstring(i);
+        mapping.status = i % 2 ? SyncStatus::SYNCED : SyncStatus::PENDING;
+        mapping.lastSyncTime = MappingStore::Now();
+        table[mapping.filePath] = mapping;
+    }
+    REQUIRE(MappingStore::Save(path.wstring(), table));
+
+    MappingStore::MappingTable loaded;
+    REQUIRE(MappingStore::Load(path.wstring(), loaded));
+    CHECK_EQ(loaded.size(), table.size());
+    for (const auto& pair : table) {
+        auto it = loaded.find(pair.first);
+        REQUIRE(it != loaded.end());
+        CHECK_EQ(it->second.keepNoteId, pair.second.keepNoteId);
+        CHECK(it->second.status == pair.second.status);
+        CHECK_EQ(it->second.lastSyncTime, pair.second.lastSyncTime);
+    }
+    std::filesystem::remove(path);
+
+    MappingStore::MappingTable missing;
+    CHECK(!MappingStore::Load(path.wstring(), missing));
+}
+
+TEST(NonAsciiPathsAreUtf8) {
+    NoteMapping mapping;
+    mapping.filePath = L"C:\\notes\\Grüße 東京.txt";
+    mapping.keepNoteId = L"id";
+    std::string line = MappingStore::FormatLine(mapping);
+    CHECK(line.compare(0, 27, "C:\\notes\\Gr\xC3\xBC\xC3\x9F" "e \xE6\x9D\xB1\xE4\xBA\xAC.txt") == 0);
+
+    NoteMapping parsed;
+    REQUIRE(MappingStore::ParseLine(line, parsed));
+    CHECK(parsed.filePath == mapping.filePath);
+
+    // Older files held one byte per character
+    REQUIRE(MappingStore::ParseLine("C:\\notes\\caf\xE9.txt,id,hash,SYNCED,42", parsed));
+    CHECK(parsed.filePath == L"C:\\notes\\café.txt");
+}
+
+TEST(NowIsFileTime) {
+    // 2020-01-01 in FILETIME ticks; the clock must be past it
+    CHECK(MappingStore::Now() > 132223104000000000ull);
+}
+
+TEST_MAIN()
@@ -0,0 +1,129 @@
+// NoteList tests: in-place decoding of note-list replies
+
+#include "TestHarness.h"
+#include "NoteList.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+using namespace NppGoogleKeepSync;
+
+namespace {
+    std::atomic<size_t> g_allocations{0};
+}
+
+// Counts every heap allocation in this test binary
+void* operator new(size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+TEST(DecodesFieldsInPlace) {
+    NoteList list;
+    REQUIRE(list.Parse(R"({"success": true, "count": 2, "notes": [)"
+                       R"({"id": "a1", "title": "Café \"plans\"", "text": "line\none 😀\\", )"
+                       R"("pinned": true, "archived": false, "color": "RED", "labels": ["work", "x\ty"], )"
+                       R"("timestamp": "2025-01-01", "edited": "2025-01-02"}, )"
+                       R"({"id": "b2", "nested": {"text": "not this"}, "text": "{braces} [and] \"quotes\"", )"
+                       R"("archived": true, "labels": [], "created": "2024-12-31"}]})"));
+    REQUIRE(list.size() == 2);
+
+    NoteView a = list[0];
+    CHECK(a.id == "a1");
+    CHECK(a.title == "Caf\xC3\xA9 \"plans\"");
+    CHECK(a.text == "line\none \xF0\x9F\x98\x80\\");
+    CHECK(a.pinned);
+    CHECK(!a.archived);
+    CHECK(a.color == "RED");
+    REQUIRE(a.LabelCount() == 2);
+    CHECK(a.Label(0) == "work");
+    CHECK(a.Label(1) == "x\ty");
+    CHECK(a.created_timestamp == "2025-01-01");
+    CHECK(a.edited_timestamp == "2025-01-02");
+
+    NoteView b = list[1];
+    CHECK(b.id == "b2");
+    CHECK(b.text == "{braces} [and] \"quotes\"");
+    CHECK(b.archived);
+    CHECK_EQ(b.LabelCount(), size_t(0));
+    CHECK(b.created_timestamp == "2024-12-31");
+
+    KeepNote note = a.ToKeepNote();
+    CHECK_EQ(note.title, std::string("Caf\xC3\xA9 \"plans\""));
+    REQUIRE(note.labels.size() == 2);
+    CHECK_EQ(note.labels[1], std::string("x\ty"));
+}
+
+TEST(FindsArrayByKey) {
+    NoteList list;
+    std::string reply = R"({"success": true, "full": false, "cursor": "c", "changed": [{"id": "1"}], "removed": ["2"]})";
+    CHECK(list.Parse(reply, "changed"));
+    REQUIRE(list.size() == 1);
+    CHECK(list[0].id == "1");
+
+    CHECK(!list.Parse(reply, "notes"));
+    CHECK(list.empty());
+    CHECK(list.Parse(R"({"notes": []})"));
+    CHECK(list.empty());
+}
+
+TEST(MalformedReplyKeepsEarlierNotes) {
+    NoteList list;
+    CHECK(!list.Parse(R"({"notes": [{"id": "ok"}, {"id": "cut)"));
+    REQUIRE(list.size() == 1);
+    CHECK(list[0].id == "ok");
+    CHECK(!list.Parse(""));
+    CHECK(!list.Parse("not json"));
+}
+
+TEST(TruncatedEscapeFailsTheString) {
+    // Cut after "\u": decoding in place must not write past the reply
+    for (const char* tail : {"\\u", "\\u0", "\\u00", "\\u00e", "\\u00zz\"}"}) {
+        NoteList list;
+        CHECK(!list.Parse(std::string(R"({"notes": [{"id": "ok"}, {"id": "x)") + tail));
+        REQUIRE(list.size() == 1);
+        CHECK(list[0].id == "ok");
+    }
+    NoteList list;
+    REQUIRE(list.Parse(R"({"notes": [{"id": "\u00e9\ud83d"}]})"));
+    CHECK(list[0].id == "\xC3\xA9\xED\xA0\xBD");    // A lone surrogate passes through
+}
+
+TEST(ViewsSurviveMove) {
+    NoteList list;
+    REQUIRE(list.Parse(R"({"notes": [{"id": "s"}]})"));   // Short enough for the small-string buffer
+    NoteList moved = std::move(list);
+    REQUIRE(moved.size() == 1);
+    CHECK(moved[0].id == "s");
+}
+
+TEST(TenThousandNotesInAFewAllocations) {
+    std::string reply = "{\"success\": true, \"count\": 10000, \"notes\": [";
+    for (int i = 0; i < 10000; ++i) {
+        if (i > 0) reply += ", ";
+        reply += "{\"id\": \"n" + std::to_string(i) + "\", \"title\": \"Note " + std::to_string(i) +
+                 "\", \"text\": \"line one\\nline \\\"two\\\"\", \"pinned\": false, \"archived\": false, "
+                 "\"color\": \"DEFAULT\", \"labels\": [\"work\"], \"timestamp\": \"2025-01-01\", "
+                 "\"edited\": \"2025-01-02\"}";
+    }
+    reply += "]}";
+
+    NoteList list;
+    size_t before = g_allocations.load();
+    REQUIRE(list.Parse(std::move(reply)));
+    size_t allocations = g_allocations.load() - before;
+
+    REQUIRE(list.size() == 10000);
+    CHECK(list[9999].id == "n9999");
+    CHECK(list[9999].text == "line one\nline \"two\"");
+    CHECK(list[9999].Label(0) == "work");
+    CHECK(allocations <= 32);
+}
+
+TEST_MAIN()
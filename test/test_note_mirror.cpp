@@ -0,0 +1,160 @@
+// NoteMirror tests: lookups, label index, staleness and persistence
+
+#include "TestHarness.h"
+#include "NoteMirror.h"
+
+#include <fstream>
+#include <iterator>
+
+using namespace NppGoogleKeepSync;
+
+namespace {
+    KeepNote note(const std::string& id, const std::string& text, std::vector<std::string> labels = {},
+                  const std::string& edited = "2025-01-01T00:00:00") {
+        KeepNote n;
+        n.id = id;
+        n.title = "Note " + id;
+        n.text = text;
+        n.labels = std::move(labels);
+        n.edited_timestamp = edited;
+        return n;
+    }
+}
+
+TEST(UpsertGetRemove) {
+    NoteMirror mirror;
+    mirror.Upsert(note("a", "first"));
+    auto found = mirror.Get("a");
+    REQUIRE(found.has_value());
+    CHECK_EQ(found->text, std::string("first"));
+    CHECK(!mirror.Get("b").has_value());
+
+    CHECK(mirror.Remove("a"));
+    CHECK(!mirror.Remove("a"));
+    CHECK_EQ(mirror.Size(), size_t(0));
+}
+
+TEST(LabelsAndListing) {
+    NoteMirror mirror;
+    mirror.Upsert(note("a", "alpha text", {"work"}, "2025-01-02T00:00:00"));
+    mirror.Upsert(note("b", "beta text", {"home"}, "2025-01-03T00:00:00"));
+    mirror.Upsert(note("c", "gamma text", {"work", "home"}, "2025-01-01T00:00:00"));
+
+    auto work = mirror.IdsWithLabel("work");
+    CHECK_EQ(work.size(), size_t(2));
+
+    auto all = mirror.List(true, 0);
+    REQUIRE(all.size() == 3);
+    CHECK_EQ(all[0].id, std::string("b"));     // Most recently edited first
+
+    auto filtered = mirror.List(true, 0, "", {"home"});
+    CHECK_EQ(filtered.size(), size_t(2));
+    auto searched = mirror.List(true, 0, "gamma");
+    REQUIRE(searched.size() == 1);
+    CHECK_EQ(searched[0].id, std::string("c"));
+
+    // Relabelling updates the label index
+    mirror.Upsert(note("c", "gamma text", {"home"}));
+    CHECK_EQ(mirror.IdsWithLabel("work").size(), size_t(1));
+}
+
+TEST(Staleness) {
+    NoteMirror mirror;
+    CHECK(mirror.IsStale(std::chrono::seconds(300)));
+    mirror.ReplaceAll({note("a", "x")});
+    CHECK(!mirror.IsStale(std::chrono::seconds(300)));
+    CHECK_EQ(mirror.Size(), size_t(1));
+}
+
+TEST(SaveAndLoad) {
+    auto path = std::filesystem::temp_directory_path() / "keepsync_test.mirror";
+    {
+        NoteMirror mirror;
+        mirror.Load(path);
+        mirror.ReplaceAll({note("a", "line one\nline \"two\"\n", {"work"}), note("b", "searchable words")});
+        REQUIRE(mirror.Save());
+    }
+    NoteMirror loaded;
+    REQUIRE(loaded.Load(path));
+    CHECK_EQ(loaded.Size(), size_t(2));
+    auto a = loaded.Get("a");
+    REQUIRE(a.has_value());
+    CHECK_EQ(a->text, std::string("line one\nline \"two\"\n"));
+    CHECK_EQ(loaded.IdsWithLabel("work").size(), size_t(1));
+    CHECK_EQ(loaded.Search("searchable").size(), size_t(1));
+
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+    std::filesystem::remove(path.string() + ".idx", ec);
+}
+
+TEST(CorruptHeaderIsNoMirror) {
+    auto path = std::filesystem::temp_directory_path() / "keepsync_test_corrupt.mirror";
+    {
+        NoteMirror mirror;
+        mirror.Load(path);
+        mirror.ReplaceAll({note("a", "x")});
+        REQUIRE(mirror.Save());
+    }
+    std::string contents;
+    {
+        std::ifstream in(path, std::ios::binary);
+        contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    // Refresh time (the third header field) overwritten with garbage
+    size_t tab = contents.find('\t', contents.find('\t') + 1);
+    size_t next = contents.find('\t', tab + 1);
+    REQUIRE(next < contents.find('\n'));
+    for (const char* stamp : {"12x4", "", "99999999999999999999999"}) {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << contents.substr(0, tab + 1) << stamp << contents.substr(next);
+        out.close();
+
+        NoteMirror loaded;
+        CHECK(!loaded.Load(path));
+        CHECK_EQ(loaded.Size(), size_t(0));
+        CHECK(loaded.IsStale(std::chrono::seconds(300)));
+    }
+
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+    std::filesystem::remove(path.string() + ".idx", ec);
+}
+
+TEST(StaleIndexWithSameCountIsRebuilt) {
+    auto path = std::filesystem::temp_directory_path() / "keepsync_test_stale.mirror";
+    auto index = std::filesystem::path(path.string() + ".idx");
+    std::string oldIndex;
+    {
+        NoteMirror mirror;
+        mirror.Load(path);
+        mirror.ReplaceAll({note("a", "apple"), note("b", "banana")});
+        REQUIRE(mirror.Save());
+        std::ifstream in(index, std::ios::binary);
+        oldIndex.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+
+        // A delete and a create in one pull, then a crash before the
+        // index was written: same count, different ids
+        mirror.Remove("b");
+        mirror.Upsert(note("c", "cherry"));
+        REQUIRE(mirror.Save());
+    }
+    {
+        std::ofstream out(index, std::ios::binary | std::ios::trunc);
+        out << oldIndex;
+    }
+
+    NoteMirror loaded;
+    REQUIRE(loaded.Load(path));
+    CHECK_EQ(loaded.Search("banana").size(), size_t(0));
+    CHECK_EQ(loaded.List(true, 0, "banana", {}).size(), size_t(0));
+    auto hits = loaded.List(true, 0, "cherry", {});
+    REQUIRE(hits.size() == 1);
+    CHECK_EQ(hits[0].id, std::string("c"));
+
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+    std::filesystem::remove(index, ec);
+}
+
+TEST_MAIN()
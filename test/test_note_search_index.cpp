@@ -0,0 +1,122 @@
+// NoteSearchIndex tests: tokenizing, ranking, updates and persistence
+
+#include "TestHarness.h"
+#include "NoteSearchIndex.h"
+
+#include <fstream>
+#include <iterator>
+
+using namespace NppGoogleKeepSync;
+
+namespace {
+    KeepNote note(const std::string& id, const std::string& title, const std::string& text) {
+        KeepNote n;
+        n.id = id;
+        n.title = title;
+        n.text = text;
+        return n;
+    }
+}
+
+TEST(TokenizeLowercasesAndSplits) {
+    std::vector<std::string> terms;
+    NoteSearchIndex::Tokenize("Buy MILK, eggs & 2 loaves!", terms);
+    REQUIRE(terms.size() == 5);
+    CHECK_EQ(terms[0], std::string("buy"));
+    CHECK_EQ(terms[1], std::string("milk"));
+    CHECK_EQ(terms[4], std::string("loaves"));
+}
+
+TEST(SearchRequiresAllTermsAndRanksTitles) {
+    NoteSearchIndex index;
+    index.Upsert(note("1", "Groceries", "milk eggs bread"));
+    index.Upsert(note("2", "Milk", "remember the eggs"));
+    index.Upsert(note("3", "Work", "milk the deadline"));
+
+    auto hits = index.Search("milk eggs");
+    REQUIRE(hits.size() == 2);
+    // Title match ranks first
+    CHECK_EQ(hits[0].id, std::string("2"));
+    CHECK_EQ(hits[1].id, std::string("1"));
+    CHECK(index.Search("nothing here").empty());
+    CHECK_EQ(index.Search("milk", 1).size(), size_t(1));
+}
+
+TEST(UpsertReplacesAndRemoveDrops) {
+    NoteSearchIndex index;
+    index.Upsert(note("1", "", "alpha"));
+    index.Upsert(note("1", "", "beta"));
+    CHECK(index.Search("alpha").empty());
+    CHECK_EQ(index.Search("beta").size(), size_t(1));
+    CHECK_EQ(index.DocumentCount(), size_t(1));
+
+    index.Remove("1");
+    CHECK(index.Search("beta").empty());
+    CHECK_EQ(index.DocumentCount(), size_t(0));
+
+    // Enough churn to trigger compaction
+    for (int round = 0; round < 20; ++round) {
+        for (int i = 0; i < 50; ++i) {
+            index.Upsert(note(std::to_string(i), "", "round" + std::to_string(round) + " common"));
+        }
+    }
+    CHECK_EQ(index.DocumentCount(), size_t(50));
+    CHECK_EQ(index.Search("common").size(), size_t(50));
+    CHECK(index.Search("round3").empty());
+}
+
+TEST(SaveAndLoad) {
+    auto path = std::filesystem::temp_directory_path() / "keepsync_test.index";
+    NoteSearchIndex index;
+    index.Upsert(note("1", "Trip", "passport tickets"));
+    index.Upsert(note("2", "", "tickets for the show"));
+    REQUIRE(index.Save(path));
+
+    NoteSearchIndex loaded;
+    REQUIRE(loaded.Load(path));
+    CHECK_EQ(loaded.DocumentCount(), size_t(2));
+    auto hits = loaded.Search("tickets");
+    REQUIRE(hits.size() == 2);
+    hits = loaded.Search("passport");
+    REQUIRE(hits.size() == 1);
+    CHECK_EQ(hits[0].id, std::string("1"));
+    std::filesystem::remove(path);
+}
+
+TEST(CorruptFileFailsWithoutHugeAllocations) {
+    auto path = std::filesystem::temp_directory_path() / "keepsync_test_corrupt.index";
+    NoteSearchIndex index;
+    index.Upsert(note("1", "Trip", "passport tickets"));
+    index.Upsert(note("2", "", "tickets for the show"));
+    REQUIRE(index.Save(path));
+    std::string good;
+    {
+        std::ifstream in(path, std::ios::binary);
+        good.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    auto write = [&](const std::string& bytes) {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), bytes.size());
+    };
+
+    // Every truncation fails cleanly
+    for (size_t size = 0; size < good.size(); ++size) {
+        write(good.substr(0, size));
+        NoteSearchIndex loaded;
+        CHECK(!loaded.Load(path));
+        CHECK_EQ(loaded.DocumentCount(), size_t(0));
+    }
+
+    // Counts far beyond the file: document count (after magic and
+    // version), then the first string length
+    for (size_t offset : {size_t(8), size_t(12)}) {
+        std::string bad = good;
+        bad.replace(offset, 4, std::string(4, '\xff'));
+        write(bad);
+        NoteSearchIndex loaded;
+        CHECK(!loaded.Load(path));
+    }
+    std::filesystem::remove(path);
+}
+
+TEST_MAIN()
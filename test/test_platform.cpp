@@ -0,0 +1,36 @@
+// Platform tests: path joining and environment expansion
+
+#include "TestHarness.h"
+#include "Platform.h"
+
+#include <cstdlib>
+
+#ifdef _WIN32
+static const std::wstring kSep = L"\\";
+#else
+static const std::wstring kSep = L"/";
+#endif
+
+TEST(JoinPath) {
+    CHECK_EQ(Platform::JoinPath(L"dir", L"file"), L"dir" + kSep + L"file");
+    CHECK_EQ(Platform::JoinPath(L"dir" + kSep, L"file"), L"dir" + kSep + L"file");
+    CHECK_EQ(Platform::JoinPath(L"", L"file"), std::wstring(L"file"));
+}
+
+TEST(ExpandEnvironment) {
+#ifdef _WIN32
+    _putenv_s("KEEPSYNC_TEST_VAR", "value");
+#else
+    setenv("KEEPSYNC_TEST_VAR", "value", 1);
+#endif
+    CHECK_EQ(Platform::ExpandEnvironment(L"a%KEEPSYNC_TEST_VAR%b"), std::wstring(L"avalueb"));
+    CHECK_EQ(Platform::ExpandEnvironment(L"%KEEPSYNC_UNSET_VAR%\\x"), std::wstring(L"%KEEPSYNC_UNSET_VAR%\\x"));
+    CHECK_EQ(Platform::ExpandEnvironment(L"no references"), std::wstring(L"no references"));
+    CHECK(Platform::ExpandEnvironment(L"%TEMP%").find(L'%') == std::wstring::npos);
+}
+
+TEST(DataDirectory) {
+    CHECK(!Platform::DataDirectory().empty());
+}
+
+TEST_MAIN()
@@ -0,0 +1,618 @@
+// PythonBridge tests: request framing and reply handling over an in-process
+// transport standing in for keep_bridge.py
+
+#include "TestHarness.h"
+#include "PythonBridge.h"
+#include "BridgeWatchdog.h"
+#include "Json.h"
+#include "NoteMirror.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+using namespace NppGoogleKeepSync;
+
+namespace {
+    // Process starts, and whether they should fail
+    struct StartControl {
+        int starts = 0;
+        bool refuse = false;
+    };
+
+    // Answers each newline-terminated request with reply(request), handing
+    // the reply back a few bytes at a time to exercise response framing.
+    // An empty reply ends the process; kNoReply leaves it alive but silent.
+    class ScriptedTransport : public BridgeTransport {
+    public:
+        using Handler = std::function<std::string(const std::string&)>;
+        static constexpr const char* kNoReply = "<no reply>";
+
+        ScriptedTransport(Handler handler, std::vector<std::string>* log, StartControl* control = nullptr)
+            : m_handler(std::move(handler)), m_log(log), m_control(control) {}
+
+        bool Start(const std::wstring&, const std::vector<std::wstring>&) override {
+            if (m_control) {
+                m_control->starts++;
+                if (m_control->refuse) {
+                    m_last_error = "refused";
+                    return false;
+                }
+            }
+            m_alive = m_stayAlive;
+            m_output = m_greeting;
+            return true;
+        }
+
+        // Written on start, as keep_bridge.py announces itself; a process
+        // that does not stay alive exits once it is read
+        void SetGreeting(std::string greeting, bool stayAlive = true) {
+            m_greeting = std::move(greeting);
+            m_stayAlive = stayAlive;
+        }
+        void Stop() override { m_alive = false; }
+        void Interrupt() override { m_alive = false; }
+        bool IsAlive() override { return m_alive; }
+
+        bool Write(const char* data, size_t size) override {
+            m_pending.append(data, size);
+            size_t newline;
+            while ((newline = m_pending.find('\n')) != std::string::npos) {
+                std::string request = m_pending.substr(0, newline);
+                m_pending.erase(0, newline + 1);
+                if (m_log) m_log->push_back(request);
+                if (Json::ExtractString(request, "command") == "exit") continue;
+                std::string reply = m_handler(request);
+                if (reply.empty()) {
+                    m_alive = false;    // Simulate the bridge dying
+                } else if (reply != kNoReply) {
+                    m_output += reply + "\n";
+                }
+            }
+            return true;
+        }
+
+        long long Read(char* buffer, size_t size, uint32_t) override {
+            if (m_output.empty()) return m_alive ? 0 : -1;
+            size_t n = std::min<size_t>({size, m_output.size(), 7});
+            m_output.copy(buffer, n);
+            m_output.erase(0, n);
+            return static_cast<long long>(n);
+        }
+
+    private:
+        Handler m_handler;
+        std::vector<std::string>* m_log;
+        StartControl* m_control;
+        std::string m_pending;
+        std::string m_output;
+        std::string m_greeting = R"({"ready": true, "protocol": 2, "backend": "fake"})" "\n";
+        bool m_stayAlive = true;
+        std::atomic<bool> m_alive{false};
+    };
+
+    std::unique_ptr<PythonBridge> makeBridge(ScriptedTransport::Handler handler,
+                                             std::vector<std::string>* log = nullptr,
+                                             StartControl* control = nullptr) {
+        auto bridge = std::make_unique<PythonBridge>(
+            std::make_unique<ScriptedTransport>(std::move(handler), log, control));
+        bridge->Initialize(L"python", L"keep_bridge.py");
+        return bridge;
+    }
+
+    void enableRestarts(PythonBridge& bridge) {
+        RestartPolicy policy;
+        policy.enabled = true;
+        policy.min_backoff = std::chrono::milliseconds(50);
+        bridge.SetRestartPolicy(policy);
+    }
+
+    std::string command(const std::string& request) {
+        return Json::ExtractString(request, "command");
+    }
+}
+
+TEST(CreateNoteRoundTrip) {
+    std::vector<std::string> log;
+    auto bridge = makeBridge([](const std::string& request) {
+        return std::string(R"({"success": true, "id": "n1", "title": "T", "text": "line \"one\"\n"})");
+    }, &log);
+    REQUIRE(bridge->IsConnected());
+
+    auto result = bridge->CreateNote("T", "line \"one\"\n");
+    CHECK(result.success);
+    KeepNote note = bridge->ParseNote(result.raw_json);
+    CHECK_EQ(note.id, std::string("n1"));
+    CHECK_EQ(note.text, std::string("line \"one\"\n"));
+
+    REQUIRE(log.size() == 1);
+    CHECK_EQ(command(log[0]), std::string("create_note"));
+    CHECK(log[0].find(R"("text":"line \"one\"\n")") != std::string::npos);
+
+    const auto& counters = bridge->GetCounters();
+    CHECK_EQ(counters.commands.load(), uint64_t(1));
+    CHECK_EQ(counters.errors.load(), uint64_t(0));
+    CHECK(counters.bytesReceived.load() > 0);
+}
+
+TEST(NonAsciiTextIsEscaped) {
+    std::vector<std::string> log;
+    auto bridge = makeBridge([](const std::string&) {
+        return std::string(R"({"success": true, "id": "n1"})");
+    }, &log);
+
+    std::string text = "caf\xC3\xA9 \xE6\x9D\xB1 \xF0\x9F\x98\x80\x01";
+    CHECK(bridge->CreateNote("T", text).success);
+    REQUIRE(log.size() == 1);
+    CHECK(log[0].find(R"("text":"caf\u00e9 \u6771 \ud83d\ude00\u0001")") != std::string::npos);
+    CHECK_EQ(Json::ExtractString(log[0], "text"), text);
+}
+
+TEST(ErrorReplySetsMessage) {
+    auto bridge = makeBridge([](const std::string&) {
+        return std::string(R"({"success": false, "error": "Note not found"})");
+    });
+    auto result = bridge->GetNote("missing");
+    CHECK(!result.success);
+    CHECK_EQ(result.error_message, std::string("Note not found"));
+    CHECK_EQ(bridge->GetCounters().errors.load(), uint64_t(1));
+}
+
+TEST(BridgeExitIsReported) {
+    auto bridge = makeBridge([](const std::string&) { return std::string(); });
+    auto result = bridge->GetNote("n1");
+    CHECK(!result.success);
+    CHECK(!result.error_message.empty());
+    CHECK(!bridge->IsConnected());
+}
+
+namespace {
+    std::unique_ptr<PythonBridge> startWithGreeting(const std::string& greeting, bool stayAlive = true) {
+        auto transport = std::make_unique<ScriptedTransport>([](const std::string&) {
+            return std::string(R"({"success": true})");
+        }, nullptr);
+        transport->SetGreeting(greeting, stayAlive);
+        auto bridge = std::make_unique<PythonBridge>(std::move(transport));
+        bridge->SetStartupTimeout(std::chrono::milliseconds(50));
+        bridge->Initialize(L"python", L"keep_bridge.py");
+        return bridge;
+    }
+}
+
+TEST(StartupWaitsForReadyFrame) {
+    auto bridge = startWithGreeting("Python 3 warming up\n" R"({"ready": true, "protocol": 2})" "\n");
+    CHECK(bridge->IsConnected());
+    CHECK(bridge->GetStatus().success);
+
+    // Nothing comes: not started, rather than failing the first command
+    bridge = startWithGreeting("");
+    CHECK(!bridge->IsConnected());
+    CHECK(bridge->GetLastError().find("Timed out waiting") != std::string::npos);
+}
+
+TEST(StartupReportsWhyTheBridgeExited) {
+    auto bridge = startWithGreeting("Traceback (most recent call last):\n"
+                                    "ModuleNotFoundError: No module named 'gkeepapi'\r\n", false);
+    CHECK(!bridge->IsConnected());
+    CHECK(bridge->GetLastError().find("exited during startup: ModuleNotFoundError") != std::string::npos);
+
+    bridge = startWithGreeting(R"({"ready": true, "protocol": 99})" "\n");
+    CHECK(!bridge->IsConnected());
+    CHECK(bridge->GetLastError().find("protocol 99") != std::string::npos);
+}
+
+TEST(CommandsCarryIdAndDeadline) {
+    std::vector<std::string> log;
+    auto bridge = makeBridge([](const std::string&) {
+        return std::string(R"({"success": true})");
+    }, &log);
+    bridge->SetCommandTimeout("", std::chrono::seconds(5));
+    bridge->SetCommandTimeout("get", std::chrono::seconds(2));
+    CHECK(bridge->GetCommandTimeout("sync") == std::chrono::seconds(60));   // Built-in default
+    CHECK(bridge->GetCommandTimeout("delete") == std::chrono::seconds(5));
+
+    auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    CHECK(bridge->GetNote("n1").success);
+    CHECK(bridge->DeleteNote("n1").success);
+    REQUIRE(log.size() == 2);
+    CHECK_EQ(Json::ExtractValue(log[0], "request_id"), std::string("1"));
+    CHECK_EQ(Json::ExtractValue(log[1], "request_id"), std::string("2"));
+
+    // Unix time in ms, command timeout ahead
+    long long getDeadline = std::atoll(Json::ExtractValue(log[0], "deadline").c_str());
+    long long deleteDeadline = std::atoll(Json::ExtractValue(log[1], "deadline").c_str());
+    CHECK(getDeadline >= now + 2000 && getDeadline < now + 3000);
+    CHECK(deleteDeadline >= now + 5000 && deleteDeadline < now + 6000);
+}
+
+TEST(LateReplyIsDroppedById) {
+    std::string late;
+    auto bridge = makeBridge([&](const std::string& request) {
+        std::string id = Json::ExtractValue(request, "request_id");
+        if (command(request) == "get" && id == "1") {
+            late = R"({"request_id": 1, "success": true, "id": "stale"})" "\n";
+            return std::string(ScriptedTransport::kNoReply);
+        }
+        // The slow reply turns up just ahead of this one
+        std::string reply = late + R"({"request_id": )" + id + R"(, "success": true, "id": "fresh"})";
+        late.clear();
+        return reply;
+    });
+    bridge->SetCommandTimeout("get", std::chrono::milliseconds(50));
+
+    auto slow = bridge->GetNote("n1");
+    CHECK(!slow.success);
+    CHECK(slow.error_message.find("Timed out after 50 ms waiting for get") != std::string::npos);
+    CHECK(bridge->IsConnected());       // Not restarted: the stream stays usable
+
+    auto next = bridge->GetNote("n1");
+    CHECK(next.success);
+    CHECK(next.raw_json.find("fresh") != std::string::npos);
+    CHECK_EQ(bridge->GetCounters().timeouts.load(), uint64_t(1));
+    CHECK_EQ(bridge->GetCounters().lateFrames.load(), uint64_t(1));
+}
+
+TEST(StderrNoiseIsNotAReply) {
+    auto bridge = makeBridge([](const std::string& request) {
+        return std::string("Trying cached master token...\n") +
+               "WARNING:gkeepapi:Unknown node type {\"success\"\n" +
+               "{\"request_id\": " + Json::ExtractValue(request, "request_id") + R"(, "success": true, "message": "Sync completed"})";
+    });
+    auto result = bridge->Sync();
+    CHECK(result.success);
+    CHECK_EQ(Json::ExtractString(result.raw_json, "message"), std::string("Sync completed"));
+
+    // An id-less reply to a line the script could not parse is still ours
+    bridge = makeBridge([](const std::string&) {
+        return std::string("Traceback noise\n") + R"({"success": false, "error": "Invalid JSON"})";
+    });
+    result = bridge->Sync();
+    CHECK(!result.success);
+    CHECK_EQ(result.error_message, std::string("Invalid JSON"));
+}
+
+TEST(RestartReplaysIdempotentCommand) {
+    std::vector<std::string> log;
+    bool died = false;
+    auto bridge = makeBridge([&](const std::string& request) {
+        if (command(request) == "get" && !died) {
+            died = true;
+            return std::string();
+        }
+        if (command(request) == "status") {
+            return std::string(R"({"success": true, "authenticated": true})");
+        }
+        return std::string(R"({"success": true, "id": "n1"})");
+    }, &log);
+    enableRestarts(*bridge);
+
+    auto result = bridge->GetNote("n1");
+    CHECK(result.success);
+    CHECK(bridge->IsConnected());
+    REQUIRE(log.size() == 3);
+    CHECK_EQ(command(log[0]), std::string("get"));
+    CHECK_EQ(command(log[1]), std::string("status"));   // Signed in from the cached token
+    CHECK_EQ(command(log[2]), std::string("get"));
+
+    const auto& counters = bridge->GetCounters();
+    CHECK_EQ(counters.restarts.load(), uint64_t(1));
+    CHECK_EQ(counters.replayed.load(), uint64_t(1));
+    CHECK_EQ(counters.recovery.Count(), uint64_t(1));
+}
+
+TEST(RestartDoesNotReplayCreate) {
+    std::vector<std::string> log;
+    bool died = false;
+    auto bridge = makeBridge([&](const std::string& request) {
+        if (command(request) == "create_note" && !died) {
+            died = true;
+            return std::string();
+        }
+        return std::string(R"({"success": true, "authenticated": true, "id": "n1"})");
+    }, &log);
+    enableRestarts(*bridge);
+
+    // The create may have gone through before the process died
+    CHECK(!bridge->CreateNote("T", "text").success);
+    CHECK(!bridge->IsConnected());
+
+    // The next command restarts the bridge first
+    CHECK(bridge->GetNote("n1").success);
+    REQUIRE(log.size() == 3);
+    CHECK_EQ(command(log[1]), std::string("status"));
+    CHECK_EQ(command(log[2]), std::string("get"));
+    CHECK_EQ(bridge->GetCounters().replayed.load(), uint64_t(0));
+}
+
+TEST(RestartLogsInAgainWithoutCachedToken) {
+    std::vector<std::string> log;
+    bool died = false;
+    auto bridge = makeBridge([&](const std::string& request) {
+        std::string name = command(request);
+        if (name == "sync" && !died) {
+            died = true;
+            return std::string();
+        }
+        if (name == "status") {
+            return std::string(R"({"success": true, "authenticated": false})");
+        }
+        return std::string(R"({"success": true})");
+    }, &log);
+    enableRestarts(*bridge);
+
+    CHECK(bridge->Login("me@example.com", "app password").success);
+    CHECK(bridge->Sync().success);
+    REQUIRE(log.size() == 5);
+    CHECK_EQ(command(log[2]), std::string("status"));
+    CHECK_EQ(command(log[3]), std::string("login"));
+    CHECK_EQ(Json::ExtractString(log[3], "app_password"), std::string("app password"));
+    CHECK_EQ(command(log[4]), std::string("sync"));
+}
+
+TEST(RestartBacksOff) {
+    StartControl control;
+    auto bridge = makeBridge([](const std::string& request) {
+        return command(request) == "status" ? std::string(R"({"success": true, "authenticated": true})")
+                                            : std::string();
+    }, nullptr, &control);
+    enableRestarts(*bridge);
+    REQUIRE(control.starts == 1);
+
+    control.refuse = true;
+    CHECK(!bridge->GetNote("n1").success);      // Dies; the restart is refused
+    CHECK_EQ(control.starts, 2);
+    CHECK(!bridge->GetNote("n1").success);      // Within the backoff: no attempt
+    CHECK_EQ(control.starts, 2);
+
+    control.refuse = false;
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    CHECK(bridge->Recover());
+    CHECK_EQ(control.starts, 3);
+    CHECK(bridge->IsConnected());
+}
+
+TEST(WatchdogRestartsHungBridge) {
+    std::vector<std::string> log;
+    bool hung = true;
+    auto bridge = makeBridge([&](const std::string& request) {
+        if (command(request) == "ping" && hung) {
+            hung = false;
+            return std::string(ScriptedTransport::kNoReply);
+        }
+        return std::string(R"({"success": true, "authenticated": true})");
+    }, &log);
+    enableRestarts(*bridge);
+
+    std::recursive_mutex bridgeMutex;
+    BridgeWatchdog watchdog(*bridge, bridgeMutex, std::chrono::seconds(60), 20);
+    CHECK(watchdog.Check());
+    CHECK(bridge->IsConnected());
+    CHECK_EQ(bridge->GetCounters().restarts.load(), uint64_t(1));
+
+    // A bridge in use is left alone
+    {
+        std::lock_guard<std::recursive_mutex> busy(bridgeMutex);
+        std::thread other([&] { CHECK(watchdog.Check()); });
+        other.join();
+    }
+    CHECK(watchdog.Check());
+    CHECK_EQ(bridge->GetCounters().restarts.load(), uint64_t(1));
+}
+
+TEST(AbortFailsCommandInProgress) {
+    auto bridge = makeBridge([](const std::string&) {
+        return std::string(ScriptedTransport::kNoReply);
+    });
+    enableRestarts(*bridge);
+    bridge->SetCommandTimeout("", std::chrono::seconds(30));
+
+    auto started = std::chrono::steady_clock::now();
+    std::thread shutdown([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        bridge->Abort();
+    });
+    auto result = bridge->Sync();
+    shutdown.join();
+    CHECK(!result.success);
+    CHECK(std::chrono::steady_clock::now() - started < std::chrono::seconds(5));
+
+    // Neither restarted nor sent
+    result = bridge->Sync();
+    CHECK(!result.success);
+    CHECK_EQ(result.error_message, std::string("Bridge is shutting down"));
+    CHECK_EQ(bridge->GetCounters().restarts.load(), uint64_t(0));
+}
+
+TEST(PatchNoteSendsLineOps) {
+    std::string base;
+    for (int i = 0; i < 200; ++i) base += "line " + std::to_string(i) + "\n";
+    std::string edited = base;
+    edited.replace(edited.find("line 100\n"), 9, "changed\n");
+
+    std::vector<std::string> log;
+    auto bridge = makeBridge([](const std::string& request) {
+        return std::string(R"({"success": true, "id": "n1", "title": "T"})");
+    }, &log);
+    auto result = bridge->PatchNote("n1", base, edited, std::nullopt);
+    CHECK(result.success);
+    REQUIRE(log.size() == 1);
+    CHECK_EQ(command(log[0]), std::string("patch_note"));
+    CHECK(log[0].find(R"("ops":[[100,1,"changed\n"]])") != std::string::npos);
+    CHECK(log[0].find("\"base_lines\":200") != std::string::npos);
+    CHECK(log[0].size() < edited.size() / 4);
+}
+
+TEST(PatchNoteFallsBackOnBaseMismatch) {
+    std::string base;
+    for (int i = 0; i < 200; ++i) base += "line " + std::to_string(i) + "\n";
+    std::string edited = base + "appended\n";
+
+    std::vector<std::string> log;
+    auto bridge = makeBridge([](const std::string& request) {
+        if (command(request) == "patch_note") {
+            return std::string(R"({"success": false, "error": "Base text mismatch", "code": "base_mismatch"})");
+        }
+        return std::string(R"({"success": true, "id": "n1"})");
+    }, &log);
+    auto result = bridge->PatchNote("n1", base, edited, std::string("T"));
+    CHECK(result.success);
+    REQUIRE(log.size() == 2);
+    CHECK_EQ(command(log[1]), std::string("update_note"));
+}
+
+TEST(BatchCollectsResultIds) {
+    std::vector<std::string> log;
+    auto bridge = makeBridge([](const std::string&) {
+        return std::string(R"({"success": true, "results": [{"id": "a"}, {"id": "b"}, {"id": "c"}]})");
+    }, &log);
+
+    std::vector<BatchOp> ops(3);
+    ops[0].kind = BatchOp::Kind::Create;
+    ops[0].title = std::string("x (1/2)");
+    ops[0].text = std::string("one");
+    ops[1].kind = BatchOp::Kind::Update;
+    ops[1].id = "b";
+    ops[1].text = std::string("two");
+    ops[2].kind = BatchOp::Kind::Delete;
+    ops[2].id = "c";
+
+    std::vector<std::string> ids;
+    auto result = bridge->Batch(ops, ids);
+    CHECK(result.success);
+    REQUIRE(ids.size() == 3);
+    CHECK_EQ(ids[0], std::string("a"));
+    CHECK_EQ(ids[2], std::string("c"));
+    REQUIRE(log.size() == 1);
+    CHECK_EQ(command(log[0]), std::string("batch"));
+}
+
+namespace {
+    // A streamed list reply: `pages` frames of `per_page` notes each
+    std::string listFrames(int pages, int per_page) {
+        std::string reply;
+        for (int page = 0; page < pages; ++page) {
+            if (page > 0) reply += "\n";
+            bool more = page + 1 < pages;
+            reply += std::string(R"({"success": true, "more": )") + (more ? "true" : "false") + ", \"notes\": [";
+            for (int i = 0; i < per_page; ++i) {
+                if (i > 0) reply += ", ";
+                reply += R"({"id": "n)" + std::to_string(page * per_page + i) + R"(", "text": "}{"})";
+            }
+            reply += "]}";
+        }
+        return reply;
+    }
+}
+
+TEST(StreamNotesReadsEveryFrame) {
+    std::vector<std::string> log;
+    auto bridge = makeBridge([](const std::string& request) {
+        return command(request) == "list" ? listFrames(4, 3) : std::string(R"({"success": true})");
+    }, &log);
+
+    ListQuery query;
+    query.all = true;
+    query.page_size = 3;
+    std::vector<std::string> ids;
+    auto result = bridge->StreamNotes(query, [&](KeepNote& note) {
+        ids.push_back(note.id);
+        return true;
+    });
+    CHECK(result.success);
+    REQUIRE(ids.size() == 12);
+    CHECK_EQ(ids[0], std::string("n0"));
+    CHECK_EQ(ids[11], std::string("n11"));
+
+    REQUIRE(log.size() == 1);
+    CHECK_EQ(Json::ExtractValue(log[0], "page_size"), std::string("3"));
+    CHECK(Json::ExtractBool(log[0], "stream"));
+    CHECK(Json::ExtractBool(log[0], "all"));
+}
+
+TEST(StreamNotesStopsEarlyAndDrains) {
+    auto bridge = makeBridge([](const std::string& request) {
+        return command(request) == "list" ? listFrames(5, 2) : std::string(R"({"success": true, "id": "after"})");
+    });
+
+    int seen = 0;
+    auto result = bridge->StreamNotes(ListQuery(), [&](KeepNote&) { return ++seen < 3; });
+    CHECK(result.success);
+    CHECK_EQ(seen, 3);
+
+    // The unread frames must not be taken for the next reply
+    auto next = bridge->GetNote("after");
+    CHECK(next.success);
+    CHECK_EQ(Json::ExtractString(next.raw_json, "id"), std::string("after"));
+}
+
+TEST(StreamNotesReportsErrorFrame) {
+    auto bridge = makeBridge([](const std::string&) {
+        return std::string(R"({"success": true, "more": true, "notes": [{"id": "a"}]})") + "\n" +
+               R"({"success": false, "error": "List failed: gone", "more": false})";
+    });
+
+    int seen = 0;
+    auto result = bridge->StreamNotes(ListQuery(), [&](KeepNote&) { ++seen; return true; });
+    CHECK(!result.success);
+    CHECK_EQ(result.error_message, std::string("List failed: gone"));
+    CHECK_EQ(seen, 1);
+}
+
+TEST(ChangesSinceSavesMirrorBeforeAdvancingCursor) {
+    auto bridge = makeBridge([](const std::string&) {
+        return std::string(R"({"success": true, "full": false, "cursor": "t2|b", "changed": [{"id": "b", "title": "B"}], "removed": []})");
+    });
+    auto dir = std::filesystem::temp_directory_path() / "keepsync_test_changes";
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+
+    // Mirror file cannot be written: the old cursor comes back
+    bridge->EnableMirror((dir / "mirror").wstring(), std::chrono::seconds(300));
+    RemoteChanges changes;
+    CHECK(bridge->ChangesSince("t1|a", changes).success);
+    CHECK_EQ(changes.cursor, std::string("t1|a"));
+
+    std::filesystem::create_directories(dir);
+    bridge->EnableMirror((dir / "mirror").wstring(), std::chrono::seconds(300));
+    CHECK(bridge->ChangesSince("t1|a", changes).success);
+    CHECK_EQ(changes.cursor, std::string("t2|b"));
+
+    NoteMirror saved;
+    CHECK(saved.Load(dir / "mirror"));
+    CHECK(saved.Get("b").has_value());
+    std::filesystem::remove_all(dir, ec);
+}
+
+TEST(ChangesSinceFullAnswerDropsNotesMissingFromIt) {
+    int calls = 0;
+    auto bridge = makeBridge([&](const std::string&) {
+        // A restarted bridge cannot name hard deletes, so it answers in full
+        return ++calls == 1
+            ? std::string(R"({"success": true, "full": false, "cursor": "t2|b", "changed": [{"id": "a"}, {"id": "b"}], "removed": []})")
+            : std::string(R"({"success": true, "full": true, "cursor": "t3|a", "changed": [{"id": "a"}], "removed": []})");
+    });
+    auto dir = std::filesystem::temp_directory_path() / "keepsync_test_restart";
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+    std::filesystem::create_directories(dir);
+
+    bridge->EnableMirror((dir / "mirror").wstring(), std::chrono::seconds(300));
+    RemoteChanges changes;
+    CHECK(bridge->ChangesSince("t1|a", changes).success);
+    CHECK(bridge->ChangesSince(changes.cursor, changes).success);
+    CHECK(changes.full);
+    CHECK_EQ(changes.cursor, std::string("t3|a"));
+
+    NoteMirror saved;
+    CHECK(saved.Load(dir / "mirror"));
+    CHECK(saved.Get("a").has_value());
+    CHECK(!saved.Get("b").has_value());
+    std::filesystem::remove_all(dir, ec);
+}
+
+TEST_MAIN()
@@ -0,0 +1,97 @@
+// SyncRules tests: extensions, names, directories, globs and size bounds
+
+#include "TestHarness.h"
+#include "SyncRules.h"
+
+TEST(Extensions) {
+    SyncRules rules = SyncRules::Compile({L"exe", L"PNG", L".zip"});
+    CHECK(rules.IsExcluded(L"C:\\a\\setup.EXE"));
+    CHECK(rules.IsExcluded(L"/a/b/photo.png"));
+    CHECK(rules.IsExcluded(L"archive.zip"));
+    CHECK(!rules.IsExcluded(L"notes.txt"));
+    CHECK(!rules.IsExcluded(L"/a/dir.exe/readme"));
+    CHECK(!rules.IsExcluded(L"/a/b/exe"));
+    CHECK(!rules.IsExcluded(L"file.exe2"));
+    CHECK(!rules.NeedsSize());
+
+    // "*.ext" patterns land in the same table
+    rules = SyncRules::Compile({}, {L"*.LOG"});
+    CHECK(rules.IsExcluded(L"C:\\logs\\today.log"));
+    CHECK(!rules.IsExcluded(L"C:\\logs\\today.log.txt"));
+    CHECK(SyncRules::Compile({}).Empty());
+}
+
+TEST(NamesAndDirectories) {
+    SyncRules rules = SyncRules::Compile({}, {L"node_modules", L"Thumbs.db", L"build/", L"C:\\Temp\\"});
+    CHECK(rules.IsExcluded(L"C:\\src\\app\\node_modules\\pkg\\index.js"));
+    CHECK(rules.IsExcluded(L"/home/me/node_modules"));
+    CHECK(rules.IsExcluded(L"D:\\photos\\thumbs.db"));
+    CHECK(rules.IsExcluded(L"/src/build/out.txt"));
+    CHECK(!rules.IsExcluded(L"/src/build"));            // A file named build
+    CHECK(!rules.IsExcluded(L"/src/rebuild/out.txt"));
+    CHECK(rules.IsExcluded(L"c:/temp/notes.txt"));
+    CHECK(rules.IsExcluded(L"C:\\TEMP\\a\\b.txt"));
+    CHECK(!rules.IsExcluded(L"D:\\Temp\\notes.txt"));
+    CHECK(!rules.IsExcluded(L"C:\\Temporary\\notes.txt"));
+
+    CHECK(rules.IsExcludedDirectory(L"C:\\src\\app\\node_modules"));
+    CHECK(rules.IsExcludedDirectory(L"/src/Build/"));
+    CHECK(!rules.IsExcludedDirectory(L"/src/app"));
+}
+
+TEST(Globs) {
+    SyncRules rules = SyncRules::Compile({}, {L"*.min.js", L"~$*", L"docs/*/draft?.md", L"/var/**/cache/**",
+                                              L"C:\\Work\\**\\*.bak"});
+    CHECK(rules.IsExcluded(L"/site/app.MIN.js"));
+    CHECK(!rules.IsExcluded(L"/site/app.js"));
+    CHECK(rules.IsExcluded(L"C:\\docs\\~$report.docx"));
+    CHECK(rules.IsExcluded(L"/home/me/docs/2024/draft1.md"));
+    CHECK(rules.IsExcluded(L"C:\\Docs\\x\\Draft2.md"));
+    CHECK(!rules.IsExcluded(L"/home/me/docs/2024/q1/draft1.md"));  // '*' stays in one directory
+    CHECK(!rules.IsExcluded(L"/home/me/docs/2024/draft10.md"));
+    CHECK(!rules.IsExcluded(L"/home/me/mydocs/2024/draft1.md"));
+    CHECK(rules.IsExcluded(L"/var/cache/a"));
+    CHECK(rules.IsExcluded(L"/var/lib/app/cache/b/c"));
+    CHECK(!rules.IsExcluded(L"/var/lib/cache"));
+    CHECK(!rules.IsExcluded(L"/usr/var/cache/a"));
+    CHECK(rules.IsExcluded(L"c:\\work\\old.bak"));
+    CHECK(rules.IsExcluded(L"C:\\Work\\a\\b\\old.BAK"));
+    CHECK(!rules.IsExcluded(L"D:\\Work\\old.bak"));
+
+    rules = SyncRules::Compile({}, {L"**/gen/*.tmp", L"out/**"});
+    CHECK(rules.IsExcluded(L"/a/b/gen/x.tmp"));
+    CHECK(rules.IsExcluded(L"gen\\x.tmp"));
+    CHECK(!rules.IsExcluded(L"/a/gen/b/x.tmp"));
+    CHECK(rules.IsExcluded(L"C:\\proj\\out\\bin\\app.txt"));
+    CHECK(!rules.IsExcluded(L"C:\\proj\\output\\app.txt"));
+}
+
+TEST(SizeBounds) {
+    SyncRules rules = SyncRules::Compile({}, {L"*.log >1MB", L"*.csv > 10KB < 1 MB", L"huge >5GB", L"bad >lots"});
+    CHECK(rules.NeedsSize());
+    CHECK(rules.IsExcluded(L"/a/app.log", 2 * 1024 * 1024));
+    CHECK(!rules.IsExcluded(L"/a/app.log", 1024 * 1024));
+    CHECK(!rules.IsExcluded(L"/a/app.log"));                    // Size unknown
+    CHECK(rules.IsExcluded(L"/a/data.csv", 20 * 1024));
+    CHECK(!rules.IsExcluded(L"/a/data.csv", 5 * 1024));
+    CHECK(!rules.IsExcluded(L"/a/data.csv", 2 * 1024 * 1024));
+    CHECK(rules.IsExcluded(L"/a/huge", 6ull << 30));
+    CHECK(!rules.IsExcluded(L"/a/bad", 1));                     // Did not parse, ignored
+
+    // A sized name rule does not cover the directory
+    rules = SyncRules::Compile({}, {L"vendor >1KB"});
+    CHECK(!rules.IsExcludedDirectory(L"/src/vendor"));
+}
+
+TEST(IncludeRules) {
+    SyncRules rules = SyncRules::Compile({L"tmp"}, {L"scratch"}, {L"*.txt", L"*.md <100KB"});
+    CHECK(!rules.IsExcluded(L"/notes/a.txt"));
+    CHECK(!rules.IsExcluded(L"/notes/b.md", 1000));
+    CHECK(rules.IsExcluded(L"/notes/b.md", 200 * 1024));
+    CHECK(rules.IsExcluded(L"/notes/c.cpp"));
+    CHECK(rules.IsExcluded(L"/notes/scratch/a.txt"));           // Exclude wins
+    CHECK(rules.IsExcluded(L"/notes/a.tmp"));
+    CHECK(!rules.IsExcludedDirectory(L"/notes/sub"));           // May hold included files
+}
+
+TEST_MAIN()
@@ -0,0 +1,147 @@
+// SyncScheduler tests: priority order, dedup, aging, active buffer, bulk yield
+
+#include "TestHarness.h"
+#include "SyncScheduler.h"
+
+#include <thread>
+
+using namespace std::chrono_literals;
+
+namespace {
+    using Clock = SyncScheduler::Clock;
+
+    std::wstring pop(SyncScheduler& scheduler, Clock::time_point now) {
+        SyncScheduler::Job job;
+        if (!scheduler.TryPop(job, now)) return L"";
+        scheduler.Done(job);
+        return job.path;
+    }
+}
+
+TEST(HigherPriorityFirst) {
+    SyncScheduler scheduler(10s);
+    auto now = Clock::now();
+    CHECK(scheduler.Push(L"bulk", SyncPriority::Bulk, false, now));
+    CHECK(scheduler.Push(L"external1", SyncPriority::Background, false, now));
+    CHECK(scheduler.Push(L"external2", SyncPriority::Background, false, now));
+    CHECK(scheduler.Push(L"saved", SyncPriority::Save, false, now));
+    CHECK(scheduler.Push(L"now", SyncPriority::Interactive, false, now));
+    CHECK_EQ(scheduler.Size(), 5u);
+
+    CHECK(pop(scheduler, now) == L"now");
+    CHECK(pop(scheduler, now) == L"saved");
+    CHECK(pop(scheduler, now) == L"external1");
+    CHECK(pop(scheduler, now) == L"external2");
+    CHECK(pop(scheduler, now) == L"bulk");
+    CHECK(pop(scheduler, now).empty());
+}
+
+TEST(DuplicatesMoveUp) {
+    SyncScheduler scheduler(10s);
+    auto start = Clock::now();
+    CHECK(scheduler.Push(L"a", SyncPriority::Background, false, start));
+    CHECK(scheduler.Push(L"b", SyncPriority::Save, false, start + 1ms));
+    CHECK(!scheduler.Push(L"a", SyncPriority::Bulk, false, start + 2ms));   // Stays Background
+    CHECK(!scheduler.Push(L"a", SyncPriority::Save, true, start + 3ms));
+    CHECK_EQ(scheduler.Size(), 2u);
+
+    // Promoted, it keeps its original queue time and so goes before b
+    SyncScheduler::Job job;
+    REQUIRE(scheduler.TryPop(job, start + 4ms));
+    CHECK(job.path == L"a");
+    CHECK(job.priority == SyncPriority::Save);
+    CHECK(job.force);
+    CHECK(job.queued == start);
+    scheduler.Done(job);
+    CHECK(pop(scheduler, start + 4ms) == L"b");
+}
+
+TEST(ActiveFileRunsFirst) {
+    SyncScheduler scheduler(10s);
+    auto now = Clock::now();
+    scheduler.Push(L"saved", SyncPriority::Save, false, now);
+    scheduler.Push(L"other", SyncPriority::Background, false, now);
+    scheduler.SetActive(L"other");      // Already queued: moves up
+    scheduler.Push(L"active", SyncPriority::Bulk, false, now);
+    scheduler.SetActive(L"active");
+    scheduler.Push(L"active2", SyncPriority::Background, false, now);
+
+    CHECK(pop(scheduler, now) == L"other");
+    CHECK(pop(scheduler, now) == L"active");
+    CHECK(pop(scheduler, now) == L"saved");
+    CHECK(pop(scheduler, now) == L"active2");
+
+    // Pushes for the active file are Interactive from the start
+    scheduler.Push(L"bg", SyncPriority::Background, false, now);
+    scheduler.Push(L"active", SyncPriority::Background, false, now);
+    CHECK(pop(scheduler, now) == L"active");
+}
+
+TEST(AgingPreventsStarvation) {
+    Diagnostics::Histogram waits[kSyncPriorities];
+    SyncScheduler scheduler(100ms, waits);
+    auto start = Clock::now();
+    scheduler.Push(L"old", SyncPriority::Bulk, false, start);
+
+    // A steady stream of saves wins while the bulk job is young...
+    scheduler.Push(L"save1", SyncPriority::Save, false, start + 50ms);
+    CHECK(pop(scheduler, start + 60ms) == L"save1");
+
+    // ...but after two steps it ranks with Save and, being older, goes first
+    scheduler.Push(L"save2", SyncPriority::Save, false, start + 190ms);
+    CHECK(pop(scheduler, start + 200ms) == L"old");
+    CHECK(pop(scheduler, start + 200ms) == L"save2");
+
+    CHECK_EQ(waits[static_cast<int>(SyncPriority::Save)].Count(), 2u);
+    CHECK_EQ(waits[static_cast<int>(SyncPriority::Bulk)].Count(), 1u);
+    CHECK(waits[static_cast<int>(SyncPriority::Bulk)].MaxUs() >= 200000);
+}
+
+TEST(BulkYieldsUntilDrainedOrTimeout) {
+    Diagnostics::Histogram waits[kSyncPriorities];
+    SyncScheduler scheduler(10s, waits);
+    const int bulk = static_cast<int>(SyncPriority::Bulk);
+
+    // Nothing ahead of it: no wait
+    auto start = Clock::now();
+    scheduler.Yield(SyncPriority::Bulk, 5s);
+    CHECK(Clock::now() - start < 1s);
+    CHECK_EQ(waits[bulk].Count(), 1u);
+
+    // A queued save holds bulk work back until it has run
+    // (timed from before the worker starts, so a slow spawn cannot eat the hold)
+    scheduler.Push(L"saved", SyncPriority::Save);
+    start = Clock::now();
+    std::thread worker([&] {
+        SyncScheduler::Job job;
+        if (scheduler.Pop(job)) {
+            std::this_thread::sleep_for(50ms);
+            scheduler.Done(job);
+        }
+    });
+    scheduler.Yield(SyncPriority::Bulk, 5s);
+    CHECK(Clock::now() - start >= 20ms);
+    CHECK(Clock::now() - start < 5s);
+    CHECK_EQ(scheduler.Size(), 0u);
+    worker.join();
+
+    // Work that never drains only holds it for maxWait
+    scheduler.Push(L"stuck", SyncPriority::Interactive);
+    start = Clock::now();
+    scheduler.Yield(SyncPriority::Bulk, 30ms);
+    CHECK(Clock::now() - start >= 25ms);
+    CHECK_EQ(waits[bulk].Count(), 3u);
+
+    // Stop wakes a blocked Pop
+    SyncScheduler idle;
+    std::thread waiter([&] {
+        SyncScheduler::Job job;
+        CHECK(!idle.Pop(job));
+    });
+    std::this_thread::sleep_for(10ms);
+    idle.Stop();
+    waiter.join();
+    CHECK(!idle.Push(L"late", SyncPriority::Save));
+}
+
+TEST_MAIN()
@@ -0,0 +1,78 @@
+// TextMerge tests: line diff and three-way merge
+
+#include "TestHarness.h"
+#include "TextMerge.h"
+
+namespace {
+    // Rebuild newText from oldText and the hunks, as the bridge's patch_note does
+    std::string applyHunks(const std::string& oldText, const std::string& newText) {
+        auto oldLines = TextMerge::SplitLines(oldText);
+        auto newLines = TextMerge::SplitLines(newText);
+        std::string out;
+        size_t pos = 0;
+        for (const auto& h : TextMerge::DiffLines(oldLines, newLines)) {
+            for (; pos < h.baseStart; ++pos) out += oldLines[pos];
+            for (size_t i = 0; i < h.otherCount; ++i) out += newLines[h.otherStart + i];
+            pos += h.baseCount;
+        }
+        for (; pos < oldLines.size(); ++pos) out += oldLines[pos];
+        return out;
+    }
+}
+
+TEST(SplitLinesKeepsTerminators) {
+    auto lines = TextMerge::SplitLines("a\nb\n\nc");
+    REQUIRE(lines.size() == 4);
+    CHECK_EQ(std::string(lines[0]), std::string("a\n"));
+    CHECK_EQ(std::string(lines[2]), std::string("\n"));
+    CHECK_EQ(std::string(lines[3]), std::string("c"));
+    CHECK(TextMerge::SplitLines("").empty());
+}
+
+TEST(DiffOfIdenticalTextIsEmpty) {
+    CHECK(TextMerge::Diff("a\nb\nc\n", "a\nb\nc\n").empty());
+}
+
+TEST(DiffReconstructsNewText) {
+    const char* cases[][2] = {
+        {"", "a\nb\n"},
+        {"a\nb\n", ""},
+        {"a\nb\nc\nd\n", "a\nx\nc\nd\ny\n"},
+        {"one\ntwo\nthree\nfour\nfive\n", "zero\none\nthree\nfour\nfive\nsix\n"},
+        {"}\n}\n}\nx\n", "}\nx\n}\n}\n"},
+    };
+    for (const auto& c : cases) {
+        CHECK_EQ(applyHunks(c[0], c[1]), std::string(c[1]));
+    }
+}
+
+TEST(MergeTakesNonOverlappingChanges) {
+    std::string base = "a\nb\nc\nd\ne\n";
+    std::string local = "A\nb\nc\nd\ne\n";
+    std::string remote = "a\nb\nc\nd\nE\n";
+    auto merged = TextMerge::Merge(base, local, remote);
+    CHECK_EQ(merged.conflicts, size_t(0));
+    CHECK_EQ(merged.text, std::string("A\nb\nc\nd\nE\n"));
+}
+
+TEST(MergeTakesIdenticalChangesOnce) {
+    auto merged = TextMerge::Merge("a\nb\n", "a\nB\n", "a\nB\n");
+    CHECK_EQ(merged.conflicts, size_t(0));
+    CHECK_EQ(merged.text, std::string("a\nB\n"));
+}
+
+TEST(MergeMarksConflicts) {
+    auto merged = TextMerge::Merge("a\nb\nc\n", "a\nlocal\nc\n", "a\nremote\nc\n");
+    CHECK_EQ(merged.conflicts, size_t(1));
+    CHECK(merged.text.find("<<<<<<< local") != std::string::npos);
+    CHECK(merged.text.find(">>>>>>> keep") != std::string::npos);
+    CHECK(merged.text.find("local\n") != std::string::npos);
+    CHECK(merged.text.find("remote\n") != std::string::npos);
+}
+
+TEST(NormalizeNewlines) {
+    CHECK_EQ(TextMerge::NormalizeNewlines("a\r\nb\r\n\nc"), std::string("a\nb\n\nc"));
+    CHECK_EQ(TextMerge::NormalizeNewlines("no newline"), std::string("no newline"));
+}
+
+TEST_MAIN()
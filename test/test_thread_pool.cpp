@@ -0,0 +1,94 @@
+// ThreadPool tests: completion, nested submits, stealing and errors
+
+#include "TestHarness.h"
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+
+TEST(RunsEveryTask) {
+    ThreadPool pool(4);
+    std::atomic<int> count{0};
+    for (int i = 0; i < 10000; ++i) {
+        pool.Submit([&] { count.fetch_add(1); });
+    }
+    pool.Wait();
+    CHECK_EQ(count.load(), 10000);
+    CHECK_EQ(pool.Size(), size_t(4));
+}
+
+TEST(WaitIsReusable) {
+    ThreadPool pool(2);
+    std::atomic<int> count{0};
+    pool.Wait();    // Nothing submitted yet
+    for (int round = 1; round <= 3; ++round) {
+        for (int i = 0; i < 100; ++i) {
+            pool.Submit([&] { count.fetch_add(1); });
+        }
+        pool.Wait();
+        CHECK_EQ(count.load(), round * 100);
+    }
+}
+
+TEST(NestedSubmit) {
+    ThreadPool pool(3);
+    std::atomic<int> leaves{0};
+    for (int i = 0; i < 10; ++i) {
+        pool.Submit([&] {
+            for (int j = 0; j < 10; ++j) {
+                pool.Submit([&] { leaves.fetch_add(1); });
+            }
+        });
+    }
+    pool.Wait();
+    CHECK_EQ(leaves.load(), 100);
+}
+
+TEST(IdleWorkersSteal) {
+    ThreadPool pool(4);
+    std::atomic<int> count{0};
+    // One task fans out onto its own worker's deque; the others must steal
+    pool.Submit([&] {
+        for (int i = 0; i < 64; ++i) {
+            pool.Submit([&] {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                count.fetch_add(1);
+            });
+        }
+    });
+    pool.Wait();
+    CHECK_EQ(count.load(), 64);
+    CHECK(pool.Steals() > 0);
+}
+
+TEST(RethrowsTaskException) {
+    ThreadPool pool(2);
+    std::atomic<int> count{0};
+    pool.Submit([] { throw std::runtime_error("boom"); });
+    for (int i = 0; i < 10; ++i) {
+        pool.Submit([&] { count.fetch_add(1); });
+    }
+    bool threw = false;
+    try {
+        pool.Wait();
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    CHECK(threw);
+    CHECK_EQ(count.load(), 10);
+    pool.Wait();    // Error reported once
+}
+
+TEST(DestructorDrainsQueue) {
+    std::atomic<int> count{0};
+    {
+        ThreadPool pool(2);
+        for (int i = 0; i < 500; ++i) {
+            pool.Submit([&] { count.fetch_add(1); });
+        }
+    }
+    CHECK_EQ(count.load(), 500);
+}
+
+TEST_MAIN()
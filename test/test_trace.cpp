@@ -0,0 +1,71 @@
+// Trace tests: event recording and Chrome trace output
+
+#include "TestHarness.h"
+#include "Trace.h"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace {
+    std::string readFile(const std::filesystem::path& path) {
+        std::ifstream in(path);
+        std::ostringstream out;
+        out << in.rdbuf();
+        return out.str();
+    }
+
+    size_t countOf(const std::string& text, const std::string& needle) {
+        size_t count = 0;
+        for (size_t pos = text.find(needle); pos != std::string::npos; pos = text.find(needle, pos + 1)) {
+            count++;
+        }
+        return count;
+    }
+}
+
+TEST(DisabledScopesRecordNothing) {
+    Trace::Disable();
+    { TRACE_SCOPE("should_not_appear"); }
+
+    auto path = std::filesystem::temp_directory_path() / "keepsync_test_trace_off.json";
+    Trace::Enable(path.wstring());
+    Trace::Disable();
+    REQUIRE(Trace::Flush());
+    CHECK(readFile(path).find("should_not_appear") == std::string::npos);
+    std::filesystem::remove(path);
+}
+
+TEST(ConcurrentScopesAreFlushed) {
+    auto path = std::filesystem::temp_directory_path() / "keepsync_test_trace.json";
+    Trace::Enable(path.wstring());
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([] {
+            for (int i = 0; i < 500; ++i) {
+                TRACE_SCOPE("worker_stage");
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    { TRACE_SCOPE(Trace::Intern("bridge:" + std::string("status"))); }
+    REQUIRE(Trace::Flush());
+    Trace::Disable();
+
+    std::string json = readFile(path);
+    CHECK(json.rfind("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 0) == 0);
+    CHECK(json.find("]}") != std::string::npos);
+    CHECK_EQ(countOf(json, "\"worker_stage\""), size_t(2000));
+    CHECK_EQ(countOf(json, "\"bridge:status\""), size_t(1));
+    std::filesystem::remove(path);
+}
+
+TEST(FlushWithoutPathFails) {
+    Trace::Enable(L"");
+    CHECK(!Trace::Enabled());
+    CHECK(!Trace::Flush());
+}
+
+TEST_MAIN()
@@ -0,0 +1,107 @@
+// Utf tests: UTF-8 / wide conversion, validation and malformed input
+
+#include "TestHarness.h"
+#include "Utf.h"
+
+namespace {
+    // "Grüße, 東京 😀" with ASCII on both sides of the SIMD block size
+    const char* const kUtf8 = "A long enough ASCII lead-in. Gr\xC3\xBC\xC3\x9F" "e, \xE6\x9D\xB1\xE4\xBA\xAC \xF0\x9F\x98\x80 and an ASCII tail";
+
+    std::wstring wide() {
+        std::wstring text = L"A long enough ASCII lead-in. Grüße, 東京 ";
+        if (sizeof(wchar_t) == 2) {
+            text += static_cast<wchar_t>(0xD83D);
+            text += static_cast<wchar_t>(0xDE00);
+        } else {
+            text += static_cast<wchar_t>(0x1F600);
+        }
+        return text + L" and an ASCII tail";
+    }
+}
+
+TEST(RoundTripsMixedText) {
+    CHECK(Utf::ToUtf8(wide()) == kUtf8);
+    CHECK(Utf::FromUtf8(kUtf8) == wide());
+    CHECK(Utf::ToUtf8(L"").empty());
+    CHECK(Utf::FromUtf8("").empty());
+}
+
+TEST(EveryLengthAndOffset) {
+    // Non-ASCII at each position of runs around the 16-character blocks
+    for (size_t length = 0; length < 40; ++length) {
+        for (size_t at = 0; at <= length; ++at) {
+            std::wstring text(length, L'x');
+            if (at < length) text[at] = L'é';
+            std::string utf8 = Utf::ToUtf8(text);
+            CHECK_EQ(utf8.size(), length + (at < length ? 1 : 0));
+            CHECK(Utf::FromUtf8(utf8) == text);
+        }
+    }
+}
+
+TEST(MalformedUtf8BecomesReplacement) {
+    const wchar_t r = static_cast<wchar_t>(0xFFFD);
+    CHECK(Utf::FromUtf8("a\xFF" "b") == (std::wstring(L"a") + r + L"b"));
+    CHECK(Utf::FromUtf8("\xC0\xAF") == (std::wstring() + r + r));         // Overlong '/'
+    CHECK(Utf::FromUtf8("\xED\xA0\x80") == (std::wstring() + r + r + r));  // Encoded surrogate
+    CHECK(Utf::FromUtf8("\xE6\x9D") == (std::wstring() + r));              // Truncated, one replacement
+    CHECK(Utf::FromUtf8("\xF4\x90\x80\x80").size() == 4);                   // Past U+10FFFF
+
+    CHECK(Utf::IsValidUtf8(kUtf8));
+    CHECK(Utf::IsValidUtf8("\xEF\xBF\xBD"));    // U+FFFD itself is fine
+    CHECK(!Utf::IsValidUtf8("caf\xE9"));        // Latin-1
+    CHECK(!Utf::IsValidUtf8(std::string(40, 'a') + "\xC3"));
+}
+
+TEST(UnpairedSurrogatesBecomeReplacement) {
+    std::wstring text = L"a";
+    text += static_cast<wchar_t>(0xDC00);
+    text += L"b";
+    CHECK(Utf::ToUtf8(text) == "a\xEF\xBF\xBD" "b");
+}
+
+TEST(Utf16) {
+    std::u16string text = u"Grüße, 東京 \U0001F600 and more than sixteen ASCII characters";
+    std::string utf8 = Utf::ToUtf8(text);
+    CHECK(utf8 == "Gr\xC3\xBC\xC3\x9F" "e, \xE6\x9D\xB1\xE4\xBA\xAC \xF0\x9F\x98\x80 and more than sixteen ASCII characters");
+    CHECK(Utf::ToUtf16(utf8) == text);
+
+    for (size_t length = 0; length < 40; ++length) {
+        for (size_t at = 0; at + 1 < length; ++at) {
+            std::u16string run(length, u'x');
+            run[at] = 0xD83D;       // Surrogate pair straddling block boundaries
+            run[at + 1] = 0xDE00;
+            CHECK(Utf::ToUtf16(Utf::ToUtf8(run)) == run);
+        }
+    }
+
+    std::u16string lone = u"a";
+    lone += static_cast<char16_t>(0xD800);
+    CHECK(Utf::ToUtf8(lone) == "a\xEF\xBF\xBD");
+}
+
+TEST(Cp1252AndDecode) {
+    CHECK(Utf::FromCp1252("caf\xE9") == "caf\xC3\xA9");
+    CHECK(Utf::FromCp1252("plain") == "plain");
+    // Euro sign, curly quotes and an en dash rather than C1 controls
+    CHECK(Utf::FromCp1252("\x80 \x93q\x94 \x96") == "\xE2\x82\xAC \xE2\x80\x9Cq\xE2\x80\x9D \xE2\x80\x93");
+    CHECK(Utf::FromCp1252("\x81") == "\xC2\x81");     // Undefined in Windows-1252
+
+    char byte;
+    CHECK(Utf::ToCp1252(0x20AC, byte) && byte == '\x80');
+    CHECK(Utf::ToCp1252(0xE9, byte) && byte == '\xE9');
+    CHECK(Utf::ToCp1252(0x81, byte) && byte == '\x81');
+    CHECK(!Utf::ToCp1252(0x80, byte));
+    CHECK(!Utf::ToCp1252(0x6771, byte));
+
+    char32_t cp;
+    CHECK_EQ(Utf::Decode(kUtf8, 31, cp), size_t(2));
+    CHECK(cp == 0xFC);
+    CHECK_EQ(Utf::AsciiPrefix(kUtf8), size_t(31));
+
+    std::string out;
+    Utf::Append(out, 0x1F600);
+    CHECK(out == "\xF0\x9F\x98\x80");
+}
+
+TEST_MAIN()